@@ -49,8 +49,7 @@ NamedValueSet::NamedValue& NamedValueSet::NamedValue::operator= (const NamedValu
 
 #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
 NamedValueSet::NamedValue::NamedValue (NamedValue&& other) noexcept
-    : nextListItem (static_cast <LinkedListPointer<NamedValue>&&> (other.nextListItem)),
-      name (static_cast <Identifier&&> (other.name)),
+    : name (static_cast <Identifier&&> (other.name)),
       value (static_cast <var&&> (other.value))
 {
 }
@@ -62,7 +61,6 @@ inline NamedValueSet::NamedValue::NamedValue (const Identifier& name_, var&& val
 
 NamedValueSet::NamedValue& NamedValueSet::NamedValue::operator= (NamedValue&& other) noexcept
 {
-    nextListItem = static_cast <LinkedListPointer<NamedValue>&&> (other.nextListItem);
     name = static_cast <Identifier&&> (other.name);
     value = static_cast <var&&> (other.value);
     return *this;
@@ -80,26 +78,28 @@ NamedValueSet::NamedValueSet() noexcept
 }
 
 NamedValueSet::NamedValueSet (const NamedValueSet& other)
+    : values (other.values), hashSlots (other.hashSlots)
 {
-    values.addCopyOfList (other.values);
 }
 
 NamedValueSet& NamedValueSet::operator= (const NamedValueSet& other)
 {
-    clear();
-    values.addCopyOfList (other.values);
+    values = other.values;
+    hashSlots = other.hashSlots;
     return *this;
 }
 
 #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
 NamedValueSet::NamedValueSet (NamedValueSet&& other) noexcept
-    : values (static_cast <LinkedListPointer<NamedValue>&&> (other.values))
+    : values (static_cast <Array<NamedValue>&&> (other.values)),
+      hashSlots (static_cast <Array<int>&&> (other.hashSlots))
 {
 }
 
 NamedValueSet& NamedValueSet::operator= (NamedValueSet&& other) noexcept
 {
-    other.values.swapWith (values);
+    other.values.swapWithArray (values);
+    other.hashSlots.swapWithArray (hashSlots);
     return *this;
 }
 #endif
@@ -111,23 +111,18 @@ NamedValueSet::~NamedValueSet()
 
 void NamedValueSet::clear()
 {
-    values.deleteAll();
+    values.clear();
+    hashSlots.clear();
 }
 
 bool NamedValueSet::operator== (const NamedValueSet& other) const
 {
-    const NamedValue* i1 = values;
-    const NamedValue* i2 = other.values;
+    const int num = jmin (values.size(), other.values.size());
 
-    while (i1 != nullptr && i2 != nullptr)
-    {
-        if (! (*i1 == *i2))
+    for (int i = 0; i < num; ++i)
+        if (! (values.getReference (i) == other.values.getReference (i)))
             return false;
 
-        i1 = i1->nextListItem;
-        i2 = i2->nextListItem;
-    }
-
     return true;
 }
 
@@ -143,11 +138,8 @@ int NamedValueSet::size() const noexcept
 
 const var& NamedValueSet::operator[] (const Identifier& name) const
 {
-    for (NamedValue* i = values; i != nullptr; i = i->nextListItem)
-        if (i->name == name)
-            return i->value;
-
-    return var::null;
+    const int index = indexOf (name);
+    return index >= 0 ? values.getReference (index).value : var::null;
 }
 
 var NamedValueSet::getWithDefault (const Identifier& name, const var& defaultReturnValue) const
@@ -158,60 +150,47 @@ var NamedValueSet::getWithDefault (const Identifier& name, const var& defaultRet
 
 var* NamedValueSet::getVarPointer (const Identifier& name) const noexcept
 {
-    for (NamedValue* i = values; i != nullptr; i = i->nextListItem)
-        if (i->name == name)
-            return &(i->value);
-
-    return nullptr;
+    const int index = indexOf (name);
+    return index >= 0 ? &(values.getReference (index).value) : nullptr;
 }
 
 #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
 bool NamedValueSet::set (const Identifier& name, var&& newValue)
 {
-    LinkedListPointer<NamedValue>* i = &values;
+    const int index = indexOf (name);
 
-    while (i->get() != nullptr)
+    if (index >= 0)
     {
-        NamedValue* const v = i->get();
+        var& v = values.getReference (index).value;
 
-        if (v->name == name)
-        {
-            if (v->value.equalsWithSameType (newValue))
-                return false;
-
-            v->value = static_cast <var&&> (newValue);
-            return true;
-        }
+        if (v.equalsWithSameType (newValue))
+            return false;
 
-        i = &(v->nextListItem);
+        v = static_cast <var&&> (newValue);
+        return true;
     }
 
-    i->insertNext (new NamedValue (name, static_cast <var&&> (newValue)));
+    addValue (NamedValue (name, static_cast <var&&> (newValue)));
     return true;
 }
 #endif
 
 bool NamedValueSet::set (const Identifier& name, const var& newValue)
 {
-    LinkedListPointer<NamedValue>* i = &values;
+    const int index = indexOf (name);
 
-    while (i->get() != nullptr)
+    if (index >= 0)
     {
-        NamedValue* const v = i->get();
-
-        if (v->name == name)
-        {
-            if (v->value.equalsWithSameType (newValue))
-                return false;
+        var& v = values.getReference (index).value;
 
-            v->value = newValue;
-            return true;
-        }
+        if (v.equalsWithSameType (newValue))
+            return false;
 
-        i = &(v->nextListItem);
+        v = newValue;
+        return true;
     }
 
-    i->insertNext (new NamedValue (name, newValue));
+    addValue (NamedValue (name, newValue));
     return true;
 }
 
@@ -222,62 +201,272 @@ bool NamedValueSet::contains (const Identifier& name) const
 
 bool NamedValueSet::remove (const Identifier& name)
 {
-    LinkedListPointer<NamedValue>* i = &values;
-
-    for (;;)
-    {
-        NamedValue* const v = i->get();
+    const int index = indexOf (name);
 
-        if (v == nullptr)
-            break;
-
-        if (v->name == name)
-        {
-            delete i->removeNext();
-            return true;
-        }
+    if (index < 0)
+        return false;
 
-        i = &(v->nextListItem);
+    if (hashSlots.size() > 0)
+    {
+        if (values.size() <= minimumSizeForHashing)
+            hashSlots.clear();
+        else
+            removeFromHashTable (index);
     }
 
-    return false;
+    values.remove (index);
+    return true;
 }
 
 const Identifier NamedValueSet::getName (const int index) const
 {
-    const NamedValue* const v = values[index];
-    jassert (v != nullptr);
-    return v->name;
+    jassert (isPositiveAndBelow (index, values.size()));
+    return values [index].name;
 }
 
 const var& NamedValueSet::getValueAt (const int index) const
 {
-    const NamedValue* const v = values[index];
-    jassert (v != nullptr);
-    return v->value;
+    if (isPositiveAndBelow (index, values.size()))
+        return values.getReference (index).value;
+
+    jassertfalse;
+    return var::null;
 }
 
 void NamedValueSet::setFromXmlAttributes (const XmlElement& xml)
 {
     clear();
-    LinkedListPointer<NamedValue>::Appender appender (values);
 
     const int numAtts = xml.getNumAttributes(); // xxx inefficient - should write an att iterator..
+    values.ensureStorageAllocated (numAtts);
 
     for (int i = 0; i < numAtts; ++i)
-        appender.append (new NamedValue (xml.getAttributeName (i), var (xml.getAttributeValue (i))));
+        values.add (NamedValue (xml.getAttributeName (i), var (xml.getAttributeValue (i))));
+
+    if (numAtts >= minimumSizeForHashing)
+        rebuildHashTable();
 }
 
 void NamedValueSet::copyToXmlAttributes (XmlElement& xml) const
 {
-    for (NamedValue* i = values; i != nullptr; i = i->nextListItem)
+    for (int i = 0; i < values.size(); ++i)
+    {
+        const NamedValue& v = values.getReference (i);
+        jassert (! v.value.isObject()); // DynamicObjects can't be stored as XML!
+
+        xml.setAttribute (v.name.toString(),
+                          v.value.toString());
+    }
+}
+
+//==============================================================================
+namespace NamedValueSetHelpers
+{
+    // Identifiers are pooled, so two of them are equal if their string pointers are.
+    inline int getHashSlot (const Identifier& name, const int numSlots) noexcept
+    {
+        const pointer_sized_uint address = (pointer_sized_uint) ((String::CharPointerType) name).getAddress();
+        return (int) ((uint32) ((address >> 3) * 2654435761u) & (uint32) (numSlots - 1));
+    }
+}
+
+int NamedValueSet::indexOf (const Identifier& name) const noexcept
+{
+    const int numSlots = hashSlots.size();
+
+    if (numSlots == 0)
+    {
+        for (int i = 0; i < values.size(); ++i)
+            if (values.getReference (i).name == name)
+                return i;
+
+        return -1;
+    }
+
+    const int* const slots = hashSlots.begin();
+
+    for (int slot = NamedValueSetHelpers::getHashSlot (name, numSlots);; slot = (slot + 1) & (numSlots - 1))
+    {
+        const int index = slots [slot] - 1;
+
+        if (index < 0 || values.getReference (index).name == name)
+            return index;
+    }
+}
+
+void NamedValueSet::addValue (const NamedValue& newValue)
+{
+    values.add (newValue);
+
+    const int numSlots = hashSlots.size();
+
+    if (numSlots == 0 ? values.size() >= minimumSizeForHashing
+                      : values.size() * 2 > numSlots)
+    {
+        rebuildHashTable();
+    }
+    else if (numSlots > 0)
+    {
+        int slot = NamedValueSetHelpers::getHashSlot (newValue.name, numSlots);
+
+        while (hashSlots.getUnchecked (slot) != 0)
+            slot = (slot + 1) & (numSlots - 1);
+
+        hashSlots.set (slot, values.size());
+    }
+}
+
+// Must be called before the value is removed from the array. The table uses linear probing,
+// so rather than leaving a tombstone, any entries after the hole that would no longer be
+// reachable are shifted back into it.
+void NamedValueSet::removeFromHashTable (const int index)
+{
+    const int numSlots = hashSlots.size();
+    int* const slots = hashSlots.getRawDataPointer();
+
+    int hole = NamedValueSetHelpers::getHashSlot (values.getReference (index).name, numSlots);
+
+    while (slots [hole] != index + 1)
+        hole = (hole + 1) & (numSlots - 1);
+
+    for (int slot = (hole + 1) & (numSlots - 1); slots [slot] != 0; slot = (slot + 1) & (numSlots - 1))
     {
-        jassert (! i->value.isObject()); // DynamicObjects can't be stored as XML!
+        const int home = NamedValueSetHelpers::getHashSlot (values.getReference (slots [slot] - 1).name, numSlots);
 
-        xml.setAttribute (i->name.toString(),
-                          i->value.toString());
+        // (an entry can only move back if its home slot isn't between the hole and where it is now)
+        if (((slot - home) & (numSlots - 1)) >= ((slot - hole) & (numSlots - 1)))
+        {
+            slots [hole] = slots [slot];
+            hole = slot;
+        }
     }
+
+    slots [hole] = 0;
+
+    // the values after the removed one are about to move down by one place
+    if (index < values.size() - 1)
+        for (int i = 0; i < numSlots; ++i)
+            if (slots[i] > index + 1)
+                --slots[i];
 }
 
+void NamedValueSet::rebuildHashTable()
+{
+    hashSlots.clearQuick();
+
+    if (values.size() < minimumSizeForHashing)
+        return;
+
+    int numSlots = 64;
+    while (numSlots < values.size() * 4)
+        numSlots <<= 1;
+
+    hashSlots.insertMultiple (0, 0, numSlots);
+    int* const slots = hashSlots.getRawDataPointer();
+
+    for (int i = 0; i < values.size(); ++i)
+    {
+        int slot = NamedValueSetHelpers::getHashSlot (values.getReference (i).name, numSlots);
+
+        while (slots [slot] != 0)
+            slot = (slot + 1) & (numSlots - 1);
+
+        slots [slot] = i + 1;
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NamedValueSetTests  : public UnitTest
+{
+public:
+    NamedValueSetTests() : UnitTest ("NamedValueSet") {}
+
+    void checkAgainst (const NamedValueSet& set, const StringArray& names, const Array<int>& values, const int numNames)
+    {
+        expectEquals (set.size(), names.size());
+
+        for (int i = 0; i < names.size(); ++i)
+        {
+            expectEquals (set.getName (i).toString(), names[i]);
+            expect (set.getValueAt (i) == var (values[i]));
+        }
+
+        for (int i = 0; i < numNames; ++i)
+        {
+            const String name ("n" + String (i));
+            const int index = names.indexOf (name);
+
+            expect (set.contains (name) == (index >= 0));
+            expect (set [name] == (index >= 0 ? var (values[index]) : var::null));
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("Adding, removing and renaming");
+
+        Random r (4321);
+        const int numNames = 60;
+
+        NamedValueSet set;
+        StringArray names;
+        Array<int> values;
+
+        for (int i = 0; i < 3000; ++i)
+        {
+            const String name ("n" + String (r.nextInt (numNames)));
+            const int index = names.indexOf (name);
+            const int value = r.nextInt (1000);
+
+            switch (r.nextInt (4))
+            {
+                case 0:
+                case 1:
+                    expect (set.set (name, value) == (index < 0 || values[index] != value));
+
+                    if (index >= 0)
+                    {
+                        values.set (index, value);
+                    }
+                    else
+                    {
+                        names.add (name);
+                        values.add (value);
+                    }
+
+                    break;
+
+                case 2:
+                    expect (set.remove (name) == (index >= 0));
+                    names.remove (index);
+                    values.remove (index);
+                    break;
+
+                default:
+                    // renaming is done by removing the old name and adding the new one
+                    if (index >= 0 && ! names.contains (name + "x"))
+                    {
+                        const var oldValue (set [name]);
+                        set.remove (name);
+                        set.set (name + "x", oldValue);
+
+                        names.remove (index);
+                        names.add (name + "x");
+                        values.add (values.remove (index));
+                    }
+
+                    break;
+            }
+
+            checkAgainst (set, names, values, numNames);
+        }
+    }
+};
+
+static NamedValueSetTests namedValueSetUnitTests;
+
+#endif
 
 END_JUCE_NAMESPACE
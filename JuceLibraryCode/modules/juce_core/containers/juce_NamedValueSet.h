@@ -27,7 +27,7 @@
 #define __JUCE_NAMEDVALUESET_JUCEHEADER__
 
 #include "juce_Variant.h"
-#include "../containers/juce_LinkedListPointer.h"
+#include "../containers/juce_Array.h"
 class XmlElement;
 #ifndef DOXYGEN
  class JSONFormatter;
@@ -39,6 +39,10 @@ class XmlElement;
 
     This can be used as a basic structure to hold a set of var object, which can
     be retrieved by using their identifier.
+
+    The values are kept in the order in which they were added. Small sets are
+    searched linearly, but once a set grows beyond a handful of items, it also
+    builds a hash table so that looking up a name doesn't depend on the set's size.
 */
 class JUCE_API  NamedValueSet
 {
@@ -148,7 +152,6 @@ private:
        #endif
         bool operator== (const NamedValue& other) const noexcept;
 
-        LinkedListPointer<NamedValue> nextListItem;
         Identifier name;
         var value;
 
@@ -156,8 +159,15 @@ private:
         JUCE_LEAK_DETECTOR (NamedValue);
     };
 
-    friend class LinkedListPointer<NamedValue>;
-    LinkedListPointer<NamedValue> values;
+    Array<NamedValue> values;
+    Array<int> hashSlots;   // (indexes into the values array + 1, or 0 for an empty slot)
+
+    enum { minimumSizeForHashing = 16 };
+
+    int indexOf (const Identifier& name) const noexcept;
+    void addValue (const NamedValue& newValue);
+    void rebuildHashTable();
+    void removeFromHashTable (int index);
 
     friend class JSONFormatter;
 };
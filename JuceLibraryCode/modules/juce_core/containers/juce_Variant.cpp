@@ -610,6 +610,16 @@ void var::writeToStream (OutputStream& output) const
 }
 
 var var::readFromStream (InputStream& input)
+{
+    return readFromStream (input, static_cast <ObjectArena*> (nullptr));
+}
+
+var var::readFromStream (InputStream& input, ObjectArena& arena)
+{
+    return readFromStream (input, &arena);
+}
+
+var var::readFromStream (InputStream& input, ObjectArena* const arena)
 {
     const int numBytes = input.readCompressedInt();
 
@@ -624,6 +634,23 @@ var var::readFromStream (InputStream& input)
             case varMarker_Double:      return var (input.readDouble());
             case varMarker_String:
             {
+                if (arena != nullptr)
+                {
+                    char localBuffer [256];
+                    HeapBlock<char> heapBuffer;
+                    char* text = localBuffer;
+
+                    if (numBytes > numElementsInArray (localBuffer))
+                    {
+                        heapBuffer.malloc ((size_t) numBytes);
+                        text = heapBuffer;
+                    }
+
+                    const int numRead = jmax (0, input.read (text, numBytes - 1));
+                    text [numRead] = 0;
+                    return var (arena->getPooledString (CharPointer_UTF8 (text)));
+                }
+
                 MemoryOutputStream mo;
                 mo.writeFromInputStream (input, numBytes - 1);
                 return var (mo.toUTF8());
@@ -635,7 +662,7 @@ var var::readFromStream (InputStream& input)
                 Array<var>* const destArray = v.convertToArray();
 
                 for (int i = input.readCompressedInt(); --i >= 0;)
-                    destArray->add (readFromStream (input));
+                    destArray->add (readFromStream (input, arena));
 
                 return v;
             }
@@ -34,6 +34,7 @@
 #ifndef DOXYGEN
  class ReferenceCountedObject;
  class DynamicObject;
+ class ObjectArena;
 #endif
 
 //==============================================================================
@@ -234,6 +235,12 @@ public:
     */
     static var readFromStream (InputStream& input);
 
+    /** Reads back a stored binary representation of a value, sharing its string data
+        with any equal strings that have already been pooled in the given arena.
+        @see ObjectArena
+    */
+    static var readFromStream (InputStream& input, ObjectArena& arena);
+
 private:
     //==============================================================================
     class VariantType;         friend class VariantType;
@@ -263,6 +270,7 @@ private:
     ValueUnion value;
 
     Array<var>* convertToArray();
+    static var readFromStream (InputStream&, ObjectArena*);
     friend class DynamicObject;
     var invokeMethod (DynamicObject*, const var*, int) const;
 };
@@ -29,16 +29,16 @@ BEGIN_JUCE_NAMESPACE
 class JSONParser
 {
 public:
-    static Result parseAny (String::CharPointerType& t, var& result)
+    static Result parseAny (String::CharPointerType& t, var& result, ObjectArena* const arena)
     {
         t = t.findEndOfWhitespace();
         String::CharPointerType t2 (t);
 
         switch (t2.getAndAdvance())
         {
-            case '{':    t = t2; return parseObject (t, result);
-            case '[':    t = t2; return parseArray (t, result);
-            case '"':    t = t2; return parseString (t, result);
+            case '{':    t = t2; return parseObject (t, result, arena);
+            case '[':    t = t2; return parseArray (t, result, arena);
+            case '"':    t = t2; return parseString (t, result, arena);
 
             case '-':
                 t2 = t2.findEndOfWhitespace();
@@ -88,6 +88,19 @@ public:
     }
 
 private:
+    class ArenaObject  : public DynamicObject
+    {
+    public:
+        ArenaObject() {}
+
+        static void* operator new (size_t size, ObjectArena& arena)   { return arena.allocateObject (size); }
+        static void operator delete (void* p, ObjectArena&) noexcept  { ObjectArena::releaseObject (p); }
+        static void operator delete (void* p) noexcept               { ObjectArena::releaseObject (p); }
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (ArenaObject);
+    };
+
     static Result createFail (const char* const message, const String::CharPointerType* location = nullptr)
     {
         String m (message);
@@ -144,9 +157,10 @@ private:
         return Result::ok();
     }
 
-    static Result parseObject (String::CharPointerType& t, var& result)
+    static Result parseObject (String::CharPointerType& t, var& result, ObjectArena* const arena)
     {
-        DynamicObject* const resultObject = new DynamicObject();
+        DynamicObject* const resultObject = arena != nullptr ? new (*arena) ArenaObject()
+                                                             : new DynamicObject();
         result = resultObject;
         NamedValueSet& resultProperties = resultObject->getProperties();
 
@@ -166,14 +180,14 @@ private:
             if (c == '"')
             {
                 var propertyNameVar;
-                Result r (parseString (t, propertyNameVar));
+                Result r (parseString (t, propertyNameVar, arena));
 
                 if (r.failed())
                     return r;
 
-                const String propertyName (propertyNameVar.toString());
+                const String propertyNameString (propertyNameVar.toString());
 
-                if (propertyName.isNotEmpty())
+                if (propertyNameString.isNotEmpty())
                 {
                     t = t.findEndOfWhitespace();
                     oldT = t;
@@ -182,10 +196,13 @@ private:
                     if (c2 != ':')
                         return createFail ("Expected ':', but found", &oldT);
 
+                    const Identifier propertyName (arena != nullptr ? arena->getPooledIdentifier (propertyNameString.getCharPointer())
+                                                                    : Identifier (propertyNameString));
+
                     resultProperties.set (propertyName, var::null);
                     var* propertyValue = resultProperties.getVarPointer (propertyName);
 
-                    Result r2 (parseAny (t, *propertyValue));
+                    Result r2 (parseAny (t, *propertyValue, arena));
 
                     if (r2.failed())
                         return r2;
@@ -208,7 +225,7 @@ private:
         return Result::ok();
     }
 
-    static Result parseArray (String::CharPointerType& t, var& result)
+    static Result parseArray (String::CharPointerType& t, var& result, ObjectArena* const arena)
     {
         result = var (Array<var>());
         Array<var>* const destArray = result.getArray();
@@ -228,7 +245,7 @@ private:
 
             t = oldT;
             destArray->add (var::null);
-            Result r (parseAny (t, destArray->getReference (destArray->size() - 1)));
+            Result r (parseAny (t, destArray->getReference (destArray->size() - 1), arena));
 
             if (r.failed())
                 return r;
@@ -249,10 +266,13 @@ private:
         return Result::ok();
     }
 
-    static Result parseString (String::CharPointerType& t, var& result)
+    static Result parseString (String::CharPointerType& t, var& result, ObjectArena* const arena)
     {
-        Array<juce_wchar> buffer;
-        buffer.ensureStorageAllocated (256);
+        // most strings fit in the local buffer, so only long ones need a heap allocation
+        juce_wchar localBuffer [256];
+        HeapBlock<juce_wchar> heapBuffer;
+        juce_wchar* buffer = localBuffer;
+        int numChars = 0, bufferSize = numElementsInArray (localBuffer);
 
         for (;;)
         {
@@ -298,11 +318,34 @@ private:
             if (c == 0)
                 return createFail ("Unexpected end-of-input in string constant");
 
-            buffer.add (c);
+            if (numChars >= bufferSize - 1)
+            {
+                bufferSize *= 2;
+
+                if (buffer == localBuffer)
+                {
+                    heapBuffer.malloc ((size_t) bufferSize);
+                    memcpy (heapBuffer, localBuffer, sizeof (localBuffer));
+                }
+                else
+                {
+                    heapBuffer.realloc ((size_t) bufferSize);
+                }
+
+                buffer = heapBuffer;
+            }
+
+            buffer [numChars++] = c;
         }
 
-        buffer.add (0);
-        result = String (CharPointer_UTF32 (buffer.getRawDataPointer()));
+        buffer [numChars] = 0;
+        const CharPointer_UTF32 text (buffer);
+
+        if (arena != nullptr)
+            result = arena->getPooledString (text);
+        else
+            result = String (text);
+
         return Result::ok();
     }
 };
@@ -346,14 +389,8 @@ public:
         }
     }
 
-private:
     enum { indentSize = 2 };
 
-    static void writeEscapedChar (OutputStream& out, const unsigned short value)
-    {
-        out << "\\u" << String::toHexString ((int) value).paddedLeft ('0', 4);
-    }
-
     static void writeString (OutputStream& out, String::CharPointerType t)
     {
         out << '"';
@@ -401,6 +438,12 @@ private:
         }
     }
 
+private:
+    static void writeEscapedChar (OutputStream& out, const unsigned short value)
+    {
+        out << "\\u" << String::toHexString ((int) value).paddedLeft ('0', 4);
+    }
+
     static void writeSpaces (OutputStream& out, int numSpaces)
     {
         out.writeRepeatedByte (' ', numSpaces);
@@ -446,23 +489,20 @@ private:
         if (! allOnOneLine)
             out << newLine;
 
-        LinkedListPointer<NamedValueSet::NamedValue>* i = &(props.values);
+        const int numProps = props.size();
 
-        for (;;)
+        for (int i = 0; i < numProps; ++i)
         {
-            NamedValueSet::NamedValue* const v = i->get();
-
-            if (v == nullptr)
-                break;
+            const NamedValueSet::NamedValue& v = props.values.getReference (i);
 
             if (! allOnOneLine)
                 writeSpaces (out, indentLevel + indentSize);
 
-            writeString (out, v->name);
+            writeString (out, v.name);
             out << ": ";
-            write (out, v->value, indentLevel + indentSize, allOnOneLine);
+            write (out, v.value, indentLevel + indentSize, allOnOneLine);
 
-            if (v->nextListItem.get() != nullptr)
+            if (i < numProps - 1)
             {
                 if (allOnOneLine)
                     out << ", ";
@@ -471,8 +511,6 @@ private:
             }
             else if (! allOnOneLine)
                 out << newLine;
-
-            i = &(v->nextListItem);
         }
 
         if (! allOnOneLine)
@@ -487,7 +525,7 @@ var JSON::parse (const String& text)
 {
     var result;
     String::CharPointerType t (text.getCharPointer());
-    if (! JSONParser::parseAny (t, result))
+    if (! JSONParser::parseAny (t, result, nullptr))
         result = var::null;
 
     return result;
@@ -506,7 +544,13 @@ var JSON::parse (const File& file)
 Result JSON::parse (const String& text, var& result)
 {
     String::CharPointerType t (text.getCharPointer());
-    return JSONParser::parseAny (t, result);
+    return JSONParser::parseAny (t, result, nullptr);
+}
+
+Result JSON::parse (const String& text, var& result, ObjectArena& arena)
+{
+    String::CharPointerType t (text.getCharPointer());
+    return JSONParser::parseAny (t, result, &arena);
 }
 
 String JSON::toString (const var& data, const bool allOnOneLine)
@@ -600,6 +644,35 @@ public:
         }
     }
 
+    static void writeItemByItem (JSONWriter& writer, const var& v)
+    {
+        if (v.isArray())
+        {
+            writer.startArray();
+
+            for (int i = 0; i < v.size(); ++i)
+                writeItemByItem (writer, v[i]);
+
+            writer.endArray();
+        }
+        else if (DynamicObject* const object = dynamic_cast<DynamicObject*> (v.getObject()))
+        {
+            writer.startObject();
+
+            for (int i = 0; i < object->getProperties().size(); ++i)
+            {
+                writer.writeName (object->getProperties().getName (i).toString());
+                writeItemByItem (writer, object->getProperties().getValueAt (i));
+            }
+
+            writer.endObject();
+        }
+        else
+        {
+            writer.writeValue (v);
+        }
+    }
+
     void runTest()
     {
         beginTest ("JSON");
@@ -628,6 +701,70 @@ public:
             var parsed = JSON::parse (asString);
             String parsedString (JSON::toString (parsed, oneLine));
             expect (asString.isNotEmpty() && parsedString == asString);
+
+            var parsedWithArena;
+            ObjectArena::Ptr arena (new ObjectArena());
+            expect (JSON::parse (asString, parsedWithArena, *arena).wasOk());
+            expect (JSON::toString (parsedWithArena, oneLine) == asString);
+        }
+
+        beginTest ("JSON streams");
+
+        for (int i = 50; --i >= 0;)
+        {
+            const var v (createRandomVar (r, 0));
+            const bool oneLine = r.nextBool();
+            const String asString (JSON::toString (v, oneLine));
+
+            MemoryOutputStream written;
+
+            {
+                JSONWriter writer (written, oneLine);
+                writeItemByItem (writer, v);
+            }
+
+            expect (written.toString() == asString);
+
+            MemoryInputStream in (written.getData(), written.getDataSize(), false);
+            JSONReader reader (in);
+            reader.readNext();
+
+            var parsed;
+            expect (reader.readValue (parsed).wasOk());
+            expect (JSON::toString (parsed, oneLine) == asString);
+            expect (reader.readNext() == JSONReader::endOfInput);
+        }
+
+        {
+            const String text ("{\"skip\": [1, {\"a\": \"b\"}, [[]]], \"keep\": -3}\n[4.5e1]");
+            MemoryInputStream in (text.toUTF8(), (size_t) text.getNumBytesAsUTF8(), false);
+            JSONReader reader (in);
+
+            expect (reader.readNext() == JSONReader::startObject);
+            expect (reader.readNext() == JSONReader::propertyName && reader.getString() == "skip");
+            expect (reader.skipValue() && reader.getDepth() == 1);
+            expect (reader.readNext() == JSONReader::propertyName && reader.getString() == "keep");
+            expect (reader.readNext() == JSONReader::numberValue && reader.getValue() == var (-3));
+            expect (reader.readNext() == JSONReader::endObject);
+            expect (reader.readNext() == JSONReader::startArray);
+            expect (reader.readNext() == JSONReader::numberValue && reader.getValue() == var (45.0));
+            expect (reader.readNext() == JSONReader::endArray);
+            expect (reader.readNext() == JSONReader::endOfInput);
+        }
+
+        {
+            const char* const badText[] = { "[1, 2", "{\"a\" 1}", "[1,]", "{\"a\": tru}", "\"abc", "[01.e]" };
+
+            for (int j = 0; j < numElementsInArray (badText); ++j)
+            {
+                MemoryInputStream in (badText[j], strlen (badText[j]), false);
+                JSONReader reader (in);
+
+                while (reader.readNext() < JSONReader::endOfInput)
+                {}
+
+                expect (reader.getCurrentToken() == JSONReader::parseError && reader.getResult().failed());
+            }
         }
     }
 };
@@ -31,6 +31,7 @@
 class InputStream;
 class OutputStream;
 class File;
+class ObjectArena;
 
 
 //==============================================================================
@@ -59,6 +60,21 @@ public:
     */
     static Result parse (const String& text, var& parsedResult);
 
+    /** Parses a string of JSON-formatted text, allocating the objects that it creates
+        from an ObjectArena.
+
+        This does the same job as parse (const String&, var&), but is intended for loading
+        large documents: the result's objects are carved out of the arena's blocks rather
+        than being individually allocated, and all the property names and string values
+        that occur more than once will share a single pooled copy.
+
+        The arena will be kept alive until all the objects that were allocated from it
+        have been deleted, and it can be reused to parse more documents that are likely to
+        contain the same strings.
+        @see ObjectArena
+    */
+    static Result parse (const String& text, var& parsedResult, ObjectArena& arena);
+
     /** Attempts to parse some JSON-formatted text, and returns the result as a var object.
 
         If the parsing fails, this simply returns var::null - if you need to find out more
@@ -0,0 +1,575 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+BEGIN_JUCE_NAMESPACE
+
+//==============================================================================
+JSONReader::JSONReader (InputStream& source_)
+    : source (source_),
+      buffer (bufferSize),
+      bufferPos (0),
+      numBytesInBuffer (0),
+      bufferStart (0),
+      state (expectingValue),
+      currentToken (nullValue),
+      result (Result::ok()),
+      skipping (false)
+{
+    // skip any UTF-8 byte-order mark
+    if (peekByte() == 0xef && numBytesInBuffer >= 3
+         && (uint8) buffer[1] == 0xbb && (uint8) buffer[2] == 0xbf)
+        bufferPos = 3;
+}
+
+JSONReader::~JSONReader()
+{
+}
+
+//==============================================================================
+bool JSONReader::fillBuffer()
+{
+    bufferStart += numBytesInBuffer;
+    bufferPos = 0;
+    numBytesInBuffer = jmax (0, source.read (buffer, bufferSize));
+    return numBytesInBuffer > 0;
+}
+
+inline int JSONReader::peekByte()
+{
+    if (bufferPos >= numBytesInBuffer && ! fillBuffer())
+        return -1;
+
+    return (uint8) buffer [bufferPos];
+}
+
+inline int JSONReader::nextByte()
+{
+    const int c = peekByte();
+
+    if (c >= 0)
+        ++bufferPos;
+
+    return c;
+}
+
+int JSONReader::skipWhitespace()
+{
+    for (;;)
+    {
+        const int c = peekByte();
+
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            return c;
+
+        ++bufferPos;
+    }
+}
+
+JSONReader::TokenType JSONReader::fail (const String& message)
+{
+    result = Result::fail (message + " at position " + String (getPosition()));
+    state = failed;
+    currentString = String::empty;
+    currentValue = var::null;
+    return currentToken = parseError;
+}
+
+inline JSONReader::TokenType JSONReader::setToken (const TokenType type)
+{
+    return currentToken = type;
+}
+
+inline void JSONReader::finishValue() noexcept
+{
+    state = containers.size() == 0 ? expectingValue : expectingCommaOrEnd;
+}
+
+//==============================================================================
+JSONReader::TokenType JSONReader::readNext()
+{
+    for (;;)
+    {
+        const int c = skipWhitespace();
+
+        switch (state)
+        {
+            case expectingCommaOrEnd:
+                if (c == ',')
+                {
+                    ++bufferPos;
+                    state = containers.getLast() == '{' ? expectingName : expectingValue;
+                    continue;
+                }
+
+                return readEndOfContainer (c);
+
+            case expectingFirstNameOrEnd:
+                if (c == '}')
+                    return readEndOfContainer (c);
+
+                return readPropertyName (c);
+
+            case expectingName:
+                return readPropertyName (c);
+
+            case expectingFirstValueOrEnd:
+                if (c == ']')
+                    return readEndOfContainer (c);
+
+                return readValueToken (c);
+
+            case expectingValue:
+                return readValueToken (c);
+
+            default:
+                return currentToken;
+        }
+    }
+}
+
+JSONReader::TokenType JSONReader::readValueToken (const int c)
+{
+    switch (c)
+    {
+        case '{':
+        case '[':
+            ++bufferPos;
+            containers.add ((char) c);
+            state = (c == '{') ? expectingFirstNameOrEnd : expectingFirstValueOrEnd;
+            return setToken (c == '{' ? startObject : startArray);
+
+        case '"':
+            ++bufferPos;
+
+            if (! readString())
+                return parseError;
+
+            currentValue = currentString;
+            finishValue();
+            return setToken (stringValue);
+
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return readNumber();
+
+        case 't':   return readLiteral ("true",  var (true),  boolValue);
+        case 'f':   return readLiteral ("false", var (false), boolValue);
+        case 'n':   return readLiteral ("null",  var::null,   nullValue);
+
+        case -1:
+            if (containers.size() == 0)
+                return setToken (endOfInput);
+
+            return fail ("Unexpected end-of-input");
+
+        default:
+            return fail ("Syntax error");
+    }
+}
+
+JSONReader::TokenType JSONReader::readPropertyName (const int c)
+{
+    if (c != '"')
+        return fail (c < 0 ? "Unexpected end-of-input" : "Expected a property name");
+
+    ++bufferPos;
+
+    if (! readString())
+        return parseError;
+
+    if (skipWhitespace() != ':')
+        return fail ("Expected ':'");
+
+    ++bufferPos;
+    currentValue = var::null;
+    state = expectingValue;
+    return setToken (propertyName);
+}
+
+JSONReader::TokenType JSONReader::readEndOfContainer (const int c)
+{
+    const char type = containers.getLast();
+
+    if (c != (type == '{' ? '}' : ']'))
+    {
+        if (c < 0)
+            return fail ("Unexpected end-of-input");
+
+        return fail (type == '{' ? "Expected ',' or '}'" : "Expected ',' or ']'");
+    }
+
+    ++bufferPos;
+    containers.removeLast();
+    finishValue();
+    return setToken (type == '{' ? endObject : endArray);
+}
+
+JSONReader::TokenType JSONReader::readLiteral (const char* text, const var& value, const TokenType type)
+{
+    while (*text != 0)
+        if (nextByte() != *text++)
+            return fail ("Syntax error");
+
+    currentValue = value;
+    finishValue();
+    return setToken (type);
+}
+
+JSONReader::TokenType JSONReader::readNumber()
+{
+    stringBuffer.clearQuick();
+
+    for (;;)
+    {
+        const int c = peekByte();
+
+        if (! ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'))
+            break;
+
+        if (stringBuffer.size() >= maxNumberLength)
+            return fail ("Number too long");
+
+        stringBuffer.add ((char) c);
+        ++bufferPos;
+    }
+
+    stringBuffer.add (0);
+    const char* const text = stringBuffer.getRawDataPointer();
+
+    // check that it follows the JSON grammar: -?digits(.digits)?([eE][+-]?digits)?
+    const char* t = text;
+    if (*t == '-')
+        ++t;
+
+    const char* const intStart = t;
+    while (*t >= '0' && *t <= '9')
+        ++t;
+
+    bool isInteger = true;
+    bool isValid = t > intStart;
+
+    if (*t == '.')
+    {
+        isInteger = false;
+        const char* const fracStart = ++t;
+        while (*t >= '0' && *t <= '9')
+            ++t;
+
+        isValid = isValid && t > fracStart;
+    }
+
+    if (*t == 'e' || *t == 'E')
+    {
+        isInteger = false;
+        ++t;
+        if (*t == '+' || *t == '-')
+            ++t;
+
+        const char* const expStart = t;
+        while (*t >= '0' && *t <= '9')
+            ++t;
+
+        isValid = isValid && t > expStart;
+    }
+
+    if (! isValid || *t != 0)
+        return fail ("Syntax error in number");
+
+    if (isInteger)
+    {
+        const bool isNegative = (*text == '-');
+        int64 value = 0;
+
+        for (const char* d = intStart; *d != 0; ++d)
+        {
+            const int digit = *d - '0';
+
+            if (value > (std::numeric_limits<int64>::max() - digit) / 10)
+            {
+                isInteger = false;   // too big for an int64
+                break;
+            }
+
+            value = value * 10 + digit;
+        }
+
+        if (isInteger)
+        {
+            if (isNegative)
+                value = -value;
+
+            if (value == (int64) (int) value)
+                currentValue = (int) value;
+            else
+                currentValue = value;
+        }
+    }
+
+    if (! isInteger)
+    {
+        CharPointer_ASCII p (text);
+        currentValue = CharacterFunctions::readDoubleValue (p);
+    }
+
+    finishValue();
+    return setToken (numberValue);
+}
+
+//==============================================================================
+void JSONReader::addCharacter (const juce_wchar c)
+{
+    char utf8[8] = { 0 };
+    CharPointer_UTF8 p (utf8);
+    p.write (c);
+    stringBuffer.addArray (static_cast <const char*> (utf8), (int) (p.getAddress() - utf8));
+}
+
+bool JSONReader::readString()
+{
+    stringBuffer.clearQuick();
+
+    for (;;)
+    {
+        if (bufferPos >= numBytesInBuffer && ! fillBuffer())
+        {
+            fail ("Unexpected end-of-input in string constant");
+            return false;
+        }
+
+        // copy any plain characters in one go..
+        const char* const start = buffer + bufferPos;
+        const char* const end = buffer + numBytesInBuffer;
+        const char* p = start;
+
+        while (p < end && *p != '"' && *p != '\\')
+            ++p;
+
+        if (! skipping)
+            stringBuffer.addArray (start, (int) (p - start));
+
+        bufferPos += (int) (p - start);
+
+        if (p == end)
+            continue;
+
+        ++bufferPos;
+
+        if (*p == '"')
+            break;
+
+        // ..and then deal with an escape sequence
+        juce_wchar c = (juce_wchar) nextByte();
+
+        switch (c)
+        {
+            case '"':
+            case '\\':
+            case '/':  break;
+
+            case 'b':  c = '\b'; break;
+            case 'f':  c = '\f'; break;
+            case 'n':  c = '\n'; break;
+            case 'r':  c = '\r'; break;
+            case 't':  c = '\t'; break;
+
+            case 'u':
+            {
+                c = 0;
+
+                for (int i = 4; --i >= 0;)
+                {
+                    const int digitValue = CharacterFunctions::getHexDigitValue ((juce_wchar) nextByte());
+
+                    if (digitValue < 0)
+                    {
+                        fail ("Syntax error in unicode escape sequence");
+                        return false;
+                    }
+
+                    c = (juce_wchar) ((c << 4) + digitValue);
+                }
+
+                // a UTF-16 surrogate pair is written as two escape sequences
+                if (c >= 0xd800 && c < 0xdc00 && peekByte() == '\\')
+                {
+                    ++bufferPos;
+
+                    if (nextByte() != 'u')
+                    {
+                        fail ("Syntax error in unicode escape sequence");
+                        return false;
+                    }
+
+                    juce_wchar low = 0;
+
+                    for (int i = 4; --i >= 0;)
+                    {
+                        const int digitValue = CharacterFunctions::getHexDigitValue ((juce_wchar) nextByte());
+
+                        if (digitValue < 0)
+                        {
+                            fail ("Syntax error in unicode escape sequence");
+                            return false;
+                        }
+
+                        low = (juce_wchar) ((low << 4) + digitValue);
+                    }
+
+                    if (low >= 0xdc00 && low < 0xe000)
+                    {
+                        c = (juce_wchar) (0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00));
+                    }
+                    else
+                    {
+                        if (! skipping)
+                            addCharacter (c);
+
+                        c = low;
+                    }
+                }
+
+                break;
+            }
+
+            default:
+                fail (c == (juce_wchar) -1 ? "Unexpected end-of-input in string constant"
+                                           : "Illegal escape sequence in string constant");
+                return false;
+        }
+
+        if (c == 0)
+        {
+            fail ("Illegal character in string constant");
+            return false;
+        }
+
+        if (! skipping)
+            addCharacter (c);
+    }
+
+    if (skipping || stringBuffer.size() == 0)
+        currentString = String::empty;
+    else
+        currentString = String::fromUTF8 (stringBuffer.getRawDataPointer(), stringBuffer.size());
+
+    return true;
+}
+
+//==============================================================================
+bool JSONReader::skipValue()
+{
+    const bool wasSkipping = skipping;
+    skipping = true;
+
+    if (currentToken == propertyName)
+        readNext();
+
+    if (currentToken == startObject || currentToken == startArray)
+    {
+        const int depth = getDepth() - 1;
+
+        while (getDepth() > depth && currentToken != parseError)
+            readNext();
+    }
+
+    skipping = wasSkipping;
+    return currentToken != parseError;
+}
+
+Result JSONReader::readValue (var& value)
+{
+    if (currentToken == propertyName)
+        readNext();
+
+    switch (currentToken)
+    {
+        case startObject:
+        {
+            DynamicObject* const object = new DynamicObject();
+            value = object;
+
+            for (;;)
+            {
+                const TokenType type = readNext();
+
+                if (type == endObject)
+                    break;
+
+                if (type != propertyName)
+                    return result;
+
+                const Identifier name (currentString);
+                readNext();
+
+                var propertyValue;
+                const Result r (readValue (propertyValue));
+
+                if (r.failed())
+                    return r;
+
+                object->setProperty (name, propertyValue);
+            }
+
+            return Result::ok();
+        }
+
+        case startArray:
+        {
+            value = var (Array<var>());
+            Array<var>* const array = value.getArray();
+
+            for (;;)
+            {
+                if (readNext() == endArray)
+                    break;
+
+                array->add (var::null);
+                const Result r (readValue (array->getReference (array->size() - 1)));
+
+                if (r.failed())
+                    return r;
+            }
+
+            return Result::ok();
+        }
+
+        case stringValue:
+        case numberValue:
+        case boolValue:
+        case nullValue:
+            value = currentValue;
+            return Result::ok();
+
+        case parseError:
+            return result;
+
+        default:
+            value = var::null;
+            return Result::fail ("Expected a value");
+    }
+}
+
+END_JUCE_NAMESPACE
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_JSONREADER_JUCEHEADER__
+#define __JUCE_JSONREADER_JUCEHEADER__
+
+#include "juce_JSON.h"
+#include "../memory/juce_HeapBlock.h"
+
+
+//==============================================================================
+/**
+    Reads JSON-formatted text from a stream, one token at a time.
+
+    Unlike JSON::parse(), which has to load all of the text and then builds a complete
+    var structure from it, a JSONReader pulls its data from the stream in small chunks,
+    and hands back each element as a token (the start or end of an object or array, a
+    property name, or a value), so the memory it uses doesn't depend on the size of the
+    input. Parts of the data that you're not interested in can be skipped with skipValue(),
+    and parts that you do want can be turned into a var with readValue().
+
+    The stream must contain UTF-8 text. It can contain several values one after another
+    (e.g. one object per line), in which case endOfInput is only returned after the last one.
+
+    @code
+    FileInputStream in (file);
+    JSONReader reader (in);
+
+    while (reader.readNext() == JSONReader::propertyName)
+    {
+        if (reader.getString() == "samples")
+            reader.skipValue();
+        ...
+    }
+    @endcode
+
+    @see JSONWriter, JSON
+*/
+class JUCE_API  JSONReader
+{
+public:
+    //==============================================================================
+    /** Creates a reader for a stream.
+        The stream isn't deleted by this object, so it must stay valid until the reader
+        has been deleted.
+    */
+    explicit JSONReader (InputStream& source);
+
+    /** Destructor. */
+    ~JSONReader();
+
+    //==============================================================================
+    /** The different kinds of token that readNext() can return. */
+    enum TokenType
+    {
+        startObject,        /**< An opening '{'. */
+        endObject,          /**< A closing '}'. */
+        startArray,         /**< An opening '['. */
+        endArray,           /**< A closing ']'. */
+        propertyName,       /**< The name of an object property - use getString() to find out what it is. */
+        stringValue,        /**< A string value - use getString() or getValue() to find out what it is. */
+        numberValue,        /**< A number, which getValue() will return as an int, int64 or double. */
+        boolValue,          /**< A true or false value. */
+        nullValue,          /**< A null value. */
+        endOfInput,         /**< The stream has been read to the end. */
+        parseError          /**< The text wasn't valid - use getResult() to get a description of the error. */
+    };
+
+    /** Reads the next token from the stream.
+        Once this has returned endOfInput or parseError, it'll keep returning the same thing.
+    */
+    TokenType readNext();
+
+    /** Returns the token that was last read by readNext(). */
+    TokenType getCurrentToken() const noexcept              { return currentToken; }
+
+    /** Returns the text of the current propertyName or stringValue token. */
+    const String& getString() const noexcept                { return currentString; }
+
+    /** Returns the value of the current stringValue, numberValue, boolValue or nullValue token. */
+    const var& getValue() const noexcept                    { return currentValue; }
+
+    /** Returns the number of objects and arrays that the reader is currently inside. */
+    int getDepth() const noexcept                           { return containers.size(); }
+
+    /** Returns the number of bytes that have been read from the stream so far. */
+    int64 getPosition() const noexcept                      { return bufferStart + bufferPos; }
+
+    /** Returns an error if the text couldn't be parsed. */
+    const Result& getResult() const noexcept                { return result; }
+
+    //==============================================================================
+    /** Skips over the value that starts with the current token.
+
+        If the current token is startObject or startArray, this will read up to and
+        including the matching endObject or endArray, without creating any strings along
+        the way. If the current token is a propertyName, the property's value is skipped.
+
+        @returns false if there was a parse error
+    */
+    bool skipValue();
+
+    /** Reads the value that starts with the current token into a var.
+
+        If the current token is startObject or startArray, this will read the whole
+        object or array, up to and including its matching end token. If the current token
+        is a propertyName, the property's value is read.
+    */
+    Result readValue (var& result);
+
+private:
+    //==============================================================================
+    enum State
+    {
+        expectingValue,
+        expectingFirstValueOrEnd,
+        expectingFirstNameOrEnd,
+        expectingName,
+        expectingCommaOrEnd,
+        failed
+    };
+
+    enum { bufferSize = 8192, maxNumberLength = 512 };
+
+    InputStream& source;
+    HeapBlock <char> buffer;
+    int bufferPos, numBytesInBuffer;
+    int64 bufferStart;
+
+    Array <char> containers, stringBuffer;
+    State state;
+    TokenType currentToken;
+    String currentString;
+    var currentValue;
+    Result result;
+    bool skipping;
+
+    bool fillBuffer();
+    int peekByte();
+    int nextByte();
+    int skipWhitespace();
+    TokenType fail (const String& message);
+    TokenType setToken (TokenType);
+    void finishValue() noexcept;
+    TokenType readValueToken (int firstChar);
+    TokenType readPropertyName (int firstChar);
+    TokenType readEndOfContainer (int firstChar);
+    TokenType readNumber();
+    TokenType readLiteral (const char* text, const var& value, TokenType type);
+    bool readString();
+    void addCharacter (juce_wchar);
+
+    JUCE_DECLARE_NON_COPYABLE (JSONReader);
+};
+
+
+#endif   // __JUCE_JSONREADER_JUCEHEADER__
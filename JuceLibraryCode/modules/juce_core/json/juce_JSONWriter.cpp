@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+BEGIN_JUCE_NAMESPACE
+
+//==============================================================================
+JSONWriter::JSONWriter (OutputStream& output_, const bool allOnOneLine_)
+    : output (output_),
+      allOnOneLine (allOnOneLine_),
+      isFirstItem (true),
+      nameWritten (false),
+      hasWrittenTopLevelValue (false)
+{
+}
+
+JSONWriter::~JSONWriter()
+{
+    // Every object and array that you start must be finished!
+    jassert (containers.size() == 0);
+}
+
+//==============================================================================
+void JSONWriter::startItem()
+{
+    if (containers.size() == 0)
+    {
+        if (hasWrittenTopLevelValue)
+            output << newLine;
+
+        hasWrittenTopLevelValue = true;
+    }
+    else if (containers.getLast() == '[' || ! nameWritten)
+    {
+        // Inside an object, each value needs to be given a name with writeName()!
+        jassert (containers.getLast() == '[');
+
+        if (! isFirstItem)
+            output << (allOnOneLine ? ", " : ",");
+
+        if (! allOnOneLine)
+        {
+            output << newLine;
+            output.writeRepeatedByte (' ', containers.size() * JSONFormatter::indentSize);
+        }
+
+        isFirstItem = false;
+    }
+
+    nameWritten = false;
+}
+
+void JSONWriter::startContainer (const char type)
+{
+    startItem();
+    output << type;
+    containers.add (type);
+    isFirstItem = true;
+}
+
+void JSONWriter::endContainer (const char type)
+{
+    // You've tried to close an object or array that wasn't opened!
+    jassert (containers.size() > 0 && containers.getLast() == type && ! nameWritten);
+
+    if (containers.size() > 0)
+    {
+        containers.removeLast();
+
+        if (! allOnOneLine)
+        {
+            output << newLine;
+            output.writeRepeatedByte (' ', containers.size() * JSONFormatter::indentSize);
+        }
+
+        output << (type == '{' ? '}' : ']');
+        isFirstItem = false;
+    }
+}
+
+void JSONWriter::startObject()      { startContainer ('{'); }
+void JSONWriter::endObject()        { endContainer ('{'); }
+void JSONWriter::startArray()       { startContainer ('['); }
+void JSONWriter::endArray()         { endContainer ('['); }
+
+void JSONWriter::writeName (const String& propertyName)
+{
+    // Names can only be written inside an object, and must be followed by a value!
+    jassert (containers.size() > 0 && containers.getLast() == '{' && ! nameWritten);
+
+    if (! isFirstItem)
+        output << (allOnOneLine ? ", " : ",");
+
+    if (! allOnOneLine)
+    {
+        output << newLine;
+        output.writeRepeatedByte (' ', containers.size() * JSONFormatter::indentSize);
+    }
+
+    JSONFormatter::writeString (output, propertyName.getCharPointer());
+    output << ": ";
+
+    isFirstItem = false;
+    nameWritten = true;
+}
+
+void JSONWriter::writeValue (const var& value)
+{
+    startItem();
+    JSONFormatter::write (output, value, containers.size() * JSONFormatter::indentSize, allOnOneLine);
+}
+
+void JSONWriter::writeProperty (const String& propertyName, const var& value)
+{
+    writeName (propertyName);
+    writeValue (value);
+}
+
+END_JUCE_NAMESPACE
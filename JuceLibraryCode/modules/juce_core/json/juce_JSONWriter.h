@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_JSONWRITER_JUCEHEADER__
+#define __JUCE_JSONWRITER_JUCEHEADER__
+
+#include "juce_JSON.h"
+
+
+//==============================================================================
+/**
+    Writes JSON-formatted text to a stream, one element at a time.
+
+    This lets you write very large amounts of JSON without first having to build
+    the whole structure as a var. Objects and arrays are opened and closed with
+    startObject()/endObject() and startArray()/endArray(), and the values inside them
+    are written with writeValue() (which can also be given a whole var structure).
+    Inside an object, each value must be preceded by a call to writeName().
+
+    The text that's produced is exactly the same as JSON::writeToStream() would produce
+    for the equivalent var.
+
+    If more than one top-level value is written, each one starts on a new line.
+
+    @code
+    JSONWriter writer (output);
+    writer.startObject();
+    writer.writeProperty ("name", "test");
+    writer.writeName ("samples");
+    writer.startArray();
+
+    for (int i = 0; i < numSamples; ++i)
+        writer.writeValue (samples[i]);
+
+    writer.endArray();
+    writer.endObject();
+    @endcode
+
+    @see JSONReader, JSON
+*/
+class JUCE_API  JSONWriter
+{
+public:
+    //==============================================================================
+    /** Creates a writer for a stream.
+
+        The stream isn't deleted by this object, so it must stay valid until the writer
+        has been deleted.
+
+        If allOnOneLine is true, the output is written without any line-breaks; if false,
+        it'll be laid out in a more human-readable format.
+    */
+    JSONWriter (OutputStream& output, bool allOnOneLine = false);
+
+    /** Destructor. */
+    ~JSONWriter();
+
+    //==============================================================================
+    /** Starts writing an object. */
+    void startObject();
+
+    /** Finishes the object that was started with startObject(). */
+    void endObject();
+
+    /** Starts writing an array. */
+    void startArray();
+
+    /** Finishes the array that was started with startArray(). */
+    void endArray();
+
+    /** Writes the name of the next property in an object.
+        This must be followed by a value, or by a call to startObject() or startArray().
+    */
+    void writeName (const String& propertyName);
+
+    /** Writes a value.
+        If the value is an array or a DynamicObject, all of its contents are written.
+    */
+    void writeValue (const var& value);
+
+    /** Writes a name and a value inside an object.
+        This is a shortcut for calling writeName() followed by writeValue().
+    */
+    void writeProperty (const String& propertyName, const var& value);
+
+    /** Returns the number of objects and arrays that have been started but not yet finished. */
+    int getDepth() const noexcept                   { return containers.size(); }
+
+private:
+    //==============================================================================
+    OutputStream& output;
+    const bool allOnOneLine;
+    Array <char> containers;
+    bool isFirstItem, nameWritten, hasWrittenTopLevelValue;
+
+    void startItem();
+    void startContainer (char type);
+    void endContainer (char type);
+
+    JUCE_DECLARE_NON_COPYABLE (JSONWriter);
+};
+
+
+#endif   // __JUCE_JSONWRITER_JUCEHEADER__
@@ -179,6 +179,12 @@ BEGIN_JUCE_NAMESPACE
 #ifndef __JUCE_JSON_JUCEHEADER__
  #include "json/juce_JSON.h"
 #endif
+#ifndef __JUCE_JSONREADER_JUCEHEADER__
+ #include "json/juce_JSONReader.h"
+#endif
+#ifndef __JUCE_JSONWRITER_JUCEHEADER__
+ #include "json/juce_JSONWriter.h"
+#endif
 #ifndef __JUCE_FILELOGGER_JUCEHEADER__
  #include "logging/juce_FileLogger.h"
 #endif
@@ -218,6 +224,9 @@ BEGIN_JUCE_NAMESPACE
 #ifndef __JUCE_MEMORYBLOCK_JUCEHEADER__
  #include "memory/juce_MemoryBlock.h"
 #endif
+#ifndef __JUCE_OBJECTARENA_JUCEHEADER__
+ #include "memory/juce_ObjectArena.h"
+#endif
 #ifndef __JUCE_OPTIONALSCOPEDPOINTER_JUCEHEADER__
  #include "memory/juce_OptionalScopedPointer.h"
 #endif
@@ -338,6 +347,9 @@ BEGIN_JUCE_NAMESPACE
 #ifndef __JUCE_INTERPROCESSLOCK_JUCEHEADER__
  #include "threads/juce_InterProcessLock.h"
 #endif
+#ifndef __JUCE_PARALLELLOOP_JUCEHEADER__
+ #include "threads/juce_ParallelLoop.h"
+#endif
 #ifndef __JUCE_PROCESS_JUCEHEADER__
  #include "threads/juce_Process.h"
 #endif
@@ -356,6 +368,9 @@ BEGIN_JUCE_NAMESPACE
 #ifndef __JUCE_SPINLOCK_JUCEHEADER__
  #include "threads/juce_SpinLock.h"
 #endif
+#ifndef __JUCE_TASKGRAPH_JUCEHEADER__
+ #include "threads/juce_TaskGraph.h"
+#endif
 #ifndef __JUCE_THREAD_JUCEHEADER__
  #include "threads/juce_Thread.h"
 #endif
@@ -386,6 +401,9 @@ BEGIN_JUCE_NAMESPACE
 #ifndef __JUCE_XMLELEMENT_JUCEHEADER__
  #include "xml/juce_XmlElement.h"
 #endif
+#ifndef __JUCE_XMLPULLPARSER_JUCEHEADER__
+ #include "xml/juce_XmlPullParser.h"
+#endif
 #ifndef __JUCE_GZIPCOMPRESSOROUTPUTSTREAM_JUCEHEADER__
  #include "zip/juce_GZIPCompressorOutputStream.h"
 #endif
@@ -25,6 +25,334 @@
 
 BEGIN_JUCE_NAMESPACE
 
+//==============================================================================
+/*  A ring buffer of messages with a single reader. Each record is an 8-byte header
+    (the text length and the message's sequence number) followed by the UTF-8 text,
+    padded to a multiple of 4 bytes. A length of -1 marks the unused space at the end of
+    the buffer when a record had to wrap around to the start.
+
+    Any thread may write to it, but only while holding writeLock.
+*/
+class FileLogger::MessageBuffer
+{
+public:
+    explicit MessageBuffer (const int size_)
+        : size (size_), readPosition (0), writePosition (0)
+    {
+        data.malloc ((size_t) size_);
+    }
+
+    // called by a thread that holds writeLock
+    bool write (const char* const text, const int numBytes, const uint32 sequenceNumber)
+    {
+        const uint32 w = writePosition.get();
+        const int offset = (int) (w & (uint32) (size - 1));
+        const int recordSize = getRecordSize (numBytes);
+        const int spaceAtEnd = size - offset;
+        const int padding = recordSize > spaceAtEnd ? spaceAtEnd : 0;
+
+        if ((int) (w - readPosition.get()) + padding + recordSize > size)
+            return false;
+
+        if (padding > 0)
+            *reinterpret_cast <int32*> (data + offset) = -1;
+
+        char* const dest = data + ((offset + padding) & (size - 1));
+        reinterpret_cast <int32*> (dest)[0] = numBytes;
+        reinterpret_cast <uint32*> (dest)[1] = sequenceNumber;
+        memcpy (dest + headerSize, text, (size_t) numBytes);
+
+        writePosition = w + (uint32) (padding + recordSize);
+        return true;
+    }
+
+    // called by the writer thread: finds the next message without removing it
+    bool peek (const char*& text, int& numBytes, uint32& sequenceNumber)
+    {
+        uint32 r = readPosition.get();
+
+        for (;;)
+        {
+            if (r == writePosition.get())
+                return false;
+
+            const int offset = (int) (r & (uint32) (size - 1));
+            const int32 length = *reinterpret_cast <const int32*> (data + offset);
+
+            if (length >= 0)
+            {
+                numBytes = length;
+                sequenceNumber = reinterpret_cast <const uint32*> (data + offset)[1];
+                text = data + offset + headerSize;
+                return true;
+            }
+
+            r += (uint32) (size - offset);
+            readPosition = r;
+        }
+    }
+
+    void removeNext (const int numBytes)
+    {
+        readPosition = readPosition.get() + (uint32) getRecordSize (numBytes);
+    }
+
+    int getNumBytesUsed() const noexcept        { return (int) (writePosition.get() - readPosition.get()); }
+
+    static int getMaxMessageSize (const int bufferSize) noexcept   { return bufferSize / 2 - headerSize; }
+
+    const int size;
+    SpinLock writeLock;
+
+private:
+    enum { headerSize = 8 };
+
+    HeapBlock <char> data;
+    Atomic <uint32> readPosition, writePosition;
+
+    static int getRecordSize (const int numBytes) noexcept     { return headerSize + ((numBytes + 3) & ~3); }
+
+    JUCE_DECLARE_NON_COPYABLE (MessageBuffer);
+};
+
+//==============================================================================
+class FileLogger::BackgroundWriter  : public Thread
+{
+public:
+    BackgroundWriter (FileLogger& owner_, const int bufferSize_, const int flushIntervalMs_,
+                      const bool waitWhenFull_, const int64 maxFileSize_)
+        : Thread ("Log writer"),
+          owner (owner_),
+          bufferSize (roundUpToPowerOfTwo (bufferSize_)),
+          flushIntervalMs (jmax (1, flushIntervalMs_)),
+          maxFileSize (maxFileSize_),
+          waitWhenFull (waitWhenFull_),
+          numDroppedWritten (0)
+    {
+        for (int i = 0; i < numBuffers; ++i)
+            buffers[i] = nullptr;
+
+        openFile();
+        startThread();
+    }
+
+    ~BackgroundWriter()
+    {
+        stopThread (10000);
+
+        for (int i = 0; i < numBuffers; ++i)
+            delete buffers[i].get();
+    }
+
+    //==============================================================================
+    void addMessage (const String& message)
+    {
+        const char* const text = message.toUTF8();
+        int numBytes = (int) message.getNumBytesAsUTF8();
+
+        if (numBytes > MessageBuffer::getMaxMessageSize (bufferSize))
+        {
+            // cut long messages at the start of a character rather than in the middle of one
+            numBytes = MessageBuffer::getMaxMessageSize (bufferSize);
+
+            while (numBytes > 0 && (text[numBytes] & 0xc0) == 0x80)
+                --numBytes;
+        }
+
+        const uint32 sequenceNumber = (uint32) (++nextSequenceNumber);
+        MessageBuffer* buffer;
+
+        for (;;)
+        {
+            buffer = &lockBufferForCurrentThread();
+            const bool ok = buffer->write (text, numBytes, sequenceNumber);
+            buffer->writeLock.exit();
+
+            if (ok)
+                break;
+
+            notify();
+
+            if (! waitWhenFull)
+            {
+                ++numDropped;
+                return;
+            }
+
+            Thread::sleep (1);
+        }
+
+        if (buffer->getNumBytesUsed() >= bufferSize / 2)
+            notify();
+    }
+
+    void flush()
+    {
+        const int target = ++numFlushesRequested;
+        notify();
+
+        while (numFlushesDone.get() - target < 0 && isThreadRunning())
+            flushDone.wait (10);
+    }
+
+    int getNumDropped() const noexcept      { return numDropped.get(); }
+
+    //==============================================================================
+    void run()
+    {
+        while (! threadShouldExit())
+        {
+            wait (flushIntervalMs);
+            writePendingMessages();
+        }
+
+        writePendingMessages();
+    }
+
+private:
+    enum { numBuffers = 16 };
+
+    FileLogger& owner;
+    const int bufferSize, flushIntervalMs;
+    const int64 maxFileSize;
+    const bool waitWhenFull;
+
+    Atomic <MessageBuffer*> buffers [numBuffers];
+
+    Atomic <int> nextSequenceNumber, numDropped, numFlushesRequested, numFlushesDone;
+    int numDroppedWritten;
+    WaitableEvent flushDone;
+    ScopedPointer <FileOutputStream> out;
+
+    static int roundUpToPowerOfTwo (const int minimumSize) noexcept
+    {
+        int n = 1024;
+
+        while (n < minimumSize && n < (1 << 30))
+            n <<= 1;
+
+        return n;
+    }
+
+    MessageBuffer& getBuffer (const int index)
+    {
+        MessageBuffer* b = buffers[index].get();
+
+        if (b == nullptr)
+        {
+            b = new MessageBuffer (bufferSize);
+
+            if (! buffers[index].compareAndSetBool (b, nullptr))
+            {
+                delete b;
+                b = buffers[index].get();
+            }
+        }
+
+        return *b;
+    }
+
+    // Each thread starts looking at a buffer picked from its thread ID, so threads rarely
+    // contend, but no thread ever owns a buffer, so there's nothing to clean up when it exits.
+    MessageBuffer& lockBufferForCurrentThread()
+    {
+        const int start = (int) ((((pointer_sized_uint) Thread::getCurrentThreadId()) >> 4) % numBuffers);
+
+        for (;;)
+        {
+            for (int i = 0; i < numBuffers; ++i)
+            {
+                MessageBuffer& b = getBuffer ((start + i) % numBuffers);
+
+                if (b.writeLock.tryEnter())
+                    return b;
+            }
+
+            Thread::yield();
+        }
+    }
+
+    void openFile()
+    {
+        out = new FileOutputStream (owner.logFile, 32768);
+
+        if (out->failedToOpen())
+            out = nullptr;
+    }
+
+    void writePendingMessages()
+    {
+        const int flushesRequested = numFlushesRequested.get();
+
+        if (out == nullptr)
+            openFile();
+
+        for (;;)
+        {
+            // pick the oldest message at the front of any of the buffers. Each thread's messages
+            // come out in order, but a message that got its sequence number just before another
+            // thread's may still be written after it
+            MessageBuffer* oldest = nullptr;
+            const char* oldestText = nullptr;
+            int oldestSize = 0;
+            uint32 oldestSequenceNumber = 0;
+
+            for (int i = 0; i < numBuffers; ++i)
+            {
+                MessageBuffer* const b = buffers[i].get();
+                const char* text;
+                int numBytes;
+                uint32 sequenceNumber;
+
+                if (b != nullptr && b->peek (text, numBytes, sequenceNumber)
+                     && (oldest == nullptr || (int) (sequenceNumber - oldestSequenceNumber) < 0))
+                {
+                    oldest = b;
+                    oldestText = text;
+                    oldestSize = numBytes;
+                    oldestSequenceNumber = sequenceNumber;
+                }
+            }
+
+            if (oldest == nullptr)
+                break;
+
+            if (out != nullptr)
+            {
+                out->write (oldestText, oldestSize);
+                *out << newLine;
+            }
+
+            oldest->removeNext (oldestSize);
+        }
+
+        const int dropped = numDropped.get();
+
+        if (dropped != numDroppedWritten && out != nullptr)
+        {
+            *out << "(" << (dropped - numDroppedWritten) << " log messages were dropped because the buffer was full)" << newLine;
+            numDroppedWritten = dropped;
+        }
+
+        if (out != nullptr)
+        {
+            out->flush();
+
+            if (maxFileSize > 0 && out->getPosition() > maxFileSize)
+            {
+                out = nullptr;
+                owner.trimFileSize ((int) jmin ((int64) 0x7fffffff, maxFileSize / 2));
+                openFile();
+            }
+        }
+
+        numFlushesDone = flushesRequested;
+        flushDone.signal();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BackgroundWriter);
+};
+
 //==============================================================================
 FileLogger::FileLogger (const File& logFile_,
                         const String& welcomeMessage,
@@ -51,6 +379,7 @@ FileLogger::FileLogger (const File& logFile_,
 
 FileLogger::~FileLogger()
 {
+    backgroundWriter = nullptr;
 }
 
 //==============================================================================
@@ -58,13 +387,40 @@ void FileLogger::logMessage (const String& message)
 {
     DBG (message);
 
+    if (backgroundWriter != nullptr)
+    {
+        backgroundWriter->addMessage (message);
+        return;
+    }
+
     const ScopedLock sl (logLock);
 
     FileOutputStream out (logFile, 256);
     out << message << newLine;
 }
 
+void FileLogger::enableBackgroundWriting (const int bufferSizeBytes, const int flushIntervalMs,
+                                          const bool waitWhenBufferIsFull, const int64 maxFileSizeBytes)
+{
+    const ScopedLock sl (logLock);
+
+    if (backgroundWriter == nullptr)
+        backgroundWriter = new BackgroundWriter (*this, bufferSizeBytes, flushIntervalMs,
+                                                 waitWhenBufferIsFull, maxFileSizeBytes);
+}
+
+void FileLogger::flush()
+{
+    if (backgroundWriter != nullptr)
+        backgroundWriter->flush();
+}
+
+int FileLogger::getNumDroppedMessages() const noexcept
+{
+    return backgroundWriter != nullptr ? backgroundWriter->getNumDropped() : 0;
+}
 
+//==============================================================================
 void FileLogger::trimFileSize (int maxFileSizeBytes) const
 {
     if (maxFileSizeBytes <= 0)
@@ -134,4 +490,134 @@ FileLogger* FileLogger::createDefaultAppLogger (const String& logFileSubDirector
     return new FileLogger (logFile, welcomeMessage, maxInitialFileSizeBytes);
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class FileLoggerTests  : public UnitTest
+{
+public:
+    FileLoggerTests() : UnitTest ("FileLogger") {}
+
+    enum { numThreads = 4, numMessagesPerThread = 250 };
+
+    static String getMessage (const int threadIndex, const int messageIndex)
+    {
+        return "thread " + String (threadIndex) + " message " + String (messageIndex)
+                 + " " + String::repeatedString ("x", messageIndex % 37);
+    }
+
+    class LoggingThread  : public Thread
+    {
+    public:
+        LoggingThread (FileLogger& logger_, const int index_)
+            : Thread ("Logging test"), logger (logger_), index (index_)
+        {
+        }
+
+        void run()
+        {
+            for (int i = 0; i < numMessagesPerThread; ++i)
+                logger.logMessage (getMessage (index, i));
+        }
+
+    private:
+        FileLogger& logger;
+        const int index;
+    };
+
+    static StringArray readLines (const File& file)
+    {
+        StringArray lines;
+        lines.addLines (file.loadFileAsString());
+        return lines;
+    }
+
+    void runTest()
+    {
+        const File logFile (File::getSpecialLocation (File::tempDirectory)
+                                .getNonexistentChildFile ("juce_FileLoggerTest", ".txt", false));
+
+        beginTest ("Background writing from several threads");
+
+        {
+            {
+                FileLogger logger (logFile, "test", -1);
+                logger.enableBackgroundWriting (4096, 10, true);
+
+                OwnedArray <LoggingThread> threads;
+
+                for (int i = 0; i < numThreads; ++i)
+                    threads.add (new LoggingThread (logger, i));
+
+                for (int i = 0; i < numThreads; ++i)
+                    threads.getUnchecked (i)->startThread();
+
+                for (int i = 0; i < numThreads; ++i)
+                    expect (threads.getUnchecked (i)->waitForThreadToExit (30000));
+
+                logger.flush();
+                expectEquals (logger.getNumDroppedMessages(), 0);
+            }
+
+            // every message must be there once, complete, and in the order its thread logged it
+            const StringArray lines (readLines (logFile));
+            int nextMessage [numThreads] = { 0 };
+            int numMessagesFound = 0;
+
+            for (int i = 0; i < lines.size(); ++i)
+            {
+                if (lines[i].startsWith ("thread "))
+                {
+                    const int threadIndex = lines[i].fromFirstOccurrenceOf ("thread ", false, false).getIntValue();
+                    expect (threadIndex >= 0 && threadIndex < numThreads);
+
+                    if (threadIndex >= 0 && threadIndex < numThreads)
+                        expectEquals (lines[i], getMessage (threadIndex, nextMessage [threadIndex]++));
+
+                    ++numMessagesFound;
+                }
+            }
+
+            expectEquals (numMessagesFound, numThreads * numMessagesPerThread);
+
+            for (int i = 0; i < numThreads; ++i)
+                expectEquals (nextMessage[i], (int) numMessagesPerThread);
+
+            logFile.deleteFile();
+        }
+
+        beginTest ("Truncating long messages");
+
+        {
+            // with 1024-byte buffers, messages are cut to 504 bytes, which falls in the middle of
+            // one of these characters
+            const String threeByteChars ("a" + String::repeatedString (CharPointer_UTF8 ("\xe2\x82\xac"), 400));
+            const String fourByteChars ("ab" + String::repeatedString (CharPointer_UTF8 ("\xf0\x9d\x84\x9e"), 300));
+
+            {
+                FileLogger logger (logFile, "test", -1);
+                logger.enableBackgroundWriting (1024, 10, true);
+                logger.logMessage (threeByteChars);
+                logger.logMessage (fourByteChars);
+                logger.logMessage ("short message");
+            }
+
+            MemoryBlock data;
+            expect (logFile.loadFileAsData (data));
+            expect (CharPointer_UTF8::isValidString (static_cast <const char*> (data.getData()), (int) data.getSize()));
+
+            const StringArray lines (readLines (logFile));
+            expect (lines.contains (threeByteChars.substring (0, 1 + 167)));
+            expect (lines.contains (fourByteChars.substring (0, 2 + 125)));
+            expect (lines.contains ("short message"));
+
+            logFile.deleteFile();
+        }
+    }
+};
+
+static FileLoggerTests fileLoggerUnitTests;
+
+#endif
+
 END_JUCE_NAMESPACE
@@ -69,6 +69,49 @@ public:
 
     File getLogFile() const               { return logFile; }
 
+    //==============================================================================
+    /** Makes the logger hand its messages to a background thread, which writes them to
+        the file.
+
+        Normally, each call to logMessage() opens the file, writes the message and closes it
+        again, while holding a lock. In background mode, logMessage() just copies the text into
+        one of a set of buffers, which are spread between the threads so that they rarely have
+        to wait for each other. The writer thread keeps the file open, and writes out all the
+        buffered messages whenever a buffer gets half-full or the flush interval has passed.
+
+        Each thread's messages are written in the order in which it logged them, but the order
+        of messages logged by different threads at almost the same moment is only best-effort.
+        Messages longer than half the buffer size are truncated.
+
+        This should be called before any other threads start using the logger, and once
+        it's been enabled, background mode stays on until the logger is deleted, at which
+        point any remaining messages are written.
+
+        @param bufferSizeBytes      the size of each message buffer
+        @param flushIntervalMs      the longest time that a message will wait in a buffer
+                                    before being written
+        @param waitWhenBufferIsFull if true, a thread that finds its buffer full will wait for the
+                                    writer to catch up; if false, the message is dropped, and a
+                                    note of how many messages were lost is written to the log
+        @param maxFileSizeBytes     if this is greater than zero, the file will be trimmed back
+                                    to half this size whenever it grows larger than it
+        @see flush, getNumDroppedMessages
+    */
+    void enableBackgroundWriting (int bufferSizeBytes = 64 * 1024,
+                                  int flushIntervalMs = 250,
+                                  bool waitWhenBufferIsFull = false,
+                                  int64 maxFileSizeBytes = -1);
+
+    /** If background writing is enabled, this waits until all the messages logged so far
+        have been written to the file.
+    */
+    void flush();
+
+    /** Returns the number of messages that have been thrown away because a buffer was full.
+        @see enableBackgroundWriting
+    */
+    int getNumDroppedMessages() const noexcept;
+
     //==============================================================================
     /** Helper function to create a log file in the correct place for this platform.
 
@@ -99,6 +142,11 @@ private:
     File logFile;
     CriticalSection logLock;
 
+    class MessageBuffer;
+    class BackgroundWriter;
+    friend class ScopedPointer <BackgroundWriter>;
+    ScopedPointer <BackgroundWriter> backgroundWriter;
+
     void trimFileSize (int maxFileSizeBytes) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileLogger);
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+BEGIN_JUCE_NAMESPACE
+
+//==============================================================================
+ObjectArena::ObjectArena (const size_t blockSizeBytes)
+    : nextFree (nullptr),
+      spaceLeftInBlock (0),
+      totalBlockSize (0),
+      blockSize (jmax ((size_t) 1024, blockSizeBytes)),
+      numHashSlots (64)
+{
+    hashSlots.calloc ((size_t) numHashSlots);
+}
+
+ObjectArena::~ObjectArena()
+{
+    for (int i = blocks.size(); --i >= 0;)
+        std::free (blocks.getUnchecked(i));
+}
+
+//==============================================================================
+void* ObjectArena::allocate (size_t numBytes)
+{
+    numBytes = (numBytes + 15) & ~(size_t) 15;
+
+    if (numBytes > blockSize / 4)
+    {
+        // big allocations get a block of their own, so that they don't waste the
+        // remainder of the current one
+        char* const block = static_cast <char*> (std::malloc (numBytes));
+        blocks.add (block);
+        totalBlockSize += numBytes;
+        return block;
+    }
+
+    if (numBytes > spaceLeftInBlock)
+    {
+        nextFree = static_cast <char*> (std::malloc (blockSize));
+        blocks.add (nextFree);
+        spaceLeftInBlock = blockSize;
+        totalBlockSize += blockSize;
+    }
+
+    void* const result = nextFree;
+    nextFree += numBytes;
+    spaceLeftInBlock -= numBytes;
+    return result;
+}
+
+void* ObjectArena::allocateObject (const size_t numBytes)
+{
+    char* const block = static_cast <char*> (allocate (numBytes + objectHeaderSize));
+    *reinterpret_cast <ObjectArena**> (block) = this;
+    incReferenceCount();
+
+    return block + objectHeaderSize;
+}
+
+void ObjectArena::releaseObject (void* const object) noexcept
+{
+    if (object != nullptr)
+    {
+        ObjectArena* const arena = *reinterpret_cast <ObjectArena**> (static_cast <char*> (object) - objectHeaderSize);
+        jassert (arena != nullptr);
+        arena->decReferenceCount();
+    }
+}
+
+//==============================================================================
+ObjectArena::PooledString& ObjectArena::addString (const String& text, const uint32 hash, const int slot)
+{
+    PooledString s;
+    s.text = text;
+    s.hash = hash;
+    strings.add (s);
+
+    hashSlots [slot] = strings.size();
+
+    if (strings.size() * 2 > numHashSlots)
+    {
+        numHashSlots *= 2;
+        hashSlots.calloc ((size_t) numHashSlots);
+
+        for (int i = 0; i < strings.size(); ++i)
+        {
+            int n = (int) (strings.getReference (i).hash & (uint32) (numHashSlots - 1));
+
+            while (hashSlots [n] != 0)
+                n = (n + 1) & (numHashSlots - 1);
+
+            hashSlots [n] = i + 1;
+        }
+    }
+
+    return strings.getReference (strings.size() - 1);
+}
+
+END_JUCE_NAMESPACE
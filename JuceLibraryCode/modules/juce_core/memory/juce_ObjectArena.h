@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_OBJECTARENA_JUCEHEADER__
+#define __JUCE_OBJECTARENA_JUCEHEADER__
+
+#include "juce_ReferenceCountedObject.h"
+#include "juce_HeapBlock.h"
+#include "../text/juce_Identifier.h"
+#include "../containers/juce_Array.h"
+
+
+//==============================================================================
+/**
+    A bump allocator and string pool for the objects that make up a large document.
+
+    Loading a big JSON file or ValueTree normally involves one heap allocation for
+    every object, key and string value, and the same number of frees when it's
+    deleted. An ObjectArena lets these loaders carve their objects out of a few large
+    blocks instead, and shares a single copy of each distinct string between all the
+    places that use it.
+
+    Objects created with allocateObject() keep a reference to the arena, so its memory
+    is only freed once the arena and every object that was allocated from it have been
+    deleted. That means an arena must always be created with new, and held by an
+    ObjectArena::Ptr, e.g.
+    @code
+    ObjectArena::Ptr arena (new ObjectArena());
+    var result;
+    JSON::parse (text, result, *arena);
+    @endcode
+
+    Allocating and pooling strings isn't thread-safe, so an arena should only be filled
+    by one thread at a time, but the objects it contains can be released from any thread.
+
+    @see JSON::parse, ValueTree::readFromStream, var::readFromStream
+*/
+class JUCE_API  ObjectArena  : public ReferenceCountedObject
+{
+public:
+    //==============================================================================
+    /** Creates an empty arena.
+        @param blockSizeBytes   the size of the blocks that memory is allocated in
+    */
+    explicit ObjectArena (size_t blockSizeBytes = 65536);
+
+    /** Destructor. */
+    ~ObjectArena();
+
+    /** A pointer to an arena. */
+    typedef ReferenceCountedObjectPtr <ObjectArena> Ptr;
+
+    //==============================================================================
+    /** Allocates some uninitialised memory from the arena.
+        The memory will be aligned to 16 bytes, and stays valid until the arena is deleted.
+    */
+    void* allocate (size_t numBytes);
+
+    /** Allocates memory for an object that keeps this arena alive until it's released.
+
+        This is intended for use in a class-specific operator new, with a matching
+        operator delete that calls releaseObject(), e.g.
+        @code
+        static void* operator new (size_t size, ObjectArena& arena)   { return arena.allocateObject (size); }
+        static void operator delete (void* p, ObjectArena&) noexcept  { ObjectArena::releaseObject (p); }
+        static void operator delete (void* p) noexcept               { ObjectArena::releaseObject (p); }
+        @endcode
+    */
+    void* allocateObject (size_t numBytes);
+
+    /** Releases an object's hold on the arena that it was allocated from.
+        This doesn't free any memory, but if it was the arena's last reference, the
+        arena will be deleted.
+        @see allocateObject
+    */
+    static void releaseObject (void* objectAllocatedFromArena) noexcept;
+
+    //==============================================================================
+    /** Returns a String that holds the given null-terminated text.
+        The first time a particular string is requested, a String is created for it, and
+        subsequent requests for the same text will return a reference to that same string
+        data, so documents containing many repeated values only store each of them once.
+    */
+    template <class CharPointerType>
+    String getPooledString (const CharPointerType text)
+    {
+        return getEntryFor (text).text;
+    }
+
+    /** Returns an Identifier for the given null-terminated text.
+        This does the same job as constructing an Identifier from a String, but avoids
+        the cost of creating a temporary string and searching the global Identifier pool
+        each time a name is repeated. Empty text will return a null Identifier.
+    */
+    template <class CharPointerType>
+    Identifier getPooledIdentifier (const CharPointerType text)
+    {
+        PooledString& s = getEntryFor (text);
+
+        if (s.identifier == Identifier() && s.text.isNotEmpty())
+            s.identifier = Identifier (s.text);
+
+        return s.identifier;
+    }
+
+    //==============================================================================
+    /** Returns the number of distinct strings that have been pooled. */
+    int getNumPooledStrings() const noexcept            { return strings.size(); }
+
+    /** Returns the total number of bytes that have been allocated for the arena's blocks. */
+    size_t getTotalBlockSize() const noexcept           { return totalBlockSize; }
+
+private:
+    //==============================================================================
+    struct PooledString
+    {
+        String text;
+        Identifier identifier;
+        uint32 hash;
+    };
+
+    Array <char*> blocks;
+    char* nextFree;
+    size_t spaceLeftInBlock, totalBlockSize;
+    const size_t blockSize;
+
+    Array <PooledString> strings;
+    HeapBlock <int> hashSlots;
+    int numHashSlots;
+
+    enum { objectHeaderSize = 16 };
+
+    PooledString& addString (const String& text, uint32 hash, int slot);
+
+    template <class CharPointerType>
+    static uint32 calculateHash (CharPointerType text) noexcept
+    {
+        uint32 hash = 0;
+
+        for (;;)
+        {
+            const juce_wchar c = text.getAndAdvance();
+
+            if (c == 0)
+                return hash;
+
+            hash = hash * 31 + (uint32) c;
+        }
+    }
+
+    template <class CharPointerType>
+    PooledString& getEntryFor (const CharPointerType text)
+    {
+        const uint32 hash = calculateHash (text);
+        int slot = (int) (hash & (uint32) (numHashSlots - 1));
+
+        for (;;)
+        {
+            const int index = hashSlots [slot] - 1;
+
+            if (index < 0)
+                return addString (String (text), hash, slot);
+
+            PooledString& s = strings.getReference (index);
+
+            if (s.hash == hash && CharacterFunctions::compare (s.text.getCharPointer(), text) == 0)
+                return s;
+
+            slot = (slot + 1) & (numHashSlots - 1);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ObjectArena);
+};
+
+
+#endif   // __JUCE_OBJECTARENA_JUCEHEADER__
@@ -175,6 +175,8 @@
  #include <sys/types.h>
  #include <sys/ioctl.h>
  #include <sys/socket.h>
+ #include <sys/eventfd.h>
+ #include <sys/epoll.h>
  #include <net/if.h>
  #include <sys/sysinfo.h>
  #include <sys/file.h>
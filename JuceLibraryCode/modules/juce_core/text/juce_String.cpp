@@ -96,17 +96,8 @@ public:
         if (text.getAddress() == nullptr || text.isEmpty() || maxChars == 0)
             return getEmpty();
 
-        CharPointer end (text);
-        size_t numChars = 0;
-        size_t bytesNeeded = sizeof (CharType);
-
-        while (numChars < maxChars && ! end.isEmpty())
-        {
-            bytesNeeded += CharPointerType::getBytesRequiredFor (end.getAndAdvance());
-            ++numChars;
-        }
-
-        const CharPointerType dest (createUninitialisedBytes (bytesNeeded));
+        size_t numChars;
+        const CharPointerType dest (createUninitialisedBytes (getNumBytesFor (text, maxChars, numChars)));
         CharPointerType (dest).writeWithCharLimit (text, (int) numChars + 1);
         return dest;
     }
@@ -195,6 +186,27 @@ public:
         return bufferFromText (text)->allocatedNumBytes;
     }
 
+    //==============================================================================
+    // A holder in external storage starts with a count that's too high to ever drop to -1,
+    // so it's never deleted, and it falls below this value once all its strings have gone.
+    enum { externalStorageRefCount = 0x3fffffff };
+
+    template <class CharPointer>
+    static size_t getNumBytesFor (const CharPointer& text, const size_t maxChars, size_t& numChars) noexcept
+    {
+        CharPointer end (text);
+        size_t bytesNeeded = sizeof (CharType);
+        numChars = 0;
+
+        while (numChars < maxChars && ! end.isEmpty())
+        {
+            bytesNeeded += CharPointerType::getBytesRequiredFor (end.getAndAdvance());
+            ++numChars;
+        }
+
+        return bytesNeeded;
+    }
+
     //==============================================================================
     Atomic<int> refCount;
     size_t allocatedNumBytes;
@@ -245,6 +257,32 @@ String::~String() noexcept
     StringHolder::release (text);
 }
 
+//==============================================================================
+size_t String::getExternalStorageSize (const CharPointerType t, const size_t maxChars) noexcept
+{
+    size_t numChars;
+    return sizeof (StringHolder) - sizeof (CharPointerType::CharType)
+            + StringHolder::getNumBytesFor (t, maxChars, numChars);
+}
+
+String String::createInExternalStorage (void* const storage, const CharPointerType t, const size_t maxChars)
+{
+    size_t numChars;
+    StringHolder* const holder = static_cast <StringHolder*> (storage);
+    holder->refCount.value = (int) StringHolder::externalStorageRefCount;
+    holder->allocatedNumBytes = StringHolder::getNumBytesFor (t, maxChars, numChars);
+    CharPointerType (holder->text).writeWithCharLimit (t, (int) numChars + 1);
+
+    String result;
+    result.text = CharPointerType (holder->text);
+    return result;
+}
+
+bool String::isExternalStorageInUse (const void* const storage) noexcept
+{
+    return static_cast <const StringHolder*> (storage)->refCount.get() >= (int) StringHolder::externalStorageRefCount;
+}
+
 String::String (const String& other) noexcept
     : text (other.text)
 {
@@ -1196,6 +1196,16 @@ public:
         JUCE_DECLARE_NON_COPYABLE (Concatenator);
     };
 
+   #ifndef DOXYGEN
+    //==============================================================================
+    // These let an allocator (e.g. the arena that an XmlDocument can use) keep the text of a
+    // string in a block of memory that it owns. The string and its copies never free that
+    // memory, so the owner must wait until isExternalStorageInUse() returns false.
+    static size_t getExternalStorageSize (CharPointerType text, size_t maxChars) noexcept;
+    static String createInExternalStorage (void* storage, CharPointerType text, size_t maxChars);
+    static bool isExternalStorageInUse (const void* storage) noexcept;
+   #endif
+
    #if JUCE_MAC || JUCE_IOS || DOXYGEN
     //==============================================================================
     /** MAC ONLY - Creates a String from an OSX CFString. */
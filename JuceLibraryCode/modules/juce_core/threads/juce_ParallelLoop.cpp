@@ -0,0 +1,313 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+BEGIN_JUCE_NAMESPACE
+
+//==============================================================================
+/*  The state of a loop is shared between the calling thread and its helper jobs, so
+    that a helper which only gets to run after the loop has finished can still look at
+    it safely (and will find that there's nothing left to do).
+*/
+class ParallelLoop::SharedState  : public ReferenceCountedObject
+{
+public:
+    SharedState (Body& body_, const int start_, const int end_, const int chunkSize_)
+        : body (body_), start (start_), end (end_), chunkSize (chunkSize_),
+          numChunks ((end_ - start_ + chunkSize_ - 1) / chunkSize_),
+          nextChunk (0), numChunksLeft (numChunks)
+    {
+    }
+
+    bool processNextChunk()
+    {
+        const int chunk = (++nextChunk) - 1;
+
+        if (chunk >= numChunks)
+            return false;
+
+        const int rangeStart = start + chunk * chunkSize;
+        body.processRange (rangeStart, jmin (end, rangeStart + chunkSize));
+
+        if (--numChunksLeft == 0)
+            finished.signal();
+
+        return true;
+    }
+
+    void waitUntilFinished()
+    {
+        while (numChunksLeft.get() > 0)
+            finished.wait();
+    }
+
+    int getNumChunks() const noexcept       { return numChunks; }
+
+private:
+    Body& body;
+    const int start, end, chunkSize, numChunks;
+    Atomic <int> nextChunk, numChunksLeft;
+    WaitableEvent finished;
+
+    JUCE_DECLARE_NON_COPYABLE (SharedState);
+};
+
+//==============================================================================
+class ParallelLoop::HelperJob  : public ThreadPoolJob
+{
+public:
+    HelperJob (SharedState* const state_)
+        : ThreadPoolJob ("Parallel loop"),
+          state (state_)
+    {
+    }
+
+    JobStatus runJob()
+    {
+        while (state->processNextChunk())
+        {}
+
+        return jobHasFinishedAndShouldBeDeleted;
+    }
+
+private:
+    const ReferenceCountedObjectPtr <SharedState> state;
+
+    JUCE_DECLARE_NON_COPYABLE (HelperJob);
+};
+
+//==============================================================================
+int ParallelLoop::chooseGrainSize (ThreadPool& pool, const int numItems, const int grainSize) noexcept
+{
+    if (grainSize > 0)
+        return grainSize;
+
+    // a few chunks per thread, so that threads which finish early can help the others
+    return jmax (1, numItems / (4 * (pool.getNumThreads() + 1)));
+}
+
+void ParallelLoop::run (ThreadPool& pool, const int start, const int end, Body& body, const int grainSize)
+{
+    if (end <= start)
+        return;
+
+    const int chunkSize = chooseGrainSize (pool, end - start, grainSize);
+
+    if (end - start <= chunkSize)
+    {
+        body.processRange (start, end);
+        return;
+    }
+
+    const ReferenceCountedObjectPtr <SharedState> state (new SharedState (body, start, end, chunkSize));
+
+    for (int i = jmin (pool.getNumThreads(), state->getNumChunks() - 1); --i >= 0;)
+        pool.addJob (new HelperJob (state));
+
+    while (state->processNextChunk())
+    {}
+
+    state->waitUntilFinished();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ParallelLoopTests  : public UnitTest
+{
+public:
+    ParallelLoopTests() : UnitTest ("ParallelLoop") {}
+
+    struct VisitCounter
+    {
+        VisitCounter (const int numItems)   { counts.calloc ((size_t) numItems); }
+
+        void operator() (const int index)   { ++counts[index]; }
+
+        bool eachVisitedOnce (const int numItems) const
+        {
+            for (int i = 0; i < numItems; ++i)
+                if (counts[i].get() != 1)
+                    return false;
+
+            return true;
+        }
+
+        HeapBlock <Atomic<int> > counts;
+    };
+
+    struct RangeRecorder  : public ParallelLoop::Body
+    {
+        RangeRecorder (const int numItems) : counter (numItems) {}
+
+        void processRange (const int rangeStart, const int rangeEnd)
+        {
+            for (int i = rangeStart; i < rangeEnd; ++i)
+                counter (i);
+        }
+
+        VisitCounter counter;
+    };
+
+    struct SumOfRange
+    {
+        int64 operator() (const int rangeStart, const int rangeEnd) const
+        {
+            int64 total = 0;
+
+            for (int i = rangeStart; i < rangeEnd; ++i)
+                total += i;
+
+            return total;
+        }
+    };
+
+    struct Add
+    {
+        int64 operator() (const int64 a, const int64 b) const    { return a + b; }
+    };
+
+    // (this isn't commutative, so it'll only give the expected result if chunks are combined in order)
+    struct AppendRange
+    {
+        String operator() (const int rangeStart, const int rangeEnd) const
+        {
+            String s;
+
+            for (int i = rangeStart; i < rangeEnd; ++i)
+                s << i << ',';
+
+            return s;
+        }
+    };
+
+    struct Concatenate
+    {
+        String operator() (const String& a, const String& b) const      { return a + b; }
+    };
+
+    // a job that runs a loop on the same pool that it's running on
+    class NestedLoopJob  : public ThreadPoolJob
+    {
+    public:
+        NestedLoopJob (ThreadPool& pool_, const int numItems_)
+            : ThreadPoolJob ("Nested loop"), pool (pool_), numItems (numItems_), counter (numItems_), succeeded (false)
+        {
+        }
+
+        JobStatus runJob()
+        {
+            ParallelLoop::forEach (pool, 0, numItems, counter, 1);
+            succeeded = counter.eachVisitedOnce (numItems);
+            return jobHasFinished;
+        }
+
+        ThreadPool& pool;
+        const int numItems;
+        VisitCounter counter;
+        bool succeeded;
+    };
+
+    void runTest()
+    {
+        ThreadPool pool (3);
+
+        beginTest ("forEach and run");
+
+        {
+            VisitCounter counter (1000);
+            ParallelLoop::forEach (pool, 0, 1000, counter);
+            expect (counter.eachVisitedOnce (1000));
+        }
+
+        {
+            // many more chunks than there are threads
+            RangeRecorder recorder (5000);
+            ParallelLoop::run (pool, 0, 5000, recorder, 1);
+            expect (recorder.counter.eachVisitedOnce (5000));
+        }
+
+        {
+            RangeRecorder recorder (1);
+            ParallelLoop::run (pool, 10, 10, recorder);
+            ParallelLoop::run (pool, 10, 5, recorder);
+            expectEquals (recorder.counter.counts[0].get(), 0);
+        }
+
+        beginTest ("reduce");
+
+        {
+            SumOfRange sum;
+            Add add;
+
+            for (int grainSize = 0; grainSize < 40; grainSize += 7)
+                expect (ParallelLoop::reduce (pool, 0, 10000, (int64) 0, sum, add, grainSize) == 49995000);
+
+            expect (ParallelLoop::reduce (pool, 5, 5, (int64) 42, sum, add) == 42);
+        }
+
+        {
+            AppendRange append;
+            Concatenate concatenate;
+
+            const String expected (append (0, 500));
+            expectEquals (ParallelLoop::reduce (pool, 0, 500, String::empty, append, concatenate, 3), expected);
+        }
+
+        beginTest ("Nested loops");
+
+        {
+            // with a single thread, the job that's running the loop is using the only thread
+            // in the pool, so it has to do all of the work itself
+            ThreadPool singleThreadPool (1);
+            NestedLoopJob job (singleThreadPool, 200);
+            singleThreadPool.addJob (&job);
+
+            expect (singleThreadPool.waitForJobToFinish (&job, 10000));
+            expect (job.succeeded);
+        }
+
+        {
+            OwnedArray <NestedLoopJob> jobs;
+
+            for (int i = 0; i < 6; ++i)
+            {
+                jobs.add (new NestedLoopJob (pool, 300));
+                pool.addJob (jobs.getLast());
+            }
+
+            for (int i = 0; i < jobs.size(); ++i)
+            {
+                expect (pool.waitForJobToFinish (jobs.getUnchecked (i), 10000));
+                expect (jobs.getUnchecked (i)->succeeded);
+            }
+        }
+    }
+};
+
+static ParallelLoopTests parallelLoopUnitTests;
+
+#endif
+
+END_JUCE_NAMESPACE
@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_PARALLELLOOP_JUCEHEADER__
+#define __JUCE_PARALLELLOOP_JUCEHEADER__
+
+#include "juce_ThreadPool.h"
+
+
+//==============================================================================
+/**
+    Contains static methods for spreading the iterations of a loop across the threads
+    of a ThreadPool.
+
+    The range of indexes is split into chunks, and the pool's threads and the calling
+    thread all take chunks until there are none left. Each call only allocates a few
+    small helper objects, no matter how many items there are, and the calling thread
+    always does some of the work itself, so it's safe to run a loop from inside one of
+    the pool's own jobs.
+
+    The loop body is given as an object rather than a function, e.g.
+    @code
+    struct ImageRowBrightener
+    {
+        ImageRowBrightener (Image::BitmapData& data_) : data (data_) {}
+
+        void operator() (int y)
+        {
+            // ..brighten row y..
+        }
+
+        Image::BitmapData& data;
+    };
+
+    ImageRowBrightener brightener (bitmapData);
+    ParallelLoop::forEach (pool, 0, bitmapData.height, brightener);
+    @endcode
+
+    @see ThreadPool, TaskGraph
+*/
+class JUCE_API  ParallelLoop
+{
+public:
+    //==============================================================================
+    /** The callback that's used by run() to process a range of indexes. */
+    class JUCE_API  Body
+    {
+    public:
+        virtual ~Body() {}
+
+        /** Must process all the indexes from rangeStart up to (but not including) rangeEnd.
+            This will be called by several threads at once, for different ranges.
+        */
+        virtual void processRange (int rangeStart, int rangeEnd) = 0;
+    };
+
+    /** Calls Body::processRange() for chunks of the range start to end, using the threads
+        in the pool, and returns when all of them have been processed.
+
+        @param pool         the pool whose threads should help with the work
+        @param start        the first index to process
+        @param end          the index after the last one to process
+        @param body         the object that does the work
+        @param grainSize    the number of indexes in each chunk. If this is 0, a size is
+                            chosen to give each thread a few chunks
+    */
+    static void run (ThreadPool& pool, int start, int end, Body& body, int grainSize = 0);
+
+    //==============================================================================
+    /** Calls a function object for each index from start up to (but not including) end,
+        using the threads in the pool, and returns when all of the calls have finished.
+
+        The FunctionType must have an operator() that takes an int index.
+        @see run
+    */
+    template <class FunctionType>
+    static void forEach (ThreadPool& pool, const int start, const int end,
+                         FunctionType& function, const int grainSize = 0)
+    {
+        ForEachBody <FunctionType> body (function);
+        run (pool, start, end, body, grainSize);
+    }
+
+    /** Calculates a value for each chunk of a range of indexes in parallel, and then
+        combines these values in order.
+
+        The MapFunctionType must have an operator() that takes the start and end of a
+        range, and returns a ValueType for it. The CombineFunctionType must have an
+        operator() that takes two ValueTypes and returns their combined value.
+
+        The chunk results are combined on the calling thread, in index order, starting with
+        initialValue, so the result doesn't depend on how the work was spread across the
+        threads.
+    */
+    template <typename ValueType, class MapFunctionType, class CombineFunctionType>
+    static ValueType reduce (ThreadPool& pool, const int start, const int end,
+                             const ValueType& initialValue,
+                             MapFunctionType& mapFunction,
+                             CombineFunctionType& combineFunction,
+                             const int grainSize = 0)
+    {
+        if (end <= start)
+            return initialValue;
+
+        const int chunkSize = chooseGrainSize (pool, end - start, grainSize);
+        const int numChunks = (end - start + chunkSize - 1) / chunkSize;
+
+        Array <ValueType> chunkResults;
+        chunkResults.insertMultiple (0, initialValue, numChunks);
+
+        ReduceBody <ValueType, MapFunctionType> body (mapFunction, chunkResults, start, chunkSize);
+        run (pool, start, end, body, chunkSize);
+
+        ValueType result (initialValue);
+
+        for (int i = 0; i < numChunks; ++i)
+            result = combineFunction (result, chunkResults.getReference (i));
+
+        return result;
+    }
+
+private:
+    //==============================================================================
+    class SharedState;
+    class HelperJob;
+
+    static int chooseGrainSize (ThreadPool& pool, int numItems, int grainSize) noexcept;
+
+    template <class FunctionType>
+    class ForEachBody  : public Body
+    {
+    public:
+        ForEachBody (FunctionType& function_) : function (function_) {}
+
+        void processRange (const int rangeStart, const int rangeEnd)
+        {
+            for (int i = rangeStart; i < rangeEnd; ++i)
+                function (i);
+        }
+
+    private:
+        FunctionType& function;
+        JUCE_DECLARE_NON_COPYABLE (ForEachBody);
+    };
+
+    template <typename ValueType, class MapFunctionType>
+    class ReduceBody  : public Body
+    {
+    public:
+        ReduceBody (MapFunctionType& function_, Array <ValueType>& results_, const int start_, const int chunkSize_)
+            : function (function_), results (results_), start (start_), chunkSize (chunkSize_)
+        {
+        }
+
+        void processRange (const int rangeStart, const int rangeEnd)
+        {
+            results.getReference ((rangeStart - start) / chunkSize) = function (rangeStart, rangeEnd);
+        }
+
+    private:
+        MapFunctionType& function;
+        Array <ValueType>& results;
+        const int start, chunkSize;
+        JUCE_DECLARE_NON_COPYABLE (ReduceBody);
+    };
+
+    ParallelLoop(); // This class can't be instantiated - just use its static methods.
+};
+
+
+#endif   // __JUCE_PARALLELLOOP_JUCEHEADER__
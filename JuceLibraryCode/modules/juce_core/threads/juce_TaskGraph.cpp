@@ -0,0 +1,280 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+BEGIN_JUCE_NAMESPACE
+
+//==============================================================================
+TaskGraph::Task::Task (const String& name)
+    : ThreadPoolJob (name),
+      graph (nullptr),
+      numDependencies (0),
+      visitMarker (0)
+{
+}
+
+TaskGraph::Task::~Task()
+{
+}
+
+ThreadPoolJob::JobStatus TaskGraph::Task::runJob()
+{
+    run();
+    graph->taskFinished (*this);
+    return jobHasFinished;
+}
+
+//==============================================================================
+TaskGraph::TaskGraph (ThreadPool& pool_)
+    : pool (pool_),
+      lastVisitMarker (0)
+{
+}
+
+TaskGraph::~TaskGraph()
+{
+    // you mustn't delete a graph while it's still running!
+    jassert (numTasksLeft.get() == 0);
+
+    for (int i = tasks.size(); --i >= 0;)
+        tasks.getUnchecked(i)->graph = nullptr;
+}
+
+void TaskGraph::addTask (Task* const task)
+{
+    jassert (task != nullptr && task->graph == nullptr);  // a task can only be in one graph!
+    jassert (numTasksLeft.get() == 0);                     // can't change a graph while it's running
+
+    if (task != nullptr && task->graph == nullptr)
+    {
+        task->graph = this;
+        tasks.add (task);
+    }
+}
+
+bool TaskGraph::addDependency (Task* const task, Task* const taskToRunFirst)
+{
+    jassert (task != nullptr && task->graph == this);
+    jassert (taskToRunFirst != nullptr && taskToRunFirst->graph == this);
+    jassert (numTasksLeft.get() == 0);
+
+    if (task == nullptr || taskToRunFirst == nullptr
+         || task->graph != this || taskToRunFirst->graph != this)
+        return false;
+
+    if (task == taskToRunFirst || dependsOn (taskToRunFirst, task))
+    {
+        jassertfalse;  // this would create a cycle, so the tasks could never run
+        return false;
+    }
+
+    if (! taskToRunFirst->dependents.contains (task))
+    {
+        taskToRunFirst->dependents.add (task);
+        ++(task->numDependencies);
+    }
+
+    return true;
+}
+
+bool TaskGraph::dependsOn (const Task* const task, Task* const possibleDependency)
+{
+    // Walks through everything that waits for possibleDependency. Each task is marked when
+    // it's first reached, so a task that can be reached along several paths is only
+    // searched once.
+    const int marker = ++lastVisitMarker;
+    possibleDependency->visitMarker = marker;
+
+    Array <Task*> tasksToSearch;
+    tasksToSearch.add (possibleDependency);
+
+    while (tasksToSearch.size() > 0)
+    {
+        const Task* const t = tasksToSearch.getLast();
+        tasksToSearch.removeLast();
+
+        for (int i = t->dependents.size(); --i >= 0;)
+        {
+            Task* const dependent = t->dependents.getUnchecked(i);
+
+            if (dependent == task)
+                return true;
+
+            if (dependent->visitMarker != marker)
+            {
+                dependent->visitMarker = marker;
+                tasksToSearch.add (dependent);
+            }
+        }
+    }
+
+    return false;
+}
+
+//==============================================================================
+void TaskGraph::run()
+{
+    if (tasks.size() == 0)
+        return;
+
+    numTasksLeft = tasks.size();
+
+    int i;
+    for (i = tasks.size(); --i >= 0;)
+        tasks.getUnchecked(i)->numDependenciesLeft = tasks.getUnchecked(i)->numDependencies;
+
+    for (i = 0; i < tasks.size(); ++i)
+        if (tasks.getUnchecked(i)->numDependencies == 0)
+            pool.addJob (tasks.getUnchecked(i));
+
+    finished.wait();
+
+    // the last task has signalled, but the pool may still be tidying up after it
+    for (i = tasks.size(); --i >= 0;)
+        pool.waitForJobToFinish (tasks.getUnchecked(i), -1);
+}
+
+void TaskGraph::taskFinished (Task& task)
+{
+    for (int i = 0; i < task.dependents.size(); ++i)
+    {
+        Task* const next = task.dependents.getUnchecked(i);
+
+        // (when this is called on a pool thread, the pool puts the new job on that
+        // thread's own queue, so it'll usually be the next thing that it runs)
+        if (--(next->numDependenciesLeft) == 0)
+            pool.addJob (next);
+    }
+
+    if (--numTasksLeft == 0)
+        finished.signal();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TaskGraphTests  : public UnitTest
+{
+public:
+    TaskGraphTests() : UnitTest ("TaskGraph") {}
+
+    class OrderRecordingTask  : public TaskGraph::Task
+    {
+    public:
+        OrderRecordingTask (Atomic<int>& counter_) : Task ("test"), counter (counter_), position (0) {}
+
+        void run()      { position = ++counter; }
+
+        Atomic<int>& counter;
+        int position;
+    };
+
+    void runTest()
+    {
+        ThreadPool pool (4);
+        Atomic<int> counter;
+
+        beginTest ("Ordering");
+
+        {
+            // a diamond: b and c wait for a, and d waits for both of them
+            TaskGraph graph (pool);
+            OrderRecordingTask a (counter), b (counter), c (counter), d (counter);
+            graph.addTask (&a);
+            graph.addTask (&b);
+            graph.addTask (&c);
+            graph.addTask (&d);
+
+            expect (graph.addDependency (&b, &a));
+            expect (graph.addDependency (&c, &a));
+            expect (graph.addDependency (&d, &b));
+            expect (graph.addDependency (&d, &c));
+
+            for (int run = 0; run < 50; ++run)
+            {
+                counter = 0;
+                graph.run();
+
+                expectEquals (counter.get(), 4);
+                expectEquals (a.position, 1);
+                expect (b.position < d.position && c.position < d.position);
+            }
+        }
+
+        beginTest ("Cycle rejection");
+
+        {
+            TaskGraph graph (pool);
+            OrderRecordingTask a (counter), b (counter), c (counter);
+            graph.addTask (&a);
+            graph.addTask (&b);
+            graph.addTask (&c);
+
+            expect (graph.addDependency (&b, &a));
+            expect (graph.addDependency (&c, &b));
+
+            expect (! graph.addDependency (&a, &a));
+            expect (! graph.addDependency (&a, &b));
+            expect (! graph.addDependency (&a, &c));
+
+            counter = 0;
+            graph.run();
+            expect (a.position == 1 && b.position == 2 && c.position == 3);
+        }
+
+        beginTest ("Cycle check on a lattice");
+
+        {
+            // each layer depends on both tasks in the layer above, so there are 2^numLayers paths
+            // from top to bottom. Adding the edges from the bottom up makes every check search
+            // the whole graph below it.
+            const int numLayers = 40;
+            TaskGraph graph (pool);
+            OwnedArray<OrderRecordingTask> lattice;
+
+            for (int i = 0; i < numLayers * 2; ++i)
+            {
+                lattice.add (new OrderRecordingTask (counter));
+                graph.addTask (lattice.getLast());
+            }
+
+            for (int layer = numLayers - 1; --layer >= 0;)
+                for (int i = 0; i < 2; ++i)
+                    for (int j = 0; j < 2; ++j)
+                        expect (graph.addDependency (lattice [(layer + 1) * 2 + i], lattice [layer * 2 + j]));
+
+            expect (! graph.addDependency (lattice [0], lattice [numLayers * 2 - 1]));
+
+            counter = 0;
+            graph.run();
+            expectEquals (counter.get(), numLayers * 2);
+        }
+    }
+};
+
+static TaskGraphTests taskGraphUnitTests;
+
+#endif
+
+END_JUCE_NAMESPACE
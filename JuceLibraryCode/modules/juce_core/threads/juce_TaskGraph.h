@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_TASKGRAPH_JUCEHEADER__
+#define __JUCE_TASKGRAPH_JUCEHEADER__
+
+#include "juce_ThreadPool.h"
+
+
+//==============================================================================
+/**
+    A set of tasks with dependencies between them, which are run using a ThreadPool.
+
+    Each task is started as soon as all the tasks that it depends on have finished, so
+    independent parts of the graph run in parallel. When a task finishes on one of the
+    pool's threads, any tasks that were waiting for it are queued on that same thread,
+    so a task's continuations tend to run straight after it, while its data is still
+    in the cache.
+
+    e.g.
+    @code
+    TaskGraph graph (pool);
+    LoadTask loadA ("a.png"), loadB ("b.png");
+    CompositeTask composite (loadA, loadB);
+
+    graph.addTask (&loadA);
+    graph.addTask (&loadB);
+    graph.addTask (&composite);
+    graph.addDependency (&composite, &loadA);
+    graph.addDependency (&composite, &loadB);
+
+    graph.run(); // runs the loads in parallel, then the composite, and waits for them all
+    @endcode
+
+    @see ThreadPool, ParallelLoop
+*/
+class JUCE_API  TaskGraph
+{
+public:
+    //==============================================================================
+    /** Creates an empty graph, whose tasks will be run by the given pool. */
+    explicit TaskGraph (ThreadPool& pool);
+
+    /** Destructor. */
+    ~TaskGraph();
+
+    //==============================================================================
+    /** A task that can be added to a TaskGraph. */
+    class JUCE_API  Task  : private ThreadPoolJob
+    {
+    public:
+        /** Creates a task. */
+        explicit Task (const String& name);
+
+        /** Destructor. */
+        ~Task();
+
+        /** Subclasses must implement this to do the task's work. */
+        virtual void run() = 0;
+
+    private:
+        friend class TaskGraph;
+        TaskGraph* graph;
+        Array <Task*> dependents;
+        int numDependencies, visitMarker;
+        Atomic <int> numDependenciesLeft;
+
+        JobStatus runJob();
+
+        JUCE_DECLARE_NON_COPYABLE (Task);
+    };
+
+    //==============================================================================
+    /** Adds a task to the graph.
+        The graph doesn't take ownership of the task, which must stay alive for as long
+        as the graph might run it. A task can only belong to one graph.
+    */
+    void addTask (Task* task);
+
+    /** Makes a task wait for another one to finish before it's started.
+
+        Both tasks must already have been added to the graph. If the new dependency would
+        create a cycle, it isn't added, and this returns false.
+    */
+    bool addDependency (Task* task, Task* taskToRunFirst);
+
+    /** Returns the number of tasks in the graph. */
+    int getNumTasks() const noexcept                    { return tasks.size(); }
+
+    //==============================================================================
+    /** Runs all the tasks, and waits for them to finish.
+
+        The graph can be run again once this has returned. Don't call this from one of
+        the pool's own jobs, because it blocks the calling thread, and if all the pool's
+        threads were blocked like this, none of them would be free to run the tasks.
+    */
+    void run();
+
+private:
+    //==============================================================================
+    ThreadPool& pool;
+    Array <Task*> tasks;
+    Atomic <int> numTasksLeft;
+    WaitableEvent finished;
+    int lastVisitMarker;
+
+    void taskFinished (Task&);
+    bool dependsOn (const Task* task, Task* possibleDependency);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TaskGraph);
+};
+
+
+#endif   // __JUCE_TASKGRAPH_JUCEHEADER__
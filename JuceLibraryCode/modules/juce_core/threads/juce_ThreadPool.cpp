@@ -31,7 +31,9 @@ ThreadPoolJob::ThreadPoolJob (const String& name)
       pool (nullptr),
       shouldStop (false),
       isActive (false),
-      shouldBeDeleted (false)
+      shouldBeDeleted (false),
+      queueEntry (nullptr),
+      poolIndex (-1)
 {
 }
 
@@ -58,14 +60,154 @@ void ThreadPoolJob::signalJobShouldExit()
 }
 
 
+//==============================================================================
+/*  Each time a job is queued, it gets a new QueueEntry. The entry is shared between
+    the queue that it sits in and the job itself, and whichever thread manages to take
+    the job pointer out of it gets to run the job. This lets a queued job be cancelled
+    (and deleted) while the queues still contain its entry.
+*/
+class ThreadPoolJob::QueueEntry
+{
+public:
+    explicit QueueEntry (ThreadPoolJob* const job_) noexcept
+        : next (nullptr), job (job_), refCount (2)
+    {
+    }
+
+    ThreadPoolJob* claim() noexcept                         { return job.exchange (nullptr); }
+    bool cancel (ThreadPoolJob* const jobToCancel) noexcept { return job.compareAndSetBool (nullptr, jobToCancel); }
+
+    void release() noexcept
+    {
+        if (--refCount == 0)
+            delete this;
+    }
+
+    QueueEntry* next;
+
+private:
+    Atomic <ThreadPoolJob*> job;
+    Atomic <int> refCount;
+
+    JUCE_DECLARE_NON_COPYABLE (QueueEntry);
+};
+
+//==============================================================================
+/*  A Chase-Lev work-stealing deque. Only the thread that owns it may call push() and
+    pop(), which work at the bottom end; any other thread may steal() from the top.
+*/
+class ThreadPool::WorkQueue
+{
+public:
+    WorkQueue()
+        : top (0), bottom (0)
+    {
+        buffers.add (new Buffer (64));
+        buffer = buffers.getFirst();
+    }
+
+    void push (ThreadPoolJob::QueueEntry* const entry)
+    {
+        const int64 b = bottom.get();
+        const int64 t = top.get();
+        Buffer* buf = buffer.get();
+
+        if (b - t >= buf->size - 1)
+            buf = grow (buf, b, t);
+
+        buf->set (b, entry);
+        bottom = b + 1;
+    }
+
+    ThreadPoolJob::QueueEntry* pop()
+    {
+        const int64 b = bottom.get() - 1;
+        Buffer* const buf = buffer.get();
+        bottom = b;
+        Atomic<int64>::memoryBarrier();
+
+        const int64 t = top.get();
+
+        if (t > b)
+        {
+            bottom = b + 1;
+            return nullptr;
+        }
+
+        ThreadPoolJob::QueueEntry* entry = buf->get (b);
+
+        if (t == b)
+        {
+            // this is the last item, so we have to race any thieves for it
+            if (! top.compareAndSetBool (t + 1, t))
+                entry = nullptr;
+
+            bottom = b + 1;
+        }
+
+        return entry;
+    }
+
+    ThreadPoolJob::QueueEntry* steal()
+    {
+        const int64 t = top.get();
+        Atomic<int64>::memoryBarrier();
+        const int64 b = bottom.get();
+
+        if (t >= b)
+            return nullptr;
+
+        ThreadPoolJob::QueueEntry* const entry = buffer.get()->get (t);
+        return top.compareAndSetBool (t + 1, t) ? entry : nullptr;
+    }
+
+    bool isEmpty() const noexcept
+    {
+        return bottom.get() <= top.get();
+    }
+
+private:
+    struct Buffer
+    {
+        explicit Buffer (const int size_)
+            : size (size_), mask (size_ - 1)
+        {
+            items.calloc ((size_t) size_);
+        }
+
+        ThreadPoolJob::QueueEntry* get (const int64 index) const noexcept            { return items [(int) (index & mask)]; }
+        void set (const int64 index, ThreadPoolJob::QueueEntry* const entry) noexcept { items [(int) (index & mask)] = entry; }
+
+        const int size, mask;
+        HeapBlock <ThreadPoolJob::QueueEntry*> items;
+    };
+
+    Atomic <int64> top, bottom;
+    Atomic <Buffer*> buffer;
+    OwnedArray <Buffer> buffers; // (old buffers are kept because a thief may still be reading one)
+
+    Buffer* grow (Buffer* const oldBuffer, const int64 b, const int64 t)
+    {
+        Buffer* const newBuffer = new Buffer (oldBuffer->size * 2);
+
+        for (int64 i = t; i < b; ++i)
+            newBuffer->set (i, oldBuffer->get (i));
+
+        buffers.add (newBuffer);
+        buffer = newBuffer;
+        return newBuffer;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (WorkQueue);
+};
+
 //==============================================================================
 class ThreadPool::ThreadPoolThread  : public Thread
 {
 public:
     ThreadPoolThread (ThreadPool& pool_)
         : Thread ("Pool"),
-          pool (pool_),
-          busy (false)
+          pool (pool_)
     {
     }
 
@@ -73,15 +215,36 @@ public:
     {
         while (! threadShouldExit())
         {
-            if (! pool.runNextJob())
-                wait (500);
+            if (pool.runNextJob (*this))
+                continue;
+
+            // Park until another thread hands us some work. The queues are checked again
+            // after marking ourselves as parked, so that a job that arrived in between
+            // can't be missed.
+            parked = 1;
+
+            if (! pool.hasQueuedJobs())
+                wait (pool.threadStopTimeout > 0 ? pool.threadStopTimeout : -1);
+
+            if (parked.compareAndSetBool (0, 1))
+                pool.stopThreadIfIdle (*this);
         }
     }
 
-private:
+    bool wakeIfParked()
+    {
+        if (! parked.compareAndSetBool (0, 1))
+            return false;
+
+        notify();
+        return true;
+    }
+
     ThreadPool& pool;
-    bool volatile busy;
+    WorkQueue queue;
+    Atomic <int> parked;
 
+private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolThread);
 };
 
@@ -90,7 +253,10 @@ ThreadPool::ThreadPool (const int numThreads,
                         const bool startThreadsOnlyWhenNeeded,
                         const int stopThreadsWhenNotUsedTimeoutMs)
     : threadStopTimeout (stopThreadsWhenNotUsedTimeoutMs),
-      priority (5)
+      priority (5),
+      lastJobEndTime (0),
+      sharedQueueHead (nullptr),
+      sharedQueueTail (nullptr)
 {
     jassert (numThreads > 0); // not much point having one of these with no threads in it.
 
@@ -112,6 +278,22 @@ ThreadPool::~ThreadPool()
 
     for (i = threads.size(); --i >= 0;)
         threads.getUnchecked(i)->stopThread (500);
+
+    // release any entries left behind by jobs that were cancelled while queued
+    for (i = threads.size(); --i >= 0;)
+        while (ThreadPoolJob::QueueEntry* const entry = threads.getUnchecked(i)->queue.pop())
+            entry->release();
+
+    while (sharedQueueHead != nullptr)
+    {
+        ThreadPoolJob::QueueEntry* const entry = sharedQueueHead;
+        sharedQueueHead = entry->next;
+        entry->release();
+    }
+
+    for (i = jobs.size(); --i >= 0;)
+        if (jobs.getUnchecked(i)->queueEntry != nullptr)
+            jobs.getUnchecked(i)->queueEntry->release();
 }
 
 void ThreadPool::addJob (ThreadPoolJob* const job)
@@ -125,41 +307,38 @@ void ThreadPool::addJob (ThreadPoolJob* const job)
         job->shouldStop = false;
         job->isActive = false;
 
-        {
-            const ScopedLock sl (lock);
-            jobs.add (job);
+        const ScopedLock sl (lock);
+        job->poolIndex = jobs.size();
+        jobs.add (job);
+        queueJob (job, false);
 
-            int numRunning = 0;
+        int numRunning = 0;
 
-            for (int i = threads.size(); --i >= 0;)
-                if (threads.getUnchecked(i)->isThreadRunning() && ! threads.getUnchecked(i)->threadShouldExit())
-                    ++numRunning;
+        for (int i = threads.size(); --i >= 0;)
+            if (threads.getUnchecked(i)->isThreadRunning() && ! threads.getUnchecked(i)->threadShouldExit())
+                ++numRunning;
 
-            if (numRunning < threads.size())
-            {
-                bool startedOne = false;
-                int n = 1000;
+        if (numRunning < threads.size())
+        {
+            bool startedOne = false;
+            int n = 1000;
 
-                while (--n >= 0 && ! startedOne)
+            while (--n >= 0 && ! startedOne)
+            {
+                for (int i = threads.size(); --i >= 0;)
                 {
-                    for (int i = threads.size(); --i >= 0;)
+                    if (! threads.getUnchecked(i)->isThreadRunning())
                     {
-                        if (! threads.getUnchecked(i)->isThreadRunning())
-                        {
-                            threads.getUnchecked(i)->startThread (priority);
-                            startedOne = true;
-                            break;
-                        }
+                        threads.getUnchecked(i)->startThread (priority);
+                        startedOne = true;
+                        break;
                     }
-
-                    if (! startedOne)
-                        Thread::sleep (2);
                 }
+
+                if (! startedOne)
+                    Thread::sleep (2);
             }
         }
-
-        for (int i = threads.size(); --i >= 0;)
-            threads.getUnchecked(i)->notify();
     }
 }
 
@@ -168,6 +347,11 @@ int ThreadPool::getNumJobs() const
     return jobs.size();
 }
 
+int ThreadPool::getNumThreads() const noexcept
+{
+    return threads.size();
+}
+
 ThreadPoolJob* ThreadPool::getJob (const int index) const
 {
     const ScopedLock sl (lock);
@@ -217,18 +401,18 @@ bool ThreadPool::removeJob (ThreadPoolJob* const job,
 
         if (jobs.contains (job))
         {
-            if (job->isActive)
+            if (cancelQueuedJob (job))
+            {
+                removeFromPool (job);
+                job->pool = nullptr;
+            }
+            else
             {
                 if (interruptIfRunning)
                     job->signalJobShouldExit();
 
                 dontWait = false;
             }
-            else
-            {
-                jobs.removeValue (job);
-                job->pool = nullptr;
-            }
         }
     }
 
@@ -251,22 +435,22 @@ bool ThreadPool::removeAllJobs (const bool interruptRunningJobs,
 
             if (selectedJobsToRemove == nullptr || selectedJobsToRemove->isJobSuitable (job))
             {
-                if (job->isActive)
-                {
-                    jobsToWaitFor.add (job);
-
-                    if (interruptRunningJobs)
-                        job->signalJobShouldExit();
-                }
-                else
+                if (cancelQueuedJob (job))
                 {
-                    jobs.remove (i);
+                    removeFromPool (job);
 
                     if (deleteInactiveJobs)
                         delete job;
                     else
                         job->pool = nullptr;
                 }
+                else
+                {
+                    jobsToWaitFor.add (job);
+
+                    if (interruptRunningJobs)
+                        job->signalJobShouldExit();
+                }
             }
         }
     }
@@ -276,7 +460,7 @@ bool ThreadPool::removeAllJobs (const bool interruptRunningJobs,
     for (;;)
     {
         for (int i = jobsToWaitFor.size(); --i >= 0;)
-            if (! isJobRunning (jobsToWaitFor.getUnchecked (i)))
+            if (! contains (jobsToWaitFor.getUnchecked (i)))
                 jobsToWaitFor.remove (i);
 
         if (jobsToWaitFor.size() == 0)
@@ -322,86 +506,369 @@ bool ThreadPool::setThreadPriorities (const int newPriority)
     return ok;
 }
 
-bool ThreadPool::runNextJob()
+//==============================================================================
+// This reads the job's poolIndex, so it must only be used on a job that's known to still
+// exist - i.e. by the thread that's running it. A job that the pool has deleted can still
+// be passed to contains() and waitForJobToFinish(), which only compare pointers.
+bool ThreadPool::isInPool (const ThreadPoolJob* const job) const noexcept
+{
+    return job != nullptr
+            && isPositiveAndBelow (job->poolIndex, jobs.size())
+            && jobs.getUnchecked (job->poolIndex) == job;
+}
+
+void ThreadPool::removeFromPool (ThreadPoolJob* const job)
 {
-    ThreadPoolJob* job = nullptr;
+    // (the last job is swapped into the gap, so that removal doesn't need to shuffle the list)
+    const int index = job->poolIndex;
+    ThreadPoolJob* const lastJob = jobs.getLast();
+
+    jobs.set (index, lastJob);
+    lastJob->poolIndex = index;
+    jobs.removeLast();
+    job->poolIndex = -1;
+}
+
+bool ThreadPool::cancelQueuedJob (ThreadPoolJob* const job)
+{
+    ThreadPoolJob::QueueEntry* const entry = job->queueEntry;
 
+    if (entry != nullptr)
     {
-        const ScopedLock sl (lock);
+        if (! entry->cancel (job))
+            return false;  // a thread has already taken it out of the queue to run it
+
+        entry->release();
+        job->queueEntry = nullptr;
+    }
+
+    return true;
+}
+
+ThreadPool::ThreadPoolThread* ThreadPool::getCurrentPoolThread() const noexcept
+{
+    const Thread::ThreadID currentThreadId = Thread::getCurrentThreadId();
+
+    for (int i = threads.size(); --i >= 0;)
+        if (threads.getUnchecked(i)->getThreadId() == currentThreadId)
+            return threads.getUnchecked(i);
+
+    return nullptr;
+}
+
+void ThreadPool::queueJob (ThreadPoolJob* const job, const bool useSharedQueue)
+{
+    jassert (job->queueEntry == nullptr);
+
+    ThreadPoolJob::QueueEntry* const entry = new ThreadPoolJob::QueueEntry (job);
+    job->queueEntry = entry;
 
-        for (int i = 0; i < jobs.size(); ++i)
+    ThreadPoolThread* const currentThread = useSharedQueue ? nullptr : getCurrentPoolThread();
+
+    if (currentThread != nullptr)
+    {
+        // jobs added by a job go onto its own thread's queue, where idle threads can steal them
+        currentThread->queue.push (entry);
+    }
+    else
+    {
+        const SpinLock::ScopedLockType sl (sharedQueueLock);
+
+        if (sharedQueueTail != nullptr)
+            sharedQueueTail->next = entry;
+        else
+            sharedQueueHead = entry;
+
+        sharedQueueTail = entry;
+    }
+
+    for (int i = threads.size(); --i >= 0;)
+        if (threads.getUnchecked(i)->wakeIfParked())
+            break;
+}
+
+bool ThreadPool::hasQueuedJobs() const noexcept
+{
+    {
+        const SpinLock::ScopedLockType sl (sharedQueueLock);
+
+        if (sharedQueueHead != nullptr)
+            return true;
+    }
+
+    for (int i = threads.size(); --i >= 0;)
+        if (! threads.getUnchecked(i)->queue.isEmpty())
+            return true;
+
+    return false;
+}
+
+ThreadPoolJob* ThreadPool::takeNextJob (ThreadPoolThread& thread)
+{
+    for (;;)
+    {
+        ThreadPoolJob::QueueEntry* entry = thread.queue.pop();
+
+        if (entry == nullptr)
         {
-            job = jobs[i];
+            const SpinLock::ScopedLockType sl (sharedQueueLock);
+            entry = sharedQueueHead;
 
-            if (job != nullptr && ! (job->isActive || job->shouldStop))
-                break;
+            if (entry != nullptr)
+            {
+                sharedQueueHead = entry->next;
 
-            job = nullptr;
+                if (sharedQueueHead == nullptr)
+                    sharedQueueTail = nullptr;
+            }
         }
 
-        if (job != nullptr)
-            job->isActive = true;
+        if (entry == nullptr)
+        {
+            const int numThreads = threads.size();
+            const int startIndex = threads.indexOf (&thread);
+
+            for (int i = 1; i < numThreads && entry == nullptr; ++i)
+                entry = threads.getUnchecked ((startIndex + i) % numThreads)->queue.steal();
 
+            if (entry == nullptr)
+                return nullptr;
+        }
+
+        ThreadPoolJob* const job = entry->claim();
+        entry->release();
+
+        if (job != nullptr)
+            return job;
     }
+}
 
-    if (job != nullptr)
+bool ThreadPool::runNextJob (ThreadPoolThread& thread)
+{
+    ThreadPoolJob* const job = takeNextJob (thread);
+
+    if (job == nullptr)
+        return false;
+
+    if (job->shouldStop)
     {
-        JUCE_TRY
+        // a job that's been told to stop before it started is dropped without being run. Its
+        // queue entry has already been claimed, so nothing else will take it out of the pool.
+        const ScopedLock sl (lock);
+
+        if (isInPool (job))
         {
-            ThreadPoolJob::JobStatus result = job->runJob();
+            job->queueEntry->release();
+            job->queueEntry = nullptr;
+            job->pool = nullptr;
+            removeFromPool (job);
+            jobFinishedSignal.signal();
+        }
 
-            lastJobEndTime = Time::getApproximateMillisecondCounter();
+        return true;
+    }
 
-            const ScopedLock sl (lock);
+    job->isActive = true;
 
-            if (jobs.contains (job))
-            {
-                job->isActive = false;
+    JUCE_TRY
+    {
+        ThreadPoolJob::JobStatus result = job->runJob();
 
-                if (result != ThreadPoolJob::jobNeedsRunningAgain || job->shouldStop)
-                {
-                    job->pool = nullptr;
-                    job->shouldStop = true;
-                    jobs.removeValue (job);
+        lastJobEndTime = Time::getApproximateMillisecondCounter();
 
-                    if (result == ThreadPoolJob::jobHasFinishedAndShouldBeDeleted)
-                        delete job;
+        const ScopedLock sl (lock);
 
-                    jobFinishedSignal.signal();
-                }
-                else
-                {
-                    // move the job to the end of the queue if it wants another go
-                    jobs.move (jobs.indexOf (job), -1);
-                }
+        if (isInPool (job))
+        {
+            job->isActive = false;
+            job->queueEntry->release();
+            job->queueEntry = nullptr;
+
+            if (result != ThreadPoolJob::jobNeedsRunningAgain || job->shouldStop)
+            {
+                job->pool = nullptr;
+                job->shouldStop = true;
+                removeFromPool (job);
+
+                if (result == ThreadPoolJob::jobHasFinishedAndShouldBeDeleted)
+                    delete job;
+
+                jobFinishedSignal.signal();
+            }
+            else
+            {
+                // send the job to the back of the shared queue if it wants another go
+                queueJob (job, true);
             }
         }
+    }
 #if JUCE_CATCH_UNHANDLED_EXCEPTIONS
-        catch (...)
+    catch (...)
+    {
+        const ScopedLock sl (lock);
+
+        if (isInPool (job))
         {
-            const ScopedLock sl (lock);
-            jobs.removeValue (job);
+            job->queueEntry->release();
+            job->queueEntry = nullptr;
+            removeFromPool (job);
         }
+    }
 #endif
+
+    return true;
+}
+
+void ThreadPool::stopThreadIfIdle (ThreadPoolThread& thread)
+{
+    if (threadStopTimeout > 0
+         && Time::getApproximateMillisecondCounter() > lastJobEndTime + threadStopTimeout)
+    {
+        // (this is done with the lock held so that addJob() will see that the thread is
+        // stopping and restart it, if a job arrives at the same time)
+        const ScopedLock sl (lock);
+
+        if (! hasQueuedJobs())
+            thread.signalThreadShouldExit();
     }
-    else
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ThreadPoolTests  : public UnitTest
+{
+public:
+    ThreadPoolTests() : UnitTest ("ThreadPool") {}
+
+    class TestJob  : public ThreadPoolJob
     {
-        if (threadStopTimeout > 0
-             && Time::getApproximateMillisecondCounter() > lastJobEndTime + threadStopTimeout)
+    public:
+        TestJob() : ThreadPoolJob ("test") {}
+
+        JobStatus runJob()
         {
-            const ScopedLock sl (lock);
+            for (int i = 0; i < 200 && ! shouldExit(); ++i)
+                Thread::yield();
 
-            if (jobs.size() == 0)
-                for (int i = threads.size(); --i >= 0;)
-                    threads.getUnchecked(i)->signalThreadShouldExit();
+            return jobHasFinished;
         }
-        else
+    };
+
+    class BlockingJob  : public ThreadPoolJob
+    {
+    public:
+        BlockingJob() : ThreadPoolJob ("blocker") {}
+
+        JobStatus runJob()
         {
-            return false;
+            started.signal();
+            release.wait (5000);
+            return jobHasFinished;
+        }
+
+        WaitableEvent started, release;
+    };
+
+    class SelfDeletingJob  : public ThreadPoolJob
+    {
+    public:
+        SelfDeletingJob() : ThreadPoolJob ("self-deleting") {}
+
+        JobStatus runJob()
+        {
+            for (int i = 0; i < 50; ++i)
+                Thread::yield();
+
+            return jobHasFinishedAndShouldBeDeleted;
+        }
+    };
+
+    void runTest()
+    {
+        beginTest ("Waiting for jobs that delete themselves");
+
+        {
+            ThreadPool selfDeletingPool (4);
+
+            for (int pass = 0; pass < 20; ++pass)
+            {
+                Array<ThreadPoolJob*> addedJobs;
+
+                for (int i = 0; i < 32; ++i)
+                {
+                    SelfDeletingJob* const job = new SelfDeletingJob();
+                    addedJobs.add (job);
+                    selfDeletingPool.addJob (job);
+                }
+
+                // the pool deletes these jobs while we're still asking about them
+                for (int i = 0; i < addedJobs.size(); ++i)
+                    expect (selfDeletingPool.waitForJobToFinish (addedJobs.getUnchecked (i), 5000));
+
+                expectEquals (selfDeletingPool.getNumJobs(), 0);
+            }
+
+            for (int i = 0; i < 32; ++i)
+                selfDeletingPool.addJob (new SelfDeletingJob());
+
+            expect (selfDeletingPool.removeAllJobs (false, 5000));
+        }
+
+        beginTest ("Job told to stop while queued");
+
+        {
+            ThreadPool singleThreadPool (1);
+            BlockingJob blocker;
+            TestJob stoppedJob;
+
+            singleThreadPool.addJob (&blocker);
+            expect (blocker.started.wait (5000));
+
+            singleThreadPool.addJob (&stoppedJob);
+            stoppedJob.signalJobShouldExit();
+            blocker.release.signal();
+
+            // the thread claims the job, sees it has been stopped, and must drop it from the pool
+            expect (singleThreadPool.waitForJobToFinish (&stoppedJob, 5000));
+            expectEquals (singleThreadPool.getNumJobs(), 0);
+        }
+
+        beginTest ("Remove while dispatching");
+
+        ThreadPool pool (4);
+        OwnedArray<TestJob> testJobs;
+
+        for (int i = 0; i < 64; ++i)
+            testJobs.add (new TestJob());
+
+        for (int pass = 0; pass < 200; ++pass)
+        {
+            for (int i = 0; i < testJobs.size(); ++i)
+                pool.addJob (testJobs.getUnchecked (i));
+
+            // removing jobs while the threads are busy claiming them must never leave one stuck
+            for (int i = 0; i < testJobs.size(); ++i)
+                expect (pool.removeJob (testJobs.getUnchecked (i), (i & 1) != 0, 5000));
+
+            expectEquals (pool.getNumJobs(), 0);
+        }
+
+        beginTest ("Remove all while dispatching");
+
+        for (int pass = 0; pass < 200; ++pass)
+        {
+            for (int i = 0; i < testJobs.size(); ++i)
+                pool.addJob (testJobs.getUnchecked (i));
+
+            expect (pool.removeAllJobs (true, 5000));
+            expectEquals (pool.getNumJobs(), 0);
         }
     }
+};
 
-    return true;
-}
+static ThreadPoolTests threadPoolUnitTests;
+
+#endif
 
 END_JUCE_NAMESPACE
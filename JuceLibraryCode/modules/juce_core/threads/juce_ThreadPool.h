@@ -27,6 +27,7 @@
 #define __JUCE_THREADPOOL_JUCEHEADER__
 
 #include "juce_Thread.h"
+#include "juce_SpinLock.h"
 #include "../text/juce_StringArray.h"
 #include "../containers/juce_Array.h"
 #include "../containers/juce_OwnedArray.h"
@@ -131,6 +132,9 @@ private:
     String jobName;
     ThreadPool* pool;
     bool shouldStop, isActive, shouldBeDeleted;
+    class QueueEntry;
+    QueueEntry* queueEntry;
+    int poolIndex;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolJob);
 };
@@ -143,6 +147,12 @@ private:
     When a ThreadPoolJob object is added to the ThreadPool's list, its run() method
     will be called by the next pooled thread that becomes free.
 
+    Each thread has its own queue of jobs, and jobs that are added from inside a
+    running job go onto the queue of the thread that's running it. Jobs added from
+    any other thread go into a shared queue. Threads that run out of work take jobs
+    from the shared queue, or steal them from the other threads' queues, and then
+    sleep until a new job arrives.
+
     @see ThreadPoolJob, Thread
 */
 class JUCE_API  ThreadPool
@@ -248,6 +258,9 @@ public:
     */
     int getNumJobs() const;
 
+    /** Returns the number of threads that the pool can use to run jobs. */
+    int getNumThreads() const noexcept;
+
     /** Returns one of the jobs in the queue.
 
         Note that this can be a very volatile list as jobs might be continuously getting shifted
@@ -303,8 +316,21 @@ private:
     uint32 lastJobEndTime;
     WaitableEvent jobFinishedSignal;
 
+    class WorkQueue;
+    SpinLock sharedQueueLock;
+    ThreadPoolJob::QueueEntry* sharedQueueHead;
+    ThreadPoolJob::QueueEntry* sharedQueueTail;
+
     friend class ThreadPoolThread;
-    bool runNextJob();
+    bool runNextJob (ThreadPoolThread&);
+    ThreadPoolJob* takeNextJob (ThreadPoolThread&);
+    ThreadPoolThread* getCurrentPoolThread() const noexcept;
+    void queueJob (ThreadPoolJob*, bool useSharedQueue);
+    bool cancelQueuedJob (ThreadPoolJob*);
+    void removeFromPool (ThreadPoolJob*);
+    bool isInPool (const ThreadPoolJob*) const noexcept;
+    bool hasQueuedJobs() const noexcept;
+    void stopThreadIfIdle (ThreadPoolThread&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPool);
 };
@@ -29,13 +29,15 @@ BEGIN_JUCE_NAMESPACE
 XmlDocument::XmlDocument (const String& documentText)
     : originalText (documentText),
       input (nullptr),
-      ignoreEmptyTextElements (true)
+      ignoreEmptyTextElements (true),
+      useArena (false)
 {
 }
 
 XmlDocument::XmlDocument (const File& file)
     : input (nullptr),
       ignoreEmptyTextElements (true),
+      useArena (false),
       inputSource (new FileInputSource (file))
 {
 }
@@ -66,6 +68,11 @@ void XmlDocument::setEmptyTextElementsIgnored (const bool shouldBeIgnored) noexc
     ignoreEmptyTextElements = shouldBeIgnored;
 }
 
+void XmlDocument::setArenaAllocationEnabled (const bool shouldUseArena) noexcept
+{
+    useArena = shouldUseArena;
+}
+
 namespace XmlIdentifierChars
 {
     bool isIdentifierCharSlow (const juce_wchar c) noexcept
@@ -97,6 +104,18 @@ namespace XmlIdentifierChars
     }*/
 }
 
+namespace XmlTextHelpers
+{
+    bool containsNonWhitespaceChars (String::CharPointerType text, size_t numChars) noexcept
+    {
+        while (numChars-- > 0)
+            if (! CharacterFunctions::isWhitespace (text.getAndAdvance()))
+                return true;
+
+        return false;
+    }
+}
+
 XmlElement* XmlDocument::getDocumentElement (const bool onlyReadOuterDocumentElement)
 {
     String textToParse (originalText);
@@ -122,6 +141,8 @@ XmlElement* XmlDocument::getDocumentElement (const bool onlyReadOuterDocumentEle
     outOfData = false;
     needToLoadDTD = true;
 
+    ScopedPointer <XmlElement> result;
+
     if (textToParse.isEmpty())
     {
         lastError = "not enough input";
@@ -132,10 +153,16 @@ XmlElement* XmlDocument::getDocumentElement (const bool onlyReadOuterDocumentEle
 
         if (input.getAddress() != nullptr)
         {
-            ScopedPointer <XmlElement> result (readNextElement (! onlyReadOuterDocumentElement));
+            if (useArena)
+                arena = new XmlElement::Arena();
+
+            result = readNextElement (! onlyReadOuterDocumentElement);
 
-            if (! errorOccurred)
-                return result.release();
+            if (errorOccurred)
+                result = nullptr;
+
+            // the elements keep the arena alive for as long as they need it
+            arena = nullptr;
         }
         else
         {
@@ -143,7 +170,7 @@ XmlElement* XmlDocument::getDocumentElement (const bool onlyReadOuterDocumentEle
         }
     }
 
-    return nullptr;
+    return result.release();
 }
 
 const String& XmlDocument::getLastParseError() const noexcept
@@ -329,7 +356,12 @@ void XmlDocument::readQuotedString (String& result)
 
                 if (character == quote)
                 {
-                    result.appendCharPointer (start, numChars);
+                    // (if there are no entities, an arena can hold the whole string)
+                    if (arena != nullptr && result.isEmpty())
+                        result = arena->createString (start, numChars);
+                    else
+                        result.appendCharPointer (start, numChars);
+
                     ++input;
                     return;
                 }
@@ -380,7 +412,7 @@ XmlElement* XmlDocument::readNextElement (const bool alsoParseSubElements)
             }
         }
 
-        node = new XmlElement (String (input, (size_t) tagLen));
+        node = createElement (input, tagLen);
         input += tagLen;
         LinkedListPointer<XmlElement::XmlAttributeNode>::Appender attributeAppender (node->attributes);
 
@@ -429,9 +461,7 @@ XmlElement* XmlDocument::readNextElement (const bool alsoParseSubElements)
 
                         if (nextChar == '"' || nextChar == '\'')
                         {
-                            XmlElement::XmlAttributeNode* const newAtt
-                                = new XmlElement::XmlAttributeNode (String (attNameStart, (size_t) attNameLen),
-                                                                    String::empty);
+                            XmlElement::XmlAttributeNode* const newAtt = createAttribute (attNameStart, attNameLen);
 
                             readQuotedString (newAtt->value);
                             attributeAppender.append (newAtt);
@@ -514,7 +544,8 @@ void XmlDocument::readChildElements (XmlElement* parent)
                     ++len;
                 }
 
-                childAppender.append (XmlElement::createTextElement (String (inputStart, len)));
+                childAppender.append (createTextElement (arena != nullptr ? arena->createString (inputStart, len)
+                                                                          : String (inputStart, len)));
             }
             else
             {
@@ -601,18 +632,45 @@ void XmlDocument::readChildElements (XmlElement* parent)
                         ++len;
                     }
 
-                    textElementContent.appendCharPointer (start, len);
+                    // (if this is all of the text, an arena can hold the whole string)
+                    if (arena != nullptr && *input == '<' && textElementContent.isEmpty()
+                         && ((! ignoreEmptyTextElements) || XmlTextHelpers::containsNonWhitespaceChars (start, len)))
+                        textElementContent = arena->createString (start, len);
+                    else
+                        textElementContent.appendCharPointer (start, len);
                 }
             }
 
             if ((! ignoreEmptyTextElements) || textElementContent.containsNonWhitespaceChars())
             {
-                childAppender.append (XmlElement::createTextElement (textElementContent));
+                childAppender.append (createTextElement (textElementContent));
             }
         }
     }
 }
 
+XmlElement* XmlDocument::createElement (const String::CharPointerType tagName, const int length)
+{
+    if (arena != nullptr)
+        return new (*arena) XmlElement (arena->getName (tagName, (size_t) length));
+
+    return new XmlElement (String (tagName, (size_t) length));
+}
+
+XmlElement::XmlAttributeNode* XmlDocument::createAttribute (const String::CharPointerType name, const int length)
+{
+    if (arena != nullptr)
+        return new (*arena) XmlElement::XmlAttributeNode (arena->getName (name, (size_t) length), String::empty);
+
+    return new XmlElement::XmlAttributeNode (String (name, (size_t) length), String::empty);
+}
+
+XmlElement* XmlDocument::createTextElement (const String& text)
+{
+    return arena != nullptr ? XmlElement::createTextElement (text, *arena)
+                            : XmlElement::createTextElement (text);
+}
+
 void XmlDocument::readEntity (String& result)
 {
     // skip over the ampersand
@@ -852,5 +910,102 @@ String XmlDocument::getParameterEntity (const String& entity)
     return entity;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class XmlDocumentTests  : public UnitTest
+{
+public:
+    XmlDocumentTests() : UnitTest ("XmlDocument") {}
+
+    static XmlElement* parse (const String& text, const bool useArena)
+    {
+        XmlDocument doc (text);
+        doc.setArenaAllocationEnabled (useArena);
+        return doc.getDocumentElement();
+    }
+
+    void runTest()
+    {
+        const String text ("<DOC version=\"1\"><ITEM name=\"first\" value=\"a &amp; b\">some text</ITEM>"
+                           "<ITEM name=\"second\" value=\"\"><![CDATA[raw <data>]]></ITEM>"
+                           "<ITEM name=\"third\">  before &lt;entity&gt; after  </ITEM>\n  <EMPTY/></DOC>");
+
+        beginTest ("Arena allocation");
+
+        {
+            ScopedPointer<XmlElement> normal (parse (text, false));
+            ScopedPointer<XmlElement> arena (parse (text, true));
+            expect (normal != nullptr && arena != nullptr);
+            expectEquals (arena->createDocument (String::empty), normal->createDocument (String::empty));
+            expect (arena->isEquivalentTo (normal, false));
+
+            XmlElement* const first = arena->getChildByName ("ITEM");
+            expectEquals (first->getStringAttribute ("value"), String ("a & b"));
+            expectEquals (first->getAllSubText(), String ("some text"));
+
+            // changing and adding to an arena tree should work as normal
+            first->setAttribute ("value", "changed");
+            first->setAttribute ("extra", 123);
+            first->addChildElement (new XmlElement ("NEW"));
+            arena->removeChildElement (arena->getChildByName ("EMPTY"), true);
+            expectEquals (first->getStringAttribute ("value"), String ("changed"));
+            expectEquals (first->getIntAttribute ("extra"), 123);
+            expectEquals (arena->getNumChildElements(), 3);
+        }
+
+        beginTest ("Arena strings that outlive their tree");
+
+        {
+            String name, value;
+            ScopedPointer<XmlElement> removedElement;
+
+            {
+                ScopedPointer<XmlElement> arena (parse (text, true));
+                XmlElement* const third = arena->getChildElement (2);
+                name = third->getStringAttribute ("name");
+                value = arena->getChildElement (1)->getAllSubText();
+
+                arena->removeChildElement (third, false);
+                removedElement = third;
+            }
+
+            // the removed element and the copied strings are still usable after the rest has gone
+            expectEquals (name, String ("third"));
+            expectEquals (value, String ("raw <data>"));
+            expectEquals (removedElement->getAllSubText(), String ("  before <entity> after  "));
+            removedElement = nullptr;
+
+            // (releasing another arena lets the blocks that the strings were in be freed)
+            delete parse (text, true);
+            expectEquals (name + value, String ("thirdraw <data>"));
+            name = String::empty;
+            value = String::empty;
+            delete parse (text, true);
+        }
+
+        {
+            // a big document, so that several blocks are needed
+            String bigText ("<BIG>");
+
+            for (int i = 0; i < 5000; ++i)
+                bigText << "<ITEM index=\"" << i << "\" name=\"item" << i << "\">text " << i << "</ITEM>";
+
+            bigText << "</BIG>";
+
+            ScopedPointer<XmlElement> normal (parse (bigText, false));
+            ScopedPointer<XmlElement> arena (parse (bigText, true));
+            expect (arena->isEquivalentTo (normal, false));
+
+            const String lastText (arena->getChildElement (4999)->getAllSubText());
+            arena = nullptr;
+            expectEquals (lastText, String ("text 4999"));
+        }
+    }
+};
+
+static XmlDocumentTests xmlDocumentUnitTests;
+
+#endif
 
 END_JUCE_NAMESPACE
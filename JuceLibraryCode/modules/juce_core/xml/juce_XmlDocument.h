@@ -136,6 +136,26 @@ public:
     */
     void setEmptyTextElementsIgnored (bool shouldBeIgnored) noexcept;
 
+    /** Makes the parser allocate the whole element tree from a single block of memory.
+
+        When this is enabled, all the elements and attributes that getDocumentElement()
+        creates are carved out of a few large memory blocks instead of being allocated
+        individually, along with the text of their names and values (repeated names share
+        the same string data). This makes large documents much quicker to parse and
+        delete, and uses less memory.
+
+        The tree can still be used and modified in exactly the same way as normal - the
+        memory is simply released when the last element or attribute that was allocated
+        from it has been deleted. Because of that, if you remove a small part of the tree
+        and delete the rest, the whole block will stay allocated until that part is also
+        deleted, so this is best used for trees that are going to be thrown away as a whole.
+
+        The same goes for copies of the tree's strings: if any of these are still in use
+        when the tree is deleted, the blocks that hold them are kept, and are released
+        when another arena is freed after the copies have gone.
+    */
+    void setArenaAllocationEnabled (bool shouldUseArena) noexcept;
+
     //==============================================================================
     /** A handy static method that parses a file.
         This is a shortcut for creating an XmlDocument object and calling getDocumentElement() on it.
@@ -158,8 +178,9 @@ private:
 
     String lastError, dtdText;
     StringArray tokenisedDTD;
-    bool needToLoadDTD, ignoreEmptyTextElements;
+    bool needToLoadDTD, ignoreEmptyTextElements, useArena;
     ScopedPointer <InputSource> inputSource;
+    XmlElement::Arena::Ptr arena;
 
     void setLastError (const String& desc, bool carryOn);
     void skipHeader();
@@ -170,6 +191,9 @@ private:
     int findNextTokenLength() noexcept;
     void readQuotedString (String& result);
     void readEntity (String& result);
+    XmlElement* createElement (String::CharPointerType tagName, int length);
+    XmlElement::XmlAttributeNode* createAttribute (String::CharPointerType name, int length);
+    XmlElement* createTextElement (const String& text);
 
     String getFileContents (const String& filename) const;
     String expandEntity (const String& entity);
@@ -48,6 +48,286 @@ inline bool XmlElement::XmlAttributeNode::hasName (const String& nameToMatch) co
     return name.equalsIgnoreCase (nameToMatch);
 }
 
+//==============================================================================
+/*  Each of an arena's blocks starts with one of these. The strings that are created in
+    a block are kept in a list, so that when the arena is released it can check whether
+    any copies of them are still being used elsewhere.
+*/
+struct XmlElement::Arena::Block
+{
+    Arena* arena;
+    Block* next;
+    char* end;
+    void* firstString;
+};
+
+namespace XmlArenaHelpers
+{
+    inline size_t align (const size_t numBytes) noexcept
+    {
+        return (numBytes + sizeof (double) - 1) & ~(sizeof (double) - 1);
+    }
+
+    // The blocks that belong to live arenas, sorted by address, so that deleting an object
+    // can find out whether it came from one of them without needing anything stored next
+    // to the object itself. These are all plain statics, so they can still be used while
+    // other static objects are being destroyed.
+    SpinLock liveBlocksLock;
+    Atomic<int> numLiveBlocks;
+    char** liveBlocks = nullptr;
+    int numLiveBlocksAllocated = 0;
+
+    // Blocks whose arena has gone, but which still contain strings that are in use.
+    void* retiredBlocks = nullptr;
+
+    // returns the index of the last block that starts at or before the given address
+    int findLiveBlockIndex (const void* const address) noexcept
+    {
+        int start = 0;
+        int end = numLiveBlocks.get();
+
+        while (start < end)
+        {
+            const int halfway = (start + end) >> 1;
+
+            if (liveBlocks [halfway] <= static_cast <const char*> (address))
+                start = halfway + 1;
+            else
+                end = halfway;
+        }
+
+        return start - 1;
+    }
+
+    void addLiveBlock (char* const block)
+    {
+        const SpinLock::ScopedLockType sl (liveBlocksLock);
+        const int num = numLiveBlocks.get();
+
+        if (num >= numLiveBlocksAllocated)
+        {
+            numLiveBlocksAllocated = jmax (16, numLiveBlocksAllocated * 2);
+            liveBlocks = static_cast <char**> (::realloc (liveBlocks, (size_t) numLiveBlocksAllocated * sizeof (char*)));
+        }
+
+        const int index = findLiveBlockIndex (block) + 1;
+        memmove (liveBlocks + index + 1, liveBlocks + index, (size_t) (num - index) * sizeof (char*));
+        liveBlocks [index] = block;
+        numLiveBlocks = num + 1;
+    }
+
+    void removeLiveBlock (char* const block) noexcept
+    {
+        const SpinLock::ScopedLockType sl (liveBlocksLock);
+        const int num = numLiveBlocks.get();
+        const int index = findLiveBlockIndex (block);
+
+        jassert (index >= 0 && liveBlocks [index] == block);
+        memmove (liveBlocks + index, liveBlocks + index + 1, (size_t) (num - index - 1) * sizeof (char*));
+        numLiveBlocks = num - 1;
+    }
+
+    // each string in an arena is preceded by a pointer to the next one in its block
+    inline void*& nextString (void* const s) noexcept    { return *static_cast <void**> (s); }
+    inline char* getStringStorage (void* const s) noexcept { return static_cast <char*> (s) + align (sizeof (void*)); }
+}
+
+XmlElement::Arena::Arena() noexcept
+    : blocks (nullptr),
+      nextFree (nullptr),
+      numBytesFree (0),
+      nextBlockSize (16384)
+{
+}
+
+XmlElement::Arena::~Arena()
+{
+    using namespace XmlArenaHelpers;
+
+    names.clearQuick();
+
+    for (Block* b = blocks; b != nullptr; b = b->next)
+        removeLiveBlock (reinterpret_cast <char*> (b));
+
+    releaseBlocks (blocks);
+
+    // ..and give any blocks that were kept for an earlier arena another chance
+    void* retired;
+
+    {
+        const SpinLock::ScopedLockType sl (liveBlocksLock);
+        retired = retiredBlocks;
+        retiredBlocks = nullptr;
+    }
+
+    releaseBlocks (static_cast <Block*> (retired));
+}
+
+void XmlElement::Arena::releaseBlocks (Block* list) noexcept
+{
+    using namespace XmlArenaHelpers;
+
+    while (list != nullptr)
+    {
+        Block* const next = list->next;
+
+        if (isBlockInUse (list))
+        {
+            const SpinLock::ScopedLockType sl (liveBlocksLock);
+            list->arena = nullptr;
+            list->next = static_cast <Block*> (retiredBlocks);
+            retiredBlocks = list;
+        }
+        else
+        {
+            ::operator delete (list);
+        }
+
+        list = next;
+    }
+}
+
+bool XmlElement::Arena::isBlockInUse (const Block* const block) noexcept
+{
+    using namespace XmlArenaHelpers;
+
+    for (void* s = block->firstString; s != nullptr; s = nextString (s))
+        if (String::isExternalStorageInUse (getStringStorage (s)))
+            return true;
+
+    return false;
+}
+
+void* XmlElement::Arena::allocate (size_t numBytes)
+{
+    using namespace XmlArenaHelpers;
+    numBytes = align (numBytes);
+
+    if (numBytes > numBytesFree)
+    {
+        const size_t headerSize = align (sizeof (Block));
+        const size_t blockSize = jmax (nextBlockSize, numBytes + headerSize);
+
+        Block* const block = static_cast <Block*> (::operator new (blockSize));
+        block->arena = this;
+        block->next = blocks;
+        block->end = reinterpret_cast <char*> (block) + blockSize;
+        block->firstString = nullptr;
+        blocks = block;
+        addLiveBlock (reinterpret_cast <char*> (block));
+
+        nextFree = reinterpret_cast <char*> (block) + headerSize;
+        numBytesFree = blockSize - headerSize;
+        nextBlockSize = jmin (nextBlockSize * 2, (size_t) 1024 * 1024);
+    }
+
+    void* const result = nextFree;
+    nextFree += numBytes;
+    numBytesFree -= numBytes;
+    return result;
+}
+
+String XmlElement::Arena::createString (const String::CharPointerType text, const size_t numChars)
+{
+    using namespace XmlArenaHelpers;
+
+    if (numChars == 0 || text.isEmpty())
+        return String::empty;
+
+    void* const s = allocate (align (sizeof (void*)) + String::getExternalStorageSize (text, numChars));
+
+    // (allocate() always uses the newest block, which is at the head of the list)
+    nextString (s) = blocks->firstString;
+    blocks->firstString = s;
+
+    return String::createInExternalStorage (getStringStorage (s), text, numChars);
+}
+
+String XmlElement::Arena::getName (const String::CharPointerType text, const size_t numChars)
+{
+    int start = 0;
+    int end = names.size();
+
+    while (start < end)
+    {
+        const int halfway = (start + end) >> 1;
+        const String::CharPointerType name (names.getReference (halfway).getCharPointer());
+        int comp = name.compareUpTo (text, (int) numChars);
+
+        if (comp == 0)
+        {
+            if ((name + (int) numChars).isEmpty())
+                return names.getReference (halfway);
+
+            comp = 1;
+        }
+
+        if (comp < 0)
+            start = halfway + 1;
+        else
+            end = halfway;
+    }
+
+    const String name (createString (text, numChars));
+    names.insert (start, name);
+    return name;
+}
+
+void* XmlElement::Arena::allocateObject (const size_t numBytes, Arena* const arena)
+{
+    // Arena objects don't get freed individually - each one just holds a reference to the
+    // arena, which releases all its memory when the last one has been deleted.
+    if (arena == nullptr)
+        return ::operator new (numBytes);
+
+    arena->incReferenceCount();
+    return arena->allocate (numBytes);
+}
+
+XmlElement::Arena* XmlElement::Arena::findArenaContaining (const void* const object) noexcept
+{
+    using namespace XmlArenaHelpers;
+
+    if (numLiveBlocks.get() == 0)
+        return nullptr;
+
+    const SpinLock::ScopedLockType sl (liveBlocksLock);
+    const int index = findLiveBlockIndex (object);
+
+    if (index >= 0)
+    {
+        const Block* const block = reinterpret_cast <const Block*> (liveBlocks [index]);
+
+        if (static_cast <const char*> (object) < block->end)
+            return block->arena;
+    }
+
+    return nullptr;
+}
+
+void XmlElement::Arena::releaseObject (void* const object) noexcept
+{
+    if (object != nullptr)
+    {
+        Arena* const arena = findArenaContaining (object);
+
+        if (arena != nullptr)
+            arena->decReferenceCount();
+        else
+            ::operator delete (object);
+    }
+}
+
+void* XmlElement::operator new (const size_t numBytes)                                   { return Arena::allocateObject (numBytes, nullptr); }
+void* XmlElement::operator new (const size_t numBytes, Arena& arena)                     { return Arena::allocateObject (numBytes, &arena); }
+void XmlElement::operator delete (void* const object) noexcept                           { Arena::releaseObject (object); }
+void XmlElement::operator delete (void* const object, Arena&) noexcept                   { Arena::releaseObject (object); }
+
+void* XmlElement::XmlAttributeNode::operator new (const size_t numBytes)                 { return Arena::allocateObject (numBytes, nullptr); }
+void* XmlElement::XmlAttributeNode::operator new (const size_t numBytes, Arena& arena)   { return Arena::allocateObject (numBytes, &arena); }
+void XmlElement::XmlAttributeNode::operator delete (void* const object) noexcept         { Arena::releaseObject (object); }
+void XmlElement::XmlAttributeNode::operator delete (void* const object, Arena&) noexcept { Arena::releaseObject (object); }
+
 //==============================================================================
 XmlElement::XmlElement (const String& tagName_) noexcept
     : tagName (tagName_)
@@ -837,6 +1117,13 @@ XmlElement* XmlElement::createTextElement (const String& text)
     return e;
 }
 
+XmlElement* XmlElement::createTextElement (const String& text, Arena& arena)
+{
+    XmlElement* const e = new (arena) XmlElement ((int) 0);
+    e->attributes = new (arena) XmlAttributeNode (juce_xmltextContentAttributeName, text);
+    return e;
+}
+
 void XmlElement::addTextElement (const String& text)
 {
     addChildElement (createTextElement (text));
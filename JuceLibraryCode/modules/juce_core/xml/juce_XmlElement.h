@@ -30,6 +30,8 @@
 #include "../streams/juce_OutputStream.h"
 #include "../files/juce_File.h"
 #include "../containers/juce_LinkedListPointer.h"
+#include "../containers/juce_Array.h"
+#include "../memory/juce_ReferenceCountedObject.h"
 
 
 //==============================================================================
@@ -690,8 +692,45 @@ public:
     */
     static XmlElement* createTextElement (const String& text);
 
+    //==============================================================================
+   #ifndef DOXYGEN
+    // Elements may have been allocated from an XmlDocument's arena, so these make
+    // sure that deleting one releases its memory in the right way.
+    static void* operator new (size_t);
+    static void operator delete (void*) noexcept;
+   #endif
+
     //==============================================================================
 private:
+    class Arena  : public ReferenceCountedObject
+    {
+    public:
+        Arena() noexcept;
+        ~Arena();
+
+        typedef ReferenceCountedObjectPtr<Arena> Ptr;
+
+        String createString (String::CharPointerType text, size_t numChars);
+        String getName (String::CharPointerType text, size_t numChars);
+
+        static void* allocateObject (size_t numBytes, Arena* arena);
+        static void releaseObject (void* object) noexcept;
+
+    private:
+        struct Block;
+        Block* blocks;
+        char* nextFree;
+        size_t numBytesFree, nextBlockSize;
+        Array<String> names;
+
+        void* allocate (size_t numBytes);
+        static Arena* findArenaContaining (const void* object) noexcept;
+        static bool isBlockInUse (const Block*) noexcept;
+        static void releaseBlocks (Block* list) noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (Arena);
+    };
+
     struct XmlAttributeNode
     {
         XmlAttributeNode (const XmlAttributeNode&) noexcept;
@@ -702,6 +741,11 @@ private:
 
         bool hasName (const String&) const noexcept;
 
+        static void* operator new (size_t);
+        static void* operator new (size_t, Arena&);
+        static void operator delete (void*) noexcept;
+        static void operator delete (void*, Arena&) noexcept;
+
     private:
         XmlAttributeNode& operator= (const XmlAttributeNode&);
     };
@@ -717,6 +761,9 @@ private:
     String tagName;
 
     XmlElement (int) noexcept;
+    static void* operator new (size_t, Arena&);
+    static void operator delete (void*, Arena&) noexcept;
+    static XmlElement* createTextElement (const String& text, Arena&);
     void copyChildrenAndAttributesFrom (const XmlElement&);
     void writeElementAsText (OutputStream&, int indentationLevel, int lineWrapLength) const;
     void getChildElementsAsArray (XmlElement**) const noexcept;
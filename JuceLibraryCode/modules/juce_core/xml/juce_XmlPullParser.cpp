@@ -0,0 +1,863 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+BEGIN_JUCE_NAMESPACE
+
+//==============================================================================
+XmlPullParser::XmlPullParser (InputStream* const sourceStream, const bool deleteSourceWhenDestroyed)
+    : source (sourceStream, deleteSourceWhenDestroyed)
+{
+    initialise();
+}
+
+XmlPullParser::XmlPullParser (const File& file)
+    : source (file.createInputStream(), true)
+{
+    initialise();
+}
+
+XmlPullParser::~XmlPullParser()
+{
+}
+
+void XmlPullParser::initialise()
+{
+    buffer.malloc ((size_t) bufferSize);
+    bufferPos = bufferEnd = 0;
+    numLookahead = 0;
+    maxTextLength = 65536;
+    numTextChars = 0;
+    outOfData = finished = pendingEndElement = skipping = insideCData = false;
+    ignoreEmptyTextElements = true;
+    currentEvent = noEvent;
+    depth = 0;
+
+    if (source == nullptr)
+        setLastError ("not enough input", false);
+    else if (peekChar (0) == 0xfeff)  // skip a UTF-8 byte-order mark
+        skipChars (1);
+}
+
+void XmlPullParser::setEmptyTextElementsIgnored (const bool shouldBeIgnored) noexcept
+{
+    ignoreEmptyTextElements = shouldBeIgnored;
+}
+
+void XmlPullParser::setMaximumTextLength (const int maxNumChars) noexcept
+{
+    jassert (maxNumChars > 0);
+    maxTextLength = jmax (1, maxNumChars);
+}
+
+void XmlPullParser::setLastError (const String& desc, const bool carryOn)
+{
+    lastError = desc;
+
+    if (! carryOn)
+        finished = true;
+}
+
+//==============================================================================
+bool XmlPullParser::hasTagName (const String& possibleTagName) const noexcept
+{
+    return tagName.equalsIgnoreCase (possibleTagName);
+}
+
+const String& XmlPullParser::getAttributeName (const int attributeIndex) const noexcept
+{
+    return attributeNames [attributeIndex];
+}
+
+const String& XmlPullParser::getAttributeValue (const int attributeIndex) const noexcept
+{
+    return attributeValues [attributeIndex];
+}
+
+String XmlPullParser::getStringAttribute (const String& attributeName, const String& defaultReturnValue) const
+{
+    for (int i = 0; i < attributeNames.size(); ++i)
+        if (attributeNames[i].equalsIgnoreCase (attributeName))
+            return attributeValues[i];
+
+    return defaultReturnValue;
+}
+
+//==============================================================================
+bool XmlPullParser::next()
+{
+    if (finished)
+    {
+        currentEvent = noEvent;
+        return false;
+    }
+
+    if (pendingEndElement)
+    {
+        // the second half of an empty tag..
+        pendingEndElement = false;
+        depth = openTags.size();
+        openTags.remove (depth - 1);
+        attributeNames.clear();
+        attributeValues.clear();
+        currentEvent = endElement;
+        return true;
+    }
+
+    if (currentEvent == endElement && openTags.size() == 0)
+    {
+        // the document element has been closed, so don't bother reading any further
+        finished = true;
+        currentEvent = noEvent;
+        return false;
+    }
+
+    while (! finished)
+    {
+        if (insideCData)
+        {
+            // (either a new CDATA section, or the rest of one that was too long for one event)
+            if (readCData())
+                return true;
+
+            continue;
+        }
+
+        const juce_wchar c = peekChar (0);
+
+        if (c == 0)
+        {
+            setLastError (openTags.size() > 0 ? "unmatched tags" : "not enough input", false);
+        }
+        else if (c == '<')
+        {
+            const juce_wchar c1 = peekChar (1);
+
+            if (c1 == '/')
+            {
+                if (readEndTag())
+                    return true;
+            }
+            else if (c1 == '?')
+            {
+                skipUntil ("?>");
+            }
+            else if (c1 == '!')
+            {
+                if (nextCharsMatch ("<!--"))
+                    skipUntil ("-->");
+                else if (nextCharsMatch ("<![CDATA["))
+                {
+                    skipChars (9);
+                    insideCData = true;
+                }
+                else
+                    skipDeclaration();
+            }
+            else if (readStartTag())
+            {
+                return true;
+            }
+        }
+        else if (openTags.size() == 0)
+        {
+            readChar(); // ignore anything outside the document element
+        }
+        else if (readText())
+        {
+            return true;
+        }
+    }
+
+    currentEvent = noEvent;
+    return false;
+}
+
+bool XmlPullParser::skipElement()
+{
+    // this must be called when positioned at the start of an element!
+    jassert (currentEvent == startElement);
+
+    if (currentEvent == startElement)
+    {
+        const int elementDepth = depth;
+        skipping = true;
+
+        while (next())
+            if (currentEvent == endElement && depth == elementDepth)
+                break;
+
+        skipping = false;
+    }
+
+    return currentEvent == endElement;
+}
+
+String XmlPullParser::readElementText()
+{
+    // this must be called when positioned at the start of an element!
+    jassert (currentEvent == startElement);
+
+    String result;
+
+    if (currentEvent == startElement)
+    {
+        const int elementDepth = depth;
+
+        while (next())
+        {
+            if (currentEvent == text)
+                result += currentText;
+            else if (currentEvent == endElement && depth == elementDepth)
+                break;
+        }
+    }
+
+    return result;
+}
+
+//==============================================================================
+juce_wchar XmlPullParser::readByte()
+{
+    if (bufferPos >= bufferEnd)
+    {
+        bufferPos = 0;
+        bufferEnd = outOfData ? 0 : source->read (buffer, bufferSize);
+
+        if (bufferEnd <= 0)
+        {
+            bufferEnd = 0;
+            outOfData = true;
+            return 0;
+        }
+    }
+
+    return (juce_wchar) (uint8) buffer [bufferPos++];
+}
+
+juce_wchar XmlPullParser::decodeNextChar()
+{
+    // the stream is treated as UTF-8, in the same way as XmlDocument reads files..
+    uint32 n = (uint32) readByte();
+
+    if (n < 0x80)
+        return (juce_wchar) n;
+
+    uint32 mask = 0x7f;
+    uint32 bit = 0x40;
+    int numExtraValues = 0;
+
+    while ((n & bit) != 0 && bit > 0x8)
+    {
+        mask >>= 1;
+        ++numExtraValues;
+        bit >>= 1;
+    }
+
+    n &= mask;
+
+    while (--numExtraValues >= 0)
+    {
+        const uint32 nextByte = (uint32) readByte();
+
+        if ((nextByte & 0xc0) != 0x80)
+            break;
+
+        n <<= 6;
+        n |= (nextByte & 0x3f);
+    }
+
+    return (juce_wchar) n;
+}
+
+juce_wchar XmlPullParser::peekChar (const int offset)
+{
+    jassert (offset < numElementsInArray (lookahead));
+
+    while (numLookahead <= offset)
+        lookahead [numLookahead++] = decodeNextChar();
+
+    return lookahead [offset];
+}
+
+juce_wchar XmlPullParser::readChar()
+{
+    if (numLookahead == 0)
+        return decodeNextChar();
+
+    const juce_wchar c = lookahead[0];
+    --numLookahead;
+
+    for (int i = 0; i < numLookahead; ++i)
+        lookahead[i] = lookahead[i + 1];
+
+    return c;
+}
+
+bool XmlPullParser::nextCharsMatch (const char* chars)
+{
+    for (int i = 0; chars[i] != 0; ++i)
+        if (peekChar (i) != (juce_wchar) (uint8) chars[i])
+            return false;
+
+    return true;
+}
+
+void XmlPullParser::skipChars (int num)
+{
+    while (--num >= 0)
+        readChar();
+}
+
+void XmlPullParser::skipWhiteSpace()
+{
+    while (CharacterFunctions::isWhitespace (peekChar (0)))
+        readChar();
+}
+
+void XmlPullParser::skipUntil (const char* terminator)
+{
+    const int terminatorLength = (int) strlen (terminator);
+
+    while (! nextCharsMatch (terminator))
+    {
+        if (peekChar (0) == 0)
+            return;
+
+        readChar();
+    }
+
+    skipChars (terminatorLength);
+}
+
+void XmlPullParser::skipDeclaration()
+{
+    // skips a <!DOCTYPE or similar, including any nested declarations..
+    readChar();
+    int n = 1;
+
+    while (n > 0)
+    {
+        const juce_wchar c = readChar();
+
+        if (c == 0)
+            return;
+
+        if (c == '<')
+            ++n;
+        else if (c == '>')
+            --n;
+    }
+}
+
+String XmlPullParser::readName()
+{
+    scratch.reset();
+
+    while (XmlIdentifierChars::isIdentifierChar (peekChar (0)))
+        appendToScratch (readChar());
+
+    return scratch.toUTF8();
+}
+
+void XmlPullParser::appendToScratch (const juce_wchar c)
+{
+    if (c < 0x80)
+    {
+        scratch.writeByte ((char) c);
+    }
+    else
+    {
+        char utf8 [8] = { 0 };
+        CharPointer_UTF8 (utf8).write (c);
+        scratch.write (utf8, (int) CharPointer_UTF8::getBytesRequiredFor (c));
+    }
+}
+
+void XmlPullParser::appendTextChar (const juce_wchar c)
+{
+    if (! skipping)
+    {
+        appendToScratch (c);
+        ++numTextChars;
+    }
+}
+
+void XmlPullParser::startNewText()
+{
+    scratch.reset();
+    numTextChars = 0;
+}
+
+void XmlPullParser::readEntity()
+{
+    // skip over the ampersand
+    readChar();
+
+    juce_wchar name [34];
+    int len = 0;
+    bool terminated = false;
+
+    for (;;)
+    {
+        const juce_wchar c = peekChar (0);
+
+        if (c == ';')
+        {
+            readChar();
+            terminated = true;
+            break;
+        }
+
+        if (c == 0 || c == '<' || c == '&' || CharacterFunctions::isWhitespace (c)
+             || len >= numElementsInArray (name) - 2)
+            break;
+
+        name [len++] = readChar();
+    }
+
+    const String entity (CharPointer_UTF32 (name), (size_t) len);
+
+    if (terminated)
+    {
+        if (entity.equalsIgnoreCase ("amp"))    { appendTextChar ('&');  return; }
+        if (entity.equalsIgnoreCase ("quot"))   { appendTextChar ('"');  return; }
+        if (entity.equalsIgnoreCase ("apos"))   { appendTextChar ('\''); return; }
+        if (entity.equalsIgnoreCase ("lt"))     { appendTextChar ('<');  return; }
+        if (entity.equalsIgnoreCase ("gt"))     { appendTextChar ('>');  return; }
+
+        if (name[0] == '#')
+        {
+            if (name[1] == 'x' || name[1] == 'X')
+            {
+                appendTextChar ((juce_wchar) entity.substring (2).getHexValue32());
+                return;
+            }
+
+            if (name[1] >= '0' && name[1] <= '9')
+            {
+                appendTextChar ((juce_wchar) entity.substring (1).getIntValue());
+                return;
+            }
+
+            setLastError ("illegal escape sequence", true);
+        }
+        else
+        {
+            // without a DTD there's no way to expand this, so it gets left as it is..
+            setLastError ("unknown entity", true);
+        }
+    }
+    else
+    {
+        setLastError ("entity without terminating semi-colon", true);
+    }
+
+    appendTextChar ('&');
+
+    for (int i = 0; i < len; ++i)
+        appendTextChar (name[i]);
+
+    if (terminated)
+        appendTextChar (';');
+}
+
+//==============================================================================
+bool XmlPullParser::readStartTag()
+{
+    readChar();
+
+    // allow for a gap after the '<' before giving an error
+    skipWhiteSpace();
+    tagName = readName();
+
+    if (tagName.isEmpty())
+    {
+        setLastError ("tag name missing", false);
+        return false;
+    }
+
+    attributeNames.clear();
+    attributeValues.clear();
+
+    for (;;)
+    {
+        skipWhiteSpace();
+
+        juce_wchar c = peekChar (0);
+
+        // empty tag..
+        if (c == '/' && peekChar (1) == '>')
+        {
+            skipChars (2);
+            pendingEndElement = true;
+            break;
+        }
+
+        if (c == '>')
+        {
+            readChar();
+            break;
+        }
+
+        // get an attribute..
+        if (XmlIdentifierChars::isIdentifierChar (c))
+        {
+            const String attributeName (readName());
+            skipWhiteSpace();
+            c = peekChar (0);
+
+            if (c == '=')
+            {
+                readChar();
+                skipWhiteSpace();
+                c = peekChar (0);
+
+                if (c == '"' || c == '\'')
+                {
+                    const juce_wchar quote = readChar();
+                    scratch.reset();
+
+                    for (;;)
+                    {
+                        const juce_wchar nextChar = peekChar (0);
+
+                        if (nextChar == quote)
+                        {
+                            readChar();
+                            break;
+                        }
+
+                        if (nextChar == 0)
+                        {
+                            setLastError ("unmatched quotes", false);
+                            return false;
+                        }
+
+                        if (nextChar == '&')
+                            readEntity();
+                        else
+                            appendTextChar (readChar());
+                    }
+
+                    if (! skipping)
+                    {
+                        attributeNames.add (attributeName);
+                        attributeValues.add (scratch.toUTF8());
+                    }
+
+                    continue;
+                }
+            }
+        }
+
+        if (c == 0)
+            setLastError ("unmatched tags", false);
+        else
+            setLastError ("illegal character found in " + tagName + ": '" + c + "'", false);
+
+        return false;
+    }
+
+    openTags.add (tagName);
+    depth = openTags.size();
+    currentEvent = startElement;
+    return true;
+}
+
+bool XmlPullParser::readEndTag()
+{
+    skipChars (2);
+    skipWhiteSpace();
+    const String name (readName());
+    skipUntil (">");
+
+    if (openTags.size() == 0 || name != openTags [openTags.size() - 1])
+    {
+        setLastError ("unmatched tags", false);
+        return false;
+    }
+
+    depth = openTags.size();
+    openTags.remove (depth - 1);
+    tagName = name;
+    attributeNames.clear();
+    attributeValues.clear();
+    currentEvent = endElement;
+    return true;
+}
+
+bool XmlPullParser::readText()
+{
+    startNewText();
+    bool containsNonWhitespace = false;
+
+    for (;;)
+    {
+        const juce_wchar c = peekChar (0);
+
+        // (if the text is too long, the rest of it gets read by the next call)
+        if (c == '<' || numTextChars >= maxTextLength)
+            break;
+
+        if (c == 0)
+        {
+            setLastError ("unmatched tags", false);
+            return false;
+        }
+
+        if (c == '&')
+        {
+            readEntity();
+            containsNonWhitespace = true;
+        }
+        else
+        {
+            if (! CharacterFunctions::isWhitespace (c))
+                containsNonWhitespace = true;
+
+            appendTextChar (readChar());
+        }
+    }
+
+    if (skipping || (ignoreEmptyTextElements && ! containsNonWhitespace))
+        return false;
+
+    currentText = scratch.toUTF8();
+    depth = openTags.size();
+    currentEvent = text;
+    return true;
+}
+
+bool XmlPullParser::readCData()
+{
+    startNewText();
+
+    for (;;)
+    {
+        if (nextCharsMatch ("]]>"))
+        {
+            skipChars (3);
+            insideCData = false;
+            break;
+        }
+
+        // (if the section is too long, the rest of it gets read by the next call)
+        if (numTextChars >= maxTextLength)
+            break;
+
+        const juce_wchar c = readChar();
+
+        if (c == 0)
+        {
+            setLastError ("unterminated CDATA section", false);
+            return false;
+        }
+
+        appendTextChar (c);
+    }
+
+    if (skipping || openTags.size() == 0)
+        return false;
+
+    currentText = scratch.toUTF8();
+    depth = openTags.size();
+    currentEvent = text;
+    return true;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class XmlPullParserTests  : public UnitTest
+{
+public:
+    XmlPullParserTests() : UnitTest ("XmlPullParser") {}
+
+    static XmlElement* createTreeFromEvents (XmlPullParser& parser)
+    {
+        ScopedPointer<XmlElement> root;
+        Array<XmlElement*> openElements;
+
+        while (parser.next())
+        {
+            if (parser.getEventType() == XmlPullParser::startElement)
+            {
+                XmlElement* const e = new XmlElement (parser.getTagName());
+
+                for (int i = 0; i < parser.getNumAttributes(); ++i)
+                    e->setAttribute (parser.getAttributeName (i), parser.getAttributeValue (i));
+
+                if (openElements.size() > 0)
+                    openElements.getLast()->addChildElement (e);
+                else
+                    root = e;
+
+                openElements.add (e);
+            }
+            else if (parser.getEventType() == XmlPullParser::text)
+            {
+                openElements.getLast()->addChildElement (XmlElement::createTextElement (parser.getText()));
+            }
+            else if (parser.getEventType() == XmlPullParser::endElement)
+            {
+                openElements.removeLast();
+            }
+        }
+
+        return root.release();
+    }
+
+    void runTest()
+    {
+        beginTest ("XmlPullParser");
+
+        const String doc ("<?xml version=\"1.0\"?>\n<!DOCTYPE list [ <!ELEMENT list ANY> ]>\n"
+                          "<list name=\"a &amp; b\" id='2'><item>one &lt;1&gt; &#65;&#x42;</item><!-- comment -->"
+                          "<empty/><item><![CDATA[<raw>]]><sub x=\"y\">two</sub></item></list>\n<!-- trailing -->");
+
+        {
+            MemoryInputStream in (doc.toUTF8(), doc.getNumBytesAsUTF8(), false);
+            XmlPullParser parser (&in, false);
+            ScopedPointer<XmlElement> fromEvents (createTreeFromEvents (parser));
+            ScopedPointer<XmlElement> fromDocument (XmlDocument::parse (doc));
+
+            expect (fromEvents != nullptr && fromDocument != nullptr
+                     && fromEvents->isEquivalentTo (fromDocument, false));
+            expect (parser.getLastParseError().isEmpty());
+        }
+
+        {
+            MemoryInputStream in (doc.toUTF8(), doc.getNumBytesAsUTF8(), false);
+            XmlPullParser parser (&in, false);
+
+            expect (parser.next() && parser.hasTagName ("list") && parser.getDepth() == 1);
+            expect (parser.getStringAttribute ("name") == "a & b" && parser.getStringAttribute ("id") == "2");
+            expect (parser.next() && parser.hasTagName ("item") && parser.getDepth() == 2);
+            expect (parser.skipElement() && parser.hasTagName ("item"));
+            expect (parser.next() && parser.hasTagName ("empty"));
+            expect (parser.next() && parser.getEventType() == XmlPullParser::endElement && parser.hasTagName ("empty"));
+            expect (parser.next() && parser.hasTagName ("item"));
+            expect (parser.readElementText() == "<raw>two");
+            expect (parser.next() && parser.getEventType() == XmlPullParser::endElement && parser.getDepth() == 1);
+            expect (! parser.next());
+        }
+
+        {
+            const char* const badDocs[] = { "<a><b></a>", "<a>text", "<a b=\"c></a>", "<a <", "" };
+
+            for (int i = 0; i < numElementsInArray (badDocs); ++i)
+            {
+                MemoryInputStream in (badDocs[i], strlen (badDocs[i]), false);
+                XmlPullParser parser (&in, false);
+
+                while (parser.next())
+                {}
+
+                expect (parser.getLastParseError().isNotEmpty());
+            }
+        }
+
+        beginTest ("Long text");
+
+        {
+            String expectedText, expectedCData;
+            MemoryOutputStream xml;
+            xml << "<doc><text>";
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                xml << "line " << i << " &amp; &#x263a;\n";
+                expectedText << "line " << i << " & " << String::charToString ((juce_wchar) 0x263a) << "\n";
+            }
+
+            xml << "</text><cdata><![CDATA[";
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                xml << "<" << i << "> ]] ";
+                expectedCData << "<" << i << "> ]] ";
+            }
+
+            xml << "]]></cdata><short>abc</short></doc>";
+
+            const int maxLength = 500;
+            MemoryInputStream in (xml.getData(), xml.getDataSize(), false);
+            XmlPullParser parser (&in, false);
+            parser.setMaximumTextLength (maxLength);
+
+            String text, cdata;
+            int numTextEvents = 0, numCDataEvents = 0;
+            bool allShortEnough = true;
+
+            while (parser.next())
+            {
+                if (parser.getEventType() == XmlPullParser::startElement && parser.hasTagName ("short"))
+                {
+                    expectEquals (parser.readElementText(), String ("abc"));
+                }
+                else if (parser.getEventType() == XmlPullParser::text)
+                {
+                    // (an entity at the end can take it slightly over the limit)
+                    allShortEnough = allShortEnough && parser.getText().length() <= maxLength + 8;
+                    expectEquals (parser.getDepth(), 2);
+
+                    if (cdata.isEmpty() && text.length() < expectedText.length())
+                    {
+                        text += parser.getText();
+                        ++numTextEvents;
+                    }
+                    else
+                    {
+                        cdata += parser.getText();
+                        ++numCDataEvents;
+                    }
+                }
+            }
+
+            expect (parser.getLastParseError().isEmpty());
+            expect (allShortEnough);
+            expect (text == expectedText);
+            expect (cdata == expectedCData);
+            expect (numTextEvents >= expectedText.length() / (maxLength + 8));
+            expect (numCDataEvents >= expectedCData.length() / maxLength);
+
+            // ..and readElementText() puts the pieces back together
+            MemoryInputStream in2 (xml.getData(), xml.getDataSize(), false);
+            XmlPullParser parser2 (&in2, false);
+            parser2.setMaximumTextLength (maxLength);
+
+            expect (parser2.next() && parser2.next() && parser2.hasTagName ("text"));
+            expect (parser2.readElementText() == expectedText);
+            expect (parser2.next() && parser2.hasTagName ("cdata"));
+            expect (parser2.readElementText() == expectedCData);
+        }
+    }
+};
+
+static XmlPullParserTests xmlPullParserUnitTests;
+
+#endif
+
+END_JUCE_NAMESPACE
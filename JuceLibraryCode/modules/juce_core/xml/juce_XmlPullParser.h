@@ -0,0 +1,231 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_XMLPULLPARSER_JUCEHEADER__
+#define __JUCE_XMLPULLPARSER_JUCEHEADER__
+
+#include "../text/juce_StringArray.h"
+#include "../files/juce_File.h"
+#include "../streams/juce_MemoryOutputStream.h"
+#include "../memory/juce_OptionalScopedPointer.h"
+#include "../memory/juce_HeapBlock.h"
+
+
+//==============================================================================
+/**
+    Reads an XML document from a stream as a sequence of events, without building
+    an XmlElement tree.
+
+    Unlike XmlDocument, which has to load the whole document into memory before
+    parsing it, this reads its source stream through a small buffer and only keeps
+    hold of the current event and the names of the currently-open elements. This makes
+    it suitable for scanning large files, or for pulling a single item out of a
+    document, because you can skip over any elements you're not interested in and
+    stop as soon as you've found what you need.
+
+    e.g.
+    @code
+
+    XmlPullParser parser (File ("myfile.xml"));
+
+    while (parser.next())
+    {
+        if (parser.getEventType() == XmlPullParser::startElement)
+        {
+            if (parser.hasTagName ("title"))
+            {
+                String title (parser.readElementText());
+                ..use the title
+                break;
+            }
+
+            if (parser.hasTagName ("images"))
+                parser.skipElement();
+        }
+    }
+
+    @endcode
+
+    Entities are expanded in text and attribute values, but the parser doesn't load
+    DTDs, so any custom entities will be left as they appear in the source.
+
+    @see XmlDocument
+*/
+class JUCE_API  XmlPullParser
+{
+public:
+    //==============================================================================
+    /** Creates a parser that will read from a stream.
+
+        @param sourceStream                 the stream to read the XML text from
+        @param deleteSourceWhenDestroyed    whether the sourceStream that is passed in should be
+                                            deleted by this object when it is itself deleted.
+    */
+    XmlPullParser (InputStream* sourceStream, bool deleteSourceWhenDestroyed);
+
+    /** Creates a parser that will read from a file. */
+    XmlPullParser (const File& file);
+
+    /** Destructor. */
+    ~XmlPullParser();
+
+    //==============================================================================
+    /** The different kinds of event that next() can produce. */
+    enum EventType
+    {
+        noEvent,        /**< next() hasn't been called yet, or the end of the document has been reached. */
+        startElement,   /**< An opening tag has been read. Its name and attributes are available. */
+        text,           /**< A block of text or a CDATA section has been read. Long blocks are
+                             split into several consecutive text events - see setMaximumTextLength(). */
+        endElement      /**< A closing tag has been read (empty tags produce a start and an end event). */
+    };
+
+    /** Reads the next event from the stream.
+
+        @returns    false when the outer document element has been closed, or if there was a
+                    parse error (in which case getLastParseError() will return a description).
+    */
+    bool next();
+
+    /** Returns the type of the event that the last call to next() produced. */
+    EventType getEventType() const noexcept                     { return currentEvent; }
+
+    /** Returns the nesting level of the current event.
+
+        For a start or end element, this is the level of that element, where the outer document
+        element is at level 1. For text, it's the number of elements that enclose it.
+    */
+    int getDepth() const noexcept                               { return depth; }
+
+    //==============================================================================
+    /** Returns the name of the element for a startElement or endElement event. */
+    const String& getTagName() const noexcept                   { return tagName; }
+
+    /** Tests whether the current element has a particular tag name. */
+    bool hasTagName (const String& possibleTagName) const noexcept;
+
+    /** Returns the number of attributes that the current startElement has. */
+    int getNumAttributes() const noexcept                       { return attributeNames.size(); }
+
+    /** Returns the name of one of the current element's attributes. */
+    const String& getAttributeName (int attributeIndex) const noexcept;
+
+    /** Returns the value of one of the current element's attributes. */
+    const String& getAttributeValue (int attributeIndex) const noexcept;
+
+    /** Returns the value of a named attribute of the current element.
+        If the attribute isn't present, the default value is returned.
+    */
+    String getStringAttribute (const String& attributeName,
+                               const String& defaultReturnValue = String::empty) const;
+
+    /** Returns the content of a text event. */
+    const String& getText() const noexcept                      { return currentText; }
+
+    //==============================================================================
+    /** Skips over the rest of the element whose startElement event has just been read.
+
+        After this returns, the current event will be that element's endElement. No text or
+        attribute values are stored while the element's contents are being skipped.
+
+        @returns false if there was a parse error
+    */
+    bool skipElement();
+
+    /** Reads the rest of the current element and returns all the text that it contains.
+
+        This must be called when the current event is a startElement. It concatenates the
+        text of all its sub-elements (like XmlElement::getAllSubText()), and leaves the parser
+        positioned at that element's endElement event.
+    */
+    String readElementText();
+
+    //==============================================================================
+    /** Sets a flag to change the treatment of empty text elements.
+
+        If this is true (the default state), then any blocks of text that contain only
+        whitespace characters won't produce a text event.
+    */
+    void setEmptyTextElementsIgnored (bool shouldBeIgnored) noexcept;
+
+    /** Sets the length at which long blocks of text are split up.
+
+        A block of text or a CDATA section that's longer than this is delivered as a
+        series of consecutive text events, so that the parser never has to hold more than
+        this much of it in memory. Entities aren't split, so an event may end up a few
+        characters longer than this. If empty text elements are being ignored, a chunk
+        that only contains whitespace is skipped, in the same way as an empty block.
+
+        The default is 65536 characters.
+    */
+    void setMaximumTextLength (int maxNumChars) noexcept;
+
+    /** Returns the last parsing error that occurred, or an empty string if there wasn't one. */
+    const String& getLastParseError() const noexcept            { return lastError; }
+
+
+private:
+    //==============================================================================
+    enum { bufferSize = 4096 };
+
+    OptionalScopedPointer<InputStream> source;
+    HeapBlock <char> buffer;
+    int bufferPos, bufferEnd;
+    juce_wchar lookahead [16];
+    int numLookahead, maxTextLength, numTextChars;
+    bool outOfData, finished, pendingEndElement, skipping, ignoreEmptyTextElements, insideCData;
+
+    EventType currentEvent;
+    int depth;
+    String tagName, currentText, lastError;
+    StringArray attributeNames, attributeValues, openTags;
+    MemoryOutputStream scratch;
+
+    void initialise();
+    void setLastError (const String& desc, bool carryOn);
+    juce_wchar readByte();
+    juce_wchar decodeNextChar();
+    juce_wchar peekChar (int offset);
+    juce_wchar readChar();
+    bool nextCharsMatch (const char* chars);
+    void skipChars (int num);
+    void skipWhiteSpace();
+    void skipUntil (const char* terminator);
+    void skipDeclaration();
+    String readName();
+    void appendToScratch (juce_wchar c);
+    void appendTextChar (juce_wchar c);
+    void startNewText();
+    void readEntity();
+    bool readStartTag();
+    bool readEndTag();
+    bool readText();
+    bool readCData();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (XmlPullParser);
+};
+
+
+#endif   // __JUCE_XMLPULLPARSER_JUCEHEADER__
@@ -39,6 +39,7 @@
 #include "juce_data_structures.h"
 
 // START_AUTOINCLUDE values/*.cpp, undomanager/*.cpp, app_properties/*.cpp
+#include "values/juce_MappedValueTree.cpp"
 #include "values/juce_Value.cpp"
 #include "values/juce_ValueTree.cpp"
 #include "undomanager/juce_UndoManager.cpp"
@@ -32,6 +32,9 @@
 BEGIN_JUCE_NAMESPACE
 
 // START_AUTOINCLUDE values, undomanager, app_properties
+#ifndef __JUCE_MAPPEDVALUETREE_JUCEHEADER__
+ #include "values/juce_MappedValueTree.h"
+#endif
 #ifndef __JUCE_VALUE_JUCEHEADER__
  #include "values/juce_Value.h"
 #endif
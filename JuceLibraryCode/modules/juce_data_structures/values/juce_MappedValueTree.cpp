@@ -0,0 +1,767 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+BEGIN_JUCE_NAMESPACE
+
+//==============================================================================
+/*  File layout (all integers are 32-bit little-endian, and every node, value and
+    string starts on a 4-byte boundary):
+
+        header:     magic, version
+        nodes:      type name index, number of properties, number of children,
+                    then for each property: name index (low 24 bits) and value type (top 8 bits),
+                    followed by the value itself if it fits in 32 bits, or else its offset
+                    then for each child: offset of the child node
+        values:     doubles/int64s, strings (byte count + UTF-8 + terminator), or anything
+                    else as a byte count + the output of var::writeToStream()
+        strings:    each name as a byte count + UTF-8 + terminator
+        name index: offset of each name in the string block
+        trailer:    offset of the name index, number of names, offset of root node, magic
+
+    Children are always written before their parents, so a child's offset is always
+    lower than its parent's, which also stops bad data from creating loops.
+*/
+namespace MappedValueTreeFormat
+{
+    const uint32 magic = 0x4254564a; // "JVTB"
+    const uint32 version = 1;
+
+    enum
+    {
+        headerSize      = 8,
+        trailerSize     = 16,
+        nodeHeaderSize  = 12,
+        propertySize    = 8,
+        maxNumNames     = 0xffffff
+    };
+
+    enum ValueType
+    {
+        valueVoid = 0,
+        valueInt,
+        valueBoolTrue,
+        valueBoolFalse,
+        valueDouble,
+        valueString,
+        valueInt64,
+        valueOther
+    };
+
+    // A node whose children are still being added by Node::createValueTree()
+    struct PendingNode
+    {
+        PendingNode (const MappedValueTree::Node& node_, const ValueTree& tree_)
+            : node (node_), tree (tree_), nextChild (0)
+        {}
+
+        MappedValueTree::Node node;
+        ValueTree tree;
+        int nextChild;
+    };
+
+    // (values are only 4-byte aligned, so 64-bit numbers are read as two halves)
+    inline uint64 readInt64 (const uint8* const bytes) noexcept
+    {
+        return ByteOrder::littleEndianInt (bytes) | (((uint64) ByteOrder::littleEndianInt (bytes + 4)) << 32);
+    }
+}
+
+//==============================================================================
+class MappedValueTree::Writer
+{
+public:
+    Writer (OutputStream& output_)
+        : output (output_), start (output_.getPosition()), failed (false)
+    {
+    }
+
+    bool write (const ValueTree& tree)
+    {
+        using namespace MappedValueTreeFormat;
+
+        if (start < 0 || ! tree.isValid())
+            return false;
+
+        output.writeInt ((int) magic);
+        output.writeInt ((int) version);
+
+        const uint32 rootOffset = writeNode (tree);
+        const uint32 nameIndexOffset = writeNames();
+
+        output.writeInt ((int) nameIndexOffset);
+        output.writeInt (names.size());
+        output.writeInt ((int) rootOffset);
+        output.writeInt ((int) magic);
+
+        getOffset();
+        return ! failed;
+    }
+
+private:
+    OutputStream& output;
+    const int64 start;
+    bool failed;
+    StringArray names;
+    HashMap <String, int> nameIndexes;
+
+    uint32 getOffset()
+    {
+        const int64 offset = output.getPosition() - start;
+
+        if (offset > (int64) 0xffffffff)
+            failed = true;
+
+        return (uint32) offset;
+    }
+
+    void align()
+    {
+        while ((getOffset() & 3) != 0)
+            output.writeByte (0);
+    }
+
+    uint32 getNameIndex (const Identifier& name)
+    {
+        const String s (name.toString());
+
+        if (nameIndexes.contains (s))
+            return (uint32) nameIndexes [s];
+
+        if (names.size() >= MappedValueTreeFormat::maxNumNames)
+            failed = true;
+
+        nameIndexes.set (s, names.size());
+        names.add (s);
+        return (uint32) names.size() - 1;
+    }
+
+    uint32 writeNode (const ValueTree& tree)
+    {
+        using namespace MappedValueTreeFormat;
+
+        const int numChildren = tree.getNumChildren();
+        Array <uint32> childOffsets;
+        childOffsets.ensureStorageAllocated (numChildren);
+
+        int i;
+        for (i = 0; i < numChildren; ++i)
+            childOffsets.add (writeNode (tree.getChild (i)));
+
+        const int numProperties = tree.getNumProperties();
+        Array <uint32> propertyWords;
+        propertyWords.ensureStorageAllocated (numProperties * 2);
+
+        for (i = 0; i < numProperties; ++i)
+        {
+            const Identifier name (tree.getPropertyName (i));
+            writeValue (getNameIndex (name), tree.getProperty (name), propertyWords);
+        }
+
+        align();
+        const uint32 nodeOffset = getOffset();
+
+        output.writeInt ((int) getNameIndex (tree.getType()));
+        output.writeInt (numProperties);
+        output.writeInt (numChildren);
+
+        for (i = 0; i < propertyWords.size(); ++i)
+            output.writeInt ((int) propertyWords.getUnchecked (i));
+
+        for (i = 0; i < numChildren; ++i)
+            output.writeInt ((int) childOffsets.getUnchecked (i));
+
+        return nodeOffset;
+    }
+
+    void writeValue (const uint32 nameIndex, const var& v, Array <uint32>& propertyWords)
+    {
+        using namespace MappedValueTreeFormat;
+
+        // small values are stored in the property itself..
+        if (v.isVoid())
+        {
+            propertyWords.add (nameIndex | (valueVoid << 24));
+            propertyWords.add (0);
+            return;
+        }
+
+        if (v.isInt())
+        {
+            propertyWords.add (nameIndex | (valueInt << 24));
+            propertyWords.add ((uint32) (int) v);
+            return;
+        }
+
+        if (v.isBool())
+        {
+            propertyWords.add (nameIndex | (((bool) v ? valueBoolTrue : valueBoolFalse) << 24));
+            propertyWords.add (0);
+            return;
+        }
+
+        // ..and anything else goes in a block of its own
+        align();
+        const uint32 valueOffset = getOffset();
+        ValueType type;
+
+        if (v.isDouble())
+        {
+            type = valueDouble;
+            output.writeDouble ((double) v);
+        }
+        else if (v.isInt64())
+        {
+            type = valueInt64;
+            output.writeInt64 ((int64) v);
+        }
+        else if (v.isString())
+        {
+            type = valueString;
+            writeString (v.toString());
+        }
+        else
+        {
+            type = valueOther;
+
+            MemoryOutputStream mo;
+            v.writeToStream (mo);
+            output.writeInt ((int) mo.getDataSize());
+            output.write (mo.getData(), (int) mo.getDataSize());
+        }
+
+        propertyWords.add (nameIndex | ((uint32) type << 24));
+        propertyWords.add (valueOffset);
+    }
+
+    void writeString (const String& s)
+    {
+        const int numBytes = s.getNumBytesAsUTF8();
+        output.writeInt (numBytes);
+        output.write (s.toUTF8(), numBytes + 1);
+    }
+
+    uint32 writeNames()
+    {
+        Array <uint32> nameOffsets;
+        nameOffsets.ensureStorageAllocated (names.size());
+
+        int i;
+        for (i = 0; i < names.size(); ++i)
+        {
+            align();
+            nameOffsets.add (getOffset());
+            writeString (names[i]);
+        }
+
+        align();
+        const uint32 nameIndexOffset = getOffset();
+
+        for (i = 0; i < nameOffsets.size(); ++i)
+            output.writeInt ((int) nameOffsets.getUnchecked (i));
+
+        return nameIndexOffset;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Writer);
+};
+
+bool MappedValueTree::writeToStream (const ValueTree& tree, OutputStream& output)
+{
+    Writer writer (output);
+    return writer.write (tree);
+}
+
+//==============================================================================
+MappedValueTree::MappedValueTree (const File& file)
+    : mappedFile (new MemoryMappedFile (file, MemoryMappedFile::readOnly))
+{
+    openData (mappedFile->getData(), mappedFile->getSize());
+}
+
+MappedValueTree::MappedValueTree (const void* const data_, const size_t dataSize_)
+{
+    openData (data_, dataSize_);
+}
+
+MappedValueTree::~MappedValueTree()
+{
+}
+
+void MappedValueTree::openData (const void* const data_, const size_t dataSize_)
+{
+    using namespace MappedValueTreeFormat;
+
+    data = static_cast <const uint8*> (data_);
+    dataSize = dataSize_;
+    rootOffset = 0;
+
+    if (data != nullptr
+         && dataSize >= headerSize + trailerSize
+         && readUInt (0) == magic
+         && readUInt (4) == version
+         && readUInt (dataSize - 4) == magic)
+    {
+        const uint32 nameIndexOffset = readUInt (dataSize - trailerSize);
+        const uint32 numNames = readUInt (dataSize - trailerSize + 4);
+        rootOffset = readUInt (dataSize - trailerSize + 8);
+
+        if (getBytes (nameIndexOffset, numNames * (uint64) 4) != nullptr)
+        {
+            names.ensureStorageAllocated ((int) numNames);
+
+            for (uint32 i = 0; i < numNames; ++i)
+            {
+                const uint32 nameOffset = readUInt (nameIndexOffset + i * (uint64) 4);
+                const uint32 numBytes = readUInt (nameOffset);
+                const char* const name = reinterpret_cast <const char*> (getBytes (nameOffset + (uint64) 4, numBytes));
+
+                if (name == nullptr || numBytes == 0)
+                    break;
+
+                const String nameString (CharPointer_UTF8 (name), CharPointer_UTF8 (name + numBytes));
+
+                if (nameString.isEmpty() || ! Identifier::isValidIdentifier (nameString))
+                    break;
+
+                names.add (Identifier (nameString));
+            }
+
+            if (names.size() == (int) numNames && getRoot().isValid())
+                return;
+        }
+    }
+
+    jassert (data == nullptr); // trying to read corrupted data!
+
+    data = nullptr;
+    dataSize = 0;
+    names.clear();
+}
+
+const uint8* MappedValueTree::getBytes (const uint64 offset, const uint64 numBytes) const noexcept
+{
+    return (data != nullptr && offset + numBytes <= dataSize) ? data + offset : nullptr;
+}
+
+uint32 MappedValueTree::readUInt (const uint64 offset) const noexcept
+{
+    const uint8* const bytes = getBytes (offset, 4);
+    return bytes != nullptr ? ByteOrder::littleEndianInt (bytes) : 0;
+}
+
+Identifier MappedValueTree::getName (const uint32 index) const
+{
+    return index < (uint32) names.size() ? names.getReference ((int) index) : Identifier();
+}
+
+Identifier MappedValueTree::getPropertyName (const uint64 propertyOffset) const
+{
+    return getName (readUInt (propertyOffset) & MappedValueTreeFormat::maxNumNames);
+}
+
+var MappedValueTree::readValue (const uint64 propertyOffset) const
+{
+    using namespace MappedValueTreeFormat;
+
+    const uint32 valueOrOffset = readUInt (propertyOffset + 4);
+
+    switch (readUInt (propertyOffset) >> 24)
+    {
+        case valueInt:          return var ((int) valueOrOffset);
+        case valueBoolTrue:     return var (true);
+        case valueBoolFalse:    return var (false);
+
+        case valueDouble:
+        {
+            const uint8* const bytes = getBytes (valueOrOffset, 8);
+
+            if (bytes != nullptr)
+            {
+                union { int64 asInt; double asDouble; } n;
+                n.asInt = (int64) readInt64 (bytes);
+                return var (n.asDouble);
+            }
+
+            break;
+        }
+
+        case valueInt64:
+        {
+            const uint8* const bytes = getBytes (valueOrOffset, 8);
+
+            if (bytes != nullptr)
+                return var ((int64) readInt64 (bytes));
+
+            break;
+        }
+
+        case valueString:
+        {
+            const uint32 numBytes = readUInt (valueOrOffset);
+            const char* const text = reinterpret_cast <const char*> (getBytes (valueOrOffset + (uint64) 4, numBytes));
+
+            if (text != nullptr)
+                return var (String (CharPointer_UTF8 (text), CharPointer_UTF8 (text + numBytes)));
+
+            break;
+        }
+
+        case valueOther:
+        {
+            const uint32 numBytes = readUInt (valueOrOffset);
+            const uint8* const bytes = getBytes (valueOrOffset + (uint64) 4, numBytes);
+
+            if (bytes != nullptr)
+            {
+                MemoryInputStream in (bytes, numBytes, false);
+                return var::readFromStream (in);
+            }
+
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return var::null;
+}
+
+MappedValueTree::Node MappedValueTree::getRoot() const noexcept
+{
+    return data != nullptr ? Node (this, rootOffset) : Node();
+}
+
+ValueTree MappedValueTree::createValueTree() const
+{
+    return getRoot().createValueTree();
+}
+
+//==============================================================================
+MappedValueTree::Node::Node() noexcept
+    : owner (nullptr), offset (0)
+{
+}
+
+MappedValueTree::Node::Node (const MappedValueTree* const owner_, const uint32 offset_) noexcept
+    : owner (owner_), offset (offset_)
+{
+}
+
+MappedValueTree::Node::Node (const Node& other) noexcept
+    : owner (other.owner), offset (other.offset)
+{
+}
+
+MappedValueTree::Node& MappedValueTree::Node::operator= (const Node& other) noexcept
+{
+    owner = other.owner;
+    offset = other.offset;
+    return *this;
+}
+
+bool MappedValueTree::Node::isValid() const noexcept
+{
+    using namespace MappedValueTreeFormat;
+
+    if (owner == nullptr || owner->getBytes (offset, nodeHeaderSize) == nullptr)
+        return false;
+
+    const uint64 numProperties = owner->readUInt (offset + (uint64) 4);
+    const uint64 numChildren   = owner->readUInt (offset + (uint64) 8);
+
+    return owner->getBytes (offset, nodeHeaderSize + numProperties * propertySize + numChildren * 4) != nullptr;
+}
+
+Identifier MappedValueTree::Node::getType() const
+{
+    return isValid() ? owner->getName (owner->readUInt (offset)) : Identifier();
+}
+
+bool MappedValueTree::Node::hasType (const Identifier& typeName) const noexcept
+{
+    return isValid() && owner->getName (owner->readUInt (offset)) == typeName;
+}
+
+int MappedValueTree::Node::getNumProperties() const noexcept
+{
+    return isValid() ? (int) owner->readUInt (offset + (uint64) 4) : 0;
+}
+
+Identifier MappedValueTree::Node::getPropertyName (const int index) const
+{
+    using namespace MappedValueTreeFormat;
+
+    if (isPositiveAndBelow (index, getNumProperties()))
+        return owner->getPropertyName (offset + (uint64) nodeHeaderSize + index * (uint64) propertySize);
+
+    return Identifier();
+}
+
+int MappedValueTree::Node::indexOfProperty (const Identifier& name) const noexcept
+{
+    using namespace MappedValueTreeFormat;
+
+    const int numProperties = getNumProperties();
+
+    for (int i = 0; i < numProperties; ++i)
+        if (owner->getPropertyName (offset + (uint64) nodeHeaderSize + i * (uint64) propertySize) == name)
+            return i;
+
+    return -1;
+}
+
+var MappedValueTree::Node::getProperty (const Identifier& name) const
+{
+    return getProperty (name, var::null);
+}
+
+var MappedValueTree::Node::getProperty (const Identifier& name, const var& defaultReturnValue) const
+{
+    using namespace MappedValueTreeFormat;
+
+    const int index = indexOfProperty (name);
+
+    return index >= 0 ? owner->readValue (offset + (uint64) nodeHeaderSize + index * (uint64) propertySize)
+                      : defaultReturnValue;
+}
+
+bool MappedValueTree::Node::hasProperty (const Identifier& name) const noexcept
+{
+    return indexOfProperty (name) >= 0;
+}
+
+int MappedValueTree::Node::getNumChildren() const noexcept
+{
+    return isValid() ? (int) owner->readUInt (offset + (uint64) 8) : 0;
+}
+
+MappedValueTree::Node MappedValueTree::Node::getChild (const int index) const noexcept
+{
+    using namespace MappedValueTreeFormat;
+
+    if (isPositiveAndBelow (index, getNumChildren()))
+    {
+        const uint64 numProperties = owner->readUInt (offset + (uint64) 4);
+        const uint32 childOffset = owner->readUInt (offset + nodeHeaderSize + numProperties * propertySize + index * (uint64) 4);
+
+        if (childOffset < offset)
+            return Node (owner, childOffset);
+    }
+
+    return Node();
+}
+
+MappedValueTree::Node MappedValueTree::Node::getChildWithName (const Identifier& type) const noexcept
+{
+    const int numChildren = getNumChildren();
+
+    for (int i = 0; i < numChildren; ++i)
+    {
+        const Node child (getChild (i));
+
+        if (child.hasType (type))
+            return child;
+    }
+
+    return Node();
+}
+
+ValueTree MappedValueTree::Node::createValueTree() const
+{
+    // A valid file can't contain more nodes than this, so if bad data makes children
+    // share their nodes, this stops it from creating an enormous tree.
+    size_t maxNumNodes = owner != nullptr ? owner->dataSize / MappedValueTreeFormat::nodeHeaderSize : 0;
+
+    const ValueTree root (createValueTreeWithoutChildren (maxNumNodes));
+
+    if (! root.isValid())
+        return root;
+
+    // The nodes are visited using a stack of the ones whose children are still being
+    // added, rather than by recursion, so that a very deep tree can't overflow the stack.
+    using MappedValueTreeFormat::PendingNode;
+    Array <PendingNode> stack;
+    stack.add (PendingNode (*this, root));
+
+    while (stack.size() > 0)
+    {
+        PendingNode& pending = stack.getReference (stack.size() - 1);
+
+        if (pending.nextChild >= pending.node.getNumChildren())
+        {
+            stack.removeLast();
+            continue;
+        }
+
+        const Node child (pending.node.getChild (pending.nextChild++));
+        ValueTree childTree (child.createValueTreeWithoutChildren (maxNumNodes));
+
+        if (childTree.isValid())
+        {
+            pending.tree.addChild (childTree, -1, nullptr);
+            stack.add (PendingNode (child, childTree));
+        }
+    }
+
+    return root;
+}
+
+ValueTree MappedValueTree::Node::createValueTreeWithoutChildren (size_t& maxNumNodes) const
+{
+    using namespace MappedValueTreeFormat;
+
+    const Identifier type (getType());
+
+    if (maxNumNodes == 0 || type == Identifier())
+        return ValueTree::invalid;
+
+    --maxNumNodes;
+    ValueTree v (type);
+
+    const int numProperties = getNumProperties();
+
+    for (int i = 0; i < numProperties; ++i)
+    {
+        const uint64 propertyOffset = offset + (uint64) nodeHeaderSize + i * (uint64) propertySize;
+        const Identifier name (owner->getPropertyName (propertyOffset));
+
+        if (name != Identifier())
+            v.setProperty (name, owner->readValue (propertyOffset), nullptr);
+    }
+
+    return v;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MappedValueTreeTests  : public UnitTest
+{
+public:
+    MappedValueTreeTests() : UnitTest ("MappedValueTree") {}
+
+    static var createRandomValue (Random& r)
+    {
+        switch (r.nextInt (8))
+        {
+            case 0:     return var ((int) r.nextInt());
+            case 1:     return var (r.nextBool());
+            case 2:     return var (r.nextDouble() * 1000.0);
+            case 3:     return var ((int64) r.nextInt64());
+            case 4:     return var (String::repeatedString (CharPointer_UTF8 ("abc\xc3\xa9"), r.nextInt (5)));
+
+            case 5:
+            {
+                Array<var> array;
+                array.add (r.nextInt (100));
+                array.add ("x");
+                return var (array);
+            }
+
+            default:    return var::null;
+        }
+    }
+
+    static ValueTree createRandomTree (Random& r, const int depth)
+    {
+        ValueTree v ("n" + String (r.nextInt (5)));
+
+        for (int i = r.nextInt (6); --i >= 0;)
+            v.setProperty ("p" + String (r.nextInt (20)), createRandomValue (r), nullptr);
+
+        if (depth > 0)
+            for (int i = r.nextInt (5); --i >= 0;)
+                v.addChild (createRandomTree (r, depth - 1), -1, nullptr);
+
+        return v;
+    }
+
+    void expectRoundTrip (const ValueTree& tree)
+    {
+        MemoryOutputStream out;
+        expect (MappedValueTree::writeToStream (tree, out));
+
+        MappedValueTree mapped (out.getData(), out.getDataSize());
+        expect (mapped.isValid());
+        expect (mapped.createValueTree().isEquivalentTo (tree));
+    }
+
+    void runTest()
+    {
+        Random r (2468);
+
+        beginTest ("Round trip");
+
+        for (int i = 0; i < 20; ++i)
+            expectRoundTrip (createRandomTree (r, 4));
+
+        {
+            ValueTree deepTree ("root");
+            ValueTree node (deepTree);
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                ValueTree child ("child");
+                child.setProperty ("depth", i, nullptr);
+                node.addChild (child, -1, nullptr);
+                node = child;
+            }
+
+            expectRoundTrip (deepTree);
+        }
+
+        beginTest ("Truncated and corrupted data");
+
+        MemoryOutputStream out;
+        expect (MappedValueTree::writeToStream (createRandomTree (r, 4), out));
+        const MemoryBlock original (out.getData(), out.getDataSize());
+
+        for (int i = 0; i < 20; ++i)
+        {
+            MappedValueTree mapped (original.getData(), (size_t) r.nextInt ((int) original.getSize()));
+            expect (! mapped.isValid());
+            expect (! mapped.createValueTree().isValid());
+        }
+
+        for (int i = 0; i < 200; ++i)
+        {
+            MemoryBlock corrupted (original);
+
+            for (int j = 1 + r.nextInt (8); --j >= 0;)
+                corrupted [r.nextInt ((int) corrupted.getSize())] = (char) r.nextInt (256);
+
+            // this mustn't crash or hang, whatever it decides the data contains
+            MappedValueTree mapped (corrupted.getData(), corrupted.getSize());
+            mapped.createValueTree();
+        }
+    }
+};
+
+static MappedValueTreeTests mappedValueTreeUnitTests;
+
+#endif
+
+END_JUCE_NAMESPACE
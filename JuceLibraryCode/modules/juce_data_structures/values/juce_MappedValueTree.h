@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_MAPPEDVALUETREE_JUCEHEADER__
+#define __JUCE_MAPPEDVALUETREE_JUCEHEADER__
+
+#include "juce_ValueTree.h"
+
+
+//==============================================================================
+/**
+    Gives read-only access to a ValueTree that was saved in a compact binary format,
+    without having to load the whole thing.
+
+    The format written by writeToStream() stores each node at a fixed offset, with its
+    property values in typed blocks and all the type and property names in a single
+    string table, so a MappedValueTree can open a file by memory-mapping it, and then
+    only touch the parts of it that are actually visited. Opening even a very large
+    file is quick, and costs very little memory.
+
+    Nodes are accessed via lightweight Node objects. When you need a real ValueTree
+    (e.g. to edit part of the data), use Node::createValueTree() to build one for
+    just that sub-tree.
+
+    @code
+    MappedValueTree archive (File ("~/project.bin"));
+
+    MappedValueTree::Node tracks (archive.getRoot().getChildWithName ("TRACKS"));
+
+    for (int i = 0; i < tracks.getNumChildren(); ++i)
+        DBG (tracks.getChild (i).getProperty ("name").toString());
+    @endcode
+
+    @see MappedValueTree::writeToStream
+*/
+class JUCE_API  MappedValueTree
+{
+public:
+    //==============================================================================
+    /** Memory-maps a file that was written with writeToStream().
+        If the file can't be opened or doesn't contain valid data, isValid() will return false.
+    */
+    explicit MappedValueTree (const File& file);
+
+    /** Uses a block of data that was written with writeToStream().
+        The data isn't copied, so it must not be changed or deleted while this object
+        or any of its Nodes are still in use.
+    */
+    MappedValueTree (const void* data, size_t dataSize);
+
+    /** Destructor. */
+    ~MappedValueTree();
+
+    //==============================================================================
+    /** Returns true if the data was opened successfully. */
+    bool isValid() const noexcept                   { return data != nullptr; }
+
+    //==============================================================================
+    /**
+        Refers to one of the nodes in a MappedValueTree.
+
+        This is just a small handle, so it can be passed around by value. Its methods
+        mirror the read-only methods of ValueTree. A Node must not be used after the
+        MappedValueTree that it came from has been deleted.
+    */
+    class JUCE_API  Node
+    {
+    public:
+        /** Creates an invalid node. */
+        Node() noexcept;
+
+        Node (const Node& other) noexcept;
+        Node& operator= (const Node& other) noexcept;
+
+        /** Returns true if this refers to a node, or false if it's invalid. */
+        bool isValid() const noexcept;
+
+        /** Returns the node's type, or a null Identifier if the node is invalid. */
+        Identifier getType() const;
+
+        /** Returns true if the node has this type. */
+        bool hasType (const Identifier& typeName) const noexcept;
+
+        /** Returns the number of properties that the node has. */
+        int getNumProperties() const noexcept;
+
+        /** Returns the name of one of the node's properties. */
+        Identifier getPropertyName (int index) const;
+
+        /** Returns the value of a named property, or a void var if there's no such property. */
+        var getProperty (const Identifier& name) const;
+
+        /** Returns the value of a named property, or a default value if there's no such property. */
+        var getProperty (const Identifier& name, const var& defaultReturnValue) const;
+
+        /** Returns true if the node has a property with this name. */
+        bool hasProperty (const Identifier& name) const noexcept;
+
+        /** Returns the number of children that the node has. */
+        int getNumChildren() const noexcept;
+
+        /** Returns one of the node's children, or an invalid node if the index is out of range. */
+        Node getChild (int index) const noexcept;
+
+        /** Returns the first child with the given type, or an invalid node if there isn't one. */
+        Node getChildWithName (const Identifier& type) const noexcept;
+
+        /** Builds a ValueTree containing this node and all its children. */
+        ValueTree createValueTree() const;
+
+    private:
+        friend class MappedValueTree;
+        const MappedValueTree* owner;
+        uint32 offset;
+
+        Node (const MappedValueTree* owner, uint32 offset) noexcept;
+        int indexOfProperty (const Identifier& name) const noexcept;
+        ValueTree createValueTreeWithoutChildren (size_t& maxNumNodes) const;
+    };
+
+    /** Returns the root node, or an invalid node if the data couldn't be opened. */
+    Node getRoot() const noexcept;
+
+    /** Builds a ValueTree containing the whole tree.
+        This is equivalent to getRoot().createValueTree(), so loses the advantages of
+        using a MappedValueTree - only use it if you really do need all of the data.
+    */
+    ValueTree createValueTree() const;
+
+    //==============================================================================
+    /** Writes a tree to a stream in the format that a MappedValueTree can open.
+
+        The stream must support getPosition(), and the data written can't be larger
+        than 4GB.
+
+        @returns true if the tree was written successfully
+    */
+    static bool writeToStream (const ValueTree& tree, OutputStream& output);
+
+private:
+    //==============================================================================
+    ScopedPointer <MemoryMappedFile> mappedFile;
+    const uint8* data;
+    size_t dataSize;
+    uint32 rootOffset;
+    Array <Identifier> names;
+
+    class Writer;
+
+    void openData (const void* data, size_t dataSize);
+    const uint8* getBytes (uint64 offset, uint64 numBytes) const noexcept;
+    uint32 readUInt (uint64 offset) const noexcept;
+    var readValue (uint64 propertyOffset) const;
+    Identifier getName (uint32 index) const;
+    Identifier getPropertyName (uint64 propertyOffset) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MappedValueTree);
+};
+
+
+#endif   // __JUCE_MAPPEDVALUETREE_JUCEHEADER__
@@ -191,19 +191,270 @@ private:
 };
 
 
+//==============================================================================
+class ValueTree::ScopedChangeBatch::PendingChanges  : public CallbackMessage
+{
+public:
+    PendingChanges() {}
+
+    //==============================================================================
+    void addPropertyChange (SharedObject* const target, const Identifier& property)
+    {
+        const ChangeKey key (target, ((String::CharPointerType) property).getAddress(), propertyChanged);
+
+        if (! index.contains (key))
+            addChange (key, target, nullptr, property);
+    }
+
+    void addChildAdded (SharedObject* const parent, SharedObject* const child)
+    {
+        addChange (ChangeKey (parent, child, childAdded), parent, child, Identifier());
+    }
+
+    void addChildRemoved (SharedObject* const parent, SharedObject* const child)
+    {
+        const ChangeKey addedKey (parent, child, childAdded);
+
+        if (index.contains (addedKey))
+        {
+            // it was added during this batch, so nobody needs to hear about it
+            changes.getReference (index [addedKey]).type = cancelled;
+            index.remove (addedKey);
+        }
+        else
+        {
+            addChange (ChangeKey (parent, child, childRemoved), parent, child, Identifier());
+        }
+    }
+
+    void addChildOrderChange (SharedObject* const parent)
+    {
+        const ChangeKey key (parent, nullptr, childOrderChanged);
+
+        if (! index.contains (key))
+            addChange (key, parent, nullptr, Identifier());
+    }
+
+    void addParentChange (SharedObject* const target)
+    {
+        const ChangeKey key (target, nullptr, parentChanged);
+
+        if (! index.contains (key))
+            addChange (key, target, nullptr, Identifier());
+    }
+
+    //==============================================================================
+    bool isEmpty() const noexcept       { return changes.size() == 0; }
+
+    void deliver()
+    {
+        for (int i = 0; i < changes.size(); ++i)
+        {
+            const Change& c = changes.getReference (i);
+
+            switch (c.type)
+            {
+                case propertyChanged:       c.target->sendPropertyChangeMessage (c.property); break;
+                case childAdded:            c.target->sendChildAddedMessage (ValueTree (c.child)); break;
+                case childRemoved:          c.target->sendChildRemovedMessage (ValueTree (c.child)); break;
+                case childOrderChanged:     c.target->sendChildOrderChangedMessage(); break;
+
+                case parentChanged:
+                    // a parent change message goes to the whole sub-tree, so if one of this
+                    // node's parents is getting one too, there's no need to send another
+                    if (! hasParentChangeAbove (c.target))
+                        c.target->sendParentChangeMessage();
+
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    void messageCallback()
+    {
+        deliver();
+    }
+
+private:
+    //==============================================================================
+    enum ChangeType
+    {
+        propertyChanged,
+        childAdded,
+        childRemoved,
+        childOrderChanged,
+        parentChanged,
+        cancelled
+    };
+
+    struct Change
+    {
+        SharedObjectPtr target, child;
+        Identifier property;
+        ChangeType type;
+    };
+
+    struct ChangeKey
+    {
+        ChangeKey (const void* const object_, const void* const detail_, const ChangeType type_) noexcept
+            : object (object_), detail (detail_), type (type_)
+        {}
+
+        bool operator== (const ChangeKey& other) const noexcept
+        {
+            return object == other.object && detail == other.detail && type == other.type;
+        }
+
+        const void* object;
+        const void* detail;
+        ChangeType type;
+    };
+
+    struct ChangeKeyHash
+    {
+        static int generateHash (const ChangeKey& key, const int upperLimit) noexcept
+        {
+            const pointer_sized_uint h = (((pointer_sized_uint) key.object) >> 3) * 31
+                                           + (((pointer_sized_uint) key.detail) >> 3) * 7
+                                           + (pointer_sized_uint) key.type;
+
+            return (int) (h % (pointer_sized_uint) upperLimit);
+        }
+    };
+
+    Array <Change> changes;
+    HashMap <ChangeKey, int, ChangeKeyHash> index;
+
+    void addChange (const ChangeKey& key, SharedObject* const target, SharedObject* const child,
+                    const Identifier& property)
+    {
+        index.set (key, changes.size());
+
+        Change c;
+        c.target = target;
+        c.child = child;
+        c.property = property;
+        c.type = key.type;
+        changes.add (c);
+    }
+
+    bool hasParentChangeAbove (const SharedObject* const target) const
+    {
+        for (const SharedObject* p = target->parent; p != nullptr; p = p->parent)
+            if (index.contains (ChangeKey (p, nullptr, parentChanged)))
+                return true;
+
+        return false;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (PendingChanges);
+};
+
+ValueTree::ScopedChangeBatch::ScopedChangeBatch (const bool deliverAsynchronously_)
+    : deliverAsynchronously (deliverAsynchronously_)
+{
+    PendingChanges*& currentChanges = getCurrentChanges();
+
+    if (currentChanges == nullptr)
+    {
+        changes = new PendingChanges();
+        currentChanges = changes;
+    }
+}
+
+ValueTree::ScopedChangeBatch::~ScopedChangeBatch()
+{
+    if (changes != nullptr)
+    {
+        getCurrentChanges() = nullptr;
+
+        if (changes->isEmpty())
+            return;
+
+        if (deliverAsynchronously)
+        {
+            MessageManager::getInstance();
+            changes.release()->post();
+        }
+        else
+        {
+            changes->deliver();
+        }
+    }
+}
+
+ValueTree::ScopedChangeBatch::PendingChanges*& ValueTree::ScopedChangeBatch::getCurrentChanges() noexcept
+{
+    // each thread has its own outermost batch
+    static juce_ThreadLocal PendingChanges* currentChanges = nullptr;
+    return currentChanges;
+}
+
+
+//==============================================================================
+/*  Maps each child type to the index of the first child of that type, so that
+    getChildWithName() doesn't have to scan nodes with lots of children. It's built
+    on demand, and thrown away whenever the list of children changes.
+
+    Because it's built by const methods, more than one thread may be reading the tree
+    when it's needed, so building it and looking things up in it is done while holding
+    the node's childTypeIndexLock. (Changing the list of children while another thread
+    reads it isn't safe anyway, so childrenChanged() doesn't need the lock).
+*/
+class ValueTree::SharedObject::ChildTypeIndex
+{
+public:
+    ChildTypeIndex (const ReferenceCountedArray <SharedObject>& children)
+    {
+        // (going backwards so that the first child of each type is the one left in the map)
+        for (int i = children.size(); --i >= 0;)
+            firstChildOfType.set (getKey (children.getUnchecked(i)->type), i + 1);
+    }
+
+    int getIndexOfFirst (const Identifier& type) const
+    {
+        return firstChildOfType [getKey (type)] - 1;
+    }
+
+    enum { minimumNumChildren = 16 };
+
+private:
+    struct PointerHash
+    {
+        static int generateHash (const pointer_sized_uint key, const int upperLimit) noexcept
+        {
+            return (int) (((uint32) (key >> 3) * 2654435761u) % (uint32) upperLimit);
+        }
+    };
+
+    HashMap <pointer_sized_uint, int, PointerHash> firstChildOfType;
+
+    // Identifiers are pooled, so the string pointer is unique to each name
+    static pointer_sized_uint getKey (const Identifier& type) noexcept
+    {
+        return (pointer_sized_uint) ((String::CharPointerType) type).getAddress();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ChildTypeIndex);
+};
+
 //==============================================================================
 ValueTree::SharedObject::SharedObject (const Identifier& type_)
-    : type (type_), parent (nullptr)
+    : type (type_), parent (nullptr), indexInParent (-1)
 {
 }
 
 ValueTree::SharedObject::SharedObject (const SharedObject& other)
-    : type (other.type), properties (other.properties), parent (nullptr)
+    : type (other.type), properties (other.properties), parent (nullptr), indexInParent (-1)
 {
     for (int i = 0; i < other.children.size(); ++i)
     {
         SharedObject* const child = new SharedObject (*other.children.getUnchecked(i));
         child->parent = this;
+        child->indexInParent = i;
         children.add (child);
     }
 }
@@ -216,6 +467,7 @@ ValueTree::SharedObject::~SharedObject()
     {
         const SharedObjectPtr c (children.getUnchecked(i));
         c->parent = nullptr;
+        c->indexInParent = -1;
         children.remove (i);
         c->sendParentChangeMessage();
     }
@@ -234,6 +486,17 @@ void ValueTree::SharedObject::sendPropertyChangeMessage (ValueTree& tree, const
 
 void ValueTree::SharedObject::sendPropertyChangeMessage (const Identifier& property)
 {
+    if (! hasListenersInParentChain())
+        return;
+
+    ScopedChangeBatch::PendingChanges* const batch = ScopedChangeBatch::getCurrentChanges();
+
+    if (batch != nullptr)
+    {
+        batch->addPropertyChange (this, property);
+        return;
+    }
+
     ValueTree tree (this);
 
     for (ValueTree::SharedObject* t = this; t != nullptr; t = t->parent)
@@ -252,6 +515,17 @@ void ValueTree::SharedObject::sendChildAddedMessage (ValueTree& tree, ValueTree&
 
 void ValueTree::SharedObject::sendChildAddedMessage (ValueTree child)
 {
+    if (! hasListenersInParentChain())
+        return;
+
+    ScopedChangeBatch::PendingChanges* const batch = ScopedChangeBatch::getCurrentChanges();
+
+    if (batch != nullptr)
+    {
+        batch->addChildAdded (this, child.object);
+        return;
+    }
+
     ValueTree tree (this);
 
     for (ValueTree::SharedObject* t = this; t != nullptr; t = t->parent)
@@ -270,6 +544,17 @@ void ValueTree::SharedObject::sendChildRemovedMessage (ValueTree& tree, ValueTre
 
 void ValueTree::SharedObject::sendChildRemovedMessage (ValueTree child)
 {
+    if (! hasListenersInParentChain())
+        return;
+
+    ScopedChangeBatch::PendingChanges* const batch = ScopedChangeBatch::getCurrentChanges();
+
+    if (batch != nullptr)
+    {
+        batch->addChildRemoved (this, child.object);
+        return;
+    }
+
     ValueTree tree (this);
 
     for (ValueTree::SharedObject* t = this; t != nullptr; t = t->parent)
@@ -288,6 +573,17 @@ void ValueTree::SharedObject::sendChildOrderChangedMessage (ValueTree& tree)
 
 void ValueTree::SharedObject::sendChildOrderChangedMessage()
 {
+    if (! hasListenersInParentChain())
+        return;
+
+    ScopedChangeBatch::PendingChanges* const batch = ScopedChangeBatch::getCurrentChanges();
+
+    if (batch != nullptr)
+    {
+        batch->addChildOrderChange (this);
+        return;
+    }
+
     ValueTree tree (this);
 
     for (ValueTree::SharedObject* t = this; t != nullptr; t = t->parent)
@@ -296,6 +592,14 @@ void ValueTree::SharedObject::sendChildOrderChangedMessage()
 
 void ValueTree::SharedObject::sendParentChangeMessage()
 {
+    ScopedChangeBatch::PendingChanges* const batch = ScopedChangeBatch::getCurrentChanges();
+
+    if (batch != nullptr)
+    {
+        batch->addParentChange (this);
+        return;
+    }
+
     ValueTree tree (this);
 
     int i;
@@ -314,6 +618,15 @@ void ValueTree::SharedObject::sendParentChangeMessage()
     }
 }
 
+bool ValueTree::SharedObject::hasListenersInParentChain() const noexcept
+{
+    for (const SharedObject* t = this; t != nullptr; t = t->parent)
+        if (t->valueTreesWithListeners.size() > 0)
+            return true;
+
+    return false;
+}
+
 //==============================================================================
 const var& ValueTree::SharedObject::getProperty (const Identifier& name) const
 {
@@ -385,20 +698,45 @@ void ValueTree::SharedObject::removeAllProperties (UndoManager* const undoManage
     }
 }
 
-ValueTree ValueTree::SharedObject::getChildWithName (const Identifier& typeToMatch) const
+int ValueTree::SharedObject::getIndexOfFirstChildOfType (const Identifier& typeToMatch) const
 {
+    if (children.size() >= ChildTypeIndex::minimumNumChildren)
+    {
+        const SpinLock::ScopedLockType sl (childTypeIndexLock);
+
+        if (childTypeIndex == nullptr)
+            childTypeIndex = new ChildTypeIndex (children);
+
+        return childTypeIndex->getIndexOfFirst (typeToMatch);
+    }
+
     for (int i = 0; i < children.size(); ++i)
         if (children.getUnchecked(i)->type == typeToMatch)
-            return ValueTree (children.getUnchecked(i).getObject());
+            return i;
 
-    return ValueTree::invalid;
+    return -1;
+}
+
+void ValueTree::SharedObject::childrenChanged (const int firstChangedIndex, const int endIndex) noexcept
+{
+    childTypeIndex = nullptr;
+
+    for (int i = jmax (0, firstChangedIndex); i < jmin (endIndex, children.size()); ++i)
+        children.getUnchecked(i)->indexInParent = i;
+}
+
+ValueTree ValueTree::SharedObject::getChildWithName (const Identifier& typeToMatch) const
+{
+    const int index = getIndexOfFirstChildOfType (typeToMatch);
+    return index >= 0 ? ValueTree (children.getUnchecked (index).getObject()) : ValueTree::invalid;
 }
 
 ValueTree ValueTree::SharedObject::getOrCreateChildWithName (const Identifier& typeToMatch, UndoManager* undoManager)
 {
-    for (int i = 0; i < children.size(); ++i)
-        if (children.getUnchecked(i)->type == typeToMatch)
-            return ValueTree (children.getUnchecked(i).getObject());
+    const int index = getIndexOfFirstChildOfType (typeToMatch);
+
+    if (index >= 0)
+        return ValueTree (children.getUnchecked (index).getObject());
 
     SharedObject* const newObject = new SharedObject (typeToMatch);
     addChild (newObject, -1, undoManager);
@@ -432,7 +770,16 @@ bool ValueTree::SharedObject::isAChildOf (const SharedObject* const possiblePare
 
 int ValueTree::SharedObject::indexOf (const ValueTree& child) const
 {
-    return children.indexOf (child.object);
+    return indexOf (child.object.getObject());
+}
+
+int ValueTree::SharedObject::indexOf (const SharedObject* const child) const noexcept
+{
+    if (child == nullptr || child->parent != this)
+        return -1;
+
+    jassert (children [child->indexInParent] == child);
+    return child->indexInParent;
 }
 
 void ValueTree::SharedObject::addChild (SharedObject* child, int index, UndoManager* const undoManager)
@@ -448,13 +795,14 @@ void ValueTree::SharedObject::addChild (SharedObject* child, int index, UndoMana
 
             if (child->parent != nullptr)
             {
-                jassert (child->parent->children.indexOf (child) >= 0);
-                child->parent->removeChild (child->parent->children.indexOf (child), undoManager);
+                jassert (child->parent->indexOf (child) >= 0);
+                child->parent->removeChild (child->parent->indexOf (child), undoManager);
             }
 
             if (undoManager == nullptr)
             {
                 children.insert (index, child);
+                childrenChanged (isPositiveAndBelow (index, children.size()) ? index : children.size() - 1, children.size());
                 child->parent = this;
                 sendChildAddedMessage (ValueTree (child));
                 child->sendParentChangeMessage();
@@ -485,7 +833,9 @@ void ValueTree::SharedObject::removeChild (const int childIndex, UndoManager* co
         if (undoManager == nullptr)
         {
             children.remove (childIndex);
+            childrenChanged (childIndex, children.size());
             child->parent = nullptr;
+            child->indexInParent = -1;
             sendChildRemovedMessage (ValueTree (child));
             child->sendParentChangeMessage();
         }
@@ -513,6 +863,9 @@ void ValueTree::SharedObject::moveChild (int currentIndex, int newIndex, UndoMan
         if (undoManager == nullptr)
         {
             children.move (currentIndex, newIndex);
+            childrenChanged (jmin (currentIndex, newIndex),
+                             isPositiveAndBelow (newIndex, children.size()) ? jmax (currentIndex, newIndex) + 1
+                                                                            : children.size());
             sendChildOrderChangedMessage();
         }
         else
@@ -532,6 +885,7 @@ void ValueTree::SharedObject::reorderChildren (const ReferenceCountedArray <Shar
     if (undoManager == nullptr)
     {
         children = newOrder;
+        childrenChanged (0, children.size());
         sendChildOrderChangedMessage();
     }
     else
@@ -825,7 +1179,7 @@ void ValueTree::removeChild (const int childIndex, UndoManager* const undoManage
 void ValueTree::removeChild (const ValueTree& child, UndoManager* const undoManager)
 {
     if (object != nullptr)
-        object->removeChild (object->children.indexOf (child.object), undoManager);
+        object->removeChild (object->indexOf (child.object.getObject()), undoManager);
 }
 
 void ValueTree::removeAllChildren (UndoManager* const undoManager)
@@ -911,14 +1265,68 @@ void ValueTree::writeToStream (OutputStream& output)
         getChild (i).writeToStream (output);
 }
 
+class ValueTree::ArenaSharedObject  : public ValueTree::SharedObject
+{
+public:
+    explicit ArenaSharedObject (const Identifier& type_)
+        : SharedObject (type_)
+    {
+    }
+
+    static void* operator new (size_t size, ObjectArena& arena)   { return arena.allocateObject (size); }
+    static void operator delete (void* p, ObjectArena&) noexcept  { ObjectArena::releaseObject (p); }
+    static void operator delete (void* p) noexcept               { ObjectArena::releaseObject (p); }
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (ArenaSharedObject);
+};
+
+namespace ValueTreeStreamHelpers
+{
+    Identifier readName (InputStream& input, ObjectArena* const arena)
+    {
+        if (arena == nullptr)
+        {
+            const String name (input.readString());
+            return name.isEmpty() ? Identifier() : Identifier (name);
+        }
+
+        char buffer [128];
+        int i = 0;
+
+        while ((buffer[i] = input.readByte()) != 0)
+        {
+            if (++i >= numElementsInArray (buffer))
+            {
+                // (names this long are rare enough that they're not worth pooling efficiently)
+                const String longName (String::fromUTF8 (buffer, i) + input.readString());
+                return arena->getPooledIdentifier (longName.getCharPointer());
+            }
+        }
+
+        return arena->getPooledIdentifier (CharPointer_UTF8 (buffer));
+    }
+}
+
 ValueTree ValueTree::readFromStream (InputStream& input)
 {
-    const String type (input.readString());
+    return readFromStream (input, static_cast <ObjectArena*> (nullptr));
+}
 
-    if (type.isEmpty())
+ValueTree ValueTree::readFromStream (InputStream& input, ObjectArena& arena)
+{
+    return readFromStream (input, &arena);
+}
+
+ValueTree ValueTree::readFromStream (InputStream& input, ObjectArena* const arena)
+{
+    const Identifier type (ValueTreeStreamHelpers::readName (input, arena));
+
+    if (type == Identifier())
         return ValueTree::invalid;
 
-    ValueTree v (type);
+    ValueTree v (arena != nullptr ? new (*arena) ArenaSharedObject (type)
+                                  : new SharedObject (type));
 
     const int numProps = input.readCompressedInt();
 
@@ -931,20 +1339,24 @@ ValueTree ValueTree::readFromStream (InputStream& input)
     int i;
     for (i = 0; i < numProps; ++i)
     {
-        const String name (input.readString());
-        jassert (name.isNotEmpty());
-        const var value (var::readFromStream (input));
-        v.object->properties.set (name, value);
+        const Identifier name (ValueTreeStreamHelpers::readName (input, arena));
+        jassert (name != Identifier());
+        const var value (arena != nullptr ? var::readFromStream (input, *arena)
+                                          : var::readFromStream (input));
+
+        if (name != Identifier())
+            v.object->properties.set (name, value);
     }
 
     const int numChildren = input.readCompressedInt();
 
     for (i = 0; i < numChildren; ++i)
     {
-        ValueTree child (readFromStream (input));
+        ValueTree child (readFromStream (input, arena));
 
         v.object->children.add (child.object);
         child.object->parent = v.object;
+        child.object->indexInParent = i;
     }
 
     return v;
@@ -956,4 +1368,234 @@ ValueTree ValueTree::readFromData (const void* const data, const size_t numBytes
     return readFromStream (in);
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ValueTreeChangeBatchTests  : public UnitTest
+{
+public:
+    ValueTreeChangeBatchTests() : UnitTest ("ValueTree change batches") {}
+
+    struct LoggingListener  : public ValueTree::Listener
+    {
+        void valueTreePropertyChanged (ValueTree&, const Identifier& property)  { log.add ("property " + property.toString()); }
+        void valueTreeChildAdded (ValueTree&, ValueTree& child)                 { log.add ("added " + child.getType().toString()); }
+        void valueTreeChildRemoved (ValueTree&, ValueTree& child)               { log.add ("removed " + child.getType().toString()); }
+        void valueTreeChildOrderChanged (ValueTree&)                            { log.add ("order"); }
+        void valueTreeParentChanged (ValueTree&)                                {}
+
+        StringArray log;
+    };
+
+    class PropertySetterThread  : public Thread
+    {
+    public:
+        PropertySetterThread (ValueTree& tree_) : Thread ("ValueTree test"), tree (tree_) {}
+
+        void run()
+        {
+            ValueTree::ScopedChangeBatch batch;
+            tree.setProperty ("fromThread", 1, nullptr);
+            tree.setProperty ("fromThread", 2, nullptr);
+        }
+
+    private:
+        ValueTree& tree;
+    };
+
+    void runTest()
+    {
+        beginTest ("Nesting and flush order");
+
+        {
+            ValueTree tree ("root");
+            LoggingListener listener;
+            tree.addListener (&listener);
+
+            {
+                ValueTree::ScopedChangeBatch outer;
+                tree.setProperty ("b", 1, nullptr);
+
+                {
+                    ValueTree::ScopedChangeBatch inner;
+                    tree.addChild (ValueTree ("child"), -1, nullptr);
+                    tree.setProperty ("a", 1, nullptr);
+                    tree.setProperty ("b", 2, nullptr);
+                }
+
+                // only the outermost batch delivers
+                expectEquals (listener.log.size(), 0);
+
+                tree.setProperty ("a", 2, nullptr);
+            }
+
+            expectEquals (listener.log.joinIntoString (","), String ("property b,added child,property a"));
+
+            tree.removeListener (&listener);
+        }
+
+        beginTest ("Cancelled changes");
+
+        {
+            ValueTree tree ("root");
+            LoggingListener listener;
+            tree.addListener (&listener);
+
+            {
+                ValueTree::ScopedChangeBatch batch;
+                ValueTree child ("child");
+                tree.addChild (child, -1, nullptr);
+                tree.removeChild (child, nullptr);
+            }
+
+            expectEquals (listener.log.size(), 0);
+
+            tree.removeListener (&listener);
+        }
+
+        beginTest ("Batches are per-thread");
+
+        {
+            ValueTree tree ("root");
+            LoggingListener listener;
+            tree.addListener (&listener);
+
+            {
+                ValueTree::ScopedChangeBatch batch;
+                tree.setProperty ("fromHere", 1, nullptr);
+
+                PropertySetterThread thread (tree);
+                thread.startThread();
+                expect (thread.waitForThreadToExit (5000));
+
+                // the other thread's batch is delivered on its own, and isn't held back by this one
+                expectEquals (listener.log.joinIntoString (","), String ("property fromThread"));
+            }
+
+            expectEquals (listener.log.joinIntoString (","), String ("property fromThread,property fromHere"));
+
+            tree.removeListener (&listener);
+        }
+    }
+};
+
+static ValueTreeChangeBatchTests valueTreeChangeBatchUnitTests;
+
+//==============================================================================
+class ValueTreeChildIndexTests  : public UnitTest
+{
+public:
+    ValueTreeChildIndexTests() : UnitTest ("ValueTree child indexes") {}
+
+    struct IdComparator
+    {
+        static int compareElements (const ValueTree& first, const ValueTree& second)
+        {
+            return (int) first ["id"] - (int) second ["id"];
+        }
+    };
+
+    void checkChildren (const ValueTree& tree, const int numTypes)
+    {
+        for (int i = 0; i < tree.getNumChildren(); ++i)
+        {
+            expectEquals (tree.indexOf (tree.getChild (i)), i);
+            expect (tree.getChild (i).getParent() == tree);
+        }
+
+        for (int i = 0; i < numTypes; ++i)
+        {
+            const Identifier type ("t" + String (i));
+            ValueTree firstOfType;
+
+            for (int j = 0; j < tree.getNumChildren(); ++j)
+            {
+                if (tree.getChild (j).hasType (type))
+                {
+                    firstOfType = tree.getChild (j);
+                    break;
+                }
+            }
+
+            expect (tree.getChildWithName (type) == firstOfType);
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("Adding, removing, renaming and reordering children");
+
+        Random r (5678);
+        const int numTypes = 30;
+        ValueTree tree ("root");
+        int nextId = 0;
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            const int numChildren = tree.getNumChildren();
+
+            switch (r.nextInt (6))
+            {
+                case 0:
+                case 1:
+                {
+                    ValueTree child ("t" + String (r.nextInt (numTypes)));
+                    child.setProperty ("id", r.nextInt (1000) + (nextId++ * 1000), nullptr);
+                    tree.addChild (child, r.nextInt (numChildren + 2) - 1, nullptr);
+                    break;
+                }
+
+                case 2:
+                    if (numChildren > 0)
+                        tree.removeChild (tree.getChild (r.nextInt (numChildren)), nullptr);
+
+                    break;
+
+                case 3:
+                    if (numChildren > 0)
+                        tree.moveChild (r.nextInt (numChildren), r.nextInt (numChildren + 1) - 1, nullptr);
+
+                    break;
+
+                case 4:
+                    if (numChildren > 0)
+                    {
+                        // a child's type can't change, so it's renamed by replacing it with a copy
+                        const int index = r.nextInt (numChildren);
+                        ValueTree renamed ("t" + String (r.nextInt (numTypes)));
+                        renamed.setProperty ("id", tree.getChild (index) ["id"], nullptr);
+                        tree.removeChild (index, nullptr);
+                        tree.addChild (renamed, index, nullptr);
+                    }
+
+                    break;
+
+                default:
+                    if (r.nextInt (10) == 0)
+                    {
+                        IdComparator comparator;
+                        tree.sort (comparator, nullptr, false);
+                    }
+
+                    break;
+            }
+
+            checkChildren (tree, numTypes);
+        }
+
+        beginTest ("Copied and streamed trees");
+
+        checkChildren (tree.createCopy(), numTypes);
+
+        MemoryOutputStream out;
+        tree.writeToStream (out);
+        MemoryInputStream in (out.getData(), out.getDataSize(), false);
+        checkChildren (ValueTree::readFromStream (in), numTypes);
+    }
+};
+
+static ValueTreeChildIndexTests valueTreeChildIndexUnitTests;
+
+#endif
+
 END_JUCE_NAMESPACE
@@ -334,12 +334,26 @@ public:
 
         It's much faster to load/save your tree in binary form than as XML, but
         obviously isn't human-readable.
+
+        For very large trees, see also MappedValueTree, which can read a tree without
+        having to load all of it.
     */
     void writeToStream (OutputStream& output);
 
     /** Reloads a tree from a stream that was written with writeToStream(). */
     static ValueTree readFromStream (InputStream& input);
 
+    /** Reloads a tree from a stream that was written with writeToStream(), allocating
+        its nodes from an ObjectArena.
+
+        This is intended for loading very large trees: the nodes are carved out of the
+        arena's blocks rather than being individually allocated, and repeated type names,
+        property names and string values all share a single pooled copy. The arena will be
+        kept alive until every node that was allocated from it has been deleted.
+        @see ObjectArena
+    */
+    static ValueTree readFromStream (InputStream& input, ObjectArena& arena);
+
     /** Reloads a tree from a data block that was written with writeToStream(). */
     static ValueTree readFromData (const void* data, size_t numBytes);
 
@@ -426,6 +440,57 @@ public:
     /** Removes a listener that was previously added with addListener(). */
     void removeListener (Listener* listener);
 
+    //==============================================================================
+    /**
+        Holds back the listener callbacks for any changes that are made to ValueTrees
+        while it exists, and delivers them all in one go when it's deleted.
+
+        The changes are coalesced, so however many times a property of a tree is changed,
+        its listeners only hear about it once. A child that's added and then removed again
+        inside the batch isn't reported at all, and a tree's children being re-ordered
+        several times only produces one valueTreeChildOrderChanged() callback.
+
+        Changes to trees that have no listeners attached anywhere above them (e.g. a new
+        tree that's being built up before it's added to the tree you're listening to)
+        aren't recorded at all.
+
+        Batches can be nested, in which case only the outermost one delivers the changes.
+        A batch only affects changes made by the thread that created it.
+
+        @code
+        {
+            ValueTree::ScopedChangeBatch batch;
+
+            for (int i = 0; i < 1000; ++i)
+                tree.getChild (i).setProperty ("colour", "red", nullptr);
+
+        }   // <- the listeners get called here
+        @endcode
+    */
+    class JUCE_API  ScopedChangeBatch
+    {
+    public:
+        /** Starts recording changes.
+
+            If deliverAsynchronously is true, the changes are delivered by a message that's
+            posted when the batch is deleted, rather than before its destructor returns.
+        */
+        explicit ScopedChangeBatch (bool deliverAsynchronously = false);
+
+        /** Delivers the changes that were recorded. */
+        ~ScopedChangeBatch();
+
+    private:
+        class PendingChanges;
+        friend class ValueTree;
+        ScopedPointer <PendingChanges> changes;
+        const bool deliverAsynchronously;
+
+        static PendingChanges*& getCurrentChanges() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedChangeBatch);
+    };
+
     //==============================================================================
     /** This method uses a comparator object to sort the tree's children into order.
 
@@ -470,6 +535,7 @@ private:
     class SetPropertyAction;        friend class SetPropertyAction;
     class AddOrRemoveChildAction;   friend class AddOrRemoveChildAction;
     class MoveChildAction;          friend class MoveChildAction;
+    class ArenaSharedObject;        friend class ArenaSharedObject;
 
     class JUCE_API  SharedObject    : public SingleThreadedReferenceCountedObject
     {
@@ -483,6 +549,7 @@ private:
         ReferenceCountedArray <SharedObject> children;
         SortedSet <ValueTree*> valueTreesWithListeners;
         SharedObject* parent;
+        int indexInParent; // (this node's index in its parent's list of children, or -1)
 
         void sendPropertyChangeMessage (const Identifier& property);
         void sendPropertyChangeMessage (ValueTree& tree, const Identifier& property);
@@ -493,6 +560,7 @@ private:
         void sendChildOrderChangedMessage (ValueTree& parent);
         void sendChildOrderChangedMessage();
         void sendParentChangeMessage();
+        bool hasListenersInParentChain() const noexcept;
         const var& getProperty (const Identifier& name) const;
         var getProperty (const Identifier& name, const var& defaultReturnValue) const;
         void setProperty (const Identifier& name, const var& newValue, UndoManager*);
@@ -501,6 +569,7 @@ private:
         void removeAllProperties (UndoManager*);
         bool isAChildOf (const SharedObject* possibleParent) const;
         int indexOf (const ValueTree& child) const;
+        int indexOf (const SharedObject* child) const noexcept;
         ValueTree getChildWithName (const Identifier& type) const;
         ValueTree getOrCreateChildWithName (const Identifier& type, UndoManager* undoManager);
         ValueTree getChildWithProperty (const Identifier& propertyName, const var& propertyValue) const;
@@ -513,6 +582,13 @@ private:
         XmlElement* createXml() const;
 
     private:
+        class ChildTypeIndex;
+        mutable ScopedPointer <ChildTypeIndex> childTypeIndex;
+        SpinLock childTypeIndexLock;
+
+        int getIndexOfFirstChildOfType (const Identifier& type) const;
+        void childrenChanged (int firstChangedIndex, int endIndex) noexcept;
+
         SharedObject& operator= (const SharedObject&);
         JUCE_LEAK_DETECTOR (SharedObject);
     };
@@ -544,6 +620,7 @@ private:
  public:  // (workaround for VC6)
 #endif
     explicit ValueTree (SharedObject*);
+    static ValueTree readFromStream (InputStream&, ObjectArena*);
 };
 
 
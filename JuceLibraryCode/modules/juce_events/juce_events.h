@@ -32,7 +32,7 @@
 BEGIN_JUCE_NAMESPACE
 
 // START_AUTOINCLUDE messages, broadcasters, timers,
-// interprocess, native/juce_ScopedXLock*
+// interprocess, native/juce_ScopedXLock*, native/juce_LinuxEventLoop*
 #ifndef __JUCE_APPLICATIONBASE_JUCEHEADER__
  #include "messages/juce_ApplicationBase.h"
 #endif
@@ -84,6 +84,9 @@ BEGIN_JUCE_NAMESPACE
 #ifndef __JUCE_SCOPEDXLOCK_JUCEHEADER__
  #include "native/juce_ScopedXLock.h"
 #endif
+#ifndef __JUCE_LINUXEVENTLOOP_JUCEHEADER__
+ #include "native/juce_LinuxEventLoop.h"
+#endif
 // END_AUTOINCLUDE
 
 END_JUCE_NAMESPACE
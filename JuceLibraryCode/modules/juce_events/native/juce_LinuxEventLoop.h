@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_LINUXEVENTLOOP_JUCEHEADER__
+#define __JUCE_LINUXEVENTLOOP_JUCEHEADER__
+
+
+//==============================================================================
+#if JUCE_LINUX || DOXYGEN
+
+/**
+    Lets the message thread watch file descriptors, and call you back when they're
+    ready to be read or written (Only available in Linux!).
+
+    The message loop waits for its own messages, the X connection and any
+    registered file descriptors all at once, so a socket or pipe can be handled
+    on the message thread without needing a separate thread to block on it and
+    post messages back.
+
+    The descriptors are watched in level-triggered mode, so you'll keep getting
+    callbacks for as long as there's unread data. The message loop takes turns
+    between descriptors, messages and window events, so a descriptor that's always
+    ready won't stop the others from being handled.
+
+    All of these methods must be called on the message thread.
+*/
+class JUCE_API  LinuxEventLoop
+{
+public:
+    //==============================================================================
+    /** The flags that are used to say which events to watch for, and which have happened. */
+    enum EventFlags
+    {
+        readable        = 1,    /**< The descriptor has data that can be read. */
+        writable        = 2,    /**< The descriptor can be written to without blocking. */
+        errorOrHangup   = 4     /**< The descriptor has an error, or its other end was closed.
+                                     This is always reported, even if you didn't ask for it, and
+                                     the descriptor is unregistered before the callback is made. */
+    };
+
+    //==============================================================================
+    /** Receives callbacks when a file descriptor that it has been registered for is ready.
+
+        @see LinuxEventLoop::registerFileDescriptor
+    */
+    class JUCE_API  FileDescriptorListener
+    {
+    public:
+        /** Destructor. */
+        virtual ~FileDescriptorListener()  {}
+
+        /** Called on the message thread when the descriptor is ready.
+
+            @param fileDescriptor   the descriptor that was registered
+            @param events           a combination of the EventFlags values that
+                                    describe what's happened
+        */
+        virtual void fileDescriptorReady (int fileDescriptor, int events) = 0;
+    };
+
+    //==============================================================================
+    /** Starts watching a file descriptor.
+
+        If the descriptor is already registered, its listener and flags are replaced.
+        The listener must stay valid until the descriptor is unregistered.
+
+        @param fileDescriptor   the descriptor to watch
+        @param eventsToWatch    a combination of readable and writable
+        @param listener         the object that will be called back
+        @returns false if the descriptor couldn't be watched
+        @see unregisterFileDescriptor
+    */
+    static bool registerFileDescriptor (int fileDescriptor, int eventsToWatch,
+                                        FileDescriptorListener* listener);
+
+    /** Stops watching a file descriptor.
+
+        You should call this before closing the descriptor. After it returns, no
+        more callbacks will be made for it, even if some events were still pending.
+    */
+    static void unregisterFileDescriptor (int fileDescriptor);
+
+    /** Unregisters all the file descriptors that were using a particular listener. */
+    static void unregisterListener (FileDescriptorListener* listener);
+
+private:
+    LinuxEventLoop();
+    JUCE_DECLARE_NON_COPYABLE (LinuxEventLoop);
+};
+
+#endif
+#endif   // __JUCE_LINUXEVENTLOOP_JUCEHEADER__
@@ -43,59 +43,101 @@ class InternalMessageQueue
 {
 public:
     InternalMessageQueue()
-        : bytesInSocket (0),
-          totalEventCount (0)
+        : postedMessages (nullptr),
+          firstPending (nullptr),
+          nextEventSource (0)
     {
-        int ret = ::socketpair (AF_LOCAL, SOCK_STREAM, 0, fd);
-        (void) ret; jassert (ret == 0);
+        eventHandle = eventfd (0, 0);
+        jassert (eventHandle >= 0);
+        setNonBlocking (eventHandle);
+
+        epollHandle = epoll_create (16);
+        jassert (epollHandle >= 0);
+        watchDescriptor (eventHandle, EPOLLIN, EPOLL_CTL_ADD);
     }
 
     ~InternalMessageQueue()
     {
-        close (fd[0]);
-        close (fd[1]);
+        close (epollHandle);
+        close (eventHandle);
+
+        fetchPostedMessages();
+
+        while (firstPending != nullptr)
+        {
+            QueuedMessage* const m = firstPending;
+            firstPending = m->next;
+            delete m;
+        }
 
         clearSingletonInstance();
     }
 
     //==============================================================================
-    void postMessage (Message* msg)
+    void postMessage (Message* const msg)
     {
-        const int maxBytesInSocketQueue = 128;
-
-        ScopedLock sl (lock);
-        queue.add (msg);
+        // Each post gets its own node, because the same message can be posted again
+        // before an earlier post of it has been delivered (e.g. by an AsyncUpdater).
+        QueuedMessage* const node = new QueuedMessage (msg);
+        QueuedMessage* oldHead;
 
-        if (bytesInSocket < maxBytesInSocketQueue)
+        do
         {
-            ++bytesInSocket;
+            oldHead = postedMessages.get();
+            node->next = oldHead;
+        }
+        while (! postedMessages.compareAndSetBool (node, oldHead));
 
-            ScopedUnlock ul (lock);
-            const unsigned char x = 0xff;
-            size_t bytesWritten = write (fd[0], &x, 1);
+        // Only the message that finds the list empty needs to wake up the message thread -
+        // anything posted after it will be collected in the same batch.
+        if (oldHead == nullptr)
+        {
+            const uint64 one = 1;
+            ssize_t bytesWritten = write (eventHandle, &one, sizeof (one));
             (void) bytesWritten;
         }
     }
 
     bool isEmpty() const
     {
-        ScopedLock sl (lock);
-        return queue.size() == 0;
+        return firstPending == nullptr && postedMessages.get() == nullptr;
     }
 
     bool dispatchNextEvent()
     {
-        // This alternates between giving priority to XEvents or internal messages,
-        // to keep everything running smoothly..
-        if ((++totalEventCount & 1) != 0)
-            return dispatchNextXEvent() || dispatchNextInternalMessage();
-        else
-            return dispatchNextInternalMessage() || dispatchNextXEvent();
+        // This takes turns between internal messages, XEvents and file descriptors,
+        // handling at most one batch from each, so that a source that's always busy
+        // can't hold up the others..
+        for (int i = 0; i < numEventSources; ++i)
+        {
+            const int source = (nextEventSource + i) % numEventSources;
+
+            const bool dispatched = (source == 0) ? dispatchNextInternalMessages()
+                                  : (source == 1) ? dispatchNextXEvent()
+                                                  : dispatchReadyDescriptors();
+
+            if (dispatched)
+            {
+                nextEventSource = (source + 1) % numEventSources;
+                return true;
+            }
+        }
+
+        return false;
     }
 
-    // Wait for an event (either XEvent, or an internal Message)
+    // Wait for an event (either XEvent, an internal Message, or a registered file descriptor)
     bool sleepUntilEvent (const int timeoutMs)
     {
+        if (! (isEmpty() && readyEvents.size() == 0))
+            return true;
+
+        // Reset the wakeup counter before checking the list again, so that a message posted
+        // after this point will always leave the handle signalled for the wait below.
+        uint64 count;
+        ssize_t bytesRead = read (eventHandle, &count, sizeof (count));
+        (void) bytesRead;
+
         if (! isEmpty())
             return true;
 
@@ -106,39 +148,181 @@ public:
                 return true;
         }
 
-        struct timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = timeoutMs * 1000;
-        int fd0 = getWaitHandle();
-        int fdmax = fd0;
+        return waitForDescriptors (timeoutMs) > 0;
+    }
+
+    void watchDisplayConnection()
+    {
+        ScopedXLock xlock;
+        watchDescriptor (XConnectionNumber (display), EPOLLIN, EPOLL_CTL_ADD);
+    }
 
-        fd_set readset;
-        FD_ZERO (&readset);
-        FD_SET (fd0, &readset);
+    //==============================================================================
+    bool registerFileDescriptor (const int fd, const int eventsToWatch, LinuxEventLoop::FileDescriptorListener* const listener)
+    {
+        jassert (listener != nullptr && fd != eventHandle);
 
-        if (display != 0)
+        const uint32 epollEvents = ((eventsToWatch & LinuxEventLoop::readable) != 0 ? EPOLLIN : 0)
+                                    | ((eventsToWatch & LinuxEventLoop::writable) != 0 ? EPOLLOUT : 0);
+
+        for (int i = watchers.size(); --i >= 0;)
         {
-            ScopedXLock xlock;
-            int fd1 = XConnectionNumber (display);
-            FD_SET (fd1, &readset);
-            fdmax = jmax (fd0, fd1);
+            DescriptorWatcher& w = watchers.getReference (i);
+
+            if (w.fd == fd)
+            {
+                if (! watchDescriptor (fd, epollEvents, EPOLL_CTL_MOD))
+                    return false;
+
+                w.events = eventsToWatch;
+                w.listener = listener;
+                return true;
+            }
+        }
+
+        if (! watchDescriptor (fd, epollEvents, EPOLL_CTL_ADD))
+            return false;
+
+        const DescriptorWatcher w = { fd, eventsToWatch, listener };
+        watchers.add (w);
+        return true;
+    }
+
+    void unregisterFileDescriptor (const int fd)
+    {
+        for (int i = watchers.size(); --i >= 0;)
+        {
+            if (watchers.getReference (i).fd == fd)
+            {
+                watchers.remove (i);
+                epoll_ctl (epollHandle, EPOLL_CTL_DEL, fd, 0);
+            }
         }
+    }
 
-        const int ret = select (fdmax + 1, &readset, 0, 0, &tv);
-        return (ret > 0); // ret <= 0 if error or timeout
+    void unregisterListener (LinuxEventLoop::FileDescriptorListener* const listener)
+    {
+        for (int i = watchers.size(); --i >= 0;)
+            if (watchers.getReference (i).listener == listener)
+                unregisterFileDescriptor (watchers.getReference (i).fd);
     }
 
     //==============================================================================
     juce_DeclareSingleton_SingleThreaded_Minimal (InternalMessageQueue);
 
 private:
-    CriticalSection lock;
-    ReferenceCountedArray <Message> queue;
-    int fd[2];
-    int bytesInSocket;
-    int totalEventCount;
+    struct QueuedMessage
+    {
+        QueuedMessage (Message* const message_)  : message (message_), next (nullptr) {}
+
+        const Message::Ptr message;
+        QueuedMessage* next;
+
+        JUCE_DECLARE_NON_COPYABLE (QueuedMessage);
+    };
+
+    /* Other threads push messages onto the front of this list. The message thread
+       takes the whole list in one go, and keeps it in oldest-first order in
+       firstPending while it delivers them.
+    */
+    Atomic <QueuedMessage*> postedMessages;
+    QueuedMessage* firstPending;
+    int eventHandle;
+    int nextEventSource;
+
+    enum { numEventSources = 3 };
+
+    struct DescriptorWatcher
+    {
+        int fd, events;
+        LinuxEventLoop::FileDescriptorListener* listener;
+    };
+
+    /* All the descriptors - our own eventfd, the X connection and any that were
+       registered with LinuxEventLoop - are waited on with a single epoll handle.
+       Events for registered descriptors are kept in readyEvents until they're
+       dispatched.
+    */
+    int epollHandle;
+    Array <DescriptorWatcher> watchers;
+    Array <epoll_event> readyEvents;
+
+    bool watchDescriptor (const int fd, const uint32 events, const int operation)
+    {
+        epoll_event ev;
+        zerostruct (ev);
+        ev.events = events;
+        ev.data.fd = fd;
+
+        return epoll_ctl (epollHandle, operation, fd, &ev) == 0;
+    }
+
+    int waitForDescriptors (const int timeoutMs)
+    {
+        const int maxEvents = 16;
+        epoll_event events [maxEvents];
+
+        const int numEvents = epoll_wait (epollHandle, events, maxEvents, timeoutMs);
+
+        // Our own descriptors just need to wake us up, so only registered ones get kept
+        for (int i = 0; i < numEvents; ++i)
+            if (events[i].data.fd != eventHandle && (display == 0 || events[i].data.fd != XConnectionNumber (display)))
+                readyEvents.add (events[i]);
+
+        return numEvents;
+    }
 
-    int getWaitHandle() const noexcept      { return fd[1]; }
+    bool dispatchReadyDescriptors()
+    {
+        if (watchers.size() == 0)
+        {
+            readyEvents.clearQuick();
+            return false;
+        }
+
+        if (readyEvents.size() == 0 && waitForDescriptors (0) <= 0)
+            return false;
+
+        // Only the events that are ready now are dispatched, and any that become ready
+        // during the callbacks will wait until the next turn.
+        Array <epoll_event> batch;
+        batch.swapWithArray (readyEvents);
+
+        bool anyDispatched = false;
+
+        for (int j = 0; j < batch.size(); ++j)
+        {
+            const epoll_event& ev = batch.getReference (j);
+
+            // look it up again, in case a previous callback has unregistered it
+            for (int i = watchers.size(); --i >= 0;)
+            {
+                const DescriptorWatcher w (watchers.getReference (i));
+
+                if (w.fd == ev.data.fd)
+                {
+                    const int flags = ((ev.events & EPOLLIN) != 0 ? LinuxEventLoop::readable : 0)
+                                       | ((ev.events & EPOLLOUT) != 0 ? LinuxEventLoop::writable : 0)
+                                       | ((ev.events & (EPOLLERR | EPOLLHUP)) != 0 ? LinuxEventLoop::errorOrHangup : 0);
+
+                    if ((flags & (w.events | LinuxEventLoop::errorOrHangup)) != 0)
+                    {
+                        // A descriptor with an error or hangup stays ready forever, so it
+                        // gets unregistered once the listener has been told about it.
+                        if ((flags & LinuxEventLoop::errorOrHangup) != 0)
+                            unregisterFileDescriptor (w.fd);
+
+                        w.listener->fileDescriptorReady (w.fd, flags);
+                        anyDispatched = true;
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        return anyDispatched;
+    }
 
     static bool setNonBlocking (int handle)
     {
@@ -173,37 +357,86 @@ private:
         return true;
     }
 
-    Message::Ptr popNextMessage()
+    bool fetchPostedMessages()
     {
-        const ScopedLock sl (lock);
+        QueuedMessage* m = postedMessages.exchange (nullptr);
 
-        if (bytesInSocket > 0)
-        {
-            --bytesInSocket;
+        if (m == nullptr)
+            return false;
+
+        // The posted list is newest-first, so reverse it onto the end of the pending list
+        QueuedMessage* batch = nullptr;
 
-            const ScopedUnlock ul (lock);
-            unsigned char x;
-            size_t numBytes = read (fd[1], &x, 1);
-            (void) numBytes;
+        while (m != nullptr)
+        {
+            QueuedMessage* const next = m->next;
+            m->next = batch;
+            batch = m;
+            m = next;
         }
 
-        return queue.removeAndReturn (0);
+        QueuedMessage** tail = &firstPending;
+        while (*tail != nullptr)
+            tail = &((*tail)->next);
+
+        *tail = batch;
+        return true;
     }
 
-    bool dispatchNextInternalMessage()
+    bool dispatchNextInternalMessages()
     {
-        const Message::Ptr msg (popNextMessage());
-
-        if (msg == nullptr)
+        if (firstPending == nullptr && ! fetchPostedMessages())
             return false;
 
-        MessageManager::getInstance()->deliverMessage (msg);
+        // Deliver the batch that was collected, but not anything that gets posted while
+        // we're doing so, so that XEvents still get a look-in.
+        MessageManager* const mm = MessageManager::getInstance();
+
+        do
+        {
+            QueuedMessage* const m = firstPending;
+            firstPending = m->next;
+
+            const Message::Ptr msg (m->message);
+            delete m;
+
+            mm->deliverMessage (msg);
+        }
+        while (firstPending != nullptr && ! mm->hasStopMessageBeenSent());
+
         return true;
     }
 };
 
 juce_ImplementSingleton_SingleThreaded (InternalMessageQueue);
 
+//==============================================================================
+bool LinuxEventLoop::registerFileDescriptor (int fileDescriptor, int eventsToWatch, FileDescriptorListener* listener)
+{
+    jassert (MessageManager::getInstance()->isThisTheMessageThread());
+
+    InternalMessageQueue* const queue = InternalMessageQueue::getInstanceWithoutCreating();
+    return queue != nullptr && queue->registerFileDescriptor (fileDescriptor, eventsToWatch, listener);
+}
+
+void LinuxEventLoop::unregisterFileDescriptor (int fileDescriptor)
+{
+    jassert (MessageManager::getInstance()->isThisTheMessageThread());
+
+    InternalMessageQueue* const queue = InternalMessageQueue::getInstanceWithoutCreating();
+    if (queue != nullptr)
+        queue->unregisterFileDescriptor (fileDescriptor);
+}
+
+void LinuxEventLoop::unregisterListener (FileDescriptorListener* listener)
+{
+    jassert (MessageManager::getInstance()->isThisTheMessageThread());
+
+    InternalMessageQueue* const queue = InternalMessageQueue::getInstanceWithoutCreating();
+    if (queue != nullptr)
+        queue->unregisterListener (listener);
+}
+
 
 //==============================================================================
 namespace LinuxErrorHandling
@@ -327,6 +560,8 @@ void MessageManager::doPlatformSpecificInitialisation()
                                                   0, 0, 1, 1, 0, 0, InputOnly,
                                                   DefaultVisual (display, screen),
                                                   CWEventMask, &swa);
+
+        InternalMessageQueue::getInstance()->watchDisplayConnection();
     }
 }
 
@@ -432,3 +667,180 @@ bool MessageManager::dispatchNextMessageOnSystemQueue (bool returnIfNoPendingMes
 
     return false;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class LinuxMessageQueueTests  : public UnitTest
+{
+public:
+    LinuxMessageQueueTests() : UnitTest ("Linux message queue") {}
+
+    struct CountingMessage  : public CallbackMessage
+    {
+        CountingMessage() : count (0) {}
+        void messageCallback()      { ++count; }
+
+        int count;
+    };
+
+    struct Pipe
+    {
+        Pipe()      { fds[0] = fds[1] = -1; ssize_t result = pipe (fds); (void) result; }
+        ~Pipe()     { closeWriteEnd(); close (fds[0]); }
+
+        int getReadEnd() const noexcept     { return fds[0]; }
+
+        void writeByte()
+        {
+            const char c = 0;
+            ssize_t bytesWritten = write (fds[1], &c, 1);
+            (void) bytesWritten;
+        }
+
+        void closeWriteEnd()
+        {
+            if (fds[1] >= 0)
+            {
+                close (fds[1]);
+                fds[1] = -1;
+            }
+        }
+
+        int fds[2];
+    };
+
+    struct TestListener  : public LinuxEventLoop::FileDescriptorListener
+    {
+        TestListener (InternalMessageQueue& queue_)
+            : queue (queue_), numCallbacks (0), lastEvents (0),
+              shouldReadData (true), descriptorToUnregister (-1)
+        {
+        }
+
+        void fileDescriptorReady (int fd, int events)
+        {
+            ++numCallbacks;
+            lastEvents = events;
+
+            if (shouldReadData && (events & LinuxEventLoop::readable) != 0)
+            {
+                char buffer [64];
+                ssize_t bytesRead = read (fd, buffer, sizeof (buffer));
+                (void) bytesRead;
+            }
+
+            if (descriptorToUnregister >= 0)
+                queue.unregisterFileDescriptor (descriptorToUnregister);
+        }
+
+        InternalMessageQueue& queue;
+        int numCallbacks, lastEvents;
+        bool shouldReadData;
+        int descriptorToUnregister;
+    };
+
+    static void dispatchAll (InternalMessageQueue& queue, const int maxNumEvents = 100)
+    {
+        for (int i = maxNumEvents; --i >= 0 && queue.dispatchNextEvent();)
+        {}
+    }
+
+    void runTest()
+    {
+        beginTest ("Re-posting a message that's still queued");
+
+        MessageManager::getInstance();
+        InternalMessageQueue queue;
+
+        const ReferenceCountedObjectPtr<CountingMessage> m1 (new CountingMessage()), m2 (new CountingMessage());
+
+        queue.postMessage (m1);
+        queue.postMessage (m2);
+        queue.postMessage (m1);
+        queue.postMessage (m1);
+
+        while (queue.dispatchNextEvent())
+        {}
+
+        expectEquals (m1->count, 3);
+        expectEquals (m2->count, 1);
+        expectEquals (m1->getReferenceCount(), 1);
+        expectEquals (m2->getReferenceCount(), 1);
+
+        beginTest ("File descriptors");
+
+        {
+            Pipe p;
+            TestListener listener (queue);
+            expect (queue.registerFileDescriptor (p.getReadEnd(), LinuxEventLoop::readable, &listener));
+
+            dispatchAll (queue);
+            expectEquals (listener.numCallbacks, 0);
+
+            p.writeByte();
+            expect (queue.sleepUntilEvent (1000));
+            dispatchAll (queue);
+            expectEquals (listener.numCallbacks, 1);
+            expectEquals (listener.lastEvents, (int) LinuxEventLoop::readable);
+
+            // once the other end has been closed, the listener hears about it once, and
+            // then the descriptor is unregistered
+            p.closeWriteEnd();
+            dispatchAll (queue);
+            expectEquals (listener.numCallbacks, 2);
+            expect ((listener.lastEvents & LinuxEventLoop::errorOrHangup) != 0);
+
+            dispatchAll (queue);
+            expectEquals (listener.numCallbacks, 2);
+        }
+
+        {
+            // a descriptor that stays ready mustn't stop messages being delivered
+            Pipe p;
+            TestListener listener (queue);
+            listener.shouldReadData = false;
+            queue.registerFileDescriptor (p.getReadEnd(), LinuxEventLoop::readable, &listener);
+            p.writeByte();
+
+            const ReferenceCountedObjectPtr<CountingMessage> m (new CountingMessage());
+            queue.postMessage (m);
+
+            for (int i = 0; i < 3; ++i)
+                queue.dispatchNextEvent();
+
+            expectEquals (m->count, 1);
+            expect (listener.numCallbacks > 0);
+
+            queue.unregisterListener (&listener);
+            const int numCallbacks = listener.numCallbacks;
+            dispatchAll (queue);
+            expectEquals (listener.numCallbacks, numCallbacks);
+        }
+
+        {
+            // two descriptors that are ready together, where whichever gets called first
+            // unregisters the other one
+            Pipe p1, p2;
+            TestListener l1 (queue), l2 (queue);
+            l1.descriptorToUnregister = p2.getReadEnd();
+            l2.descriptorToUnregister = p1.getReadEnd();
+
+            queue.registerFileDescriptor (p1.getReadEnd(), LinuxEventLoop::readable, &l1);
+            queue.registerFileDescriptor (p2.getReadEnd(), LinuxEventLoop::readable, &l2);
+
+            p1.writeByte();
+            p2.writeByte();
+            dispatchAll (queue);
+
+            expectEquals (l1.numCallbacks + l2.numCallbacks, 1);
+
+            queue.unregisterFileDescriptor (p1.getReadEnd());
+            queue.unregisterFileDescriptor (p2.getReadEnd());
+        }
+    }
+};
+
+static LinuxMessageQueueTests linuxMessageQueueUnitTests;
+
+#endif
@@ -26,6 +26,15 @@
 BEGIN_JUCE_NAMESPACE
 
 //==============================================================================
+/*  The active timers are kept in a hashed timing wheel: each one goes into the slot
+    for its expiry time modulo numSlots, so adding, removing and rescheduling a timer
+    is O(1), and each tick only has to look at the timers in one slot. Timers whose
+    period is longer than the wheel just stay in their slot for more than one
+    revolution.
+
+    When some timers are due, the timer thread moves them onto the dueTimers list and
+    posts a single message, and the message thread then calls all of them.
+*/
 class Timer::TimerThread  : private Thread,
                             private MessageListener,
                             private DeletedAtShutdown,
@@ -36,9 +45,12 @@ public:
 
     TimerThread()
         : Thread ("Juce Timer"),
-          firstTimer (nullptr),
+          currentTime (0),
+          firstDueTimer (nullptr),
+          lastDueTimer (nullptr),
           callbackNeeded (0)
     {
+        zeromem (slots, sizeof (slots));
         triggerAsyncUpdate();
     }
 
@@ -70,7 +82,7 @@ public:
                                                        : (std::numeric_limits<uint32>::max() - (lastTime - now)));
             lastTime = now;
 
-            const int timeUntilFirstTimer = getTimeUntilFirstTimer (elapsed);
+            const int timeUntilFirstTimer = advanceTime (elapsed);
 
             if (timeUntilFirstTimer <= 0)
             {
@@ -114,12 +126,12 @@ public:
     {
         const LockType::ScopedLockType sl (lock);
 
-        while (firstTimer != nullptr && firstTimer->countdownMs <= 0)
+        while (firstDueTimer != nullptr)
         {
-            Timer* const t = firstTimer;
-            t->countdownMs = t->periodMs;
+            Timer* const t = firstDueTimer;
 
             removeTimer (t);
+            t->expiryTime = currentTime + t->periodMs;
             addTimer (t);
 
             const LockType::ScopedUnlockType ul (lock);
@@ -158,11 +170,12 @@ public:
         callTimers();
     }
 
-    static inline void add (Timer* const tim) noexcept
+    static inline void add (Timer* const tim, const int initialCountdown) noexcept
     {
         if (instance == nullptr)
             instance = new TimerThread();
 
+        tim->expiryTime = instance->currentTime + initialCountdown;
         instance->addTimer (tim);
     }
 
@@ -176,15 +189,11 @@ public:
     {
         if (instance != nullptr)
         {
-            tim->countdownMs = newCounter;
             tim->periodMs = newCounter;
 
-            if ((tim->next != nullptr && tim->next->countdownMs < tim->countdownMs)
-                 || (tim->previous != nullptr && tim->previous->countdownMs > tim->countdownMs))
-            {
-                instance->removeTimer (tim);
-                instance->addTimer (tim);
-            }
+            instance->removeTimer (tim);
+            tim->expiryTime = instance->currentTime + newCounter;
+            instance->addTimer (tim);
         }
     }
 
@@ -192,103 +201,118 @@ public:
     static LockType lock;
 
 private:
-    Timer* volatile firstTimer;
+    enum { numSlots = 1024 };   // must be a power of two
+
+    Timer* slots [numSlots];
+    int64 currentTime;
+    Timer* firstDueTimer;
+    Timer* lastDueTimer;
     Atomic <int> callbackNeeded;
 
     //==============================================================================
-    void addTimer (Timer* const t) noexcept
+    Timer*& getSlot (const int64 time) noexcept
     {
-       #if JUCE_DEBUG
-        Timer* tt = firstTimer;
-
-        while (tt != nullptr)
-        {
-            // trying to add a timer that's already here - shouldn't get to this point,
-            // so if you get this assertion, let me know!
-            jassert (tt != t);
-
-            tt = tt->next;
-        }
+        return slots [(int) (time & (numSlots - 1))];
+    }
 
+    void addTimer (Timer* const t) noexcept
+    {
         jassert (t->previous == nullptr && t->next == nullptr);
-       #endif
 
-        Timer* i = firstTimer;
+        // a timer that's already due still has to wait for the next tick
+        if (t->expiryTime <= currentTime)
+            t->expiryTime = currentTime + 1;
 
-        if (i == nullptr || i->countdownMs > t->countdownMs)
-        {
-            t->next = firstTimer;
-            firstTimer = t;
-        }
-        else
-        {
-            while (i->next != nullptr && i->next->countdownMs <= t->countdownMs)
-                i = i->next;
-
-            jassert (i != nullptr);
+        Timer*& first = getSlot (t->expiryTime);
 
-            t->next = i->next;
-            t->previous = i;
-            i->next = t;
-        }
+        t->next = first;
 
-        if (t->next != nullptr)
-            t->next->previous = t;
+        if (first != nullptr)
+            first->previous = t;
 
-        jassert ((t->next == nullptr || t->next->countdownMs >= t->countdownMs)
-                  && (t->previous == nullptr || t->previous->countdownMs <= t->countdownMs));
+        first = t;
 
         notify();
     }
 
     void removeTimer (Timer* const t) noexcept
     {
-       #if JUCE_DEBUG
-        Timer* tt = firstTimer;
-        bool found = false;
-
-        while (tt != nullptr)
-        {
-            if (tt == t)
-            {
-                found = true;
-                break;
-            }
-
-            tt = tt->next;
-        }
-
-        // trying to remove a timer that's not here - shouldn't get to this point,
-        // so if you get this assertion, let me know!
-        jassert (found);
-       #endif
-
         if (t->previous != nullptr)
         {
-            jassert (firstTimer != t);
             t->previous->next = t->next;
         }
+        else if (firstDueTimer == t)
+        {
+            firstDueTimer = t->next;
+        }
         else
         {
-            jassert (firstTimer == t);
-            firstTimer = t->next;
+            // trying to remove a timer that's not here - shouldn't get to this point,
+            // so if you get this assertion, let me know!
+            jassert (getSlot (t->expiryTime) == t);
+
+            getSlot (t->expiryTime) = t->next;
         }
 
         if (t->next != nullptr)
             t->next->previous = t->previous;
+        else if (lastDueTimer == t)
+            lastDueTimer = t->previous;
 
         t->next = nullptr;
         t->previous = nullptr;
     }
 
-    int getTimeUntilFirstTimer (const int numMillisecsElapsed) const
+    void addDueTimer (Timer* const t) noexcept
+    {
+        t->previous = lastDueTimer;
+
+        if (lastDueTimer != nullptr)
+            lastDueTimer->next = t;
+        else
+            firstDueTimer = t;
+
+        lastDueTimer = t;
+    }
+
+    // Moves the clock on, and returns the time until the next timer is due
+    int advanceTime (const int numMillisecsElapsed)
     {
         const LockType::ScopedLockType sl (lock);
 
-        for (Timer* t = firstTimer; t != nullptr; t = t->next)
-            t->countdownMs -= numMillisecsElapsed;
+        const int64 newTime = currentTime + numMillisecsElapsed;
+        const int numSlotsToVisit = jmin ((int) numSlots, numMillisecsElapsed);
+
+        for (int i = 1; i <= numSlotsToVisit; ++i)
+        {
+            for (Timer* t = getSlot (currentTime + i); t != nullptr;)
+            {
+                Timer* const next = t->next;
+
+                if (t->expiryTime <= newTime)
+                {
+                    removeTimer (t);
+                    addDueTimer (t);
+                }
+
+                t = next;
+            }
+        }
+
+        currentTime = newTime;
+
+        if (firstDueTimer != nullptr)
+            return 0;
 
-        return firstTimer != nullptr ? firstTimer->countdownMs : 1000;
+        // The thread never waits for longer than 50ms, so only the next few slots need checking
+        const int maxLookahead = 50;
+
+        for (int i = 1; i <= maxLookahead; ++i)
+            for (Timer* t = getSlot (currentTime + i); t != nullptr; t = t->next)
+                if (t->expiryTime == currentTime + i)
+                    return i;
+
+        return 1000;
     }
 
     void handleAsyncUpdate()
@@ -308,7 +332,7 @@ static SortedSet <Timer*> activeTimers;
 #endif
 
 Timer::Timer() noexcept
-   : countdownMs (0),
+   : expiryTime (0),
      periodMs (0),
      previous (nullptr),
      next (nullptr)
@@ -320,7 +344,7 @@ Timer::Timer() noexcept
 }
 
 Timer::Timer (const Timer&) noexcept
-   : countdownMs (0),
+   : expiryTime (0),
      periodMs (0),
      previous (nullptr),
      next (nullptr)
@@ -351,9 +375,8 @@ void Timer::startTimer (const int interval) noexcept
 
     if (periodMs == 0)
     {
-        countdownMs = interval;
         periodMs = jmax (1, interval);
-        TimerThread::add (this);
+        TimerThread::add (this, interval);
     }
     else
     {
@@ -383,4 +406,216 @@ void JUCE_CALLTYPE Timer::callPendingTimersSynchronously()
         TimerThread::instance->callTimersSynchronously();
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS && JUCE_MODAL_LOOPS_PERMITTED
+
+class TimerTests  : public UnitTest
+{
+public:
+    TimerTests() : UnitTest ("Timer") {}
+
+    class TestTimer  : public Timer
+    {
+    public:
+        enum Action
+        {
+            keepGoing,
+            stopSelf,
+            restartSelf,
+            deleteSelf,
+            stopOther,
+            restartOther,
+            startOther
+        };
+
+        TestTimer (Array<TestTimer*>& callbackLog_, const Action action_ = stopSelf)
+            : callbackLog (callbackLog_), action (action_), other (nullptr),
+              numCallbacks (0), hasBeenDeleted (nullptr)
+        {
+        }
+
+        ~TestTimer()
+        {
+            if (hasBeenDeleted != nullptr)
+                *hasBeenDeleted = true;
+        }
+
+        void timerCallback()
+        {
+            ++numCallbacks;
+            callbackLog.add (this);
+
+            switch (action)
+            {
+                case stopSelf:      stopTimer(); break;
+                case restartSelf:   startTimer (100000); break;
+                case deleteSelf:    delete this; break;
+                case stopOther:     other->stopTimer(); stopTimer(); break;
+                case restartOther:  other->startTimer (100000); stopTimer(); break;
+                case startOther:    other->startTimer (5); stopTimer(); break;
+                default:            break;
+            }
+        }
+
+        Array<TestTimer*>& callbackLog;
+        Action action;
+        TestTimer* other;
+        int numCallbacks;
+        bool* hasBeenDeleted;
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (TestTimer);
+    };
+
+    static void runMessageLoop (const int milliseconds)
+    {
+        MessageManager::getInstance()->runDispatchLoopUntil (milliseconds);
+    }
+
+    void runTest()
+    {
+        if (! MessageManager::getInstance()->isThisTheMessageThread())
+        {
+            logMessage ("(The timer tests have to be run on the message thread, so they've been skipped)");
+            return;
+        }
+
+        Array<TestTimer*> log;
+
+        beginTest ("Ordering");
+
+        {
+            TestTimer a (log), b (log), c (log), d (log);
+
+            a.startTimer (150);
+            b.startTimer (50);
+            c.startTimer (100);
+            d.startTimer (50);
+
+            runMessageLoop (400);
+
+            expectEquals (log.size(), 4);
+            expect (log.contains (&b) && log.contains (&d) && log.indexOf (&b) < 2 && log.indexOf (&d) < 2);
+            expect (log[2] == &c);
+            expect (log[3] == &a);
+        }
+
+        {
+            // if the message thread is held up, timers that become due together still have
+            // to be called in the order that they expired
+            log.clear();
+            TestTimer a (log), b (log), c (log);
+
+            a.startTimer (150);
+            b.startTimer (50);
+            c.startTimer (100);
+
+            Thread::sleep (400);
+            runMessageLoop (200);
+
+            expectEquals (log.size(), 3);
+            expect (log[0] == &b);
+            expect (log[1] == &c);
+            expect (log[2] == &a);
+        }
+
+        {
+            // a timer that keeps going gets called repeatedly
+            log.clear();
+            TestTimer a (log, TestTimer::keepGoing);
+
+            a.startTimer (10);
+            runMessageLoop (300);
+            a.stopTimer();
+
+            expect (a.numCallbacks > 3);
+        }
+
+        beginTest ("Changing timers during callbacks");
+
+        {
+            log.clear();
+            TestTimer a (log, TestTimer::restartSelf);
+
+            a.startTimer (10);
+            runMessageLoop (200);
+
+            expectEquals (a.numCallbacks, 1);
+            expect (a.isTimerRunning());
+            expectEquals (a.getTimerInterval(), 100000);
+        }
+
+        {
+            log.clear();
+            bool hasBeenDeleted = false;
+            TestTimer* const a = new TestTimer (log, TestTimer::deleteSelf);
+            a->hasBeenDeleted = &hasBeenDeleted;
+
+            TestTimer b (log);
+
+            a->startTimer (10);
+            b.startTimer (10);
+            runMessageLoop (200);
+
+            expect (hasBeenDeleted);
+            expectEquals (log.size(), 2);
+            expectEquals (b.numCallbacks, 1);
+        }
+
+        {
+            // two timers that are due at the same time, which each stop or restart the
+            // other one - whichever gets called first has to stop the other being called
+            for (int i = 0; i < 2; ++i)
+            {
+                log.clear();
+                const TestTimer::Action action = (i == 0) ? TestTimer::stopOther : TestTimer::restartOther;
+                TestTimer a (log, action), b (log, action);
+                a.other = &b;
+                b.other = &a;
+
+                a.startTimer (10);
+                b.startTimer (10);
+                runMessageLoop (200);
+
+                expectEquals (log.size(), 1);
+
+                a.stopTimer();
+                b.stopTimer();
+            }
+        }
+
+        {
+            log.clear();
+            TestTimer a (log, TestTimer::startOther), b (log);
+            a.other = &b;
+
+            a.startTimer (10);
+            runMessageLoop (200);
+
+            expectEquals (log.size(), 2);
+            expect (log[0] == &a);
+            expect (log[1] == &b);
+            expect (! (a.isTimerRunning() || b.isTimerRunning()));
+        }
+
+        {
+            // stopping a timer before it's called
+            log.clear();
+            TestTimer a (log), b (log);
+
+            a.startTimer (20);
+            b.startTimer (20);
+            b.stopTimer();
+            runMessageLoop (200);
+
+            expectEquals (log.size(), 1);
+            expect (log[0] == &a);
+        }
+    }
+};
+
+static TimerTests timerUnitTests;
+
+#endif
+
 END_JUCE_NAMESPACE
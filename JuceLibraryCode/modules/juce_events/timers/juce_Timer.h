@@ -125,7 +125,8 @@ public:
 private:
     class TimerThread;
     friend class TimerThread;
-    int countdownMs, periodMs;
+    int64 expiryTime;
+    int periodMs;
     Timer* previous;
     Timer* next;
 
@@ -49,6 +49,11 @@ LowLevelGraphicsContext::~LowLevelGraphicsContext()
 {
 }
 
+RectangleList LowLevelGraphicsContext::getClipRegion() const
+{
+    return RectangleList (getClipBounds());
+}
+
 //==============================================================================
 Graphics::Graphics (const Image& imageToDrawOnto)
     : context (imageToDrawOnto.createLowLevelContext()),
@@ -746,6 +751,43 @@ void Graphics::drawImage (const Image& imageToDraw,
 
     if (imageToDraw.isValid() && context->clipRegionIntersects  (Rectangle<int> (dx, dy, dw, dh)))
     {
+        const int numMipmaps = imageToDraw.getNumMipmaps();
+
+        if (numMipmaps > 0 && sw != 0 && sh != 0)
+        {
+            // Find the smallest mipmap that's still at least as big as the size being drawn..
+            const float scale = jmax (std::abs (dw / (float) sw), std::abs (dh / (float) sh));
+            int level = 0;
+
+            while (level < numMipmaps && scale * (float) (2 << level) <= 1.0f)
+                ++level;
+
+            if (level > 0)
+            {
+                const Image mipmap (imageToDraw.getMipmap (level));
+                const float mipScaleX = mipmap.getWidth() / (float) imageToDraw.getWidth();
+                const float mipScaleY = mipmap.getHeight() / (float) imageToDraw.getHeight();
+
+                const Rectangle<float> area (sx * mipScaleX, sy * mipScaleY, sw * mipScaleX, sh * mipScaleY);
+                const Rectangle<int> mipmapArea (area.getSmallestIntegerContainer());
+
+                // ..the source area may not land on whole mipmap pixels, so the area that's
+                // drawn is rounded outwards and clipped to the destination.
+                context->saveState();
+                context->clipToRectangle (Rectangle<int> (dx, dy, dw, dh));
+
+                drawImageTransformed (mipmap.getClippedImage (mipmapArea),
+                                      AffineTransform::translation (mipmapArea.getX() - area.getX(),
+                                                                    mipmapArea.getY() - area.getY())
+                                                      .scaled (dw / area.getWidth(), dh / area.getHeight())
+                                                      .translated ((float) dx, (float) dy),
+                                      fillAlphaChannelWithCurrentBrush);
+
+                context->restoreState();
+                return;
+            }
+        }
+
         drawImageTransformed (imageToDraw.getClippedImage (Rectangle<int> (sx, sy, sw, sh)),
                               AffineTransform::scale (dw / (float) sw, dh / (float) sh)
                                               .translated ((float) dx, (float) dy),
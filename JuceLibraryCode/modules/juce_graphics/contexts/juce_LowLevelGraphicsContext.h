@@ -79,6 +79,12 @@ public:
     virtual Rectangle<int> getClipBounds() const = 0;
     virtual bool isClipEmpty() const = 0;
 
+    /** Returns the rectangles that make up the current clip region.
+        The default implementation just returns the clip bounds, so contexts that know more
+        about the shape of their clip region should override it.
+    */
+    virtual RectangleList getClipRegion() const;
+
     virtual void saveState() = 0;
     virtual void restoreState() = 0;
 
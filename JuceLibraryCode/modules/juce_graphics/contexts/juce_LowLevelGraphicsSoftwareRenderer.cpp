@@ -1027,6 +1027,7 @@ public:
 
     virtual bool clipRegionIntersects (const Rectangle<int>& r) const = 0;
     virtual Rectangle<int> getClipBounds() const = 0;
+    virtual RectangleList getClipRegion() const = 0;
 
     virtual void fillRectWithColour (Image::BitmapData& destData, const Rectangle<int>& area, const PixelARGB& colour, bool replaceContents) const = 0;
     virtual void fillRectWithColour (Image::BitmapData& destData, const Rectangle<float>& area, const PixelARGB& colour) const = 0;
@@ -1321,6 +1322,11 @@ public:
         return edgeTable.getMaximumBounds();
     }
 
+    RectangleList getClipRegion() const
+    {
+        return RectangleList (edgeTable.getMaximumBounds());
+    }
+
     void fillRectWithColour (Image::BitmapData& destData, const Rectangle<int>& area, const PixelARGB& colour, bool replaceContents) const
     {
         const Rectangle<int> totalClip (edgeTable.getMaximumBounds());
@@ -1478,6 +1484,11 @@ public:
         return clip.getBounds();
     }
 
+    RectangleList getClipRegion() const
+    {
+        return clip;
+    }
+
     void fillRectWithColour (Image::BitmapData& destData, const Rectangle<int>& area, const PixelARGB& colour, bool replaceContents) const
     {
         SubRectangleIterator iter (clip, area);
@@ -1940,6 +1951,19 @@ public:
         return Rectangle<int>();
     }
 
+    RectangleList getClipRegion() const
+    {
+        if (clip == nullptr)
+            return RectangleList();
+
+        if (! isOnlyTranslated)
+            return RectangleList (getClipBounds());
+
+        RectangleList region (clip->getClipRegion());
+        region.offsetAll (-xOffset, -yOffset);
+        return region;
+    }
+
     SavedState* beginTransparencyLayer (float opacity)
     {
         const Rectangle<int> layerBounds (getUntransformedClipBounds());
@@ -2291,6 +2315,11 @@ bool LowLevelGraphicsSoftwareRenderer::isClipEmpty() const
     return currentState->clip == 0;
 }
 
+RectangleList LowLevelGraphicsSoftwareRenderer::getClipRegion() const
+{
+    return currentState->getClipRegion();
+}
+
 //==============================================================================
 void LowLevelGraphicsSoftwareRenderer::saveState()
 {
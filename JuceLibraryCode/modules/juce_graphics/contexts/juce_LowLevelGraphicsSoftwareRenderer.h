@@ -61,6 +61,7 @@ public:
     bool clipRegionIntersects (const Rectangle<int>& r);
     Rectangle<int> getClipBounds() const;
     bool isClipEmpty() const;
+    RectangleList getClipRegion() const;
 
     void saveState();
     void restoreState();
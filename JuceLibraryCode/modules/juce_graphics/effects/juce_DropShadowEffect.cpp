@@ -62,41 +62,23 @@ void DropShadowEffect::applyEffect (Image& image, Graphics& g, float alpha)
 
     {
         const Image::BitmapData srcData (image, Image::BitmapData::readOnly);
-        const Image::BitmapData destData (shadowImage, Image::BitmapData::readWrite);
-
-        const int filter = roundToInt (63.0f / radius);
-        const int radiusMinus1 = roundToInt ((radius - 1.0f) * 63.0f);
-
-        for (int x = w; --x >= 0;)
-        {
-            int shadowAlpha = 0;
-
-            const PixelARGB* src = ((const PixelARGB*) srcData.data) + x;
-            uint8* shadowPix = destData.data + x;
-
-            for (int y = h; --y >= 0;)
-            {
-                shadowAlpha = ((shadowAlpha * radiusMinus1 + (src->getAlpha() << 6)) * filter) >> 12;
-
-                *shadowPix = (uint8) shadowAlpha;
-                src = addBytesToPointer (src, srcData.lineStride);
-                shadowPix += destData.lineStride;
-            }
-        }
+        const Image::BitmapData destData (shadowImage, Image::BitmapData::writeOnly);
 
         for (int y = h; --y >= 0;)
         {
-            int shadowAlpha = 0;
+            const PixelARGB* src = (const PixelARGB*) srcData.getLinePointer (y);
             uint8* shadowPix = destData.getLinePointer (y);
 
             for (int x = w; --x >= 0;)
-            {
-                shadowAlpha = ((shadowAlpha * radiusMinus1 + (*shadowPix << 6)) * filter) >> 12;
-                *shadowPix++ = (uint8) shadowAlpha;
-            }
+                *shadowPix++ = (src++)->getAlpha();
         }
     }
 
+    // The radius covers about two standard deviations of the gaussian, which is where
+    // the shadow becomes too faint to see.
+    blur.applyGaussianBlur (shadowImage, shadowImage, shadowImage.getBounds(),
+                            radius * 0.5f, ImageBlur::boxApproximation);
+
     g.setColour (Colours::black.withAlpha (opacity * alpha));
     g.drawImageAt (shadowImage, offsetX, offsetY, true);
 
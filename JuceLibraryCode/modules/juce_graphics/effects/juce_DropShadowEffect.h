@@ -27,6 +27,7 @@
 #define __JUCE_DROPSHADOWEFFECT_JUCEHEADER__
 
 #include "juce_ImageEffectFilter.h"
+#include "../images/juce_ImageBlur.h"
 
 
 //==============================================================================
@@ -84,6 +85,7 @@ private:
     //==============================================================================
     int offsetX, offsetY;
     float radius, opacity;
+    ImageBlur blur;
 
     JUCE_LEAK_DETECTOR (DropShadowEffect);
 };
@@ -47,12 +47,15 @@ void GlowEffect::applyEffect (Image& image, Graphics& g, float alpha)
 {
     Image temp (image.getFormat(), image.getWidth(), image.getHeight(), true);
 
-    ImageConvolutionKernel blurKernel (roundToInt (radius * 2.0f));
+    const int kernelSize = roundToInt (radius * 2.0f);
 
-    blurKernel.createGaussianBlur (radius);
-    blurKernel.rescaleAllValues (radius);
+    if (kernelSize > 0)
+    {
+        HeapBlock<float> kernel ((size_t) kernelSize);
+        ImageBlur::createGaussianKernel (kernel, kernelSize, radius);
 
-    blurKernel.applyToImage (temp, image, image.getBounds());
+        blur.applySeparableKernel (temp, image, image.getBounds(), kernel, kernel, kernelSize, radius);
+    }
 
     g.setColour (colour.withMultipliedAlpha (alpha));
     g.drawImageAt (temp, 0, 0, true);
@@ -27,6 +27,7 @@
 #define __JUCE_GLOWEFFECT_JUCEHEADER__
 
 #include "juce_ImageEffectFilter.h"
+#include "../images/juce_ImageBlur.h"
 
 
 //==============================================================================
@@ -69,6 +70,7 @@ private:
     //==============================================================================
     float radius;
     Colour colour;
+    ImageBlur blur;
 
     JUCE_LEAK_DETECTOR (GlowEffect);
 };
@@ -28,30 +28,59 @@ BEGIN_JUCE_NAMESPACE
 //==============================================================================
 AttributedString::AttributedString()
     : text (""),
+      numCharacters (0),
       lineSpacing (0.0f),
       textAlignment (AttributedString::left),
       wordWrap (AttributedString::byWord),
       readingDirection (AttributedString::natural)
 {
+    updateCharacters();
 }
 
 AttributedString::AttributedString (const String& newString)
     : text (newString),
+      numCharacters (0),
       lineSpacing (0.0f),
       textAlignment (AttributedString::left),
-      wordWrap (AttributedString::byWord)
+      wordWrap (AttributedString::byWord),
+      readingDirection (AttributedString::natural)
 {
+    updateCharacters();
 }
 
 AttributedString::~AttributedString()
 {
 }
 
-String AttributedString::getText() const
+void AttributedString::updateCharacters()
+{
+    numCharacters = text.length();
+    characters.malloc ((size_t) numCharacters + 1);
+    CharPointer_UTF32 (characters).writeAll (text.getCharPointer());
+}
+
+const String& AttributedString::getText() const noexcept
 {
     return text;
 }
 
+int AttributedString::getLength() const noexcept
+{
+    return numCharacters;
+}
+
+CharPointer_UTF32 AttributedString::getCharPointer (const int& index) const noexcept
+{
+    jassert (isPositiveAndNotGreaterThan (index, numCharacters));
+    return CharPointer_UTF32 (characters + jlimit (0, numCharacters, index));
+}
+
+String AttributedString::getSubstring (const Range<int>& range) const
+{
+    const Range<int> r (range.getIntersectionWith (Range<int> (0, numCharacters)));
+    return String (getCharPointer (r.getStart()), (size_t) r.getLength());
+}
+
 AttributedString::TextAlignment AttributedString::getTextAlignment() const
 {
     return textAlignment;
@@ -85,6 +114,7 @@ Attr* AttributedString::getCharAttribute (const int& index) const
 void AttributedString::setText (const String& other)
 {
     text = other;
+    updateCharacters();
 }
 
 void AttributedString::setTextAlignment (const TextAlignment& newTextAlignment)
@@ -132,7 +132,10 @@ public:
         rightToLeft,
     };
 
-    String getText() const;
+    const String& getText() const noexcept;
+    int getLength() const noexcept;
+    CharPointer_UTF32 getCharPointer (const int& index) const noexcept;
+    String getSubstring (const Range<int>& range) const;
     TextAlignment getTextAlignment() const;
     WordWrap getWordWrap() const;
     ReadingDirection getReadingDirection() const;
@@ -150,12 +153,18 @@ public:
 
 private:
     String text;
+    // A UTF-32 copy of the text, so that characters can be found by index in constant
+    // time and runs of them read without having to copy them out of the String.
+    HeapBlock<juce_wchar> characters;
+    int numCharacters;
     float lineSpacing;
     TextAlignment textAlignment;
     WordWrap wordWrap;
     ReadingDirection readingDirection;
     OwnedArray<Attr> charAttributes;
 
+    void updateCharacters();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AttributedString);
 };
 
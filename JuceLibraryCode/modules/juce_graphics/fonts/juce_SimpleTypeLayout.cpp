@@ -26,59 +26,6 @@
 BEGIN_JUCE_NAMESPACE
 
 //==============================================================================
-class SimpleTypeLayout::Token
-{
-public:
-    Token (const String& t, const Font& f, const Colour& c, const bool isWhitespace_)
-        : text (t),
-          font (f),
-          colour (c),
-          x(0),
-          y(0),
-          isWhitespace (isWhitespace_)
-    {
-        w = font.getStringWidth (t);
-        h = roundToInt (f.getHeight());
-        isNewLine = t.containsChar ('\n') || t.containsChar ('\r');
-    }
-
-    Token (const Token& other)
-        : text (other.text),
-          font (other.font),
-          colour (other.colour),
-          x (other.x),
-          y (other.y),
-          w (other.w),
-          h (other.h),
-          line (other.line),
-          lineHeight (other.lineHeight),
-          isWhitespace (other.isWhitespace),
-          isNewLine (other.isNewLine)
-    {
-    }
-
-    void draw (Graphics& g, const int xOffset, const int yOffset)
-    {
-        if (! isWhitespace)
-        {
-            g.setFont (font);
-            g.drawSingleLineText (text.trimEnd(), xOffset + x,
-                                  yOffset + y + (lineHeight - h)
-                                  + roundToInt (font.getAscent()));
-        }
-    }
-
-    String text;
-    Font font;
-    Colour colour;
-    int x, y, w, h;
-    int line, lineHeight;
-    bool isWhitespace, isNewLine;
-
-private:
-    JUCE_LEAK_DETECTOR (Token);
-};
-
 class SimpleTypeLayout::CharAttribute
 {
 public:
@@ -102,6 +49,7 @@ private:
 SimpleTypeLayout::SimpleTypeLayout() : totalLines (0)
 {
     tokens.ensureStorageAllocated (64);
+    positions.ensureStorageAllocated (64);
 }
 
 SimpleTypeLayout::~SimpleTypeLayout()
@@ -111,7 +59,12 @@ SimpleTypeLayout::~SimpleTypeLayout()
 
 void SimpleTypeLayout::clear()
 {
-    tokens.clear();
+    characters.clearQuick();
+    glyphs.clearQuick();
+    advances.clearQuick();
+    runs.clear();
+    tokens.clearQuick();
+    positions.clearQuick();
     totalLines = 0;
 }
 
@@ -119,16 +72,41 @@ void SimpleTypeLayout::appendText (const AttributedString& text,
                                    const Range<int>& stringRange, const Font& font,
                                    const Colour& colour)
 {
-    String stringText = text.getText().substring(stringRange.getStart(), stringRange.getEnd());
-    String::CharPointerType t (stringText.getCharPointer());
-    String currentString;
+    const Range<int> range (stringRange.getIntersectionWith (Range<int> (0, text.getLength())));
+
+    if (range.isEmpty())
+        return;
+
+    const int runStart = characters.size();
+    const int runEnd = runStart + range.getLength();
+    characters.addArray (static_cast <const juce_wchar*> (text.getCharPointer (range.getStart()).getAddress()),
+                         range.getLength());
+
+    // Measure the whole run in one go, and keep the glyphs so that getGlyphLayout()
+    // doesn't need to ask the font about each token again.
+    Array <int> newGlyphs;
+    Array <float> xOffsets;
+    font.getGlyphPositions (getTokenText (runStart, runEnd), newGlyphs, xOffsets);
+
+    const Run run = { font, colour, newGlyphs.size() == range.getLength() };
+    const int runIndex = runs.size();
+    runs.add (run);
+
+    glyphs.ensureStorageAllocated (runEnd);
+    advances.ensureStorageAllocated (runEnd);
+
+    for (int i = 0; i < range.getLength(); ++i)
+    {
+        glyphs.add (run.hasGlyphs ? newGlyphs.getUnchecked (i) : 0);
+        advances.add (run.hasGlyphs ? xOffsets.getUnchecked (i + 1) - xOffsets.getUnchecked (i) : 0.0f);
+    }
+
+    int tokenStart = runStart;
     int lastCharType = 0;
 
-    for (;;)
+    for (int i = runStart; i < runEnd; ++i)
     {
-        const juce_wchar c = t.getAndAdvance();
-        if (c == 0)
-            break;
+        const juce_wchar c = characters.getUnchecked (i);
 
         int charType;
         if (c == '\r' || c == '\n')
@@ -146,27 +124,53 @@ void SimpleTypeLayout::appendText (const AttributedString& text,
 
         if (charType == 0 || charType != lastCharType)
         {
-            if (currentString.isNotEmpty())
-            {
-                tokens.add (new Token (currentString, font, colour,
-                                       lastCharType == 2 || lastCharType == 0));
-            }
+            if (tokenStart < i)
+                addToken (tokenStart, i, runIndex, lastCharType == 2 || lastCharType == 0);
 
-            currentString = String::charToString (c);
+            tokenStart = i;
 
-            if (c == '\r' && *t == '\n')
-                currentString += t.getAndAdvance();
-        }
-        else
-        {
-            currentString += c;
+            if (c == '\r' && i + 1 < runEnd && characters.getUnchecked (i + 1) == '\n')
+                ++i;
         }
 
         lastCharType = charType;
     }
 
-    if (currentString.isNotEmpty())
-        tokens.add (new Token (currentString, font, colour, lastCharType == 2));
+    if (tokenStart < runEnd)
+        addToken (tokenStart, runEnd, runIndex, lastCharType == 2);
+}
+
+void SimpleTypeLayout::addToken (const int start, const int end, const int run, const bool isWhitespace)
+{
+    const Run& r = runs.getReference (run);
+    const juce_wchar firstChar = characters.getUnchecked (start);
+
+    const Token token = { start, end, run, isWhitespace, firstChar == '\n' || firstChar == '\r' };
+    tokens.add (token);
+
+    int w;
+
+    if (r.hasGlyphs)
+    {
+        float total = 0;
+
+        for (int i = start; i < end; ++i)
+            total += advances.getUnchecked (i);
+
+        w = roundToInt (total);
+    }
+    else
+    {
+        w = r.font.getStringWidth (getTokenText (start, end));
+    }
+
+    const TokenPosition position = { 0, 0, w, roundToInt (r.font.getHeight()), 0, 0 };
+    positions.add (position);
+}
+
+String SimpleTypeLayout::getTokenText (const int start, const int end) const
+{
+    return String (CharPointer_UTF32 (&characters.getReference (start)), (size_t) (end - start));
 }
 
 void SimpleTypeLayout::layout (const int& maxWidth)
@@ -179,27 +183,26 @@ void SimpleTypeLayout::layout (const int& maxWidth)
 
     for (i = 0; i < tokens.size(); ++i)
     {
-        Token* const t = tokens.getUnchecked(i);
-        t->x = x;
-        t->y = y;
-        t->line = totalLines;
-        x += t->w;
-        h = jmax (h, t->h);
-
-        const Token* nextTok = tokens[i + 1];
-
-        if (nextTok == 0)
+        TokenPosition& p = positions.getReference (i);
+        p.x = x;
+        p.y = y;
+        p.line = totalLines;
+        x += p.w;
+        h = jmax (h, p.h);
+
+        if (i + 1 >= tokens.size())
             break;
 
-        if (t->isNewLine || ((! nextTok->isWhitespace) && x + nextTok->w > maxWidth))
+        if (tokens.getReference (i).isNewLine
+             || ((! tokens.getReference (i + 1).isWhitespace) && x + positions.getReference (i + 1).w > maxWidth))
         {
             // finished a line, so go back and update the heights of the things on it
             for (int j = i; j >= 0; --j)
             {
-                Token* const tok = tokens.getUnchecked (j);
+                TokenPosition& pos = positions.getReference (j);
 
-                if (tok->line == totalLines)
-                    tok->lineHeight = h;
+                if (pos.line == totalLines)
+                    pos.lineHeight = h;
                 else
                     break;
             }
@@ -214,10 +217,10 @@ void SimpleTypeLayout::layout (const int& maxWidth)
     // finished a line, so go back and update the heights of the things on it
     for (int j = jmin (i, tokens.size() - 1); j >= 0; --j)
     {
-        Token* const t = tokens.getUnchecked (j);
+        TokenPosition& pos = positions.getReference (j);
 
-        if (t->line == totalLines)
-            t->lineHeight = h;
+        if (pos.line == totalLines)
+            pos.lineHeight = h;
         else
             break;
     }
@@ -231,10 +234,10 @@ int SimpleTypeLayout::getLineWidth (const int& lineNumber) const
 
     for (int i = tokens.size(); --i >= 0;)
     {
-        const Token* const t = tokens.getUnchecked (i);
+        const TokenPosition& p = positions.getReference (i);
 
-        if (t->line == lineNumber && ! t->isWhitespace)
-            maxW = jmax (maxW, t->x + t->w);
+        if (p.line == lineNumber && ! tokens.getReference (i).isWhitespace)
+            maxW = jmax (maxW, p.x + p.w);
     }
 
     return maxW;
@@ -246,9 +249,11 @@ int SimpleTypeLayout::getWidth() const
 
     for (int i = tokens.size(); --i >= 0;)
     {
-        const Token* const t = tokens.getUnchecked(i);
-        if (! t->isWhitespace)
-            maxW = jmax (maxW, t->x + t->w);
+        if (! tokens.getReference (i).isWhitespace)
+        {
+            const TokenPosition& p = positions.getReference (i);
+            maxW = jmax (maxW, p.x + p.w);
+        }
     }
 
     return maxW;
@@ -263,7 +268,7 @@ int SimpleTypeLayout::getNumLines() const
 void SimpleTypeLayout::getGlyphLayout (const AttributedString& text, GlyphLayout& glyphLayout)
 {
     clear();
-    int stringLength = text.getText().length();
+    int stringLength = text.getLength();
     int numCharacterAttributes = text.getCharAttributesSize();
     int rangeStart = 0;
     // Character attributes are applied as a series of ranges. These ranges may overlap or there may
@@ -347,34 +352,48 @@ void SimpleTypeLayout::getGlyphLayout (const AttributedString& text, GlyphLayout
     GlyphRun* glyphRun = new GlyphRun();
     for (int i = 0; i < tokens.size(); ++i)
     {
-        const Token* const t = tokens.getUnchecked (i);
+        const Token& t = tokens.getReference (i);
+        const TokenPosition& p = positions.getReference (i);
+        const Run& run = runs.getReference (t.run);
         // See TextLayout::draw
-        const float xOffset = (float) t->x;
-        const float yOffset = (float) t->y;
-        // See GlyphArrangement::addCurtailedLineOfText
+        const float xOffset = (float) p.x;
+        const float yOffset = (float) p.y;
+        // Trim trailing whitespace from the token
+        int end = t.end;
+        while (end > t.start && CharacterFunctions::isWhitespace (characters.getUnchecked (end - 1)))
+            --end;
+        // Use the glyphs that were measured for the whole run, unless the font couldn't
+        // produce one glyph per character, in which case measure this token on its own
         Array <int> newGlyphs;
         Array <float> xOffsets;
-        t->font.getGlyphPositions (t->text.trimEnd(), newGlyphs, xOffsets);
+        if (! run.hasGlyphs && end > t.start)
+            run.font.getGlyphPositions (getTokenText (t.start, end), newGlyphs, xOffsets);
+        const int numGlyphs = run.hasGlyphs ? end - t.start : newGlyphs.size();
         // Resize glyph run array
-        glyphRun->setNumGlyphs (glyphRun->getNumGlyphs() + newGlyphs.size());
+        glyphRun->setNumGlyphs (glyphRun->getNumGlyphs() + numGlyphs);
         // Add each glyph in the token to the current GlyphRun
-        for (int j = 0; j < newGlyphs.size(); ++j)
+        float thisX = 0;
+        for (int j = 0; j < numGlyphs; ++j)
         {
-            const float thisX = xOffsets.getUnchecked (j);
+            if (! run.hasGlyphs)
+                thisX = xOffsets.getUnchecked (j);
             // Check if this is the first character in the line
             if (charPosition == lineStartPosition)
             {
                 // Save line offset data
-                Point<float> origin (xOffset, yOffset + t->font.getAscent());
+                Point<float> origin (xOffset, yOffset + run.font.getAscent());
                 glyphLine->setLineOrigin (origin);
             }
             float xPos = glyphLayout.getX() + glyphLine->getLineOrigin().getX() + xOffset + thisX;
             float yPos = glyphLayout.getY() + glyphLine->getLineOrigin().getY();
-            Glyph* glyph = new Glyph (newGlyphs.getUnchecked(j), xPos, yPos);
+            Glyph* glyph = new Glyph (run.hasGlyphs ? glyphs.getUnchecked (t.start + j)
+                                                    : newGlyphs.getUnchecked (j), xPos, yPos);
             glyphRun->addGlyph (glyph);
+            if (run.hasGlyphs)
+                thisX += advances.getUnchecked (t.start + j);
             charPosition++;
         }
-        if (t->isWhitespace || t->isNewLine)
+        if (t.isWhitespace || t.isNewLine)
             ++charPosition;
         // We have reached the end of a token, we may need to create a new run or line
         if (i + 1 == tokens.size())
@@ -383,11 +402,11 @@ void SimpleTypeLayout::getGlyphLayout (const AttributedString& text, GlyphLayout
             // Close GlyphRun
             Range<int> runRange (runStartPosition, charPosition);
             glyphRun->setStringRange (runRange);
-            glyphRun->setFont (t->font);
-            glyphRun->setColour (t->colour);
+            glyphRun->setFont (run.font);
+            glyphRun->setColour (run.colour);
             // Check if run descent is the largest in the line
-            if (t->font.getDescent() > glyphLine->getDescent())
-                glyphLine->setDescent (t->font.getDescent());
+            if (run.font.getDescent() > glyphLine->getDescent())
+                glyphLine->setDescent (run.font.getDescent());
             glyphLine->addGlyphRun (glyphRun);
             // Close GlyphLine
             Range<int> lineRange (lineStartPosition, charPosition);
@@ -397,34 +416,34 @@ void SimpleTypeLayout::getGlyphLayout (const AttributedString& text, GlyphLayout
         else
         {
             // We have not yet reached the last token
-            const Token* const nextt = tokens.getUnchecked (i+1);
-            if (t->font != nextt->font || t->colour != nextt->colour)
+            const Run& nextRun = runs.getReference (tokens.getReference (i + 1).run);
+            if (run.font != nextRun.font || run.colour != nextRun.colour)
             {
                 //The next token has a new font or new colour
                 // Close GlyphRun
                 Range<int> runRange (runStartPosition, charPosition);
                 glyphRun->setStringRange (runRange);
-                glyphRun->setFont (t->font);
-                glyphRun->setColour (t->colour);
+                glyphRun->setFont (run.font);
+                glyphRun->setColour (run.colour);
                 // Check if run descent is the largest in the line
-                if (t->font.getDescent() > glyphLine->getDescent())
-                    glyphLine->setDescent (t->font.getDescent());
+                if (run.font.getDescent() > glyphLine->getDescent())
+                    glyphLine->setDescent (run.font.getDescent());
                 glyphLine->addGlyphRun (glyphRun);
                 // Create the next GlyphRun
                 runStartPosition = charPosition;
                 glyphRun = new GlyphRun();
             }
-            if (t->line != nextt->line)
+            if (p.line != positions.getReference (i + 1).line)
             {
                 // The next token is in a new line
                 // Close GlyphRun
                 Range<int> runRange (runStartPosition, charPosition);
                 glyphRun->setStringRange (runRange);
-                glyphRun->setFont (t->font);
-                glyphRun->setColour (t->colour);
+                glyphRun->setFont (run.font);
+                glyphRun->setColour (run.colour);
                 // Check if run descent is the largest in the line
-                if (t->font.getDescent() > glyphLine->getDescent())
-                    glyphLine->setDescent (t->font.getDescent());
+                if (run.font.getDescent() > glyphLine->getDescent())
+                    glyphLine->setDescent (run.font.getDescent());
                 glyphLine->addGlyphRun (glyphRun);
                 // Close GlyphLine
                 Range<int> lineRange (lineStartPosition, charPosition);
@@ -44,13 +44,40 @@ public:
     void getGlyphLayout (const AttributedString& text, GlyphLayout& glyphLayout);
 
 private:
-    class Token;
+    struct Run
+    {
+        Font font;
+        Colour colour;
+        bool hasGlyphs;
+    };
+
+    struct Token
+    {
+        int start, end, run;
+        bool isWhitespace, isNewLine;
+    };
+
+    struct TokenPosition
+    {
+        int x, y, w, h, line, lineHeight;
+    };
+
     class CharAttribute;
     class RunAttribute;
-    friend class OwnedArray <Token>;
-    OwnedArray<Token> tokens;
+
+    // Tokens are spans of the characters array, with their geometry kept in the
+    // parallel positions array and their font and colour referenced by run index.
+    Array <juce_wchar> characters;
+    Array <int> glyphs;
+    Array <float> advances;
+    Array <Run> runs;
+    Array <Token> tokens;
+    Array <TokenPosition> positions;
     int totalLines;
 
+    void addToken (int start, int end, int run, bool isWhitespace);
+    String getTokenText (int start, int end) const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleTypeLayout);
 };
 
@@ -25,74 +25,19 @@
 
 BEGIN_JUCE_NAMESPACE
 
-//==============================================================================
-class TextLayout::Token
-{
-public:
-    Token (const String& t,
-           const Font& f,
-           const bool isWhitespace_)
-        : text (t),
-          font (f),
-          x(0),
-          y(0),
-          isWhitespace (isWhitespace_)
-    {
-        w = font.getStringWidth (t);
-        h = roundToInt (f.getHeight());
-        isNewLine = t.containsChar ('\n') || t.containsChar ('\r');
-    }
-
-    Token (const Token& other)
-        : text (other.text),
-          font (other.font),
-          x (other.x),
-          y (other.y),
-          w (other.w),
-          h (other.h),
-          line (other.line),
-          lineHeight (other.lineHeight),
-          isWhitespace (other.isWhitespace),
-          isNewLine (other.isNewLine)
-    {
-    }
-
-    void draw (Graphics& g,
-               const int xOffset,
-               const int yOffset)
-    {
-        if (! isWhitespace)
-        {
-            g.setFont (font);
-            g.drawSingleLineText (text.trimEnd(),
-                                  xOffset + x,
-                                  yOffset + y + (lineHeight - h)
-                                    + roundToInt (font.getAscent()));
-        }
-    }
-
-    String text;
-    Font font;
-    int x, y, w, h;
-    int line, lineHeight;
-    bool isWhitespace, isNewLine;
-
-private:
-    JUCE_LEAK_DETECTOR (Token);
-};
-
-
 //==============================================================================
 TextLayout::TextLayout()
     : totalLines (0)
 {
     tokens.ensureStorageAllocated (64);
+    positions.ensureStorageAllocated (64);
 }
 
 TextLayout::TextLayout (const String& text, const Font& font)
     : totalLines (0)
 {
     tokens.ensureStorageAllocated (64);
+    positions.ensureStorageAllocated (64);
     appendText (text, font);
 }
 
@@ -106,10 +51,13 @@ TextLayout& TextLayout::operator= (const TextLayout& other)
 {
     if (this != &other)
     {
-        clear();
-
+        characters = other.characters;
+        glyphs = other.glyphs;
+        advances = other.advances;
+        runs = other.runs;
+        tokens = other.tokens;
+        positions = other.positions;
         totalLines = other.totalLines;
-        tokens.addCopiesOf (other.tokens);
     }
 
     return *this;
@@ -123,7 +71,12 @@ TextLayout::~TextLayout()
 //==============================================================================
 void TextLayout::clear()
 {
+    characters.clear();
+    glyphs.clear();
+    advances.clear();
+    runs.clear();
     tokens.clear();
+    positions.clear();
     totalLines = 0;
 }
 
@@ -134,15 +87,40 @@ bool TextLayout::isEmpty() const
 
 void TextLayout::appendText (const String& text, const Font& font)
 {
-    String::CharPointerType t (text.getCharPointer());
-    String currentString;
+    const int runStart = characters.size();
+
+    for (String::CharPointerType t (text.getCharPointer()); ! t.isEmpty();)
+        characters.add (t.getAndAdvance());
+
+    const int runEnd = characters.size();
+
+    if (runEnd == runStart)
+        return;
+
+    // measure the whole run in one go, rather than asking the font about each word
+    Array <int> newGlyphs;
+    Array <float> xOffsets;
+    font.getGlyphPositions (text, newGlyphs, xOffsets);
+
+    const Run run = { font, newGlyphs.size() == runEnd - runStart };
+    const int runIndex = runs.size();
+    runs.add (run);
+
+    glyphs.ensureStorageAllocated (runEnd);
+    advances.ensureStorageAllocated (runEnd);
+
+    for (int i = 0; i < runEnd - runStart; ++i)
+    {
+        glyphs.add (run.hasGlyphs ? newGlyphs.getUnchecked (i) : 0);
+        advances.add (run.hasGlyphs ? xOffsets.getUnchecked (i + 1) - xOffsets.getUnchecked (i) : 0.0f);
+    }
+
+    int tokenStart = runStart;
     int lastCharType = 0;
 
-    for (;;)
+    for (int i = runStart; i < runEnd; ++i)
     {
-        const juce_wchar c = t.getAndAdvance();
-        if (c == 0)
-            break;
+        const juce_wchar c = characters.getUnchecked (i);
 
         int charType;
         if (c == '\r' || c == '\n')
@@ -160,27 +138,46 @@ void TextLayout::appendText (const String& text, const Font& font)
 
         if (charType == 0 || charType != lastCharType)
         {
-            if (currentString.isNotEmpty())
-            {
-                tokens.add (new Token (currentString, font,
-                                       lastCharType == 2 || lastCharType == 0));
-            }
+            if (tokenStart < i)
+                addToken (tokenStart, i, runIndex, lastCharType == 2 || lastCharType == 0);
 
-            currentString = String::charToString (c);
+            tokenStart = i;
 
-            if (c == '\r' && *t == '\n')
-                currentString += t.getAndAdvance();
-        }
-        else
-        {
-            currentString += c;
+            if (c == '\r' && i + 1 < runEnd && characters.getUnchecked (i + 1) == '\n')
+                ++i;
         }
 
         lastCharType = charType;
     }
 
-    if (currentString.isNotEmpty())
-        tokens.add (new Token (currentString, font, lastCharType == 2));
+    if (tokenStart < runEnd)
+        addToken (tokenStart, runEnd, runIndex, lastCharType == 2);
+}
+
+void TextLayout::addToken (const int start, const int end, const int run, const bool isWhitespace)
+{
+    const Run& r = runs.getReference (run);
+    const juce_wchar firstChar = characters.getUnchecked (start);
+
+    const Token token = { start, end, run, isWhitespace, firstChar == '\n' || firstChar == '\r' };
+    tokens.add (token);
+
+    const TokenPosition position = { 0, 0, getTokenWidth (start, end, r), roundToInt (r.font.getHeight()), 0, 0 };
+    positions.add (position);
+}
+
+int TextLayout::getTokenWidth (const int start, const int end, const Run& run) const
+{
+    if (! run.hasGlyphs)
+        return run.font.getStringWidth (String (CharPointer_UTF32 (&characters.getReference (start)),
+                                                (size_t) (end - start)));
+
+    float w = 0;
+
+    for (int i = start; i < end; ++i)
+        w += advances.getUnchecked (i);
+
+    return roundToInt (w);
 }
 
 void TextLayout::setText (const String& text, const Font& font)
@@ -236,27 +233,26 @@ void TextLayout::layout (int maxWidth,
 
         for (i = 0; i < tokens.size(); ++i)
         {
-            Token* const t = tokens.getUnchecked(i);
-            t->x = x;
-            t->y = y;
-            t->line = totalLines;
-            x += t->w;
-            h = jmax (h, t->h);
-
-            const Token* nextTok = tokens [i + 1];
-
-            if (nextTok == 0)
+            TokenPosition& p = positions.getReference (i);
+            p.x = x;
+            p.y = y;
+            p.line = totalLines;
+            x += p.w;
+            h = jmax (h, p.h);
+
+            if (i + 1 >= tokens.size())
                 break;
 
-            if (t->isNewLine || ((! nextTok->isWhitespace) && x + nextTok->w > maxWidth))
+            if (tokens.getReference (i).isNewLine
+                 || ((! tokens.getReference (i + 1).isWhitespace) && x + positions.getReference (i + 1).w > maxWidth))
             {
                 // finished a line, so go back and update the heights of the things on it
                 for (int j = i; j >= 0; --j)
                 {
-                    Token* const tok = tokens.getUnchecked(j);
+                    TokenPosition& pos = positions.getReference (j);
 
-                    if (tok->line == totalLines)
-                        tok->lineHeight = h;
+                    if (pos.line == totalLines)
+                        pos.lineHeight = h;
                     else
                         break;
                 }
@@ -271,10 +267,10 @@ void TextLayout::layout (int maxWidth,
         // finished a line, so go back and update the heights of the things on it
         for (int j = jmin (i, tokens.size() - 1); j >= 0; --j)
         {
-            Token* const t = tokens.getUnchecked(j);
+            TokenPosition& pos = positions.getReference (j);
 
-            if (t->line == totalLines)
-                t->lineHeight = h;
+            if (pos.line == totalLines)
+                pos.lineHeight = h;
             else
                 break;
         }
@@ -295,12 +291,12 @@ void TextLayout::layout (int maxWidth,
                 else if (justification.testFlags (Justification::right))
                     dx = totalW - lineW;
 
-                for (int j = tokens.size(); --j >= 0;)
+                for (int j = positions.size(); --j >= 0;)
                 {
-                    Token* const t = tokens.getUnchecked(j);
+                    TokenPosition& p = positions.getReference (j);
 
-                    if (t->line == i)
-                        t->x += dx;
+                    if (p.line == i)
+                        p.x += dx;
                 }
             }
         }
@@ -314,10 +310,10 @@ int TextLayout::getLineWidth (const int lineNumber) const
 
     for (int i = tokens.size(); --i >= 0;)
     {
-        const Token* const t = tokens.getUnchecked(i);
+        const TokenPosition& p = positions.getReference (i);
 
-        if (t->line == lineNumber && ! t->isWhitespace)
-            maxW = jmax (maxW, t->x + t->w);
+        if (p.line == lineNumber && ! tokens.getReference (i).isWhitespace)
+            maxW = jmax (maxW, p.x + p.w);
     }
 
     return maxW;
@@ -329,9 +325,11 @@ int TextLayout::getWidth() const
 
     for (int i = tokens.size(); --i >= 0;)
     {
-        const Token* const t = tokens.getUnchecked(i);
-        if (! t->isWhitespace)
-            maxW = jmax (maxW, t->x + t->w);
+        if (! tokens.getReference (i).isWhitespace)
+        {
+            const TokenPosition& p = positions.getReference (i);
+            maxW = jmax (maxW, p.x + p.w);
+        }
     }
 
     return maxW;
@@ -343,10 +341,11 @@ int TextLayout::getHeight() const
 
     for (int i = tokens.size(); --i >= 0;)
     {
-        const Token* const t = tokens.getUnchecked(i);
-
-        if (! t->isWhitespace)
-            maxH = jmax (maxH, t->y + t->h);
+        if (! tokens.getReference (i).isWhitespace)
+        {
+            const TokenPosition& p = positions.getReference (i);
+            maxH = jmax (maxH, p.y + p.h);
+        }
     }
 
     return maxH;
@@ -357,8 +356,48 @@ void TextLayout::draw (Graphics& g,
                        const int xOffset,
                        const int yOffset) const
 {
+    const int clipRight = g.getClipBounds().getRight();
+    GlyphArrangement arr;
+
     for (int i = tokens.size(); --i >= 0;)
-        tokens.getUnchecked(i)->draw (g, xOffset, yOffset);
+    {
+        const Token& t = tokens.getReference (i);
+        const TokenPosition& p = positions.getReference (i);
+        const int startX = xOffset + p.x;
+
+        if (t.isWhitespace || startX >= clipRight)
+            continue;
+
+        const Run& run = runs.getReference (t.run);
+        const float baselineY = (float) (yOffset + p.y + (p.lineHeight - p.h) + roundToInt (run.font.getAscent()));
+
+        int end = t.end;
+        while (end > t.start && CharacterFunctions::isWhitespace (characters.getUnchecked (end - 1)))
+            --end;
+
+        if (run.hasGlyphs)
+        {
+            float x = (float) startX;
+
+            for (int j = t.start; j < end; ++j)
+            {
+                const juce_wchar c = characters.getUnchecked (j);
+                const float w = advances.getUnchecked (j);
+
+                arr.addGlyph (PositionedGlyph (run.font, c, glyphs.getUnchecked (j), x, baselineY,
+                                               w, CharacterFunctions::isWhitespace (c)));
+                x += w;
+            }
+        }
+        else if (end > t.start)
+        {
+            arr.addLineOfText (run.font, String (CharPointer_UTF32 (&characters.getReference (t.start)),
+                                                 (size_t) (end - t.start)),
+                               (float) startX, baselineY);
+        }
+    }
+
+    arr.draw (g);
 }
 
 void TextLayout::drawWithin (Graphics& g,
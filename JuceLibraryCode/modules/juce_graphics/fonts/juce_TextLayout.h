@@ -141,11 +141,38 @@ public:
 
 private:
     //==============================================================================
-    class Token;
-    friend class OwnedArray <Token>;
-    OwnedArray <Token> tokens;
+    struct Run
+    {
+        Font font;
+        bool hasGlyphs;
+    };
+
+    struct Token
+    {
+        int start, end, run;
+        bool isWhitespace, isNewLine;
+    };
+
+    struct TokenPosition
+    {
+        int x, y, w, h, line, lineHeight;
+    };
+
+    /* The appended text is kept as one block of characters, along with the glyphs
+       and advances that the font measured for each of them. Tokens are just spans
+       of this block, and their geometry lives in the parallel positions array.
+    */
+    Array <juce_wchar> characters;
+    Array <int> glyphs;
+    Array <float> advances;
+    Array <Run> runs;
+    Array <Token> tokens;
+    Array <TokenPosition> positions;
     int totalLines;
 
+    void addToken (int start, int end, int run, bool isWhitespace);
+    int getTokenWidth (int start, int end, const Run& run) const;
+
     JUCE_LEAK_DETECTOR (TextLayout);
 };
 
@@ -236,10 +236,20 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
 {
 #if (JUCE_MAC || JUCE_IOS) && USE_COREGRAPHICS_RENDERING && JUCE_USE_COREIMAGE_LOADER
     return juce_loadWithCoreImage (in);
+#else
+    return decodeImageWithOptions (in, DecodeOptions());
+#endif
+}
+
+Image JPEGImageFormat::decodeImageWithOptions (InputStream& in, const DecodeOptions& options)
+{
+#if (JUCE_MAC || JUCE_IOS) && USE_COREGRAPHICS_RENDERING && JUCE_USE_COREIMAGE_LOADER
+    return ImageFileFormat::decodeImageWithOptions (in, options);
 #else
     using namespace jpeglibNamespace;
     using namespace JPEGHelpers;
 
+    const int64 streamStart = in.getPosition();
     MemoryOutputStream mb;
     mb << in;
 
@@ -271,13 +281,19 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
         {
             jpeg_read_header (&jpegDecompStruct, TRUE);
 
+            // If the options allow a smaller image, the decoder can scale it down while it's
+            // doing the inverse DCT, which is much quicker than decoding at full size.
+            const int scale = options.getReductionFactor ((int) jpegDecompStruct.image_width,
+                                                          (int) jpegDecompStruct.image_height);
+            jpegDecompStruct.scale_num = 1;
+            jpegDecompStruct.scale_denom = (unsigned int) scale;
+            jpegDecompStruct.out_color_space = JCS_RGB;
+
             jpeg_calc_output_dimensions (&jpegDecompStruct);
 
             const int width  = (int) jpegDecompStruct.output_width;
             const int height = (int) jpegDecompStruct.output_height;
 
-            jpegDecompStruct.out_color_space = JCS_RGB;
-
             JSAMPARRAY buffer
                 = (*jpegDecompStruct.mem->alloc_sarray) ((j_common_ptr) &jpegDecompStruct,
                                                          JPOOL_IMAGE,
@@ -285,43 +301,31 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
 
             if (jpeg_start_decompress (&jpegDecompStruct))
             {
-                image = Image (Image::RGB, width, height, false);
-                image.getProperties()->set ("originalImageHadAlpha", false);
-                const bool hasAlphaChan = image.hasAlphaChannel(); // (the native image creator may not give back what we expect)
+                DecodedImageBuilder builder (options, width, height, scale, false);
+                int y = 0;
 
-                const Image::BitmapData destData (image, Image::BitmapData::writeOnly);
-
-                for (int y = 0; y < height; ++y)
+                for (; y < height && ! (builder.isComplete() || options.isCancelled()); ++y)
                 {
                     jpeg_read_scanlines (&jpegDecompStruct, buffer, 1);
-
-                    const uint8* src = *buffer;
-                    uint8* dest = destData.getLinePointer (y);
-
-                    if (hasAlphaChan)
-                    {
-                        for (int i = width; --i >= 0;)
-                        {
-                            ((PixelARGB*) dest)->setARGB (0xff, src[0], src[1], src[2]);
-                            ((PixelARGB*) dest)->premultiply();
-                            dest += destData.pixelStride;
-                            src += 3;
-                        }
-                    }
-                    else
-                    {
-                        for (int i = width; --i >= 0;)
-                        {
-                            ((PixelRGB*) dest)->setARGB (0xff, src[0], src[1], src[2]);
-                            dest += destData.pixelStride;
-                            src += 3;
-                        }
-                    }
+                    builder.addRGBRow (y, *buffer);
                 }
 
-                jpeg_finish_decompress (&jpegDecompStruct);
+                if (! options.isCancelled())
+                    image = builder.getImage();
 
-                in.setPosition (((char*) jpegDecompStruct.src->next_input_byte) - (char*) mb.getData());
+                if (y == height)
+                {
+                    jpeg_finish_decompress (&jpegDecompStruct);
+                    in.setPosition (streamStart + (((char*) jpegDecompStruct.src->next_input_byte) - (char*) mb.getData()));
+                }
+                else
+                {
+                    // (the rows below the area that was asked for don't need decoding, but as
+                    // it's not known where the image data ends, the stream is put back to where
+                    // it started)
+                    jpeg_abort_decompress (&jpegDecompStruct);
+                    in.setPosition (streamStart);
+                }
             }
 
             jpeg_destroy_decompress (&jpegDecompStruct);
@@ -149,10 +149,22 @@ Image PNGImageFormat::decodeImage (InputStream& in)
 {
 #if (JUCE_MAC || JUCE_IOS) && USE_COREGRAPHICS_RENDERING && JUCE_USE_COREIMAGE_LOADER
     return juce_loadWithCoreImage (in);
+#else
+    return decodeImageWithOptions (in, DecodeOptions());
+#endif
+}
+
+Image PNGImageFormat::decodeImageWithOptions (InputStream& in, const DecodeOptions& options)
+{
+#if (JUCE_MAC || JUCE_IOS) && USE_COREGRAPHICS_RENDERING && JUCE_USE_COREIMAGE_LOADER
+    return ImageFileFormat::decodeImageWithOptions (in, options);
 #else
     using namespace pnglibNamespace;
     Image image;
 
+    const int64 streamStart = in.getPosition();
+    bool readToEnd = false;
+
     png_structp pngReadStruct;
     png_infop pngInfoStruct;
 
@@ -202,71 +214,95 @@ Image PNGImageFormat::decodeImage (InputStream& in)
 
             png_set_add_alpha (pngReadStruct, 0xff, PNG_FILLER_AFTER);
 
-            bool hasAlphaChan = (colorType & PNG_COLOR_MASK_ALPHA) != 0
-                                  || pngInfoStruct->num_trans > 0;
+            const bool hasAlphaChan = (colorType & PNG_COLOR_MASK_ALPHA) != 0
+                                        || pngInfoStruct->num_trans > 0;
 
-            // Load the image into a temp buffer in the pnglib format..
-            HeapBlock <uint8> tempBuffer (height * (width << 2));
+            DecodedImageBuilder builder (options, (int) width, (int) height, 1, hasAlphaChan);
 
+            if (interlaceType == PNG_INTERLACE_NONE)
             {
-                HeapBlock <png_bytep> rows (height);
-                for (int y = (int) height; --y >= 0;)
-                    rows[y] = (png_bytep) (tempBuffer + (width << 2) * y);
+                // Non-interlaced images can be read a row at a time, which avoids keeping a
+                // second copy of the whole image, and lets us stop early if only the top
+                // part of it is needed..
+                HeapBlock <uint8> row (width << 2);
+                int y = 0;
 
                 try
                 {
-                    png_read_image (pngReadStruct, rows);
-                    png_read_end (pngReadStruct, pngInfoStruct);
+                    for (; y < (int) height && ! (builder.isComplete() || options.isCancelled()); ++y)
+                    {
+                        png_read_row (pngReadStruct, (png_bytep) row.getData(), 0);
+                        builder.addRGBARow (y, row);
+                    }
+
+                    if (y == (int) height)
+                    {
+                        png_read_end (pngReadStruct, pngInfoStruct);
+                        readToEnd = true;
+                    }
                 }
                 catch (PNGHelpers::PNGErrorStruct&)
                 {}
             }
-
-            png_destroy_read_struct (&pngReadStruct, &pngInfoStruct, 0);
-
-            // now convert the data to a juce image format..
-            image = Image (hasAlphaChan ? Image::ARGB : Image::RGB,
-                           (int) width, (int) height, hasAlphaChan);
-
-            image.getProperties()->set ("originalImageHadAlpha", image.hasAlphaChannel());
-            hasAlphaChan = image.hasAlphaChannel(); // (the native image creator may not give back what we expect)
-
-            const Image::BitmapData destData (image, Image::BitmapData::writeOnly);
-            uint8* srcRow = tempBuffer;
-            uint8* destRow = destData.data;
-
-            for (int y = 0; y < (int) height; ++y)
+            else
             {
-                const uint8* src = srcRow;
-                srcRow += (width << 2);
-                uint8* dest = destRow;
-                destRow += destData.lineStride;
+                // ..but the passes of an interlaced one have to be read into a temp buffer
+                // in the pnglib format first.
+                HeapBlock <uint8> tempBuffer (height * (width << 2));
 
-                if (hasAlphaChan)
-                {
-                    for (int i = (int) width; --i >= 0;)
-                    {
-                        ((PixelARGB*) dest)->setARGB (src[3], src[0], src[1], src[2]);
-                        ((PixelARGB*) dest)->premultiply();
-                        dest += destData.pixelStride;
-                        src += 4;
-                    }
-                }
-                else
                 {
-                    for (int i = (int) width; --i >= 0;)
+                    HeapBlock <png_bytep> rows (height);
+                    for (int y = (int) height; --y >= 0;)
+                        rows[y] = (png_bytep) (tempBuffer + (width << 2) * y);
+
+                    try
                     {
-                        ((PixelRGB*) dest)->setARGB (0, src[0], src[1], src[2]);
-                        dest += destData.pixelStride;
-                        src += 4;
+                        // (this does the same as png_read_image(), but can be cancelled between rows)
+                        const int numPasses = png_set_interlace_handling (pngReadStruct);
+                        bool finishedAllPasses = true;
+
+                        for (int pass = 0; pass < numPasses && finishedAllPasses; ++pass)
+                        {
+                            for (int y = 0; y < (int) height; ++y)
+                            {
+                                if (options.isCancelled())
+                                {
+                                    finishedAllPasses = false;
+                                    break;
+                                }
+
+                                png_read_row (pngReadStruct, rows[y], 0);
+                            }
+                        }
+
+                        if (finishedAllPasses)
+                        {
+                            png_read_end (pngReadStruct, pngInfoStruct);
+                            readToEnd = true;
+                        }
                     }
+                    catch (PNGHelpers::PNGErrorStruct&)
+                    {}
                 }
+
+                for (int y = 0; y < (int) height && ! (builder.isComplete() || options.isCancelled()); ++y)
+                    builder.addRGBARow (y, tempBuffer + (width << 2) * y);
             }
+
+            png_destroy_read_struct (&pngReadStruct, &pngInfoStruct, 0);
+
+            if (! options.isCancelled())
+                image = builder.getImage();
         }
         catch (PNGHelpers::PNGErrorStruct&)
         {}
     }
 
+    // (if the decoder stopped early, it's not known where the image data ends, so the
+    // stream is put back to where it started)
+    if (! readToEnd)
+        in.setPosition (streamStart);
+
     return image;
 #endif
 }
@@ -111,6 +111,9 @@ public:
 
     void initialiseBitmapData (Image::BitmapData& bitmap, int x, int y, Image::BitmapData::ReadWriteMode mode)
     {
+        if (mode != Image::BitmapData::readOnly)
+            image->clearMipmaps();
+
         image->initialiseBitmapData (bitmap, x + area.getX(), y + area.getY(), mode);
     }
 
@@ -138,6 +141,40 @@ Image Image::getClippedImage (const Rectangle<int>& area) const
     return Image (new SubsectionSharedImage (image, validArea));
 }
 
+//==============================================================================
+void Image::createMipmaps()
+{
+    if (image == nullptr)
+        return;
+
+    image->clearMipmaps();
+
+    ImageResampler resampler (ImageResampler::boxFilter);
+    Image level (*this);
+
+    while (level.getWidth() > 1 || level.getHeight() > 1)
+    {
+        level = resampler.rescaled (level, jmax (1, level.getWidth() / 2), jmax (1, level.getHeight() / 2));
+        image->mipmaps.add (level.image);
+    }
+}
+
+int Image::getNumMipmaps() const noexcept
+{
+    return image == nullptr ? 0 : image->mipmaps.size();
+}
+
+Image Image::getMipmap (const int level) const
+{
+    if (level == 0)
+        return *this;
+
+    if (image == nullptr)
+        return Image::null;
+
+    return Image (image->mipmaps [level - 1]);
+}
+
 
 //==============================================================================
 Image::Image()
@@ -203,13 +240,8 @@ Image Image::rescaled (const int newWidth, const int newHeight, const Graphics::
     if (image == nullptr || (image->width == newWidth && image->height == newHeight))
         return *this;
 
-    Image newImage (image->format, newWidth, newHeight, hasAlphaChannel(), image->getType());
-
-    Graphics g (newImage);
-    g.setImageResamplingQuality (quality);
-    g.drawImage (*this, 0, 0, newWidth, newHeight, 0, 0, image->width, image->height, false);
-
-    return newImage;
+    ImageResampler resampler (ImageResampler::getFilterTypeFor (quality));
+    return resampler.rescaled (*this, newWidth, newHeight);
 }
 
 Image Image::convertedToFormat (PixelFormat newFormat) const
@@ -270,6 +302,9 @@ Image::BitmapData::BitmapData (Image& image, const int x, const int y, const int
     jassert (image.image != nullptr);
     jassert (x >= 0 && y >= 0 && w > 0 && h > 0 && x + w <= image.getWidth() && y + h <= image.getHeight());
 
+    if (mode != readOnly)
+        image.image->clearMipmaps();
+
     image.image->initialiseBitmapData (*this, x, y, mode);
     jassert (data != nullptr && pixelStride > 0 && lineStride != 0);
 }
@@ -293,6 +328,9 @@ Image::BitmapData::BitmapData (const Image& image, BitmapData::ReadWriteMode mod
     // The BitmapData class must be given a valid image!
     jassert (image.image != nullptr);
 
+    if (mode != readOnly)
+        image.image->clearMipmaps();
+
     image.image->initialiseBitmapData (*this, 0, 0, mode);
     jassert (data != nullptr && pixelStride > 0 && lineStride != 0);
 }
@@ -185,7 +185,10 @@ public:
 
     /** Returns a rescaled version of this image.
 
-        A new image is returned which is a copy of this one, rescaled to the given size.
+        A new image is returned which is a copy of this one, rescaled to the given size,
+        using an ImageResampler with the filter that ImageResampler::getFilterTypeFor()
+        picks for the quality you ask for. If you're rescaling a lot of images, it's more
+        efficient to keep an ImageResampler and use that directly.
 
         Note that if the new size is identical to the existing image, this will just return
         a reference to the original image, and won't actually create a duplicate.
@@ -228,6 +231,35 @@ public:
     */
     Image getClippedImage (const Rectangle<int>& area) const;
 
+    //==============================================================================
+    /** Creates a chain of reduced copies of this image, which Graphics::drawImage() will
+        use when the image is drawn at a much smaller size.
+
+        Each level is half the size of the one before it, down to a single pixel. Drawing
+        from the level nearest to the size that's needed is faster than drawing from the
+        full image, and avoids the aliasing that you'd otherwise get from a big reduction.
+
+        The chain is shared by all the Image objects that refer to this image, and is
+        thrown away as soon as the image's pixels are modified, so you'll need to call this
+        again after changing its contents.
+
+        @see getNumMipmaps, getMipmap
+    */
+    void createMipmaps();
+
+    /** Returns the number of reduced levels that createMipmaps() has made.
+        This will be 0 if there are none, or if they've been discarded because the image
+        has changed.
+    */
+    int getNumMipmaps() const noexcept;
+
+    /** Returns one of the levels made by createMipmaps().
+
+        Level 0 is this image itself, level 1 is half its size, and so on. If the level
+        doesn't exist, this returns a null image.
+    */
+    Image getMipmap (int level) const;
+
     //==============================================================================
     /** Returns the colour of one of the pixels in the image.
 
@@ -412,12 +444,16 @@ public:
         int getWidth() const noexcept                       { return width; }
         int getHeight() const noexcept                      { return height; }
 
+        /** Throws away any mipmaps that were made from this image's contents. */
+        void clearMipmaps()                                 { mipmaps.clear(); }
+
     protected:
         friend class Image;
         friend class BitmapData;
         const PixelFormat format;
         const int width, height;
         NamedValueSet userData;
+        ReferenceCountedArray<SharedImage> mipmaps;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedImage);
     };
@@ -0,0 +1,723 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+BEGIN_JUCE_NAMESPACE
+
+namespace ImageBlurHelpers
+{
+    // The width of the strips that the vertical passes work on. Each strip's running
+    // totals live on the stack, and the inner loops run along a row of the strip, so
+    // that the compiler can vectorise them.
+    enum { stripSize = 256 };
+
+    template <typename Type>
+    static Type* getBuffer (HeapBlock<Type>& buffer, size_t& allocatedSize, const size_t numNeeded)
+    {
+        if (numNeeded > allocatedSize)
+        {
+            buffer.malloc (numNeeded);
+            allocatedSize = numNeeded;
+        }
+
+        return buffer;
+    }
+
+    static inline uint8 floatToByte (const float value) noexcept
+    {
+        return value <= 0.0f ? 0 : (value >= 255.0f ? (uint8) 255 : (uint8) (value + 0.5f));
+    }
+
+    static void runBody (ParallelLoop::Body& body, const int start, const int end, ThreadPool* const pool)
+    {
+        if (pool != nullptr)
+            ParallelLoop::run (*pool, start, end, body);
+        else
+            body.processRange (start, end);
+    }
+
+    //==============================================================================
+    // Convolves rows of the source image with the horizontal kernel, writing the
+    // results as floats into a buffer that holds one row for each source line.
+    template <int numChannels>
+    class HorizontalKernelPass  : public ParallelLoop::Body
+    {
+    public:
+        HorizontalKernelPass (const Image::BitmapData& srcData_, const int x_, const int width_,
+                              const int firstLine_, const float* const kernel_, const int kernelSize_,
+                              float* const output_) noexcept
+            : srcData (srcData_), x (x_), width (width_), firstLine (firstLine_),
+              kernel (kernel_), kernelSize (kernelSize_), output (output_)
+        {
+        }
+
+        void processRange (const int rangeStart, const int rangeEnd)
+        {
+            const int centre = kernelSize >> 1;
+
+            for (int y = rangeStart; y < rangeEnd; ++y)
+            {
+                const uint8* const line = srcData.getLinePointer (y);
+                float* dest = output + (y - firstLine) * width * numChannels;
+
+                for (int i = 0; i < width; ++i)
+                {
+                    const int sx = x + i - centre;
+                    const int kernelStart = jmax (0, -sx);
+                    const int kernelEnd = jmin (kernelSize, srcData.width - sx);
+                    const uint8* src = line + (sx + kernelStart) * numChannels;
+
+                    float total [numChannels];
+
+                    for (int c = 0; c < numChannels; ++c)
+                        total[c] = 0;
+
+                    for (int k = kernelStart; k < kernelEnd; ++k)
+                    {
+                        const float kernelMult = kernel[k];
+
+                        for (int c = 0; c < numChannels; ++c)
+                            total[c] += kernelMult * src[c];
+
+                        src += numChannels;
+                    }
+
+                    for (int c = 0; c < numChannels; ++c)
+                        *dest++ = total[c];
+                }
+            }
+        }
+
+    private:
+        const Image::BitmapData& srcData;
+        const int x, width, firstLine;
+        const float* const kernel;
+        const int kernelSize;
+        float* const output;
+
+        JUCE_DECLARE_NON_COPYABLE (HorizontalKernelPass);
+    };
+
+    //==============================================================================
+    // Convolves the columns of the buffer made by HorizontalKernelPass with the vertical
+    // kernel, and writes the results to the destination image.
+    class VerticalKernelPass  : public ParallelLoop::Body
+    {
+    public:
+        VerticalKernelPass (const float* const input_, const int firstLine_, const int endLine_,
+                            const int valuesPerLine_, const Image::BitmapData& destData_, const int destY_,
+                            const float* const kernel_, const int kernelSize_, const float gain_) noexcept
+            : input (input_), firstLine (firstLine_), endLine (endLine_), valuesPerLine (valuesPerLine_),
+              destData (destData_), destY (destY_), kernel (kernel_), kernelSize (kernelSize_), gain (gain_)
+        {
+        }
+
+        void processRange (const int rangeStart, const int rangeEnd)
+        {
+            for (int i = rangeStart; i < rangeEnd; ++i)
+            {
+                const int sy = destY + i - (kernelSize >> 1);
+                const int kernelStart = jmax (0, firstLine - sy);
+                const int kernelEnd = jmin (kernelSize, endLine - sy);
+                uint8* const dest = destData.getLinePointer (i);
+
+                for (int start = 0; start < valuesPerLine; start += stripSize)
+                {
+                    const int num = jmin ((int) stripSize, valuesPerLine - start);
+                    float total [stripSize];
+
+                    for (int j = 0; j < num; ++j)
+                        total[j] = 0;
+
+                    for (int k = kernelStart; k < kernelEnd; ++k)
+                    {
+                        const float kernelMult = kernel[k] * gain;
+                        const float* const src = input + (sy + k - firstLine) * valuesPerLine + start;
+
+                        for (int j = 0; j < num; ++j)
+                            total[j] += kernelMult * src[j];
+                    }
+
+                    for (int j = 0; j < num; ++j)
+                        dest [start + j] = floatToByte (total[j]);
+                }
+            }
+        }
+
+    private:
+        const float* const input;
+        const int firstLine, endLine, valuesPerLine;
+        const Image::BitmapData& destData;
+        const int destY;
+        const float* const kernel;
+        const int kernelSize;
+        const float gain;
+
+        JUCE_DECLARE_NON_COPYABLE (VerticalKernelPass);
+    };
+
+    //==============================================================================
+    // Finds the sizes of three box filters that add up to roughly the same curve as a
+    // gaussian with the given standard deviation.
+    static void getBoxRadii (const float standardDeviation, int* const radii) noexcept
+    {
+        const double variance = standardDeviation * (double) standardDeviation;
+        int lowerSize = (int) std::sqrt (4.0 * variance + 1.0);
+
+        if ((lowerSize & 1) == 0)
+            --lowerSize;
+
+        const int numLower = roundToInt ((12.0 * variance - 3 * lowerSize * lowerSize - 12 * lowerSize - 9)
+                                           / (-4.0 * lowerSize - 4.0));
+
+        for (int i = 0; i < 3; ++i)
+            radii[i] = ((i < numLower ? lowerSize : lowerSize + 2) - 1) / 2;
+    }
+
+    static inline unsigned int getBoxScale (const int radius) noexcept
+    {
+        const unsigned int size = (unsigned int) (radius * 2 + 1);
+        return (65536 + size / 2) / size;
+    }
+
+    static inline uint8 scaleBoxTotal (const unsigned int total, const unsigned int scale) noexcept
+    {
+        return (uint8) jmin (255u, (total * scale + 0x8000) >> 16);
+    }
+
+    // Box-filters a line of pixels, treating anything beyond its ends as zero.
+    template <int numChannels>
+    static void boxFilterLine (const uint8* const src, uint8* const dest, const int numPixels, const int radius) noexcept
+    {
+        const unsigned int scale = getBoxScale (radius);
+        unsigned int total [numChannels];
+
+        for (int c = 0; c < numChannels; ++c)
+            total[c] = 0;
+
+        for (int i = jmin (radius, numPixels); --i >= 0;)
+            for (int c = 0; c < numChannels; ++c)
+                total[c] += src [i * numChannels + c];
+
+        for (int i = 0; i < numPixels; ++i)
+        {
+            if (i + radius < numPixels)
+                for (int c = 0; c < numChannels; ++c)
+                    total[c] += src [(i + radius) * numChannels + c];
+
+            for (int c = 0; c < numChannels; ++c)
+                dest [i * numChannels + c] = scaleBoxTotal (total[c], scale);
+
+            if (i >= radius)
+                for (int c = 0; c < numChannels; ++c)
+                    total[c] -= src [(i - radius) * numChannels + c];
+        }
+    }
+
+    // Box-filters the columns of a strip of values, treating anything above or below it as zero.
+    static void boxFilterColumns (const uint8* const src, uint8* const dest, const int lineStride,
+                                  const int numLines, const int numValues, const int radius) noexcept
+    {
+        jassert (numValues <= stripSize);
+
+        const unsigned int scale = getBoxScale (radius);
+        unsigned int total [stripSize];
+
+        for (int j = 0; j < numValues; ++j)
+            total[j] = 0;
+
+        for (int y = jmin (radius, numLines); --y >= 0;)
+        {
+            const uint8* const line = src + y * lineStride;
+
+            for (int j = 0; j < numValues; ++j)
+                total[j] += line[j];
+        }
+
+        for (int y = 0; y < numLines; ++y)
+        {
+            if (y + radius < numLines)
+            {
+                const uint8* const line = src + (y + radius) * lineStride;
+
+                for (int j = 0; j < numValues; ++j)
+                    total[j] += line[j];
+            }
+
+            uint8* const destLine = dest + y * lineStride;
+
+            for (int j = 0; j < numValues; ++j)
+                destLine[j] = scaleBoxTotal (total[j], scale);
+
+            if (y >= radius)
+            {
+                const uint8* const line = src + (y - radius) * lineStride;
+
+                for (int j = 0; j < numValues; ++j)
+                    total[j] -= line[j];
+            }
+        }
+    }
+
+    //==============================================================================
+    // Runs the three box filters along each line of the working buffer. The result ends
+    // up in the second buffer.
+    template <int numChannels>
+    class HorizontalBoxPass  : public ParallelLoop::Body
+    {
+    public:
+        HorizontalBoxPass (uint8* const buffer1_, uint8* const buffer2_, const int width_, const int* const radii_) noexcept
+            : buffer1 (buffer1_), buffer2 (buffer2_), width (width_), radii (radii_)
+        {
+        }
+
+        void processRange (const int rangeStart, const int rangeEnd)
+        {
+            for (int y = rangeStart; y < rangeEnd; ++y)
+            {
+                uint8* const line1 = buffer1 + y * width * numChannels;
+                uint8* const line2 = buffer2 + y * width * numChannels;
+
+                boxFilterLine<numChannels> (line1, line2, width, radii[0]);
+                boxFilterLine<numChannels> (line2, line1, width, radii[1]);
+                boxFilterLine<numChannels> (line1, line2, width, radii[2]);
+            }
+        }
+
+    private:
+        uint8* const buffer1;
+        uint8* const buffer2;
+        const int width;
+        const int* const radii;
+
+        JUCE_DECLARE_NON_COPYABLE (HorizontalBoxPass);
+    };
+
+    // Runs the three box filters down each strip of columns of the working buffer. The
+    // result ends up back in the first buffer.
+    class VerticalBoxPass  : public ParallelLoop::Body
+    {
+    public:
+        VerticalBoxPass (uint8* const buffer1_, uint8* const buffer2_, const int valuesPerLine_,
+                         const int numLines_, const int* const radii_) noexcept
+            : buffer1 (buffer1_), buffer2 (buffer2_), valuesPerLine (valuesPerLine_),
+              numLines (numLines_), radii (radii_)
+        {
+        }
+
+        void processRange (const int rangeStart, const int rangeEnd)
+        {
+            for (int strip = rangeStart; strip < rangeEnd; ++strip)
+            {
+                const int start = strip * stripSize;
+                const int num = jmin ((int) stripSize, valuesPerLine - start);
+
+                boxFilterColumns (buffer2 + start, buffer1 + start, valuesPerLine, numLines, num, radii[0]);
+                boxFilterColumns (buffer1 + start, buffer2 + start, valuesPerLine, numLines, num, radii[1]);
+                boxFilterColumns (buffer2 + start, buffer1 + start, valuesPerLine, numLines, num, radii[2]);
+            }
+        }
+
+    private:
+        uint8* const buffer1;
+        uint8* const buffer2;
+        const int valuesPerLine, numLines;
+        const int* const radii;
+
+        JUCE_DECLARE_NON_COPYABLE (VerticalBoxPass);
+    };
+}
+
+//==============================================================================
+ImageBlur::ImageBlur()
+    : floatBufferSize (0),
+      byteBufferSize (0),
+      threadPool (nullptr),
+      minimumPixelsForThreading (0)
+{
+}
+
+ImageBlur::~ImageBlur()
+{
+}
+
+void ImageBlur::setThreadPool (ThreadPool* const pool, const int minimumPixelsForThreading_)
+{
+    threadPool = pool;
+    minimumPixelsForThreading = minimumPixelsForThreading_;
+}
+
+void ImageBlur::releaseBuffers()
+{
+    floatBuffer.free();
+    byteBuffer1.free();
+    byteBuffer2.free();
+    floatBufferSize = 0;
+    byteBufferSize = 0;
+}
+
+bool ImageBlur::checkImages (Image& destImage, const Image& sourceImage) const
+{
+    if (sourceImage == destImage)
+    {
+        destImage.duplicateIfShared();
+        return destImage.isValid();
+    }
+
+    if (sourceImage.getWidth() != destImage.getWidth()
+         || sourceImage.getHeight() != destImage.getHeight()
+         || sourceImage.getFormat() != destImage.getFormat())
+    {
+        jassertfalse;
+        return false;
+    }
+
+    return destImage.isValid();
+}
+
+bool ImageBlur::shouldUseThreads (const Rectangle<int>& area) const noexcept
+{
+    return threadPool != nullptr
+            && threadPool->getNumThreads() > 0
+            && area.getWidth() * area.getHeight() >= minimumPixelsForThreading;
+}
+
+//==============================================================================
+void ImageBlur::createGaussianKernel (float* const kernel, const int kernelSize, const float standardDeviation)
+{
+    const int centre = kernelSize >> 1;
+    double total = 0;
+
+    for (int i = 0; i < kernelSize; ++i)
+    {
+        const int distance = i - centre;
+        const double value = standardDeviation > 0 ? exp (distance * distance / (-2.0 * standardDeviation * standardDeviation))
+                                                   : (distance == 0 ? 1.0 : 0.0);
+        kernel[i] = (float) value;
+        total += value;
+    }
+
+    if (total > 0)
+        for (int i = 0; i < kernelSize; ++i)
+            kernel[i] = (float) (kernel[i] / total);
+}
+
+void ImageBlur::applyGaussianBlur (Image& destImage, const Image& sourceImage, const Rectangle<int>& destinationArea,
+                                   const float standardDeviation, const BlurMode mode, const float gain)
+{
+    if (mode == boxApproximation)
+    {
+        applyBoxApproximation (destImage, sourceImage, destinationArea, standardDeviation, gain);
+    }
+    else
+    {
+        const int kernelSize = jmax (0, (int) std::ceil (standardDeviation * 3.0f)) * 2 + 1;
+        HeapBlock<float> kernel ((size_t) kernelSize);
+        createGaussianKernel (kernel, kernelSize, standardDeviation);
+
+        applySeparableKernel (destImage, sourceImage, destinationArea, kernel, kernel, kernelSize, gain);
+    }
+}
+
+void ImageBlur::applySeparableKernel (Image& destImage, const Image& sourceImage, const Rectangle<int>& destinationArea,
+                                      const float* const horizontalKernel, const float* const verticalKernel,
+                                      const int kernelSize, const float gain)
+{
+    using namespace ImageBlurHelpers;
+    jassert (kernelSize > 0);
+
+    if (kernelSize <= 0 || ! checkImages (destImage, sourceImage))
+        return;
+
+    const Rectangle<int> area (destinationArea.getIntersection (destImage.getBounds()));
+
+    if (area.isEmpty())
+        return;
+
+    const Image::BitmapData srcData (sourceImage, Image::BitmapData::readOnly);
+    const int numChannels = srcData.pixelStride;
+    const int valuesPerLine = area.getWidth() * numChannels;
+    const int centre = kernelSize >> 1;
+
+    // The source lines that can reach the destination area through the vertical kernel.
+    const int firstLine = jmax (0, area.getY() - centre);
+    const int endLine = jmin (srcData.height, area.getBottom() + kernelSize - 1 - centre);
+
+    ThreadPool* const pool = shouldUseThreads (area) ? threadPool : nullptr;
+
+    if (endLine > firstLine)
+    {
+        // This pass reads everything it needs from the source before the destination is
+        // touched, so it's fine for them to be the same image.
+        float* const buffer = getBuffer (floatBuffer, floatBufferSize, (size_t) ((endLine - firstLine) * valuesPerLine));
+
+        if (numChannels == 4)
+        {
+            HorizontalKernelPass<4> pass (srcData, area.getX(), area.getWidth(), firstLine, horizontalKernel, kernelSize, buffer);
+            runBody (pass, firstLine, endLine, pool);
+        }
+        else if (numChannels == 3)
+        {
+            HorizontalKernelPass<3> pass (srcData, area.getX(), area.getWidth(), firstLine, horizontalKernel, kernelSize, buffer);
+            runBody (pass, firstLine, endLine, pool);
+        }
+        else
+        {
+            jassert (numChannels == 1);
+            HorizontalKernelPass<1> pass (srcData, area.getX(), area.getWidth(), firstLine, horizontalKernel, kernelSize, buffer);
+            runBody (pass, firstLine, endLine, pool);
+        }
+    }
+
+    const Image::BitmapData destData (destImage, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                                      Image::BitmapData::writeOnly);
+
+    VerticalKernelPass pass (floatBuffer, firstLine, endLine, valuesPerLine, destData, area.getY(),
+                             verticalKernel, kernelSize, gain);
+    runBody (pass, 0, area.getHeight(), pool);
+}
+
+void ImageBlur::applyBoxApproximation (Image& destImage, const Image& sourceImage, const Rectangle<int>& destinationArea,
+                                       const float standardDeviation, const float gain)
+{
+    using namespace ImageBlurHelpers;
+
+    if (! checkImages (destImage, sourceImage))
+        return;
+
+    const Rectangle<int> area (destinationArea.getIntersection (destImage.getBounds()));
+
+    if (area.isEmpty())
+        return;
+
+    int radii[3];
+    getBoxRadii (standardDeviation, radii);
+
+    // The working region has to cover every pixel that the three passes can carry
+    // into the destination area. Anything beyond the edges of the image counts as zero,
+    // but the region still extends past them, because the first passes spread some of the
+    // image out there, and the later ones carry part of that back in.
+    const int reach = radii[0] + radii[1] + radii[2];
+    const Rectangle<int> region (area.expanded (reach, reach));
+    const Rectangle<int> sourceRegion (region.getIntersection (sourceImage.getBounds()));
+
+    const Image::BitmapData srcData (sourceImage, Image::BitmapData::readOnly);
+    const int numChannels = srcData.pixelStride;
+    const int valuesPerLine = region.getWidth() * numChannels;
+    const size_t bufferSize = (size_t) (valuesPerLine * region.getHeight());
+
+    if (bufferSize > byteBufferSize)
+    {
+        byteBuffer1.malloc (bufferSize);
+        byteBuffer2.malloc (bufferSize);
+        byteBufferSize = bufferSize;
+    }
+
+    if (sourceRegion != region)
+        zeromem (byteBuffer1, bufferSize);
+
+    for (int y = sourceRegion.getY(); y < sourceRegion.getBottom(); ++y)
+        memcpy (byteBuffer1 + (y - region.getY()) * valuesPerLine + (sourceRegion.getX() - region.getX()) * numChannels,
+                srcData.getPixelPointer (sourceRegion.getX(), y),
+                (size_t) (sourceRegion.getWidth() * numChannels));
+
+    ThreadPool* const pool = shouldUseThreads (area) ? threadPool : nullptr;
+
+    if (numChannels == 4)
+    {
+        HorizontalBoxPass<4> pass (byteBuffer1, byteBuffer2, region.getWidth(), radii);
+        runBody (pass, 0, region.getHeight(), pool);
+    }
+    else if (numChannels == 3)
+    {
+        HorizontalBoxPass<3> pass (byteBuffer1, byteBuffer2, region.getWidth(), radii);
+        runBody (pass, 0, region.getHeight(), pool);
+    }
+    else
+    {
+        jassert (numChannels == 1);
+        HorizontalBoxPass<1> pass (byteBuffer1, byteBuffer2, region.getWidth(), radii);
+        runBody (pass, 0, region.getHeight(), pool);
+    }
+
+    {
+        VerticalBoxPass pass (byteBuffer1, byteBuffer2, valuesPerLine, region.getHeight(), radii);
+        runBody (pass, 0, (valuesPerLine + stripSize - 1) / stripSize, pool);
+    }
+
+    const Image::BitmapData destData (destImage, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                                      Image::BitmapData::writeOnly);
+    const int destValuesPerLine = area.getWidth() * numChannels;
+
+    for (int y = 0; y < area.getHeight(); ++y)
+    {
+        const uint8* const src = byteBuffer1 + (y + reach) * valuesPerLine + reach * numChannels;
+        uint8* const dest = destData.getLinePointer (y);
+
+        if (gain == 1.0f)
+        {
+            memcpy (dest, src, (size_t) destValuesPerLine);
+        }
+        else
+        {
+            for (int j = 0; j < destValuesPerLine; ++j)
+                dest[j] = floatToByte (src[j] * gain);
+        }
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageBlurTests  : public UnitTest
+{
+public:
+    ImageBlurTests() : UnitTest ("ImageBlur") {}
+
+    static Image createRandomImage (const Image::PixelFormat format, const int width, const int height, Random& r)
+    {
+        Image image (format, width, height, false);
+        const Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < height; ++y)
+            for (int i = 0; i < width * data.pixelStride; ++i)
+                data.getLinePointer (y)[i] = (uint8) r.nextInt (256);
+
+        return image;
+    }
+
+    static Image copyOf (const Image& image)
+    {
+        Image copy (image);
+        copy.duplicateIfShared();
+        return copy;
+    }
+
+    // Applies the 2D kernel made from a 1D one with ImageConvolutionKernel. One of its values
+    // is nudged by an amount that's too small to affect the result, so that the kernel can't
+    // be factorised, and ImageConvolutionKernel has to use its direct 2D path.
+    static void applyDirectly (Image& dest, const Image& source, const Rectangle<int>& area,
+                               const float* const kernel1D, const int kernelSize)
+    {
+        ImageConvolutionKernel kernel (kernelSize);
+
+        for (int y = 0; y < kernelSize; ++y)
+            for (int x = 0; x < kernelSize; ++x)
+                kernel.setKernelValue (x, y, kernel1D[x] * kernel1D[y]);
+
+        kernel.setKernelValue (0, 0, kernel.getKernelValue (0, 0) + 1.0e-4f);
+        kernel.applyToImage (dest, source, area);
+    }
+
+    static int getMaxDifference (const Image& image1, const Image& image2, const Rectangle<int>& area)
+    {
+        const Image::BitmapData data1 (image1, Image::BitmapData::readOnly);
+        const Image::BitmapData data2 (image2, Image::BitmapData::readOnly);
+        int maxDifference = 0;
+
+        for (int y = area.getY(); y < area.getBottom(); ++y)
+            for (int i = area.getX() * data1.pixelStride; i < area.getRight() * data1.pixelStride; ++i)
+                maxDifference = jmax (maxDifference, std::abs (data1.getLinePointer (y)[i] - (int) data2.getLinePointer (y)[i]));
+
+        return maxDifference;
+    }
+
+    void checkAgainstConvolutionKernel (const Image::PixelFormat format, const int width, const int height,
+                                        const Rectangle<int>& area, const float standardDeviation, Random& r)
+    {
+        const Image source (createRandomImage (format, width, height, r));
+        const int kernelSize = jmax (0, (int) std::ceil (standardDeviation * 3.0f)) * 2 + 1;
+        HeapBlock<float> kernel ((size_t) kernelSize);
+        ImageBlur::createGaussianKernel (kernel, kernelSize, standardDeviation);
+
+        Image expected (copyOf (source));
+        applyDirectly (expected, source, area, kernel, kernelSize);
+
+        Image result (copyOf (source));
+        ImageBlur blur;
+        blur.applyGaussianBlur (result, source, area, standardDeviation);
+        expect (getMaxDifference (result, expected, source.getBounds()) <= 1);
+
+        // blurring in place should give the same result
+        Image inPlace (copyOf (source));
+        blur.applyGaussianBlur (inPlace, inPlace, area, standardDeviation);
+        expect (getMaxDifference (inPlace, expected, source.getBounds()) <= 1);
+
+        // and so should the ImageConvolutionKernel, which hands separable kernels to ImageBlur
+        ImageConvolutionKernel separableKernel (kernelSize);
+
+        for (int y = 0; y < kernelSize; ++y)
+            for (int x = 0; x < kernelSize; ++x)
+                separableKernel.setKernelValue (x, y, kernel[x] * kernel[y]);
+
+        Image viaKernel (copyOf (source));
+        separableKernel.applyToImage (viaKernel, source, area);
+        expect (getMaxDifference (viaKernel, expected, source.getBounds()) <= 1);
+    }
+
+    void runTest()
+    {
+        Random r (0x1234);
+
+        beginTest ("Gaussian kernel");
+
+        checkAgainstConvolutionKernel (Image::ARGB, 40, 30, Rectangle<int> (40, 30), 1.5f, r);
+        checkAgainstConvolutionKernel (Image::RGB, 37, 23, Rectangle<int> (40, 30), 2.0f, r);
+        checkAgainstConvolutionKernel (Image::ARGB, 40, 30, Rectangle<int> (5, 4, 20, 15), 2.5f, r);
+        checkAgainstConvolutionKernel (Image::ARGB, 300, 8, Rectangle<int> (0, 2, 300, 3), 1.0f, r);
+
+        beginTest ("Radius larger than the image");
+
+        checkAgainstConvolutionKernel (Image::ARGB, 8, 6, Rectangle<int> (8, 6), 20.0f, r);
+        checkAgainstConvolutionKernel (Image::RGB, 5, 9, Rectangle<int> (1, 1, 3, 3), 12.0f, r);
+
+        beginTest ("Box approximation");
+
+        // the box approximation treats pixels beyond the edges as zero, as the kernel does, so
+        // a solid image should fade towards its edges in nearly the same way
+        checkBoxApproximation (64, 64, 3.0f);
+        checkBoxApproximation (200, 100, 10.0f);
+        checkBoxApproximation (9, 7, 3.0f);
+        checkBoxApproximation (9, 7, 20.0f);
+        checkBoxApproximation (5, 5, 50.0f);
+    }
+
+    void checkBoxApproximation (const int width, const int height, const float standardDeviation)
+    {
+        Image box (Image::SingleChannel, width, height, false);
+        box.clear (box.getBounds(), Colours::white);
+        Image gaussian (copyOf (box));
+
+        ImageBlur blur;
+        blur.applyGaussianBlur (box, box, box.getBounds(), standardDeviation, ImageBlur::boxApproximation);
+        blur.applyGaussianBlur (gaussian, gaussian, gaussian.getBounds(), standardDeviation, ImageBlur::gaussianKernel);
+
+        expect (getMaxDifference (box, gaussian, box.getBounds()) <= 8);
+    }
+};
+
+static ImageBlurTests imageBlurUnitTests;
+
+#endif
+
+END_JUCE_NAMESPACE
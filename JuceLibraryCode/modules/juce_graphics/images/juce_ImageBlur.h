@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+#ifndef __JUCE_IMAGEBLUR_JUCEHEADER__
+#define __JUCE_IMAGEBLUR_JUCEHEADER__
+
+#include "juce_Image.h"
+
+
+//==============================================================================
+/**
+    Applies blurs and other separable filters to images.
+
+    Rather than convolving each pixel with a 2D kernel, this does a horizontal pass
+    followed by a vertical pass, so the cost per pixel grows linearly with the size
+    of the kernel instead of with its square. In boxApproximation mode, a gaussian is
+    approximated by three successive box filters, whose cost doesn't depend on the
+    radius at all.
+
+    The working buffers are kept between calls, so if you're blurring an image on
+    every repaint, keep an ImageBlur object alive rather than creating a new one
+    each time. For large images, you can also give it a ThreadPool, and it'll split
+    each pass into bands that are processed on the pool's threads.
+
+    The images can be in any of the Image::PixelFormat formats.
+
+    @see ImageConvolutionKernel, GlowEffect, DropShadowEffect
+*/
+class JUCE_API  ImageBlur
+{
+public:
+    //==============================================================================
+    /** Creates an ImageBlur. */
+    ImageBlur();
+
+    /** Destructor. */
+    ~ImageBlur();
+
+    //==============================================================================
+    /** The methods that applyGaussianBlur() can use. */
+    enum BlurMode
+    {
+        gaussianKernel,     /**< Convolves the image with a sampled gaussian curve. This is
+                                 accurate, but the cost per pixel grows with the radius. */
+        boxApproximation    /**< Approximates the gaussian with three passes of a box filter,
+                                 which costs the same for any radius. */
+    };
+
+    //==============================================================================
+    /** Sets a ThreadPool whose threads should share the work of blurring large images.
+
+        Images whose blurred area is smaller than minimumPixelsForThreading are always
+        processed on the calling thread. The pool must not be deleted while this object
+        is still using it - pass nullptr to stop using a pool.
+    */
+    void setThreadPool (ThreadPool* pool, int minimumPixelsForThreading = 256 * 256);
+
+    //==============================================================================
+    /** Applies a gaussian blur to a region of an image.
+
+        @param destImage            the image that will receive the blurred pixels
+        @param sourceImage          the image to read from - this can be the same image as
+                                    the destination, but if different, it must be exactly the
+                                    same size and format
+        @param destinationArea      the region of the image to blur
+        @param standardDeviation    the standard deviation of the gaussian, in pixels
+        @param mode                 the method to use
+        @param gain                 a multiplier that's applied to the blurred values (which
+                                    are then clipped to their maximum value)
+    */
+    void applyGaussianBlur (Image& destImage,
+                            const Image& sourceImage,
+                            const Rectangle<int>& destinationArea,
+                            float standardDeviation,
+                            BlurMode mode = gaussianKernel,
+                            float gain = 1.0f);
+
+    /** Convolves a region of an image with a separable kernel.
+
+        The result is the same as using an ImageConvolutionKernel whose value at (x, y) is
+        (horizontalKernel[x] * verticalKernel[y]), but much faster.
+
+        @param destImage            the image that will receive the convoluted pixels
+        @param sourceImage          the image to read from - this can be the same image as
+                                    the destination, but if different, it must be exactly the
+                                    same size and format
+        @param destinationArea      the region of the image to apply the filter to
+        @param horizontalKernel     the kernelSize values to convolve each row with
+        @param verticalKernel       the kernelSize values to convolve each column with
+        @param kernelSize           the number of values in each kernel. As with an
+                                    ImageConvolutionKernel, the value at (kernelSize / 2) is the
+                                    one that's aligned with the pixel being calculated
+        @param gain                 a multiplier that's applied to the results (which are
+                                    then clipped to their maximum value)
+    */
+    void applySeparableKernel (Image& destImage,
+                               const Image& sourceImage,
+                               const Rectangle<int>& destinationArea,
+                               const float* horizontalKernel,
+                               const float* verticalKernel,
+                               int kernelSize,
+                               float gain = 1.0f);
+
+    /** Frees the working buffers that are being kept for re-use. */
+    void releaseBuffers();
+
+    //==============================================================================
+    /** Fills an array with a sampled gaussian curve whose values add up to 1.0.
+
+        The peak of the curve is at index (kernelSize / 2).
+    */
+    static void createGaussianKernel (float* kernel, int kernelSize, float standardDeviation);
+
+private:
+    //==============================================================================
+    HeapBlock <float> floatBuffer;
+    HeapBlock <uint8> byteBuffer1, byteBuffer2;
+    size_t floatBufferSize, byteBufferSize;
+    ThreadPool* threadPool;
+    int minimumPixelsForThreading;
+
+    bool checkImages (Image& destImage, const Image& sourceImage) const;
+    bool shouldUseThreads (const Rectangle<int>& area) const noexcept;
+    void applyBoxApproximation (Image& destImage, const Image& sourceImage,
+                                const Rectangle<int>& area, float standardDeviation, float gain);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImageBlur);
+};
+
+
+#endif   // __JUCE_IMAGEBLUR_JUCEHEADER__
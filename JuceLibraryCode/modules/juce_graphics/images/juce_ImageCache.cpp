@@ -31,12 +31,15 @@ class ImageCache::Pimpl     : public Timer,
 {
 public:
     Pimpl()
-        : cacheTimeout (5000)
+        : newest (nullptr), oldest (nullptr), cacheTimeout (5000),
+          sizeLimit (0), totalBytes (0),
+          numHits (0), numMisses (0), numEvictions (0)
     {
     }
 
     ~Pimpl()
     {
+        clearAll();
         clearSingletonInstance();
     }
 
@@ -44,73 +47,285 @@ public:
     {
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
-        {
-            Item* const item = images.getUnchecked(i);
+        Item* const item = items [hashCode];
 
-            if (item->hashCode == hashCode)
-                return item->image;
+        if (item == nullptr)
+        {
+            ++numMisses;
+            return Image::null;
         }
 
-        return Image::null;
+        ++numHits;
+        touch (item, Time::getApproximateMillisecondCounter());
+        return item->image;
     }
 
     void addImageToCache (const Image& image, const int64 hashCode)
     {
         if (image.isValid())
         {
-            if (! isTimerRunning())
+            if (cacheTimeout > 0 && ! isTimerRunning())
                 startTimer (2000);
 
-            Item* const item = new Item();
-            item->hashCode = hashCode;
+            const ScopedLock sl (lock);
+
+            Item* item = items [hashCode];
+
+            if (item != nullptr)
+            {
+                totalBytes -= item->numBytes;
+            }
+            else
+            {
+                item = new Item (hashCode);
+                items.set (hashCode, item);
+                linkAtFront (item);
+            }
+
             item->image = image;
-            item->lastUseTime = Time::getApproximateMillisecondCounter();
+            item->numBytes = getNumBytes (image);
+            totalBytes += item->numBytes;
+            touch (item, Time::getApproximateMillisecondCounter());
 
-            const ScopedLock sl (lock);
-            images.add (item);
+            trimToSizeLimit();
         }
     }
 
+    void setPinned (const int64 hashCode, const bool shouldBePinned)
+    {
+        const ScopedLock sl (lock);
+
+        Item* const item = items [hashCode];
+
+        if (item != nullptr)
+            item->isPinned = shouldBePinned;
+    }
+
+    void setCacheTimeout (const int millisecs)
+    {
+        cacheTimeout = millisecs;
+
+        if (cacheTimeout <= 0)
+            stopTimer();
+        else if (! isTimerRunning())
+            startTimer (2000);
+    }
+
+    void setCacheSizeLimit (const int64 maxNumBytes)
+    {
+        const ScopedLock sl (lock);
+        sizeLimit = maxNumBytes;
+        trimToSizeLimit();
+    }
+
+    void releaseUnusedImages()
+    {
+        const ScopedLock sl (lock);
+
+        for (Item* item = oldest; item != nullptr;)
+        {
+            Item* const next = item->newer;
+
+            if (isRemovable (item))
+                removeItem (item);
+
+            item = next;
+        }
+    }
+
+    ImageCache::Statistics getStatistics()
+    {
+        const ScopedLock sl (lock);
+
+        ImageCache::Statistics s;
+        s.numImages = items.size();
+        s.numBytes = totalBytes;
+        s.sizeLimit = sizeLimit;
+        s.numHits = numHits;
+        s.numMisses = numMisses;
+        s.numEvictions = numEvictions;
+        return s;
+    }
+
     void timerCallback()
     {
+        if (cacheTimeout <= 0)
+        {
+            stopTimer();
+            return;
+        }
+
         const uint32 now = Time::getApproximateMillisecondCounter();
 
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
+        // Images that are still in use get moved to the front of the list as we go, so
+        // this stops at the item that was at the front when it started.
+        Item* const last = newest;
+
+        for (Item* item = oldest; item != nullptr;)
         {
-            Item* const item = images.getUnchecked(i);
+            Item* const next = (item == last) ? nullptr : item->newer;
 
             if (item->image.getReferenceCount() <= 1)
             {
-                if (now > item->lastUseTime + cacheTimeout || now < item->lastUseTime - 1000)
-                    images.remove (i);
+                if (! item->isPinned
+                     && (now > item->lastUseTime + (uint32) cacheTimeout || now < item->lastUseTime - 1000))
+                    removeItem (item);
             }
             else
             {
-                item->lastUseTime = now; // multiply-referenced, so this image is still in use.
+                touch (item, now); // multiply-referenced, so this image is still in use.
             }
+
+            item = next;
         }
 
-        if (images.size() == 0)
+        if (items.size() == 0)
             stopTimer();
     }
 
+    juce_DeclareSingleton_SingleThreaded_Minimal (ImageCache::Pimpl);
+
+private:
+    //==============================================================================
     struct Item
     {
+        Item (const int64 hashCode_) noexcept
+            : hashCode (hashCode_), numBytes (0), lastUseTime (0),
+              isPinned (false), older (nullptr), newer (nullptr)
+        {
+        }
+
         Image image;
-        int64 hashCode;
+        const int64 hashCode;
+        int64 numBytes;
         uint32 lastUseTime;
+        bool isPinned;
+        Item* older;
+        Item* newer;
+    };
+
+    struct HashFunction
+    {
+        static int generateHash (const int64 key, const int upperLimit) noexcept
+        {
+            const uint64 h = ((uint64) key) * (uint64) literal64bit (0x9e3779b97f4a7c15);
+            return (int) ((h >> 32) % (uint32) upperLimit);
+        }
     };
 
+    // The items are kept in a list ordered by when they were last used, with the
+    // most recently used at the front, and the hash map is used to find them.
+    HashMap<int64, Item*, HashFunction> items;
+    Item* newest;
+    Item* oldest;
     int cacheTimeout;
+    int64 sizeLimit, totalBytes;
+    int64 numHits, numMisses, numEvictions;
+    CriticalSection lock;
 
-    juce_DeclareSingleton_SingleThreaded_Minimal (ImageCache::Pimpl);
+    enum { maxEvictionCandidates = 8 };
 
-private:
-    OwnedArray<Item> images;
-    CriticalSection lock;
+    static int64 getNumBytes (const Image& image) noexcept
+    {
+        const int bytesPerPixel = image.getFormat() == Image::SingleChannel ? 1
+                                    : (image.getFormat() == Image::RGB ? 3 : 4);
+
+        return image.getWidth() * (int64) image.getHeight() * bytesPerPixel;
+    }
+
+    static bool isRemovable (const Item* const item) noexcept
+    {
+        return ! (item->isPinned || item->image.getReferenceCount() > 1);
+    }
+
+    void linkAtFront (Item* const item) noexcept
+    {
+        item->older = newest;
+        item->newer = nullptr;
+
+        if (newest != nullptr)
+            newest->newer = item;
+        else
+            oldest = item;
+
+        newest = item;
+    }
+
+    void unlink (Item* const item) noexcept
+    {
+        if (item->older != nullptr)  item->older->newer = item->newer;
+        else                         oldest = item->newer;
+
+        if (item->newer != nullptr)  item->newer->older = item->older;
+        else                         newest = item->older;
+    }
+
+    void touch (Item* const item, const uint32 now) noexcept
+    {
+        item->lastUseTime = now;
+
+        if (item != newest)
+        {
+            unlink (item);
+            linkAtFront (item);
+        }
+    }
+
+    void removeItem (Item* const item)
+    {
+        unlink (item);
+        items.remove (item->hashCode);
+        totalBytes -= item->numBytes;
+        delete item;
+    }
+
+    void clearAll()
+    {
+        while (oldest != nullptr)
+            removeItem (oldest);
+    }
+
+    // Evicts unused images until the total size is under the limit. The victim is picked
+    // from the few least-recently-used candidates, weighting their age by their size, so
+    // that one big stale image goes before several small ones that were used a moment later.
+    void trimToSizeLimit()
+    {
+        if (sizeLimit <= 0)
+            return;
+
+        const uint32 now = Time::getApproximateMillisecondCounter();
+
+        while (totalBytes > sizeLimit)
+        {
+            Item* victim = nullptr;
+            double victimScore = -1.0;
+            int numCandidates = 0;
+
+            for (Item* item = oldest; item != nullptr && numCandidates < maxEvictionCandidates; item = item->newer)
+            {
+                if (isRemovable (item))
+                {
+                    const double score = (double) item->numBytes * (1.0 + (double) (now - item->lastUseTime));
+
+                    if (score > victimScore)
+                    {
+                        victim = item;
+                        victimScore = score;
+                    }
+
+                    ++numCandidates;
+                }
+            }
+
+            if (victim == nullptr)
+                break;
+
+            removeItem (victim);
+            ++numEvictions;
+        }
+    }
 
     JUCE_DECLARE_NON_COPYABLE (Pimpl);
 };
@@ -160,10 +375,140 @@ Image ImageCache::getFromMemory (const void* imageData, const int dataSize)
     return image;
 }
 
+//==============================================================================
+int64 ImageCache::getRescaledHashCode (const int64 hashCode, const int newWidth, const int newHeight,
+                                       const Graphics::ResamplingQuality quality) noexcept
+{
+    uint64 h = (uint64) hashCode;
+    h = h * 1000003 + (uint32) newWidth;
+    h = h * 1000003 + (uint32) newHeight;
+    h = h * 31 + (uint32) quality;
+    return (int64) (h ^ (h >> 29));
+}
+
+Image ImageCache::getRescaledFromFile (const File& file, const int newWidth, const int newHeight,
+                                       const Graphics::ResamplingQuality quality)
+{
+    const int64 hashCode = getRescaledHashCode (file.hashCode64(), newWidth, newHeight, quality);
+    Image image (getFromHashCode (hashCode));
+
+    if (image.isNull())
+    {
+        ImageFileFormat::DecodeOptions options;
+        options.minimumWidth = newWidth;
+        options.minimumHeight = newHeight;
+
+        image = ImageFileFormat::loadFrom (file, options);
+
+        if (image.isValid())
+        {
+            if (image.getWidth() != newWidth || image.getHeight() != newHeight)
+                image = image.rescaled (newWidth, newHeight, quality);
+
+            addImageToCache (image, hashCode);
+        }
+    }
+
+    return image;
+}
+
+Image ImageCache::getRescaled (const int64 sourceHashCode, const int newWidth, const int newHeight,
+                               const Graphics::ResamplingQuality quality)
+{
+    const int64 hashCode = getRescaledHashCode (sourceHashCode, newWidth, newHeight, quality);
+    Image image (getFromHashCode (hashCode));
+
+    if (image.isNull())
+    {
+        const Image source (getFromHashCode (sourceHashCode));
+
+        if (source.isValid())
+        {
+            image = source.rescaled (newWidth, newHeight, quality);
+            addImageToCache (image, hashCode);
+        }
+    }
+
+    return image;
+}
+
+//==============================================================================
 void ImageCache::setCacheTimeout (const int millisecs)
 {
-    Pimpl::getInstance()->cacheTimeout = millisecs;
+    Pimpl::getInstance()->setCacheTimeout (millisecs);
+}
+
+void ImageCache::setCacheSizeLimit (const int64 maxNumBytes)
+{
+    Pimpl::getInstance()->setCacheSizeLimit (maxNumBytes);
+}
+
+void ImageCache::setPinned (const int64 hashCode, const bool shouldBePinned)
+{
+    if (Pimpl::getInstanceWithoutCreating() != nullptr)
+        Pimpl::getInstanceWithoutCreating()->setPinned (hashCode, shouldBePinned);
+}
+
+void ImageCache::releaseUnusedImages()
+{
+    if (Pimpl::getInstanceWithoutCreating() != nullptr)
+        Pimpl::getInstanceWithoutCreating()->releaseUnusedImages();
 }
 
+ImageCache::Statistics ImageCache::getStatistics()
+{
+    return Pimpl::getInstance()->getStatistics();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageCacheTests  : public UnitTest
+{
+public:
+    ImageCacheTests() : UnitTest ("ImageCache") {}
+
+    void runTest()
+    {
+        beginTest ("Expiry with images in use");
+
+        ImageCache::Pimpl cache;
+        cache.setCacheTimeout (1);
+        cache.stopTimer();
+
+        Image inUse1 (Image::ARGB, 8, 8, true), inUse2 (Image::ARGB, 8, 8, true);
+        cache.addImageToCache (inUse1, 1);
+        cache.addImageToCache (inUse2, 2);
+        cache.addImageToCache (Image (Image::ARGB, 8, 8, true), 3);
+        cache.stopTimer();
+
+        Thread::sleep (20);
+        Time::getMillisecondCounter(); // updates the approximate counter
+        cache.timerCallback();
+        cache.timerCallback();
+
+        expect (cache.getFromHashCode (1) == inUse1);
+        expect (cache.getFromHashCode (2) == inUse2);
+        expect (cache.getFromHashCode (3).isNull());
+        expectEquals (cache.getStatistics().numImages, 2);
+
+        beginTest ("Size limit");
+
+        cache.setCacheSizeLimit (8 * 8 * 4 * 2);
+        inUse2 = Image::null;
+        cache.addImageToCache (Image (Image::ARGB, 8, 8, true), 4);
+        cache.addImageToCache (Image (Image::ARGB, 8, 8, true), 5);
+
+        expect (cache.getFromHashCode (1) == inUse1);
+        expect (cache.getFromHashCode (2).isNull());
+        expectEquals ((int) cache.getStatistics().numBytes, 8 * 8 * 4 * 2);
+        cache.stopTimer();
+    }
+};
+
+static ImageCacheTests imageCacheUnitTests;
+
+#endif
+
 
 END_JUCE_NAMESPACE
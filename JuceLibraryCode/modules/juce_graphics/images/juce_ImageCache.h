@@ -42,6 +42,11 @@
     loading/deleting the same image, it'll reduce the chances of having to reload it
     each time.
 
+    The cache can also be given a limit on the total size of the images that it keeps
+    (see setCacheSizeLimit()). When it's exceeded, images that nothing else is using are
+    dropped, starting with the ones that have been unused the longest, but preferring
+    bigger images among those.
+
     @see Image, ImageFileFormat
 */
 class JUCE_API  ImageCache
@@ -81,6 +86,36 @@ public:
     */
     static Image getFromMemory (const void* imageData, int dataSize);
 
+    /** Returns a rescaled version of an image file, loading and caching it if necessary.
+
+        The rescaled image is cached under its own hash code (see getRescaledHashCode()),
+        and the full-size image isn't cached at all. If the file is a format that can be
+        decoded at a reduced size (e.g. a JPEG), then it's only decoded at the size that's
+        needed, so this is a cheap way to make thumbnails of big image files.
+
+        @returns        the image, or null if it there was an error loading it
+        @see getFromFile, getRescaled
+    */
+    static Image getRescaledFromFile (const File& file, int newWidth, int newHeight,
+                                      Graphics::ResamplingQuality quality = Graphics::highResamplingQuality);
+
+    /** Returns a rescaled version of an image that's in the cache.
+
+        If the cache already contains this size of the image, it's returned. Otherwise, the
+        image with the given hash code is rescaled, and the result is added to the cache. If
+        the original image isn't in the cache, this returns an invalid image.
+
+        @see getRescaledHashCode, getRescaledFromFile
+    */
+    static Image getRescaled (int64 hashCode, int newWidth, int newHeight,
+                              Graphics::ResamplingQuality quality = Graphics::highResamplingQuality);
+
+    /** Returns the hash code under which getRescaled() and getRescaledFromFile() cache a
+        rescaled version of the image with the given hash code.
+    */
+    static int64 getRescaledHashCode (int64 hashCode, int newWidth, int newHeight,
+                                      Graphics::ResamplingQuality quality = Graphics::highResamplingQuality) noexcept;
+
     //==============================================================================
     /** Checks the cache for an image with a particular hashcode.
 
@@ -105,15 +140,53 @@ public:
     static void addImageToCache (const Image& image, int64 hashCode);
 
     /** Changes the amount of time before an unused image will be removed from the cache.
-        By default this is about 5 seconds.
+        By default this is about 5 seconds. If this is 0 or less, images are never removed
+        because of their age, only when the cache exceeds its size limit.
     */
     static void setCacheTimeout (int millisecs);
 
+    /** Sets the maximum number of bytes of pixel data that the cache should hold.
+
+        When this is exceeded, images that aren't being used anywhere else are removed from
+        the cache until it's back under the limit. (Removing images that are still in use
+        wouldn't free anything, so they're left alone). A limit of 0 or less means there's
+        no limit, which is the default.
+    */
+    static void setCacheSizeLimit (int64 maxNumBytes);
+
+    /** Stops an image in the cache from being removed, or allows it to be removed again.
+
+        A pinned image stays in the cache no matter how long it's unused for, or how big the
+        cache gets.
+    */
+    static void setPinned (int64 hashCode, bool shouldBePinned);
+
+    /** Removes all the images that aren't pinned or being used anywhere else. */
+    static void releaseUnusedImages();
+
+    //==============================================================================
+    /** Some numbers describing the state of the cache.
+        @see getStatistics
+    */
+    struct Statistics
+    {
+        int numImages;          /**< The number of images in the cache. */
+        int64 numBytes;         /**< The total size of their pixel data. */
+        int64 sizeLimit;        /**< The size limit that was set with setCacheSizeLimit(). */
+        int64 numHits;          /**< The number of lookups that found an image. */
+        int64 numMisses;        /**< The number of lookups that didn't find an image. */
+        int64 numEvictions;     /**< The number of images that were removed to stay under the size limit. */
+    };
+
+    /** Returns some numbers describing the state of the cache. */
+    static Statistics getStatistics();
+
 
 private:
     //==============================================================================
     class Pimpl;
     friend class Pimpl;
+    friend class ImageCacheTests;
 
     ImageCache();
     ~ImageCache();
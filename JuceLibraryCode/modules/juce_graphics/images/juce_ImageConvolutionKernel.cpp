@@ -101,6 +101,44 @@ void ImageConvolutionKernel::createGaussianBlur (const float radius)
     setOverallSum (1.0f);
 }
 
+//==============================================================================
+bool ImageConvolutionKernel::getSeparableKernels (float* const horizontalKernel, float* const verticalKernel) const
+{
+    // If the kernel is the product of a row and a column (as a gaussian is), then the
+    // row through its largest value and that column scaled by the value give us the factors.
+    if (size <= 0)
+        return false;
+
+    int peakIndex = 0;
+
+    for (int i = size * size; --i > 0;)
+        if (std::abs (values[i]) > std::abs (values [peakIndex]))
+            peakIndex = i;
+
+    const float peak = values [peakIndex];
+
+    if (peak == 0)
+        return false;
+
+    const int peakX = peakIndex % size;
+    const int peakY = peakIndex / size;
+
+    for (int i = 0; i < size; ++i)
+    {
+        horizontalKernel[i] = values [i + peakY * size];
+        verticalKernel[i] = values [peakX + i * size] / peak;
+    }
+
+    const float tolerance = std::abs (peak) * 1.0e-5f;
+
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x)
+            if (std::abs (values [x + y * size] - horizontalKernel[x] * verticalKernel[y]) > tolerance)
+                return false;
+
+    return true;
+}
+
 //==============================================================================
 void ImageConvolutionKernel::applyToImage (Image& destImage,
                                            const Image& sourceImage,
@@ -126,6 +164,17 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
     if (area.isEmpty())
         return;
 
+    {
+        HeapBlock<float> horizontalKernel ((size_t) size), verticalKernel ((size_t) size);
+
+        if (getSeparableKernels (horizontalKernel, verticalKernel))
+        {
+            ImageBlur blur;
+            blur.applySeparableKernel (destImage, sourceImage, area, horizontalKernel, verticalKernel, size);
+            return;
+        }
+    }
+
     const int right = area.getRight();
     const int bottom = area.getBottom();
 
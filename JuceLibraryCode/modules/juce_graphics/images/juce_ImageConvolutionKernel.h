@@ -33,7 +33,7 @@
 /**
     Represents a filter kernel to use in convoluting an image.
 
-    @see Image::applyConvolution
+    @see Image::applyConvolution, ImageBlur
 */
 class JUCE_API  ImageConvolutionKernel
 {
@@ -97,6 +97,9 @@ public:
                                 the destination, but if different, it must be exactly the same
                                 size and format.
         @param destinationArea  the region of the image to apply the filter to
+
+        If the kernel can be split into a horizontal and a vertical kernel (as a gaussian
+        blur can), this uses an ImageBlur to apply them in two passes, which is much faster.
     */
     void applyToImage (Image& destImage,
                        const Image& sourceImage,
@@ -107,6 +110,8 @@ private:
     HeapBlock <float> values;
     const int size;
 
+    bool getSeparableKernels (float* horizontalKernel, float* verticalKernel) const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImageConvolutionKernel);
 };
 
@@ -90,4 +90,457 @@ Image ImageFileFormat::loadFrom (const void* rawData, const size_t numBytes)
     return Image::null;
 }
 
+Image ImageFileFormat::loadFrom (InputStream& input, const DecodeOptions& options)
+{
+    ImageFileFormat* const format = findImageFormatForStream (input);
+
+    if (format != nullptr)
+        return format->decodeImageWithOptions (input, options);
+
+    return Image::null;
+}
+
+Image ImageFileFormat::loadFrom (const File& file, const DecodeOptions& options)
+{
+    InputStream* const in = file.createInputStream();
+
+    if (in != nullptr)
+    {
+        BufferedInputStream b (in, 8192, true);
+        return loadFrom (b, options);
+    }
+
+    return Image::null;
+}
+
+//==============================================================================
+ImageFileFormat::DecodeOptions::DecodeOptions() noexcept
+    : minimumWidth (0),
+      minimumHeight (0),
+      listener (nullptr),
+      cancelFlag (nullptr)
+{
+}
+
+bool ImageFileFormat::DecodeOptions::isCancelled() const noexcept
+{
+    return cancelFlag != nullptr && cancelFlag->get() != 0;
+}
+
+int ImageFileFormat::DecodeOptions::getReductionFactor (const int fullWidth, const int fullHeight) const noexcept
+{
+    if (minimumWidth <= 0 && minimumHeight <= 0)
+        return 1;
+
+    const Rectangle<int> fullArea (fullWidth, fullHeight);
+    const Rectangle<int> area (sourceArea.isEmpty() ? fullArea : sourceArea.getIntersection (fullArea));
+
+    for (int factor = 8; factor > 1; factor >>= 1)
+        if ((area.getWidth() + factor - 1) / factor >= minimumWidth
+             && (area.getHeight() + factor - 1) / factor >= minimumHeight)
+            return factor;
+
+    return 1;
+}
+
+Image ImageFileFormat::decodeImageWithOptions (InputStream& input, const DecodeOptions& options)
+{
+    const Image fullImage (decodeImage (input));
+
+    if (! fullImage.isValid() || options.isCancelled())
+        return Image::null;
+
+    Image image (fullImage);
+
+    if (! options.sourceArea.isEmpty())
+        image = image.getClippedImage (options.sourceArea);
+
+    const int factor = options.getReductionFactor (fullImage.getWidth(), fullImage.getHeight());
+
+    if (image.isValid() && (factor > 1 || image.getSharedImage() != fullImage.getSharedImage()))
+    {
+        // (this also makes a compact copy of a cropped image, rather than keeping the whole
+        // of the original alive)
+        ImageResampler resampler (ImageResampler::boxFilter);
+        image = resampler.rescaled (image, (image.getWidth() + factor - 1) / factor,
+                                           (image.getHeight() + factor - 1) / factor);
+        *image.getProperties() = *fullImage.getProperties();
+    }
+
+    if (options.listener != nullptr && image.isValid())
+        options.listener->imageRowsDecoded (image, image.getHeight());
+
+    return image;
+}
+
+//==============================================================================
+ImageFileFormat::DecodedImageBuilder::DecodedImageBuilder (const DecodeOptions& options_, const int width, const int height,
+                                                           const int decoderScale, const bool hasAlpha_)
+    : options (options_),
+      numRowsAdded (0),
+      numRowsInTotals (0),
+      hasAlpha (hasAlpha_)
+{
+    jassert (decoderScale > 0);
+    area = Rectangle<int> (width, height);
+
+    if (! options.sourceArea.isEmpty())
+    {
+        const Rectangle<int>& src = options.sourceArea;
+        const int x = src.getX() / decoderScale;
+        const int y = src.getY() / decoderScale;
+
+        area = area.getIntersection (Rectangle<int> (x, y,
+                                                     (src.getRight() + decoderScale - 1) / decoderScale - x,
+                                                     (src.getBottom() + decoderScale - 1) / decoderScale - y));
+    }
+
+    reduction = jmax (1, options.getReductionFactor (width * decoderScale, height * decoderScale) / decoderScale);
+
+    if (! area.isEmpty())
+    {
+        image = Image (hasAlpha ? Image::ARGB : Image::RGB,
+                       (area.getWidth() + reduction - 1) / reduction,
+                       (area.getHeight() + reduction - 1) / reduction, hasAlpha);
+
+        image.getProperties()->set ("originalImageHadAlpha", image.hasAlphaChannel());
+        hasAlpha = image.hasAlphaChannel(); // (the native image creator may not give back what we expect)
+
+        if (reduction > 1)
+            totals.calloc ((size_t) (image.getWidth() * 4));
+    }
+}
+
+ImageFileFormat::DecodedImageBuilder::~DecodedImageBuilder()
+{
+}
+
+bool ImageFileFormat::DecodedImageBuilder::needsRow (const int y) const noexcept
+{
+    return y >= area.getY() && y < area.getBottom();
+}
+
+bool ImageFileFormat::DecodedImageBuilder::isComplete() const noexcept
+{
+    return numRowsAdded >= area.getHeight();
+}
+
+void ImageFileFormat::DecodedImageBuilder::addRGBRow (const int y, const uint8* const pixels)
+{
+    addRow<3> (y, pixels);
+}
+
+void ImageFileFormat::DecodedImageBuilder::addRGBARow (const int y, const uint8* const pixels)
+{
+    addRow<4> (y, pixels);
+}
+
+template <int numChannels>
+void ImageFileFormat::DecodedImageBuilder::addRow (const int y, const uint8* pixels)
+{
+    if (! needsRow (y))
+        return;
+
+    ++numRowsAdded;
+    pixels += area.getX() * numChannels;
+
+    if (reduction == 1)
+    {
+        const int outputRow = y - area.getY();
+
+        {
+            const Image::BitmapData destData (image, 0, outputRow, image.getWidth(), 1, Image::BitmapData::writeOnly);
+            uint8* dest = destData.data;
+
+            for (int i = image.getWidth(); --i >= 0;)
+            {
+                const uint8 alpha = numChannels == 4 ? pixels[3] : (uint8) 0xff;
+
+                if (hasAlpha)
+                {
+                    ((PixelARGB*) dest)->setARGB (alpha, pixels[0], pixels[1], pixels[2]);
+                    ((PixelARGB*) dest)->premultiply();
+                }
+                else
+                {
+                    ((PixelRGB*) dest)->setARGB (0xff, pixels[0], pixels[1], pixels[2]);
+                }
+
+                dest += destData.pixelStride;
+                pixels += numChannels;
+            }
+        }
+
+        if (options.listener != nullptr)
+            options.listener->imageRowsDecoded (image, outputRow + 1);
+    }
+    else
+    {
+        // The totals are kept premultiplied, so that transparent pixels don't bleed
+        // their colour into the average.
+        int* t = totals;
+
+        for (int x = 0; x < area.getWidth(); ++x)
+        {
+            int* const total = t + (x / reduction) * 4;
+            const int alpha = numChannels == 4 ? pixels[3] : 0xff;
+
+            total[0] += alpha;
+            total[1] += (pixels[0] * alpha + 127) / 255;
+            total[2] += (pixels[1] * alpha + 127) / 255;
+            total[3] += (pixels[2] * alpha + 127) / 255;
+
+            pixels += numChannels;
+        }
+
+        if (++numRowsInTotals == reduction || isComplete())
+            flushTotals();
+    }
+}
+
+void ImageFileFormat::DecodedImageBuilder::flushTotals()
+{
+    const int outputRow = (numRowsAdded - 1) / reduction;
+
+    {
+        const Image::BitmapData destData (image, 0, outputRow, image.getWidth(), 1, Image::BitmapData::writeOnly);
+        uint8* dest = destData.data;
+        int* total = totals;
+
+        for (int x = 0; x < image.getWidth(); ++x)
+        {
+            const int numColumns = jmin (reduction, area.getWidth() - x * reduction);
+            const int numPixels = numColumns * numRowsInTotals;
+            const int half = numPixels / 2;
+
+            const uint8 a = (uint8) ((total[0] + half) / numPixels);
+            const uint8 r = (uint8) ((total[1] + half) / numPixels);
+            const uint8 g = (uint8) ((total[2] + half) / numPixels);
+            const uint8 b = (uint8) ((total[3] + half) / numPixels);
+
+            if (hasAlpha)
+                ((PixelARGB*) dest)->setARGB (a, r, g, b);
+            else
+                ((PixelRGB*) dest)->setARGB (0xff, r, g, b);
+
+            total[0] = total[1] = total[2] = total[3] = 0;
+            total += 4;
+            dest += destData.pixelStride;
+        }
+    }
+
+    numRowsInTotals = 0;
+
+    if (options.listener != nullptr)
+        options.listener->imageRowsDecoded (image, outputRow + 1);
+}
+
+//==============================================================================
+class ImageFileFormat::PendingImage::DecodeJob  : public ThreadPoolJob
+{
+public:
+    DecodeJob (PendingImage* const pendingImage_)
+        : ThreadPoolJob ("image decoder"),
+          pendingImage (pendingImage_)
+    {
+    }
+
+    JobStatus runJob()
+    {
+        pendingImage->decode();
+        return jobHasFinishedAndShouldBeDeleted;
+    }
+
+private:
+    const PendingImage::Ptr pendingImage;
+
+    JUCE_DECLARE_NON_COPYABLE (DecodeJob);
+};
+
+ImageFileFormat::PendingImage::PendingImage (const File& file_, const MemoryBlock& data_, const DecodeOptions& options_)
+    : file (file_), data (data_), options (options_), finishedEvent (true)
+{
+}
+
+ImageFileFormat::PendingImage::~PendingImage()
+{
+}
+
+bool ImageFileFormat::PendingImage::isFinished() const noexcept
+{
+    return finished.get() != 0;
+}
+
+bool ImageFileFormat::PendingImage::waitUntilFinished (const int timeOutMilliseconds) const
+{
+    return finishedEvent.wait (timeOutMilliseconds);
+}
+
+Image ImageFileFormat::PendingImage::getImage() const
+{
+    const ScopedLock sl (lock);
+    return image;
+}
+
+void ImageFileFormat::PendingImage::cancel()
+{
+    cancelled = 1;
+    setFinished (Image::null);
+}
+
+void ImageFileFormat::PendingImage::decode()
+{
+    if (cancelled.get() != 0)
+        return;
+
+    DecodeOptions optionsWithCancelFlag (options);
+    optionsWithCancelFlag.cancelFlag = &cancelled;
+
+    Image result;
+
+    if (file != File::nonexistent)
+    {
+        result = ImageFileFormat::loadFrom (file, optionsWithCancelFlag);
+    }
+    else
+    {
+        MemoryInputStream stream (data, false);
+        result = ImageFileFormat::loadFrom (stream, optionsWithCancelFlag);
+    }
+
+    setFinished (result);
+}
+
+void ImageFileFormat::PendingImage::setFinished (const Image& newImage)
+{
+    {
+        const ScopedLock sl (lock);
+
+        if (finished.get() != 0)
+            return;
+
+        if (cancelled.get() == 0)
+            image = newImage;
+
+        finished = 1;
+    }
+
+    finishedEvent.signal();
+}
+
+ImageFileFormat::PendingImage::Ptr ImageFileFormat::loadAsync (ThreadPool& pool, const File& file, const DecodeOptions& options)
+{
+    PendingImage::Ptr pendingImage (new PendingImage (file, MemoryBlock(), options));
+    pool.addJob (new PendingImage::DecodeJob (pendingImage));
+    return pendingImage;
+}
+
+ImageFileFormat::PendingImage::Ptr ImageFileFormat::loadAsync (ThreadPool& pool, const MemoryBlock& imageData, const DecodeOptions& options)
+{
+    PendingImage::Ptr pendingImage (new PendingImage (File::nonexistent, imageData, options));
+    pool.addJob (new PendingImage::DecodeJob (pendingImage));
+    return pendingImage;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageDecodeOptionsTests  : public UnitTest
+{
+public:
+    ImageDecodeOptionsTests() : UnitTest ("Image decode options") {}
+
+    static Image createTestImage()
+    {
+        Image image (Image::RGB, 64, 48, true);
+        Graphics g (image);
+        g.setGradientFill (ColourGradient (Colours::red, 0.0f, 0.0f, Colours::blue, 64.0f, 48.0f, false));
+        g.fillAll();
+        return image;
+    }
+
+    void checkDecodedSizes (ImageFileFormat& format)
+    {
+        MemoryOutputStream encoded;
+        expect (format.writeImageToStream (createTestImage(), encoded));
+
+        {
+            ImageFileFormat::DecodeOptions options;
+            MemoryInputStream in (encoded.getData(), encoded.getDataSize(), false);
+            const Image image (format.decodeImageWithOptions (in, options));
+            expectEquals (image.getWidth(), 64);
+            expectEquals (image.getHeight(), 48);
+        }
+
+        {
+            ImageFileFormat::DecodeOptions options;
+            options.minimumWidth = 16;
+            options.minimumHeight = 12;
+            MemoryInputStream in (encoded.getData(), encoded.getDataSize(), false);
+            const Image image (format.decodeImageWithOptions (in, options));
+            expectEquals (image.getWidth(), 16);
+            expectEquals (image.getHeight(), 12);
+        }
+
+        {
+            ImageFileFormat::DecodeOptions options;
+            options.minimumWidth = 20;
+            MemoryInputStream in (encoded.getData(), encoded.getDataSize(), false);
+            const Image image (format.decodeImageWithOptions (in, options));
+            expectEquals (image.getWidth(), 32);
+            expectEquals (image.getHeight(), 24);
+        }
+
+        {
+            ImageFileFormat::DecodeOptions options;
+            options.sourceArea = Rectangle<int> (8, 8, 32, 16);
+            options.minimumWidth = 8;
+            MemoryInputStream in (encoded.getData(), encoded.getDataSize(), false);
+            const Image image (format.decodeImageWithOptions (in, options));
+            expectEquals (image.getWidth(), 8);
+            expectEquals (image.getHeight(), 4);
+        }
+
+        {
+            // (the stream should end up back where it started when the decoder stops early)
+            const char prefix[] = "prefix";
+            MemoryOutputStream data;
+            data.write (prefix, sizeof (prefix));
+            data.write (encoded.getData(), encoded.getDataSize());
+
+            ImageFileFormat::DecodeOptions options;
+            options.sourceArea = Rectangle<int> (0, 0, 64, 8);
+            MemoryInputStream in (data.getData(), data.getDataSize(), false);
+            in.setPosition ((int64) sizeof (prefix));
+            const Image image (format.decodeImageWithOptions (in, options));
+            expectEquals (image.getWidth(), 64);
+            expectEquals (image.getHeight(), 8);
+            expect (in.getPosition() == (int64) sizeof (prefix));
+        }
+
+        {
+            Atomic<int> cancelled (1);
+            ImageFileFormat::DecodeOptions options;
+            options.cancelFlag = &cancelled;
+            MemoryInputStream in (encoded.getData(), encoded.getDataSize(), false);
+            expect (! format.decodeImageWithOptions (in, options).isValid());
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("PNG");
+        PNGImageFormat png;
+        checkDecodedSizes (png);
+
+        beginTest ("JPEG");
+        JPEGImageFormat jpeg;
+        checkDecodedSizes (jpeg);
+    }
+};
+
+static ImageDecodeOptionsTests imageDecodeOptionsUnitTests;
+
+#endif
+
 END_JUCE_NAMESPACE
@@ -50,6 +50,74 @@ public:
     /** Destructor. */
     virtual ~ImageFileFormat()          {}
 
+    //==============================================================================
+    /** Receives the rows of an image as they're decoded, so that a partially loaded
+        image can be displayed.
+
+        @see DecodeOptions
+    */
+    class JUCE_API  DecodeListener
+    {
+    public:
+        /** Destructor. */
+        virtual ~DecodeListener() {}
+
+        /** Called when more rows of the image have been decoded.
+
+            The image is the one that will eventually be returned, and its rows from 0 up to
+            (but not including) numRowsDecoded contain their final pixels - the rest are blank.
+            This is called on whichever thread is doing the decoding, while the decoder is
+            still writing to the image, so don't keep the image or draw anything into it.
+        */
+        virtual void imageRowsDecoded (const Image& image, int numRowsDecoded) = 0;
+    };
+
+    //==============================================================================
+    /** Options that control how decodeImageWithOptions() decodes an image.
+
+        The defaults decode the whole image at full size.
+    */
+    class JUCE_API  DecodeOptions
+    {
+    public:
+        /** Creates a set of default options. */
+        DecodeOptions() noexcept;
+
+        /** The area of the image to return, in the co-ordinates of the full-size image.
+            If this is empty, the whole image is returned.
+        */
+        Rectangle<int> sourceArea;
+
+        /** If either of these are greater than 0, the decoder is allowed to return an image
+            that's been reduced by a factor of 2, 4 or 8, as long as the result is still at least
+            this big.
+
+            JPEGs can do this very cheaply during decoding, and other formats will average blocks
+            of pixels, which at least saves the memory for the full-size image. The result will
+            often be bigger than the size you ask for, so you'll probably still need to rescale it.
+        */
+        int minimumWidth, minimumHeight;
+
+        /** If this isn't nullptr, it'll be told about the rows of the image as they're decoded.
+            It must remain valid until the decoding has finished.
+        */
+        DecodeListener* listener;
+
+        /** If this isn't nullptr, the PNG and JPEG decoders check it between rows, and give
+            up and return an invalid image as soon as it becomes non-zero. It must remain valid
+            until the decoding has finished.
+        */
+        const Atomic<int>* cancelFlag;
+
+        /** Returns true if the cancelFlag has been set. */
+        bool isCancelled() const noexcept;
+
+        /** Returns the amount by which an image of the given size can be reduced under these
+            options: this is 1, 2, 4 or 8.
+        */
+        int getReductionFactor (int fullWidth, int fullHeight) const noexcept;
+    };
+
     //==============================================================================
     /** Returns a description of this file format.
 
@@ -80,6 +148,16 @@ public:
     */
     virtual Image decodeImage (InputStream& input) = 0;
 
+    /** Tries to decode an image from the given stream, using some DecodeOptions.
+
+        The default implementation decodes the whole image with decodeImage() and then crops
+        and reduces it as the options require, but formats that can do better override this.
+
+        @returns        the image that was decoded, or an invalid image if it fails.
+        @see DecodeOptions
+    */
+    virtual Image decodeImageWithOptions (InputStream& input, const DecodeOptions& options);
+
     //==============================================================================
     /** Attempts to write an image to a stream.
 
@@ -131,6 +209,143 @@ public:
     static Image loadFrom (const void* rawData,
                            size_t numBytesOfData);
 
+    /** Tries to load an image from a stream, using some DecodeOptions.
+        @returns        the image that was decoded, or an invalid image if it fails.
+    */
+    static Image loadFrom (InputStream& input, const DecodeOptions& options);
+
+    /** Tries to load an image from a file, using some DecodeOptions.
+        @returns        the image that was decoded, or an invalid image if it fails.
+    */
+    static Image loadFrom (const File& file, const DecodeOptions& options);
+
+    //==============================================================================
+    /** An image that's being decoded in the background by loadAsync().
+
+        Hang on to the Ptr that loadAsync() returns, and call getImage() when isFinished()
+        returns true, or use waitUntilFinished() to block until it's done.
+    */
+    class JUCE_API  PendingImage  : public ReferenceCountedObject
+    {
+    public:
+        /** Destructor. */
+        ~PendingImage();
+
+        /** Returns true if the decoding has finished, failed or been cancelled. */
+        bool isFinished() const noexcept;
+
+        /** Waits until the decoding has finished.
+            @returns true if it finished, or false if the time-out expired first
+        */
+        bool waitUntilFinished (int timeOutMilliseconds = -1) const;
+
+        /** Returns the decoded image, or a null image if it hasn't finished yet, or if
+            it failed or was cancelled.
+        */
+        Image getImage() const;
+
+        /** Stops the image from being decoded.
+
+            If the decoder is already running, PNG and JPEG decoders will give up at the
+            next row, and other formats are allowed to finish, but their result is thrown
+            away. Either way, this object will count as finished after this call.
+        */
+        void cancel();
+
+        /** A pointer to a PendingImage. */
+        typedef ReferenceCountedObjectPtr<PendingImage> Ptr;
+
+    private:
+        friend class ImageFileFormat;
+        class DecodeJob;
+
+        const File file;
+        const MemoryBlock data;
+        const DecodeOptions options;
+        Image image;
+        CriticalSection lock;
+        WaitableEvent finishedEvent;
+        Atomic<int> finished, cancelled;
+
+        PendingImage (const File&, const MemoryBlock&, const DecodeOptions&);
+        void decode();
+        void setFinished (const Image&);
+
+        JUCE_DECLARE_NON_COPYABLE (PendingImage);
+    };
+
+    /** Starts loading an image file on one of the threads in a ThreadPool.
+
+        The image is decoded with decodeImageWithOptions(), so if the options contain a
+        DecodeListener, it'll be called on the pool's thread.
+    */
+    static PendingImage::Ptr loadAsync (ThreadPool& pool, const File& file,
+                                        const DecodeOptions& options = DecodeOptions());
+
+    /** Starts decoding a block of image data on one of the threads in a ThreadPool.
+
+        The data is copied, so the block doesn't need to be kept. If the options contain a
+        DecodeListener, it'll be called on the pool's thread.
+    */
+    static PendingImage::Ptr loadAsync (ThreadPool& pool, const MemoryBlock& imageData,
+                                        const DecodeOptions& options = DecodeOptions());
+
+protected:
+    //==============================================================================
+    /** Used by decoders to build the image that a set of DecodeOptions asks for.
+
+        The decoder passes in the rows of its (possibly already reduced) image in order,
+        and this crops them to the options' source area, averages them down by whatever
+        reduction is still needed, and tells the options' listener as each row of the
+        result is completed.
+    */
+    class JUCE_API  DecodedImageBuilder
+    {
+    public:
+        /** Creates a builder.
+
+            @param options          the options that the image is being decoded with
+            @param width            the width of the rows that the decoder will supply
+            @param height           the number of rows that the decoder will supply
+            @param decoderScale     the factor by which the decoder has already reduced the
+                                    image, so that it's (width * decoderScale) pixels wide
+            @param hasAlpha         true if the image has an alpha channel
+        */
+        DecodedImageBuilder (const DecodeOptions& options, int width, int height,
+                             int decoderScale, bool hasAlpha);
+
+        /** Destructor. */
+        ~DecodedImageBuilder();
+
+        /** Returns true if the given row is needed for the final image. */
+        bool needsRow (int y) const noexcept;
+
+        /** Returns true once all the rows that are needed have been added. */
+        bool isComplete() const noexcept;
+
+        /** Adds a row of 8-bit R, G, B pixels. */
+        void addRGBRow (int y, const uint8* pixels);
+
+        /** Adds a row of 8-bit R, G, B, A pixels (which aren't premultiplied). */
+        void addRGBARow (int y, const uint8* pixels);
+
+        /** Returns the image. */
+        const Image& getImage() const noexcept          { return image; }
+
+    private:
+        const DecodeOptions& options;
+        Rectangle<int> area;
+        int reduction, numRowsAdded, numRowsInTotals;
+        Image image;
+        bool hasAlpha;
+        HeapBlock<int> totals;
+
+        template <int numChannels>
+        void addRow (int y, const uint8* pixels);
+        void flushTotals();
+
+        JUCE_DECLARE_NON_COPYABLE (DecodedImageBuilder);
+    };
 };
 
 //==============================================================================
@@ -150,6 +365,7 @@ public:
     String getFormatName();
     bool canUnderstand (InputStream& input);
     Image decodeImage (InputStream& input);
+    Image decodeImageWithOptions (InputStream& input, const DecodeOptions& options);
     bool writeImageToStream (const Image& sourceImage, OutputStream& destStream);
 };
 
@@ -179,6 +395,7 @@ public:
     String getFormatName();
     bool canUnderstand (InputStream& input);
     Image decodeImage (InputStream& input);
+    Image decodeImageWithOptions (InputStream& input, const DecodeOptions& options);
     bool writeImageToStream (const Image& sourceImage, OutputStream& destStream);
 
 private:
@@ -0,0 +1,503 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+BEGIN_JUCE_NAMESPACE
+
+//==============================================================================
+// For each destination pixel along one axis, this holds the range of source pixels
+// that contribute to it and their weights, as fixed-point values that add up to
+// (1 << weightBits).
+class ImageResampler::WeightTable
+{
+public:
+    WeightTable (const FilterType filterType, const int sourceSize_, const int destSize_)
+        : sourceSize (sourceSize_), destSize (destSize_)
+    {
+        const double scale = destSize / (double) sourceSize;
+        const double filterScale = jmin (1.0, scale);
+        const double support = getFilterRadius (filterType) / filterScale;
+
+        maxTaps = jmin (sourceSize, (int) std::ceil (support * 2.0) + 1);
+        firstSource.malloc ((size_t) destSize);
+        numTaps.malloc ((size_t) destSize);
+        weights.calloc ((size_t) (destSize * maxTaps));
+
+        HeapBlock<double> values ((size_t) maxTaps);
+
+        for (int i = 0; i < destSize; ++i)
+        {
+            const double centre = (i + 0.5) / scale - 0.5;
+            const int first = jmax (0, (int) std::ceil (centre - support));
+            const int last = jmin (sourceSize - 1, jmin (first + maxTaps - 1, (int) std::floor (centre + support)));
+            const int num = jmax (1, last - first + 1);
+            double total = 0;
+
+            for (int j = 0; j < num; ++j)
+            {
+                values[j] = getFilterValue (filterType, (first + j - centre) * filterScale);
+                total += values[j];
+            }
+
+            int* const w = weights + i * maxTaps;
+
+            if (total == 0)
+            {
+                // (can only happen if the filter missed every pixel, so just use the nearest one)
+                firstSource[i] = jlimit (0, sourceSize - 1, roundToInt (centre));
+                numTaps[i] = 1;
+                w[0] = 1 << weightBits;
+                continue;
+            }
+
+            int fixedTotal = 0, biggest = 0;
+
+            for (int j = 0; j < num; ++j)
+            {
+                w[j] = roundToInt (values[j] * (1 << weightBits) / total);
+                fixedTotal += w[j];
+
+                if (w[j] > w[biggest])
+                    biggest = j;
+            }
+
+            // make sure the rounded weights still add up to exactly 1, so that flat areas stay flat
+            w[biggest] += (1 << weightBits) - fixedTotal;
+
+            firstSource[i] = first;
+            numTaps[i] = num;
+        }
+    }
+
+    enum
+    {
+        weightBits = 14,
+        intermediateBits = 7   // the extra bits of precision that the horizontal pass keeps
+    };
+
+    // Runs the horizontal pass over each line of the source data.
+    template <int numChannels>
+    void resampleLines (const Image::BitmapData& source, int* dest) const noexcept
+    {
+        const int shift = weightBits - intermediateBits;
+
+        for (int y = 0; y < source.height; ++y)
+        {
+            const uint8* const line = source.getLinePointer (y);
+
+            for (int i = 0; i < destSize; ++i)
+            {
+                const uint8* src = line + firstSource[i] * numChannels;
+                const int* const w = weights + i * maxTaps;
+                const int num = numTaps[i];
+                int total [numChannels];
+
+                for (int c = 0; c < numChannels; ++c)
+                    total[c] = 0;
+
+                for (int j = 0; j < num; ++j)
+                {
+                    for (int c = 0; c < numChannels; ++c)
+                        total[c] += w[j] * src[c];
+
+                    src += numChannels;
+                }
+
+                for (int c = 0; c < numChannels; ++c)
+                    *dest++ = (total[c] + (1 << (shift - 1))) >> shift;
+            }
+        }
+    }
+
+    const int sourceSize, destSize;
+    int maxTaps;
+    HeapBlock<int> firstSource, numTaps, weights;
+
+private:
+    static double getFilterRadius (const FilterType filterType) noexcept
+    {
+        switch (filterType)
+        {
+            case boxFilter:         return 0.5;
+            case bilinearFilter:    return 1.0;
+            default:                return 3.0;
+        }
+    }
+
+    static double getFilterValue (const FilterType filterType, const double x) noexcept
+    {
+        switch (filterType)
+        {
+            case boxFilter:
+                return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+
+            case bilinearFilter:
+                return jmax (0.0, 1.0 - std::abs (x));
+
+            default:
+                if (x == 0)
+                    return 1.0;
+
+                if (x <= -3.0 || x >= 3.0)
+                    return 0.0;
+
+                {
+                    const double px = double_Pi * x;
+                    return 3.0 * std::sin (px) * std::sin (px / 3.0) / (px * px);
+                }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (WeightTable);
+};
+
+//==============================================================================
+ImageResampler::ImageResampler (const FilterType filterType_)
+    : filterType (filterType_),
+      intermediateSize (0),
+      lineTotalsSize (0)
+{
+}
+
+ImageResampler::~ImageResampler()
+{
+}
+
+ImageResampler::FilterType ImageResampler::getFilterTypeFor (const Graphics::ResamplingQuality quality) noexcept
+{
+    switch (quality)
+    {
+        case Graphics::lowResamplingQuality:      return boxFilter;
+        case Graphics::mediumResamplingQuality:   return bilinearFilter;
+        default:                                  return lanczos3Filter;
+    }
+}
+
+const ImageResampler::WeightTable& ImageResampler::getWeights (ScopedPointer<WeightTable>& table,
+                                                               const int sourceSize, const int destSize)
+{
+    if (table == nullptr || table->sourceSize != sourceSize || table->destSize != destSize)
+        table = new WeightTable (filterType, sourceSize, destSize);
+
+    return *table;
+}
+
+//==============================================================================
+Image ImageResampler::rescaled (const Image& sourceImage, const int newWidth, const int newHeight)
+{
+    if (! sourceImage.isValid())
+        return Image::null;
+
+    Image source (sourceImage);
+
+    if (filterType != boxFilter
+         && (source.getWidth() >= newWidth * 4 || source.getHeight() >= newHeight * 4))
+    {
+        if (boxResampler == nullptr)
+            boxResampler = new ImageResampler (boxFilter);
+
+        source = boxResampler->rescaled (source, jmin (source.getWidth(), newWidth * 2),
+                                                 jmin (source.getHeight(), newHeight * 2));
+    }
+
+    Image newImage (sourceImage.getFormat(), newWidth, newHeight, false, sourceImage.getSharedImage()->getType());
+
+    const Image::BitmapData srcData (source, Image::BitmapData::readOnly);
+    const Image::BitmapData destData (newImage, Image::BitmapData::writeOnly);
+    resample (srcData, destData);
+
+    return newImage;
+}
+
+void ImageResampler::resample (const Image::BitmapData& source, const Image::BitmapData& destination)
+{
+    // The source and destination must be the same format!
+    jassert (source.pixelFormat == destination.pixelFormat && source.pixelStride == destination.pixelStride);
+
+    if (source.pixelStride != destination.pixelStride
+         || source.width <= 0 || source.height <= 0
+         || destination.width <= 0 || destination.height <= 0)
+        return;
+
+    const WeightTable& columns = getWeights (horizontalWeights, source.width, destination.width);
+    const WeightTable& rows = getWeights (verticalWeights, source.height, destination.height);
+
+    const int numChannels = source.pixelStride;
+    const int valuesPerLine = destination.width * numChannels;
+
+    if ((size_t) (valuesPerLine * source.height) > intermediateSize)
+    {
+        intermediateSize = (size_t) (valuesPerLine * source.height);
+        intermediate.malloc (intermediateSize);
+    }
+
+    if ((size_t) valuesPerLine > lineTotalsSize)
+    {
+        lineTotalsSize = (size_t) valuesPerLine;
+        lineTotals.malloc (lineTotalsSize);
+    }
+
+    switch (numChannels)
+    {
+        case 4:     columns.resampleLines<4> (source, intermediate); break;
+        case 3:     columns.resampleLines<3> (source, intermediate); break;
+        default:    jassert (numChannels == 1); columns.resampleLines<1> (source, intermediate); break;
+    }
+
+    const int shift = WeightTable::weightBits + WeightTable::intermediateBits;
+    const int maxValue = 255 << shift;
+    const bool isPremultiplied = (source.pixelFormat == Image::ARGB);
+
+    for (int y = 0; y < destination.height; ++y)
+    {
+        const int* const w = rows.weights + y * rows.maxTaps;
+        const int first = rows.firstSource[y];
+        const int num = rows.numTaps[y];
+        int* const totals = lineTotals;
+
+        for (int i = 0; i < valuesPerLine; ++i)
+            totals[i] = 1 << (shift - 1);
+
+        for (int j = 0; j < num; ++j)
+        {
+            const int weight = w[j];
+            const int* const src = intermediate + (first + j) * valuesPerLine;
+
+            for (int i = 0; i < valuesPerLine; ++i)
+                totals[i] += weight * src[i];
+        }
+
+        uint8* const dest = destination.getLinePointer (y);
+
+        for (int i = 0; i < valuesPerLine; ++i)
+            dest[i] = (uint8) (jlimit (0, maxValue, totals[i]) >> shift);
+
+        if (isPremultiplied)
+        {
+            // The negative lobes of the lanczos filter can push a colour above its alpha,
+            // which isn't a valid premultiplied colour.
+            PixelARGB* p = (PixelARGB*) dest;
+
+            for (int x = destination.width; --x >= 0;)
+            {
+                const uint8 alpha = p->getAlpha();
+                uint8* const components = (uint8*) p;
+
+                for (int c = 0; c < 4; ++c)
+                    if (c != PixelARGB::indexA)
+                        components[c] = jmin (components[c], alpha);
+
+                ++p;
+            }
+        }
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageResamplerTests  : public UnitTest
+{
+public:
+    ImageResamplerTests() : UnitTest ("ImageResampler") {}
+
+    static bool isFilledWith (const Image& image, const Colour& colour)
+    {
+        const Image::BitmapData data (image, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < data.height; ++y)
+        {
+            for (int x = 0; x < data.width; ++x)
+            {
+                const Colour c (data.getPixelColour (x, y));
+
+                if (std::abs (c.getAlpha() - colour.getAlpha()) > 1
+                     || std::abs (c.getRed()   - colour.getRed()) > 1
+                     || std::abs (c.getGreen() - colour.getGreen()) > 1
+                     || std::abs (c.getBlue()  - colour.getBlue()) > 1)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void checkFilter (const ImageResampler::FilterType filterType, const Image::PixelFormat format,
+                      const Colour& colour, const int sourceW, const int sourceH, const int destW, const int destH)
+    {
+        Image source (format, sourceW, sourceH, false);
+        source.clear (source.getBounds(), colour);
+
+        // (the colour that the image actually holds, once it's been converted to its format)
+        const Colour expected (source.getPixelAt (0, 0));
+
+        const Image result (ImageResampler (filterType).rescaled (source, destW, destH));
+
+        expect (result.getFormat() == format);
+        expectEquals (result.getWidth(), destW);
+        expectEquals (result.getHeight(), destH);
+        expect (isFilledWith (result, expected));
+    }
+
+    static Image createMipmappedImage (const int w, const int h)
+    {
+        Image image (Image::ARGB, w, h, false);
+        image.clear (image.getBounds(), getLevelColour (0));
+        image.createMipmaps();
+
+        // give each level its own colour, so that we can see which one gets drawn
+        for (int i = 1; i <= image.getNumMipmaps(); ++i)
+        {
+            Image mipmap (image.getMipmap (i));
+            mipmap.clear (mipmap.getBounds(), getLevelColour (i));
+        }
+
+        return image;
+    }
+
+    static Colour getLevelColour (const int level)
+    {
+        return Colour ((uint8) (level * 30), (uint8) (200 - level * 20), (uint8) (level * 11), (uint8) 255);
+    }
+
+    int getLevelDrawn (const Image& image, const int sx, const int sy, const int sw, const int sh,
+                       const int dw, const int dh)
+    {
+        Image target (Image::ARGB, dw + 20, dh + 20, true);
+
+        {
+            Graphics g (target);
+            g.drawImage (image, 10, 10, dw, dh, sx, sy, sw, sh);
+        }
+
+        const Colour c (target.getPixelAt (10 + dw / 2, 10 + dh / 2));
+
+        for (int i = 0; i <= image.getNumMipmaps(); ++i)
+            if (c == getLevelColour (i))
+                return i;
+
+        return -1;
+    }
+
+    void runTest()
+    {
+        const ImageResampler::FilterType filterTypes[] = { ImageResampler::boxFilter,
+                                                           ImageResampler::bilinearFilter,
+                                                           ImageResampler::lanczos3Filter };
+
+        const Image::PixelFormat formats[] = { Image::ARGB, Image::RGB, Image::SingleChannel };
+
+        const Colour colours[] = { Colour (0xff336699), Colour (0x80ff2010), Colour (0xffffffff), Colour (0x00000000) };
+
+        beginTest ("Solid colours");
+
+        for (int f = 0; f < numElementsInArray (filterTypes); ++f)
+        {
+            for (int i = 0; i < numElementsInArray (formats); ++i)
+            {
+                for (int c = 0; c < numElementsInArray (colours); ++c)
+                {
+                    checkFilter (filterTypes[f], formats[i], colours[c], 10, 7, 37, 23);   // enlarging
+                    checkFilter (filterTypes[f], formats[i], colours[c], 64, 48, 13, 9);   // reducing
+                    checkFilter (filterTypes[f], formats[i], colours[c], 200, 150, 7, 5);  // reducing a lot
+                    checkFilter (filterTypes[f], formats[i], colours[c], 37, 23, 100, 9);  // stretching one way, squashing the other
+                    checkFilter (filterTypes[f], formats[i], colours[c], 16, 16, 1, 1);
+                }
+            }
+        }
+
+        beginTest ("Output sizes");
+
+        {
+            Image source (Image::ARGB, 50, 30, true);
+
+            const Image same (source.rescaled (50, 30));
+            expectEquals (same.getWidth(), 50);
+            expectEquals (same.getHeight(), 30);
+
+            const Image bigger (source.rescaled (123, 4, Graphics::lowResamplingQuality));
+            expectEquals (bigger.getWidth(), 123);
+            expectEquals (bigger.getHeight(), 4);
+
+            const Image smaller (source.rescaled (3, 29, Graphics::mediumResamplingQuality));
+            expectEquals (smaller.getWidth(), 3);
+            expectEquals (smaller.getHeight(), 29);
+        }
+
+        beginTest ("Mipmaps");
+
+        {
+            Image image (Image::ARGB, 100, 37, true);
+            expectEquals (image.getNumMipmaps(), 0);
+
+            image.createMipmaps();
+
+            const int expectedSizes[][2] = { { 100, 37 }, { 50, 18 }, { 25, 9 }, { 12, 4 }, { 6, 2 }, { 3, 1 }, { 1, 1 } };
+            expectEquals (image.getNumMipmaps(), numElementsInArray (expectedSizes) - 1);
+
+            for (int i = 0; i < numElementsInArray (expectedSizes); ++i)
+            {
+                const Image mipmap (image.getMipmap (i));
+                expectEquals (mipmap.getWidth(), expectedSizes[i][0]);
+                expectEquals (mipmap.getHeight(), expectedSizes[i][1]);
+            }
+
+            expect (image.getMipmap (0) == image);
+            expect (! image.getMipmap (image.getNumMipmaps() + 1).isValid());
+
+            // changing the image makes its mipmaps out-of-date, so they get thrown away
+            image.clear (image.getBounds(), Colours::red);
+            expectEquals (image.getNumMipmaps(), 0);
+        }
+
+        beginTest ("Mipmap selection");
+
+        {
+            const Image image (createMipmappedImage (64, 64));
+            expectEquals (image.getNumMipmaps(), 6);
+
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 64, 64), 0);
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 100, 100), 0);
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 40, 40), 0);
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 33, 33), 0);
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 32, 32), 1);
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 20, 20), 1);
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 16, 16), 2);
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 3, 3), 4);
+
+            // the level is chosen by whichever axis is shrunk the least..
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 8, 40), 0);
+            expectEquals (getLevelDrawn (image, 0, 0, 64, 64, 16, 4), 2);
+
+            // ..and by the size of the source area, not the whole image
+            expectEquals (getLevelDrawn (image, 16, 16, 32, 32, 8, 8), 2);
+            expectEquals (getLevelDrawn (image, 8, 0, 48, 64, 12, 16), 2);
+        }
+    }
+};
+
+static ImageResamplerTests imageResamplerUnitTests;
+
+#endif
+
+END_JUCE_NAMESPACE
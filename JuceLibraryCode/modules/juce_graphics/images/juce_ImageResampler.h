@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+#ifndef __JUCE_IMAGERESAMPLER_JUCEHEADER__
+#define __JUCE_IMAGERESAMPLER_JUCEHEADER__
+
+#include "juce_Image.h"
+
+
+//==============================================================================
+/**
+    Resizes images using a separable filter.
+
+    Each output pixel is a weighted sum of the source pixels around it, calculated in a
+    horizontal pass and then a vertical pass. When an image is being reduced, the filter
+    is widened to cover all the source pixels that fall inside each output pixel, so
+    large reductions don't alias the way that point-sampling does.
+
+    The tables of filter weights are kept between calls, so if you're resizing a lot of
+    images of the same size (e.g. making thumbnails of a folder of photos), re-using
+    one ImageResampler avoids recalculating them.
+
+    @see Image::rescaled, Image::createMipmaps
+*/
+class JUCE_API  ImageResampler
+{
+public:
+    //==============================================================================
+    /** The filters that can be used. */
+    enum FilterType
+    {
+        boxFilter,          /**< Averages the source pixels under each output pixel. This
+                                 is the fastest filter, and is fine for halving an image, but
+                                 gives blocky results when enlarging one. */
+        bilinearFilter,     /**< A triangle filter, which gives smooth results when enlarging
+                                 an image, and a slightly soft result when reducing one. */
+        lanczos3Filter      /**< A windowed sinc filter, which gives the sharpest results,
+                                 but is the slowest of the three. */
+    };
+
+    /** Creates a resampler that uses the given filter. */
+    explicit ImageResampler (FilterType filterType = lanczos3Filter);
+
+    /** Destructor. */
+    ~ImageResampler();
+
+    //==============================================================================
+    /** Returns the filter type that's used for one of the Graphics resampling qualities. */
+    static FilterType getFilterTypeFor (Graphics::ResamplingQuality quality) noexcept;
+
+    /** Returns the filter that this object uses. */
+    FilterType getFilterType() const noexcept               { return filterType; }
+
+    //==============================================================================
+    /** Returns a resized copy of an image.
+
+        The new image will have the same format and type as the source. If the image is
+        being reduced to less than a quarter of its size, it's first reduced to twice the
+        new size with a box filter, which is much quicker than running the wider filters
+        over all of its pixels, and looks practically the same.
+    */
+    Image rescaled (const Image& sourceImage, int newWidth, int newHeight);
+
+    /** Resizes the pixels in one block of bitmap data to fill another one.
+
+        The two blocks must have the same pixel format. ARGB data is treated as being
+        premultiplied, as it is everywhere else in the library.
+    */
+    void resample (const Image::BitmapData& source, const Image::BitmapData& destination);
+
+private:
+    //==============================================================================
+    class WeightTable;
+
+    const FilterType filterType;
+    ScopedPointer<WeightTable> horizontalWeights, verticalWeights;
+    ScopedPointer<ImageResampler> boxResampler;
+    HeapBlock<int> intermediate, lineTotals;
+    size_t intermediateSize, lineTotalsSize;
+
+    const WeightTable& getWeights (ScopedPointer<WeightTable>& table, int sourceSize, int destSize);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImageResampler);
+};
+
+
+#endif   // __JUCE_IMAGERESAMPLER_JUCEHEADER__
@@ -131,6 +131,9 @@ BEGIN_JUCE_NAMESPACE
 #ifndef __JUCE_IMAGE_JUCEHEADER__
  #include "images/juce_Image.h"
 #endif
+#ifndef __JUCE_IMAGEBLUR_JUCEHEADER__
+ #include "images/juce_ImageBlur.h"
+#endif
 #ifndef __JUCE_IMAGECACHE_JUCEHEADER__
  #include "images/juce_ImageCache.h"
 #endif
@@ -140,6 +143,9 @@ BEGIN_JUCE_NAMESPACE
 #ifndef __JUCE_IMAGEFILEFORMAT_JUCEHEADER__
  #include "images/juce_ImageFileFormat.h"
 #endif
+#ifndef __JUCE_IMAGERESAMPLER_JUCEHEADER__
+ #include "images/juce_ImageResampler.h"
+#endif
 #ifndef __JUCE_ATTRIBUTEDSTRING_JUCEHEADER__
  #include "fonts/juce_AttributedString.h"
 #endif
@@ -111,7 +111,7 @@ public:
         IDWriteTextLayout* dwTextLayout = nullptr;
         hr = dwFactory->CreateTextLayout (
             text.getText().toWideCharPointer(),
-            text.getText().length(),
+            text.getLength(),
             dwTextFormat,
             glyphLayout.getWidth(),
             glyphLayout.getHeight(),
@@ -124,8 +124,8 @@ public:
         {
             Attr* attr = text.getCharAttribute (i);
             // Character Range Error Checking
-            if (attr->range.getStart() > text.getText().length()) continue;
-            if (attr->range.getEnd() > text.getText().length()) attr->range.setEnd (text.getText().length());
+            if (attr->range.getStart() > text.getLength()) continue;
+            if (attr->range.getEnd() > text.getLength()) attr->range.setEnd (text.getLength());
             if (attr->attribute == Attr::font)
             {
                 AttrFont* attrFont = static_cast<AttrFont*>(attr);
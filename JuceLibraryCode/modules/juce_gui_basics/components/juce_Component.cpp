@@ -314,32 +314,132 @@ public:
         return r;
     }
 
-    static void clipObscuredRegions (const Component& comp, Graphics& g, const Rectangle<int>& clipRect, const Point<int>& delta)
-    {
-        for (int i = comp.childComponentList.size(); --i >= 0;)
+    // Adds the parts of a child (within the given area of its parent) that will be
+    // completely covered by either the child or one of its opaque sub-components.
+    // Translucent, transformed and effect-filtered components can't hide anything.
+    static void addOccludedRegion (const Component& child, RectangleList& result,
+                                   const Rectangle<int>& clipRect, const Point<int>& delta)
+    {
+        if (child.flags.visibleFlag && child.affineTransform == nullptr
+             && child.componentTransparency == 0 && child.effect == nullptr)
         {
-            const Component& child = *comp.childComponentList.getUnchecked(i);
+            const Rectangle<int> area (clipRect.getIntersection (child.bounds));
 
-            if (child.isVisible() && ! child.isTransformed())
+            if (! area.isEmpty())
             {
-                const Rectangle<int> newClip (clipRect.getIntersection (child.bounds));
-
-                if (! newClip.isEmpty())
+                if (child.flags.opaqueFlag)
                 {
-                    if (child.isOpaque())
-                    {
-                        g.excludeClipRegion (newClip + delta);
-                    }
-                    else
-                    {
-                        const Point<int> childPos (child.getPosition());
-                        clipObscuredRegions (child, g, newClip - childPos, childPos + delta);
-                    }
+                    result.add (area + delta);
+                }
+                else
+                {
+                    const Point<int> childPos (child.getPosition());
+
+                    for (int i = child.childComponentList.size(); --i >= 0;)
+                        addOccludedRegion (*child.childComponentList.getUnchecked(i), result,
+                                           area - childPos, childPos + delta);
                 }
             }
         }
     }
 
+    static Component::PaintStatistics paintStats;
+    static bool collectPaintStats, showOverdraw;
+
+    // While a peer is painting with the overdraw overlay turned on, this is its component,
+    // and every region that gets painted is added to overdrawAreas, relative to it.
+    static Component* overdrawTarget;
+    static Array<Rectangle<int> > overdrawAreas;
+
+    static int64 getArea (const RectangleList& region) noexcept
+    {
+        int64 total = 0;
+
+        for (RectangleList::Iterator i (region); i.next();)
+            total += i.getRectangle()->getWidth() * (int64) i.getRectangle()->getHeight();
+
+        return total;
+    }
+
+    static bool isCollectingPaintedRegions() noexcept
+    {
+        return collectPaintStats || overdrawTarget != nullptr;
+    }
+
+    static void addPaintedRegion (const Component& comp, const RectangleList& region)
+    {
+        if (collectPaintStats)
+        {
+            ++paintStats.numComponentsPainted;
+            paintStats.numPixelsPainted += getArea (region);
+        }
+
+        if (overdrawTarget != nullptr)
+        {
+            const Point<int> offset (overdrawTarget->getLocalPoint (&comp, Point<int>()));
+
+            for (RectangleList::Iterator i (region); i.next();)
+                overdrawAreas.add (*i.getRectangle() + offset);
+        }
+    }
+
+    //==============================================================================
+    struct PaintTimingEntry
+    {
+        const std::type_info* type;
+        int numPaints;
+        int64 totalTicks, longestTicks;
+    };
+
+    static Array<PaintTimingEntry> paintTimings;
+    static bool timePaints;
+
+    static void addPaintTime (const Component& comp, const int64 ticks)
+    {
+        const std::type_info& type = typeid (comp);
+
+        for (int i = paintTimings.size(); --i >= 0;)
+        {
+            PaintTimingEntry& e = paintTimings.getReference (i);
+
+            if (*e.type == type)
+            {
+                ++e.numPaints;
+                e.totalTicks += ticks;
+                e.longestTicks = jmax (e.longestTicks, ticks);
+                return;
+            }
+        }
+
+        const PaintTimingEntry e = { &type, 1, ticks, ticks };
+        paintTimings.add (e);
+    }
+
+    static String getClassName (const std::type_info& type)
+    {
+       #if JUCE_GCC
+        int status = 0;
+        char* const demangled = abi::__cxa_demangle (type.name(), nullptr, nullptr, &status);
+
+        if (demangled != nullptr)
+        {
+            const String name (demangled);
+            ::free (demangled);
+            return name;
+        }
+       #endif
+
+        return type.name();
+    }
+
+    struct PaintTimingComparator
+    {
+        static int compareElements (const Component::PaintTiming& first, const Component::PaintTiming& second) noexcept
+        {
+            return first.totalSeconds > second.totalSeconds ? -1 : (first.totalSeconds < second.totalSeconds ? 1 : 0);
+        }
+    };
+
     static void subtractObscuredRegions (const Component& comp, RectangleList& result,
                                          const Point<int>& delta,
                                          const Rectangle<int>& clipRect,
@@ -377,6 +477,14 @@ public:
     }
 };
 
+Component::PaintStatistics Component::ComponentHelpers::paintStats = { 0, 0, 0, 0 };
+bool Component::ComponentHelpers::collectPaintStats = false;
+bool Component::ComponentHelpers::showOverdraw = false;
+Component* Component::ComponentHelpers::overdrawTarget = nullptr;
+Array<Rectangle<int> > Component::ComponentHelpers::overdrawAreas;
+Array<Component::ComponentHelpers::PaintTimingEntry> Component::ComponentHelpers::paintTimings;
+bool Component::ComponentHelpers::timePaints = false;
+
 
 //==============================================================================
 Component::Component()
@@ -701,15 +809,145 @@ bool Component::isOpaque() const noexcept
 }
 
 //==============================================================================
+/*  Keeps the image for a component that uses setBufferedToImage(), along with the
+    region of it that's still valid. All the live buffers are kept in a list so that
+    the least recently painted ones can be released when they use too much memory.
+*/
+class Component::BufferedImage
+{
+public:
+    BufferedImage (Component& owner_)
+        : owner (owner_), lastPaintCount (0)
+    {
+        getAllBuffers().add (this);
+    }
+
+    ~BufferedImage()
+    {
+        getAllBuffers().removeValue (this);
+    }
+
+    void invalidate (const Rectangle<int>& area)
+    {
+        validArea.subtract (area);
+    }
+
+    void releaseImage()
+    {
+        image = Image::null;
+        validArea.clear();
+    }
+
+    void paint (Graphics& g)
+    {
+        const Image::PixelFormat format = owner.flags.opaqueFlag ? Image::RGB : Image::ARGB;
+
+        if (image.isNull() || image.getFormat() != format
+             || image.getWidth() != owner.getWidth() || image.getHeight() != owner.getHeight())
+        {
+            image = Image (format, owner.getWidth(), owner.getHeight(), false, Image::NativeImage);
+            validArea.clear();
+            releaseOtherBuffersIfOverLimit();
+        }
+
+        lastPaintCount = ++paintCounter;
+
+        RectangleList areaToPaint (g.getClipBounds().getIntersection (image.getBounds()));
+        areaToPaint.subtract (validArea);
+
+        if (! areaToPaint.isEmpty())
+        {
+            if (format != Image::RGB)
+                for (RectangleList::Iterator i (areaToPaint); i.next();)
+                    image.clear (*i.getRectangle());
+
+            {
+                Graphics imG (image);
+                imG.reduceClipRegion (areaToPaint);
+                owner.paint (imG);
+            }
+
+            validArea.add (areaToPaint);
+            validArea.consolidate();
+        }
+
+        g.setColour (Colours::black);
+        g.drawImageAt (image, 0, 0);
+    }
+
+    static int64 memoryLimit;
+
+private:
+    Component& owner;
+    Image image;
+    RectangleList validArea;
+    uint32 lastPaintCount;
+
+    static uint32 paintCounter;
+
+    static Array<BufferedImage*>& getAllBuffers()
+    {
+        static Array<BufferedImage*> allBuffers;
+        return allBuffers;
+    }
+
+    static int64 getNumBytes (const Image& image) noexcept
+    {
+        return image.getWidth() * (int64) image.getHeight() * (image.getFormat() == Image::RGB ? 3 : 4);
+    }
+
+    void releaseOtherBuffersIfOverLimit()
+    {
+        if (memoryLimit <= 0)
+            return;
+
+        const Array<BufferedImage*>& all = getAllBuffers();
+        int64 totalBytes = 0;
+
+        for (int i = all.size(); --i >= 0;)
+            totalBytes += getNumBytes (all.getUnchecked(i)->image);
+
+        while (totalBytes > memoryLimit)
+        {
+            BufferedImage* oldest = nullptr;
+
+            for (int i = all.size(); --i >= 0;)
+            {
+                BufferedImage* const b = all.getUnchecked(i);
+
+                if (b != this && b->image.isValid()
+                     && (oldest == nullptr || (int32) (b->lastPaintCount - oldest->lastPaintCount) < 0))
+                    oldest = b;
+            }
+
+            if (oldest == nullptr)
+                break;
+
+            totalBytes -= getNumBytes (oldest->image);
+            oldest->releaseImage();
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BufferedImage);
+};
+
+int64 Component::BufferedImage::memoryLimit = 128 * 1024 * 1024;
+uint32 Component::BufferedImage::paintCounter = 0;
+
 void Component::setBufferedToImage (const bool shouldBeBuffered)
 {
     if (shouldBeBuffered != flags.bufferToImageFlag)
     {
-        bufferedImage = Image::null;
+        bufferedImage = shouldBeBuffered ? new BufferedImage (*this) : nullptr;
         flags.bufferToImageFlag = shouldBeBuffered;
     }
 }
 
+void Component::setBufferedImageMemoryLimit (const int64 maxNumBytes)
+{
+    BufferedImage::memoryLimit = maxNumBytes;
+}
+
 //==============================================================================
 void Component::moveChildInternal (const int sourceIndex, const int destIndex)
 {
@@ -991,9 +1229,10 @@ void Component::setBounds (const int x, const int y, int w, int h)
             else if (! flags.hasHeavyweightPeerFlag)
                 repaintParent();
         }
-        else
+        else if (wasResized && bufferedImage != nullptr)
         {
-            bufferedImage = Image::null;
+            // (a buffer that's only been moved is still valid, so it can be kept)
+            bufferedImage->releaseImage();
         }
 
         if (flags.hasHeavyweightPeerFlag)
@@ -1183,25 +1422,25 @@ void Component::setTransform (const AffineTransform& newTransform)
     {
         if (affineTransform != nullptr)
         {
-            repaint();
+            repaintParent();
             affineTransform = nullptr;
-            repaint();
+            repaintParent();
 
             sendMovedResizedMessages (false, false);
         }
     }
     else if (affineTransform == nullptr)
     {
-        repaint();
+        repaintParent();
         affineTransform = new AffineTransform (newTransform);
-        repaint();
+        repaintParent();
         sendMovedResizedMessages (false, false);
     }
     else if (*affineTransform != newTransform)
     {
-        repaint();
+        repaintParent();
         *affineTransform = newTransform;
-        repaint();
+        repaintParent();
         sendMovedResizedMessages (false, false);
     }
 }
@@ -1692,7 +1931,7 @@ void Component::setAlpha (const float newAlpha)
         }
         else
         {
-            repaint();
+            repaintParent();
         }
     }
 }
@@ -1716,7 +1955,8 @@ void Component::repaint()
 void Component::repaint (const int x, const int y,
                          const int w, const int h)
 {
-    bufferedImage = Image::null;
+    if (bufferedImage != nullptr)
+        bufferedImage->invalidate (Rectangle<int> (x, y, w, h));
 
     if (flags.visibleFlag)
         internalRepaint (x, y, w, h);
@@ -1784,24 +2024,19 @@ void Component::internalRepaint (int x, int y, int w, int h)
 //==============================================================================
 void Component::paintComponent (Graphics& g)
 {
-    if (flags.bufferToImageFlag)
-    {
-        if (bufferedImage.isNull())
-        {
-            bufferedImage = Image (flags.opaqueFlag ? Image::RGB : Image::ARGB,
-                                   getWidth(), getHeight(), ! flags.opaqueFlag, Image::NativeImage);
-
-            Graphics imG (bufferedImage);
-            paint (imG);
-        }
+    const int64 startTicks = ComponentHelpers::timePaints ? Time::getHighResolutionTicks() : 0;
 
-        g.setColour (Colours::black);
-        g.drawImageAt (bufferedImage, 0, 0);
+    if (bufferedImage != nullptr)
+    {
+        bufferedImage->paint (g);
     }
     else
     {
         paint (g);
     }
+
+    if (ComponentHelpers::timePaints)
+        ComponentHelpers::addPaintTime (*this, Time::getHighResolutionTicks() - startTicks);
 }
 
 void Component::paintWithinParentContext (Graphics& g)
@@ -1813,23 +2048,67 @@ void Component::paintWithinParentContext (Graphics& g)
 void Component::paintComponentAndChildren (Graphics& g)
 {
     const Rectangle<int> clipBounds (g.getClipBounds());
+    const int numChildren = childComponentList.size();
+
+    // Go through the children from front to back, working out which part of each one
+    // isn't hidden behind the children in front of it. At the end, the occluded region
+    // is the part of this component that its children will completely cover.
+    // Only the children that overlap the clip get a region, and visibleRegionIndexes[i]
+    // is the index of child i's region, or -1 if it doesn't have one.
+    RectangleList occluded;
+    Array<RectangleList> visibleRegions;
+    HeapBlock<int> visibleRegionIndexes;
+
+    if (numChildren > 0)
+    {
+        visibleRegionIndexes.malloc ((size_t) numChildren);
+
+        for (int i = numChildren; --i >= 0;)
+        {
+            const Component& child = *childComponentList.getUnchecked (i);
+            visibleRegionIndexes[i] = -1;
+
+            if (child.flags.visibleFlag && child.affineTransform == nullptr
+                 && clipBounds.intersects (child.bounds))
+            {
+                visibleRegionIndexes[i] = visibleRegions.size();
+                visibleRegions.add (RectangleList (clipBounds.getIntersection (child.bounds)));
+                RectangleList& visible = visibleRegions.getReference (visibleRegions.size() - 1);
+
+                if (! occluded.isEmpty())
+                    visible.subtract (occluded);
+
+                ComponentHelpers::addOccludedRegion (child, occluded, clipBounds, Point<int>());
+            }
+        }
+    }
 
     if (flags.dontClipGraphicsFlag)
     {
+        if (ComponentHelpers::isCollectingPaintedRegions())
+            ComponentHelpers::addPaintedRegion (*this, g.getInternalContext()->getClipRegion());
+
         paintComponent (g);
     }
     else
     {
         g.saveState();
-        ComponentHelpers::clipObscuredRegions (*this, g, clipBounds, Point<int>());
+
+        for (RectangleList::Iterator i (occluded); i.next();)
+            g.excludeClipRegion (*i.getRectangle());
 
         if (! g.isClipEmpty())
+        {
+            if (ComponentHelpers::isCollectingPaintedRegions())
+                ComponentHelpers::addPaintedRegion (*this, g.getInternalContext()->getClipRegion());
+
             paintComponent (g);
+        }
 
         g.restoreState();
     }
 
-    for (int i = 0; i < childComponentList.size(); ++i)
+    for (int i = 0; i < numChildren; ++i)
     {
         Component& child = *childComponentList.getUnchecked (i);
 
@@ -1845,34 +2124,30 @@ void Component::paintComponentAndChildren (Graphics& g)
 
                 g.restoreState();
             }
-            else if (clipBounds.intersects (child.getBounds()))
+            else if (visibleRegionIndexes[i] >= 0)
             {
-                g.saveState();
+                const RectangleList& visible = visibleRegions.getReference (visibleRegionIndexes[i]);
 
                 if (child.flags.dontClipGraphicsFlag)
                 {
+                    g.saveState();
                     child.paintWithinParentContext (g);
+                    g.restoreState();
                 }
-                else if (g.reduceClipRegion (child.getBounds()))
+                else if (visible.isEmpty())
                 {
-                    bool nothingClipped = true;
-
-                    for (int j = i + 1; j < childComponentList.size(); ++j)
-                    {
-                        const Component& sibling = *childComponentList.getUnchecked (j);
-
-                        if (sibling.flags.opaqueFlag && sibling.isVisible() && sibling.affineTransform == nullptr)
-                        {
-                            nothingClipped = false;
-                            g.excludeClipRegion (sibling.getBounds());
-                        }
-                    }
+                    if (ComponentHelpers::collectPaintStats)
+                        ++ComponentHelpers::paintStats.numComponentsCulled;
+                }
+                else
+                {
+                    g.saveState();
 
-                    if (nothingClipped || ! g.isClipEmpty())
+                    if (g.reduceClipRegion (visible))
                         child.paintWithinParentContext (g);
-                }
 
-                g.restoreState();
+                    g.restoreState();
+                }
             }
         }
     }
@@ -1925,6 +2200,54 @@ void Component::setPaintingIsUnclipped (const bool shouldPaintWithoutClipping) n
     flags.dontClipGraphicsFlag = shouldPaintWithoutClipping;
 }
 
+Component::PaintStatistics Component::getPaintStatistics() noexcept
+{
+    return ComponentHelpers::paintStats;
+}
+
+void Component::resetPaintStatistics() noexcept
+{
+    zerostruct (ComponentHelpers::paintStats);
+    ComponentHelpers::paintTimings.clear();
+}
+
+void Component::setPaintStatisticsEnabled (const bool shouldBeEnabled) noexcept
+{
+    ComponentHelpers::collectPaintStats = shouldBeEnabled;
+}
+
+void Component::setOverdrawOverlayEnabled (const bool shouldBeEnabled) noexcept
+{
+    ComponentHelpers::showOverdraw = shouldBeEnabled;
+}
+
+void Component::setPaintTimingEnabled (const bool shouldBeEnabled) noexcept
+{
+    ComponentHelpers::timePaints = shouldBeEnabled;
+}
+
+Array<Component::PaintTiming> Component::getSlowestPaintingClasses (const int maxNumClasses)
+{
+    Array<PaintTiming> results;
+
+    for (int i = 0; i < ComponentHelpers::paintTimings.size(); ++i)
+    {
+        const ComponentHelpers::PaintTimingEntry& e = ComponentHelpers::paintTimings.getReference (i);
+
+        PaintTiming t;
+        t.className = ComponentHelpers::getClassName (*e.type);
+        t.numPaints = e.numPaints;
+        t.totalSeconds = Time::highResolutionTicksToSeconds (e.totalTicks);
+        t.longestSeconds = Time::highResolutionTicksToSeconds (e.longestTicks);
+        results.add (t);
+    }
+
+    ComponentHelpers::PaintTimingComparator comparator;
+    results.sort (comparator);
+    results.removeRange (maxNumClasses, results.size());
+    return results;
+}
+
 //==============================================================================
 Image Component::createComponentSnapshot (const Rectangle<int>& areaToGrab,
                                           const bool clipImageToComponentBounds)
@@ -2987,5 +3310,120 @@ bool Component::BailOutChecker::shouldBailOut() const noexcept
     return safePointer == nullptr;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ComponentPaintingTests  : public UnitTest
+{
+public:
+    ComponentPaintingTests() : UnitTest ("Component painting") {}
+
+    class CountingComponent  : public Component
+    {
+    public:
+        CountingComponent (const bool opaque) : numPaints (0)   { setOpaque (opaque); }
+
+        void paint (Graphics& g)
+        {
+            ++numPaints;
+
+            if (isOpaque())
+                g.fillAll (Colours::white);
+        }
+
+        int numPaints;
+    };
+
+    void runTest()
+    {
+        beginTest ("Covered siblings are culled");
+
+        {
+            CountingComponent parent (false), hidden (false), left (true), right (true);
+            parent.setBounds (0, 0, 100, 100);
+            hidden.setBounds (20, 20, 60, 60);
+            left.setBounds (0, 0, 50, 100);
+            right.setBounds (50, 0, 50, 100);
+
+            // the two opaque siblings in front cover the first one between them
+            parent.addAndMakeVisible (&hidden);
+            parent.addAndMakeVisible (&left);
+            parent.addAndMakeVisible (&right);
+
+            Image image (Image::RGB, 100, 100, true);
+            Graphics g (image);
+
+            Component::setPaintStatisticsEnabled (true);
+            Component::resetPaintStatistics();
+            parent.paintEntireComponent (g, true);
+            Component::setPaintStatisticsEnabled (false);
+
+            const Component::PaintStatistics stats (Component::getPaintStatistics());
+            expectEquals ((int) stats.numComponentsCulled, 1);
+            expectEquals ((int) stats.numComponentsPainted, 2);
+            expectEquals (hidden.numPaints, 0);
+            expectEquals (parent.numPaints, 0);
+            expectEquals (left.numPaints + right.numPaints, 2);
+        }
+
+        beginTest ("Painted area follows the clip region");
+
+        {
+            CountingComponent comp (true);
+            comp.setBounds (0, 0, 100, 100);
+
+            Image image (Image::RGB, 100, 100, true);
+            Graphics g (image);
+
+            RectangleList clip;
+            clip.add (Rectangle<int> (0, 0, 10, 10));
+            clip.add (Rectangle<int> (90, 90, 10, 10));
+            g.reduceClipRegion (clip);
+
+            Component::setPaintStatisticsEnabled (true);
+            Component::resetPaintStatistics();
+            comp.paintEntireComponent (g, true);
+            Component::setPaintStatisticsEnabled (false);
+
+            // the clip's bounding box would be the whole component
+            expectEquals ((int) Component::getPaintStatistics().numPixelsPainted, 200);
+        }
+
+        beginTest ("Buffered images");
+
+        {
+            CountingComponent comp (true);
+            comp.setBounds (0, 0, 50, 50);
+            comp.setBufferedToImage (true);
+            expect (! comp.isShowing());
+
+            Image image (Image::RGB, 100, 100, true);
+            Graphics g (image);
+
+            comp.paintEntireComponent (g, true);
+            comp.paintEntireComponent (g, true);
+            expectEquals (comp.numPaints, 1);
+
+            // moving a component doesn't change its contents, so the buffer is kept..
+            comp.setTopLeftPosition (30, 40);
+            comp.paintEntireComponent (g, true);
+            expectEquals (comp.numPaints, 1);
+
+            // ..but resizing it means that it has to be redrawn
+            comp.setSize (60, 50);
+            comp.paintEntireComponent (g, true);
+            expectEquals (comp.numPaints, 2);
+
+            comp.repaint (0, 0, 10, 10);
+            comp.paintEntireComponent (g, true);
+            expectEquals (comp.numPaints, 3);
+        }
+    }
+};
+
+static ComponentPaintingTests componentPaintingUnitTests;
+
+#endif
+
 
 END_JUCE_NAMESPACE
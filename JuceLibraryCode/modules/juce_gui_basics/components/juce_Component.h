@@ -1006,18 +1006,35 @@ public:
         redraw itself, it can use this buffer rather than actually calling the
         paint() method.
 
-        The buffer is kept until the repaint() method is called directly on
-        this component (or until it is resized), when the image is invalidated
-        and then redrawn the next time the component is painted.
+        When the repaint() method is called directly on this component, only the
+        area that was repainted is invalidated, and just that part of the buffer is
+        redrawn the next time the component is painted. Resizing the component
+        invalidates the whole buffer, but moving it, or changing its alpha or its
+        transform, doesn't.
 
         Note that only the drawing that happens within the component's paint()
         method is drawn into the buffer, it's child components are not buffered, and
         nor is the paintOverChildren() method.
 
+        The buffers of all components share a memory limit - see
+        setBufferedImageMemoryLimit().
+
         @see repaint, paint, createComponentSnapshot
     */
     void setBufferedToImage (bool shouldBeBuffered);
 
+    /** Sets the total number of bytes that the buffers of components which use
+        setBufferedToImage() may take up.
+
+        When a buffer is created that takes the total over this limit, the buffers of
+        the components that were least recently painted are released, and will be
+        redrawn from scratch if they're needed again. A limit of 0 or less means
+        there's no limit. By default, this is 128MB.
+
+        @see setBufferedToImage
+    */
+    static void setBufferedImageMemoryLimit (int64 maxNumBytes);
+
     /** Generates a snapshot of part of this component.
 
         This will return a new Image, the size of the rectangle specified,
@@ -1069,6 +1086,73 @@ public:
     */
     void setPaintingIsUnclipped (bool shouldPaintWithoutClipping) noexcept;
 
+    //==============================================================================
+    /** Some counters describing how much painting has been done.
+
+        Before painting its children, a component works out which parts of each of them
+        are hidden behind opaque components in front of them. Children that are completely
+        hidden aren't painted at all, and the others are clipped to their visible region.
+
+        @see getPaintStatistics, isOpaque
+    */
+    struct PaintStatistics
+    {
+        int64 numComponentsPainted;     /**< The number of times a component's paint() method was called. */
+        int64 numComponentsCulled;      /**< The number of times a child was skipped because it was hidden. */
+        int64 numPixelsPainted;         /**< The total area of the clip regions that paint() methods were called with. */
+        int64 numPixelsInFrames;        /**< The total area of the regions that windows were asked to repaint. */
+
+        /** Returns the average number of times each pixel of a window was painted. */
+        double getOverdrawRatio() const noexcept    { return numPixelsInFrames > 0 ? numPixelsPainted / (double) numPixelsInFrames : 0.0; }
+    };
+
+    /** Turns on the painting counters returned by getPaintStatistics().
+        This has a small cost for each component that is painted, so is off by default.
+    */
+    static void setPaintStatisticsEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns the painting counters that have accumulated while they were enabled, since
+        resetPaintStatistics() was called.
+        @see setPaintStatisticsEnabled
+    */
+    static PaintStatistics getPaintStatistics() noexcept;
+
+    /** Sets all the painting counters back to zero. */
+    static void resetPaintStatistics() noexcept;
+
+    /** Enables a debugging overlay that tints every area that a component paints.
+
+        Once a window has finished painting, each region that a component painted gets
+        tinted on top of it. The tint builds up where components are painted on top of each
+        other, so the darker areas show where the most overdraw is happening.
+    */
+    static void setOverdrawOverlayEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Describes how much time the paint() methods of one class of component have taken.
+        @see getSlowestPaintingClasses
+    */
+    struct PaintTiming
+    {
+        String className;       /**< The name of the component class. */
+        int numPaints;          /**< The number of times components of this class were painted. */
+        double totalSeconds;    /**< The total time spent painting them. */
+        double longestSeconds;  /**< The longest time that a single paint took. */
+    };
+
+    /** Turns on timing of the paint() methods of all components.
+        This has a small cost for each component that is painted, so is off by default.
+        @see getSlowestPaintingClasses
+    */
+    static void setPaintTimingEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns the classes of component whose paint() methods have taken the most time in
+        total, slowest first.
+
+        This only includes the time since setPaintTimingEnabled() was turned on, or since
+        resetPaintStatistics() was last called.
+    */
+    static Array<PaintTiming> getSlowestPaintingClasses (int maxNumClasses = 10);
+
     //==============================================================================
     /** Adds an effect filter to alter the component's appearance.
 
@@ -2254,7 +2338,11 @@ private:
     LookAndFeel* lookAndFeel;
     MouseCursor cursor;
     ImageEffectFilter* effect;
-    Image bufferedImage;
+
+    class BufferedImage;
+    friend class BufferedImage;
+    friend class ScopedPointer <BufferedImage>;
+    ScopedPointer <BufferedImage> bufferedImage;
 
     class MouseListenerList;
     friend class MouseListenerList;
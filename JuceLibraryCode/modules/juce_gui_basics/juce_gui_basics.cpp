@@ -39,6 +39,10 @@
 #include "../juce_core/native/juce_BasicNativeHeaders.h"
 #include "juce_gui_basics.h"
 
+#if JUCE_GCC
+ #include <cxxabi.h>
+#endif
+
 //==============================================================================
 #if JUCE_MAC
  #import <WebKit/WebKit.h>
@@ -1665,7 +1665,9 @@ private:
     public:
         LinuxRepaintManager (LinuxComponentPeer* const peer_)
             : peer (peer_),
-              lastTimeImageUsed (0)
+              lastTimeImageUsed (0),
+              lastFrameTime (0),
+              secondsPerPixel (0)
         {
            #if JUCE_USE_XSHM
             shmCompletedDrawing = true;
@@ -1693,24 +1695,40 @@ private:
             if (! shmCompletedDrawing)
                 return;
            #endif
-            if (! regionsNeedingRepaint.isEmpty())
+            if (areasNeedingRepaint.size() > 0 || ! deferredRegions.isEmpty())
             {
                 stopTimer();
-                performAnyPendingRepaintsNow();
+                paintNextFrame();
             }
             else if (Time::getApproximateMillisecondCounter() > lastTimeImageUsed + 3000)
             {
                 stopTimer();
                 image = Image::null;
             }
+            else if (getTimerInterval() != getFramePeriod())
+            {
+                startTimer (getFramePeriod());
+            }
         }
 
         void repaint (const Rectangle<int>& area)
         {
             if (! isTimerRunning())
-                startTimer (repaintTimerPeriod);
+                startTimer (getMillisecondsUntilNextFrame());
+
+            // each area is kept whole, so that paintNextFrame() can put it off as a unit
+            for (int i = areasNeedingRepaint.size(); --i >= 0;)
+            {
+                const Rectangle<int>& existing = areasNeedingRepaint.getReference (i);
+
+                if (existing.contains (area))
+                    return;
+
+                if (area.contains (existing))
+                    areasNeedingRepaint.remove (i);
+            }
 
-            regionsNeedingRepaint.add (area);
+            areasNeedingRepaint.add (area);
         }
 
         void performAnyPendingRepaintsNow()
@@ -1718,16 +1736,85 @@ private:
            #if JUCE_USE_XSHM
             if (! shmCompletedDrawing)
             {
-                startTimer (repaintTimerPeriod);
+                startTimer (getMillisecondsUntilNextFrame());
                 return;
             }
            #endif
 
+            RectangleList region (deferredRegions);
+
+            for (int i = 0; i < areasNeedingRepaint.size(); ++i)
+                region.add (areasNeedingRepaint.getReference (i));
+
+            deferredRegions.clear();
+            areasNeedingRepaint.clear();
+
+            paintRegion (region);
+        }
+
+       #if JUCE_USE_XSHM
+        void notifyPaintCompleted()                 { shmCompletedDrawing = true; }
+       #endif
+
+    private:
+        LinuxComponentPeer* const peer;
+        Image image;
+        uint32 lastTimeImageUsed, lastFrameTime;
+        Array<Rectangle<int> > areasNeedingRepaint;
+        RectangleList deferredRegions;
+        double secondsPerPixel;
+
+       #if JUCE_USE_XSHM
+        bool useARGBImagesForRendering, shmCompletedDrawing;
+       #endif
+
+        static int getFramePeriod() noexcept
+        {
+            return jmax (1, roundToInt (1000.0 / ComponentPeer::getTargetFrameRate()));
+        }
+
+        int getMillisecondsUntilNextFrame() const noexcept
+        {
+            const int elapsed = (int) (Time::getMillisecondCounter() - lastFrameTime);
+            return jlimit (1, getFramePeriod(), getFramePeriod() - elapsed);
+        }
+
+        static int64 getArea (const RectangleList& region) noexcept
+        {
+            int64 total = 0;
+
+            for (RectangleList::Iterator i (region); i.next();)
+                total += i.getRectangle()->getWidth() * (int64) i.getRectangle()->getHeight();
+
+            return total;
+        }
+
+        // Paints everything that's been requested since the last frame, unless the time
+        // that it's expected to take is over the frame period. In that case, the smaller
+        // areas are painted first, and the rest wait until the next frame. Areas that
+        // have already been deferred are always painted.
+        void paintNextFrame()
+        {
+            RectangleList region (deferredRegions);
+            deferredRegions.clear();
+
+            peer->frameStats.numRegionsDeferred
+                += ComponentPeer::chooseAreasToPaint (areasNeedingRepaint, region, deferredRegions,
+                                                      secondsPerPixel, 1.0 / ComponentPeer::getTargetFrameRate());
+
+            areasNeedingRepaint.clear();
+            paintRegion (region);
+        }
+
+        void paintRegion (RectangleList& originalRepaintRegion)
+        {
+            lastFrameTime = Time::getMillisecondCounter();
+            const double startTime = Time::getMillisecondCounterHiRes();
+
             peer->clearMaskedRegion();
 
-            RectangleList originalRepaintRegion (regionsNeedingRepaint);
-            regionsNeedingRepaint.clear();
             const Rectangle<int> totalArea (originalRepaintRegion.getBounds());
+            const int64 numPixels = getArea (originalRepaintRegion);
 
             if (! totalArea.isEmpty())
             {
@@ -1745,7 +1832,7 @@ private:
                                                      false, peer->depth, peer->visual));
                 }
 
-                startTimer (repaintTimerPeriod);
+                startTimer (getFramePeriod());
 
                 RectangleList adjustedList (originalRepaintRegion);
                 adjustedList.offsetAll (-totalArea.getX(), -totalArea.getY());
@@ -1776,27 +1863,18 @@ private:
                                         r.getX(), r.getY(), r.getWidth(), r.getHeight(),
                                         r.getX() - totalArea.getX(), r.getY() - totalArea.getY());
                 }
+
+                // keep a running estimate of how long each pixel takes to paint, for paintNextFrame()
+                const double secondsPerPixelThisFrame = (Time::getMillisecondCounterHiRes() - startTime)
+                                                          / (1000.0 * (double) jmax ((int64) 1, numPixels));
+
+                secondsPerPixel = secondsPerPixel * 0.75 + secondsPerPixelThisFrame * 0.25;
             }
 
             lastTimeImageUsed = Time::getApproximateMillisecondCounter();
-            startTimer (repaintTimerPeriod);
+            startTimer (getMillisecondsUntilNextFrame());
         }
 
-       #if JUCE_USE_XSHM
-        void notifyPaintCompleted()                 { shmCompletedDrawing = true; }
-       #endif
-
-    private:
-        enum { repaintTimerPeriod = 1000 / 100 };
-
-        LinuxComponentPeer* const peer;
-        Image image;
-        uint32 lastTimeImageUsed;
-        RectangleList regionsNeedingRepaint;
-
-       #if JUCE_USE_XSHM
-        bool useARGBImagesForRendering, shmCompletedDrawing;
-       #endif
         JUCE_DECLARE_NON_COPYABLE (LinuxRepaintManager);
     };
 
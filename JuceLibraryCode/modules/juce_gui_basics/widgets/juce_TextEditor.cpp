@@ -196,6 +196,43 @@ public:
         return section2;
     }
 
+    bool endsWithNewLine() const
+    {
+        return atoms.size() > 0 && atoms.getLast()->isNewLine();
+    }
+
+    // Moves any atoms that follow the first line-break into new sections (which are
+    // appended to the array), so that no section ever spans more than one paragraph.
+    void splitIntoLines (Array <UniformTextSection*>& followingLines)
+    {
+        int firstLineEnd = 0;
+
+        while (firstLineEnd < atoms.size() && ! getAtom (firstLineEnd)->isNewLine())
+            ++firstLineEnd;
+
+        if (++firstLineEnd >= atoms.size())
+            return;
+
+        UniformTextSection* line = nullptr;
+
+        for (int i = firstLineEnd; i < atoms.size(); ++i)
+        {
+            if (line == nullptr)
+            {
+                line = new UniformTextSection (String::empty, font, colour, 0);
+                followingLines.add (line);
+            }
+
+            TextAtom* const atom = getAtom (i);
+            line->atoms.add (atom);
+
+            if (atom->isNewLine())
+                line = nullptr;
+        }
+
+        atoms.removeRange (firstLineEnd, atoms.size() - firstLineEnd);
+    }
+
     void appendAllText (MemoryOutputStream& mo) const
     {
         for (int i = 0; i < atoms.size(); ++i)
@@ -353,6 +390,55 @@ public:
         }
     }
 
+    // Starts iterating at the beginning of a paragraph, given the index of its first section,
+    // its first character and its y position, plus the height of the line before it.
+    Iterator (const Array <UniformTextSection*>& sections_,
+              const float wordWrapWidth_,
+              const juce_wchar passwordCharacter_,
+              const int firstSectionIndex,
+              const int startIndex,
+              const float startY,
+              const float previousLineHeight)
+      : indexInText (startIndex),
+        lineY (startY),
+        lineHeight (0),
+        maxDescent (0),
+        atomX (0),
+        atomRight (0),
+        atom (0),
+        currentSection (nullptr),
+        sections (sections_),
+        sectionIndex (0),
+        atomIndex (0),
+        wordWrapWidth (wordWrapWidth_),
+        passwordCharacter (passwordCharacter_)
+    {
+        jassert (wordWrapWidth_ > 0);
+
+        if (firstSectionIndex > 0)
+        {
+            // put the iterator into the state it'd be in just after returning the line-break
+            // that ends the previous paragraph, so that it carries on exactly as if it had
+            // started from the beginning of the text.
+            sectionIndex = firstSectionIndex - 1;
+            currentSection = sections.getUnchecked (sectionIndex);
+            atomIndex = currentSection->getNumAtoms();
+            atom = currentSection->getAtom (atomIndex - 1);
+            jassert (atom->isNewLine());
+
+            indexInText -= atom->numChars;
+            lineHeight = previousLineHeight;
+            lineY -= previousLineHeight;
+        }
+        else if (sections.size() > 0)
+        {
+            currentSection = sections.getUnchecked (0);
+
+            if (currentSection != nullptr)
+                beginNewLine();
+        }
+    }
+
     Iterator (const Iterator& other)
       : indexInText (other.indexInText),
         lineY (other.lineY),
@@ -750,6 +836,459 @@ private:
 };
 
 
+//==============================================================================
+// Caches the word-wrapped size of each paragraph (i.e. each run of sections that ends
+// with a line-break), so that an edit only needs to re-wrap the paragraphs it touches.
+// The paragraphs' lengths and heights are kept in a prefix-sum tree, so finding the
+// paragraph at a given character index or y position doesn't involve walking the text.
+class TextEditor::ParagraphCache
+{
+public:
+    ParagraphCache (const Array <UniformTextSection*>& sections_)
+        : sections (sections_),
+          numDiscardedLeaves (0),
+          layoutWidth (0),
+          layoutPasswordCharacter (0),
+          firstDirty (0),
+          endDirty (0),
+          maxWidth (0),
+          maxWidthNeedsUpdating (false),
+          editFirstParagraph (0),
+          editNumParagraphs (0),
+          editFirstSection (0),
+          editNumSections (0),
+          editTotalSections (0)
+    {
+        rebuild();
+    }
+
+    //==============================================================================
+    void rebuild()
+    {
+        paragraphs.clearQuick();
+        findParagraphs (0, sections.size(), true, paragraphs);
+        rebuildTree();
+        invalidateAll();
+    }
+
+    // Must be called before changing the sections that cover a range of characters. This
+    // returns the index of the first character of the first section that may be affected.
+    int beginEdit (const Range<int>& charRange, int& firstSection)
+    {
+        editFirstParagraph = findParagraphContaining (charRange.getStart());
+
+        const int lastParagraph = findParagraphContaining (charRange.getEnd());
+        editNumParagraphs = lastParagraph + 1 - editFirstParagraph;
+
+        const Totals start (getTotalsBefore (editFirstParagraph));
+        editFirstSection = firstSection = start.numSections;
+        editNumSections = getTotalsBefore (lastParagraph + 1).numSections - editFirstSection;
+        editTotalSections = sections.size();
+
+        return start.numChars;
+    }
+
+    Range<int> getEditedSections() const
+    {
+        return Range<int> (editFirstSection, editFirstSection + editNumSections
+                                               + sections.size() - editTotalSections);
+    }
+
+    void endEdit (const int numSectionsInRegion)
+    {
+        Array <Paragraph> newParagraphs;
+        findParagraphs (editFirstSection, editFirstSection + numSectionsInRegion,
+                        editFirstParagraph + editNumParagraphs >= paragraphs.size(), newParagraphs);
+
+        for (int i = editFirstParagraph; i < editFirstParagraph + editNumParagraphs; ++i)
+            if (paragraphs.getReference (i).width >= maxWidth)
+                maxWidthNeedsUpdating = true;
+
+        const int numAdded = newParagraphs.size() - editNumParagraphs;
+
+        if (numAdded == 0)
+        {
+            for (int i = 0; i < newParagraphs.size(); ++i)
+            {
+                Paragraph& p = paragraphs.getReference (editFirstParagraph + i);
+                addToTree (editFirstParagraph + i, Totals (newParagraphs.getReference (i)) - Totals (p));
+                p = newParagraphs.getReference (i);
+            }
+        }
+        else if (editFirstParagraph + editNumParagraphs >= paragraphs.size())
+        {
+            // text added at the end only needs the tail of the tree to be replaced
+            paragraphs.removeRange (editFirstParagraph, editNumParagraphs);
+            tree.removeRange (numDiscardedLeaves + editFirstParagraph, editNumParagraphs);
+
+            for (int i = 0; i < newParagraphs.size(); ++i)
+            {
+                paragraphs.add (newParagraphs.getReference (i));
+                addToEndOfTree (newParagraphs.getReference (i));
+            }
+        }
+        else
+        {
+            paragraphs.removeRange (editFirstParagraph, editNumParagraphs);
+            paragraphs.insertArray (editFirstParagraph, newParagraphs.getRawDataPointer(), newParagraphs.size());
+            rebuildTree();
+        }
+
+        // the paragraph after the edit starts its first line relative to the line-break
+        // before it, so that needs to be re-wrapped too.
+        const int editEnd = editFirstParagraph + newParagraphs.size();
+
+        if (editEnd < paragraphs.size())
+            paragraphs.getReference (editEnd).needsLayout = true;
+
+        const int newDirtyEnd = jmin (paragraphs.size(), editEnd + 1);
+
+        if (firstDirty < endDirty)
+        {
+            endDirty = jmax (newDirtyEnd, endDirty > editFirstParagraph + editNumParagraphs ? endDirty + numAdded : 0);
+            firstDirty = jmin (firstDirty, editFirstParagraph);
+        }
+        else
+        {
+            firstDirty = editFirstParagraph;
+            endDirty = newDirtyEnd;
+        }
+    }
+
+    //==============================================================================
+    void updateLayout (const float wordWrapWidth, const juce_wchar passwordCharacter)
+    {
+        if (wordWrapWidth != layoutWidth || passwordCharacter != layoutPasswordCharacter)
+        {
+            layoutWidth = wordWrapWidth;
+            layoutPasswordCharacter = passwordCharacter;
+            invalidateAll();
+        }
+
+        if (firstDirty < endDirty)
+        {
+            // when most of the text has changed, it's quicker to rebuild the tree afterwards
+            const bool updateTreeAfterwards = (endDirty - firstDirty) > paragraphs.size() / 8;
+
+            const Totals start (getTotalsBefore (firstDirty));
+            int sectionIndex = start.numSections;
+            int index = start.numChars;
+
+            for (int i = firstDirty; i < endDirty; ++i)
+            {
+                Paragraph& p = paragraphs.getReference (i);
+
+                if (p.needsLayout)
+                {
+                    const Totals oldTotals (p);
+                    layOutParagraph (i, sectionIndex, index);
+
+                    if (! updateTreeAfterwards)
+                        addToTree (i, Totals (p) - oldTotals);
+
+                    // an empty last paragraph takes its height from the line before it
+                    if (i == paragraphs.size() - 2 && paragraphs.getReference (i + 1).numChars == 0)
+                    {
+                        paragraphs.getReference (i + 1).needsLayout = true;
+                        endDirty = paragraphs.size();
+                    }
+                }
+
+                sectionIndex += p.numSections;
+                index += p.numChars;
+            }
+
+            firstDirty = endDirty = 0;
+
+            if (updateTreeAfterwards)
+                rebuildTree();
+        }
+    }
+
+    // Removes the given number of paragraphs from the start of the text, returning the
+    // number of characters, sections and the height that they covered.
+    int discardFirstParagraphs (const int numToDiscard, int& numSections, float& height)
+    {
+        jassert (numToDiscard > 0 && numToDiscard < paragraphs.size());
+
+        const Totals discarded (getTotalsBefore (numToDiscard));
+        numSections = discarded.numSections;
+        height = (float) discarded.height;
+
+        for (int i = 0; i < numToDiscard; ++i)
+        {
+            const Paragraph& p = paragraphs.getReference (i);
+
+            if (p.width >= maxWidth)
+                maxWidthNeedsUpdating = true;
+
+            addToTree (i, Totals() - Totals (p));
+        }
+
+        // The discarded paragraphs' leaves stay at the start of the tree with their totals
+        // zeroed, until there are enough of them to make it worth rebuilding the tree.
+        paragraphs.removeRange (0, numToDiscard);
+        numDiscardedLeaves += numToDiscard;
+
+        if (numDiscardedLeaves > paragraphs.size())
+            rebuildTree();
+
+        // the new first paragraph no longer follows a line-break, so needs re-wrapping
+        paragraphs.getReference (0).needsLayout = true;
+        endDirty = jmax (1, firstDirty < endDirty ? endDirty - numToDiscard : 0);
+        firstDirty = 0;
+
+        return discarded.numChars;
+    }
+
+    //==============================================================================
+    int getTotalNumChars() const        { return getTotalsBefore (paragraphs.size()).numChars; }
+
+    // (an empty paragraph after the last line-break doesn't count as a line)
+    int getNumLines() const             { return paragraphs.size() - (paragraphs.getLast().numChars == 0 ? 1 : 0); }
+    float getTotalHeight() const        { return (float) getTotalsBefore (paragraphs.size()).height; }
+
+    int getParagraphStart (const int paragraph, int& firstSection) const
+    {
+        const Totals start (getTotalsBefore (paragraph));
+        firstSection = start.numSections;
+        return start.numChars;
+    }
+
+    float getMaxWidth()
+    {
+        if (maxWidthNeedsUpdating)
+        {
+            maxWidthNeedsUpdating = false;
+            maxWidth = 0;
+
+            for (int i = paragraphs.size(); --i >= 0;)
+                maxWidth = jmax (maxWidth, paragraphs.getReference (i).width);
+        }
+
+        return maxWidth;
+    }
+
+    int findParagraphContaining (const int index) const     { return findParagraph (&Totals::numChars, index); }
+    int findParagraphAt (const float y) const               { return findParagraph (&Totals::height, (double) y); }
+
+    // (the layout must be up-to-date when this is called)
+    Iterator createIterator (const int paragraph) const
+    {
+        const Totals start (getTotalsBefore (paragraph));
+
+        return Iterator (sections, layoutWidth, layoutPasswordCharacter,
+                         start.numSections, start.numChars, (float) start.height,
+                         paragraph > 0 ? paragraphs.getReference (paragraph - 1).lastLineHeight : 0.0f);
+    }
+
+private:
+    //==============================================================================
+    struct Paragraph
+    {
+        Paragraph() noexcept
+            : numChars (0), numSections (0), height (0), width (0), lastLineHeight (0), needsLayout (true)
+        {}
+
+        int numChars, numSections;
+        float height, width, lastLineHeight;
+        bool needsLayout;
+    };
+
+    struct Totals
+    {
+        Totals() noexcept : numChars (0), numSections (0), height (0) {}
+
+        Totals (const Paragraph& p) noexcept
+            : numChars (p.numChars), numSections (p.numSections), height (p.height)
+        {}
+
+        Totals& operator+= (const Totals& other) noexcept
+        {
+            numChars += other.numChars;
+            numSections += other.numSections;
+            height += other.height;
+            return *this;
+        }
+
+        Totals operator- (const Totals& other) const noexcept
+        {
+            Totals t (*this);
+            t.numChars -= other.numChars;
+            t.numSections -= other.numSections;
+            t.height -= other.height;
+            return t;
+        }
+
+        int numChars, numSections;
+        double height;
+    };
+
+    const Array <UniformTextSection*>& sections;
+    Array <Paragraph> paragraphs;
+    Array <Totals> tree;  // a Fenwick tree of the paragraph totals
+    int numDiscardedLeaves;  // the number of empty leaves at the start of the tree
+    float layoutWidth;
+    juce_wchar layoutPasswordCharacter;
+    int firstDirty, endDirty;
+    float maxWidth;
+    bool maxWidthNeedsUpdating;
+    int editFirstParagraph, editNumParagraphs, editFirstSection, editNumSections, editTotalSections;
+
+    //==============================================================================
+    void findParagraphs (const int startSection, const int endSection,
+                         const bool reachesEndOfText, Array <Paragraph>& results) const
+    {
+        Paragraph p;
+
+        for (int i = startSection; i < endSection; ++i)
+        {
+            const UniformTextSection* const s = sections.getUnchecked (i);
+
+            ++p.numSections;
+            p.numChars += s->getTotalLength();
+
+            if (s->endsWithNewLine())
+            {
+                results.add (p);
+                p = Paragraph();
+            }
+        }
+
+        // (the text always has a last paragraph, even if it's empty)
+        jassert (p.numSections == 0 || reachesEndOfText);
+
+        if (p.numSections > 0 || reachesEndOfText)
+            results.add (p);
+    }
+
+    void layOutParagraph (const int paragraphIndex, const int firstSection, const int startIndex)
+    {
+        Paragraph& p = paragraphs.getReference (paragraphIndex);
+        const float oldWidth = p.width;
+
+        Iterator i (sections, layoutWidth, layoutPasswordCharacter, firstSection, startIndex, 0.0f,
+                    paragraphIndex > 0 ? paragraphs.getReference (paragraphIndex - 1).lastLineHeight : 0.0f);
+
+        float width = 0;
+
+        while (i.next())
+        {
+            width = jmax (width, i.atomRight);
+
+            if (i.atom->isNewLine())
+                break;
+        }
+
+        p.height = i.lineY + i.lineHeight;
+        p.lastLineHeight = i.lineHeight;
+        p.width = width;
+        p.needsLayout = false;
+
+        if (width >= maxWidth)
+            maxWidth = width;
+        else if (oldWidth >= maxWidth)
+            maxWidthNeedsUpdating = true;
+    }
+
+    void invalidateAll()
+    {
+        for (int i = paragraphs.size(); --i >= 0;)
+        {
+            Paragraph& p = paragraphs.getReference (i);
+            p.needsLayout = true;
+            p.width = 0;
+        }
+
+        maxWidth = 0;
+        maxWidthNeedsUpdating = false;
+        firstDirty = 0;
+        endDirty = paragraphs.size();
+    }
+
+    //==============================================================================
+    void rebuildTree()
+    {
+        const int num = paragraphs.size();
+        tree.clearQuick();
+        tree.ensureStorageAllocated (num);
+        numDiscardedLeaves = 0;
+
+        for (int i = 0; i < num; ++i)
+            tree.add (Totals (paragraphs.getReference (i)));
+
+        for (int i = 1; i <= num; ++i)
+        {
+            const int parent = i + (i & -i);
+
+            if (parent <= num)
+                tree.getReference (parent - 1) += tree.getReference (i - 1);
+        }
+    }
+
+    void addToEndOfTree (const Paragraph& p)
+    {
+        const int index = tree.size() + 1;
+        Totals t (p);
+        t += getTotalsBeforeLeaf (index - 1) - getTotalsBeforeLeaf (index - (index & -index));
+        tree.add (t);
+    }
+
+    void addToTree (const int paragraphIndex, const Totals& delta)
+    {
+        for (int i = numDiscardedLeaves + paragraphIndex + 1; i <= tree.size(); i += (i & -i))
+            tree.getReference (i - 1) += delta;
+    }
+
+    Totals getTotalsBefore (const int paragraphIndex) const
+    {
+        return getTotalsBeforeLeaf (numDiscardedLeaves + paragraphIndex);
+    }
+
+    Totals getTotalsBeforeLeaf (const int leafIndex) const
+    {
+        Totals t;
+
+        for (int i = leafIndex; i > 0; i -= (i & -i))
+            t += tree.getReference (i - 1);
+
+        return t;
+    }
+
+    // returns the first paragraph whose end lies beyond the target value
+    template <typename ValueType>
+    int findParagraph (ValueType Totals::* const member, const ValueType target) const
+    {
+        const int num = tree.size();
+        int step = 1;
+
+        while (step * 2 <= num)
+            step *= 2;
+
+        int pos = 0;
+        ValueType total = ValueType();
+
+        for (; step > 0; step >>= 1)
+        {
+            if (pos + step <= num)
+            {
+                const ValueType next = total + tree.getReference (pos + step - 1).*member;
+
+                if (next <= target)
+                {
+                    pos += step;
+                    total = next;
+                }
+            }
+        }
+
+        return jmax (0, jmin (pos - numDiscardedLeaves, num - numDiscardedLeaves - 1));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ParagraphCache);
+};
+
+
 //==============================================================================
 class TextEditor::InsertAction  : public UndoableAction
 {
@@ -943,6 +1482,34 @@ private:
     JUCE_DECLARE_NON_COPYABLE (TextEditorViewport);
 };
 
+//==============================================================================
+// Batches up the work that follows a call to appendText(), so that it's done at most once per frame.
+class TextEditor::AppendTimer  : public Timer
+{
+public:
+    AppendTimer (TextEditor& owner_)
+        : owner (owner_)
+    {
+    }
+
+    void triggerUpdate()
+    {
+        if (! isTimerRunning())
+            startTimer (1000 / 60);
+    }
+
+    void timerCallback()
+    {
+        stopTimer();
+        owner.updateAfterAppending();
+    }
+
+private:
+    TextEditor& owner;
+
+    JUCE_DECLARE_NON_COPYABLE (AppendTimer);
+};
+
 //==============================================================================
 namespace TextEditorDefs
 {
@@ -953,6 +1520,9 @@ namespace TextEditorDefs
 
     const int maxActionsPerTransaction = 100;
 
+    // how far appendText() lets the line count run over the limit before the next update
+    const int maxExcessLinesWhileAppending = 64;
+
     int getCharacterCategory (const juce_wchar character)
     {
         return CharacterFunctions::isLetterOrDigit (character)
@@ -982,8 +1552,10 @@ TextEditor::TextEditor (const String& name,
       topIndent (4),
       lastTransactionTime (0),
       currentFont (14.0f),
-      totalNumChars (0),
       caretPosition (0),
+      paragraphs (new ParagraphCache (sections)),
+      maxNumLines (0),
+      discardedHeight (0),
       passwordCharacter (passwordCharacter_),
       dragType (notDragging)
 {
@@ -1007,6 +1579,7 @@ TextEditor::~TextEditor()
             peer->dismissPendingTextInput();
     }
 
+    appendTimer = nullptr;
     textValue.referTo (Value());
     clearInternal (0);
     viewport = nullptr;
@@ -1139,7 +1712,8 @@ void TextEditor::applyFontToAllText (const Font& newFont)
         uts->colour = overallColour;
     }
 
-    coalesceSimilarSections();
+    coalesceSimilarSections (0, sections.size());
+    paragraphs->rebuild();
     updateTextHolderSize();
     scrollToMakeSureCursorIsVisible();
     repaint();
@@ -1333,9 +1907,7 @@ void TextEditor::repaintText (const Range<int>& range)
 
         if (wordWrapWidth > 0)
         {
-            Iterator i (sections, wordWrapWidth, passwordCharacter);
-
-            i.getCharPosition (range.getStart(), x, y, lh);
+            getCharPosition (range.getStart(), x, y, lh);
 
             const int y1 = (int) y;
             int y2;
@@ -1346,7 +1918,7 @@ void TextEditor::repaintText (const Range<int>& range)
             }
             else
             {
-                i.getCharPosition (range.getEnd(), x, y, lh);
+                getCharPosition (range.getEnd(), x, y, lh);
                 y2 = (int) (y + lh * 2.0f);
             }
 
@@ -1439,15 +2011,10 @@ void TextEditor::updateTextHolderSize()
 
     if (wordWrapWidth > 0)
     {
-        float maxWidth = 0.0f;
+        paragraphs->updateLayout (wordWrapWidth, passwordCharacter);
 
-        Iterator i (sections, wordWrapWidth, passwordCharacter);
-
-        while (i.next())
-            maxWidth = jmax (maxWidth, i.atomRight);
-
-        const int w = leftIndent + roundToInt (maxWidth);
-        const int h = topIndent + roundToInt (jmax (i.lineY + i.lineHeight,
+        const int w = leftIndent + roundToInt (paragraphs->getMaxWidth());
+        const int h = topIndent + roundToInt (jmax (paragraphs->getTotalHeight(),
                                                     currentFont.getHeight()));
 
         textHolder->setSize (w + 2, h + 1); // (the +2 allows a bit of space for the cursor to be at the right-hand-edge)
@@ -1616,6 +2183,128 @@ void TextEditor::insertTextAtCaret (const String& newText_)
     textChanged();
 }
 
+//==============================================================================
+TextEditor::TextChunk::TextChunk (const String& text_, const Font& font_, const Colour& colour_)
+    : text (text_), font (font_), colour (colour_)
+{
+}
+
+void TextEditor::appendText (const String& text, const Font& font, const Colour& colour)
+{
+    Array<TextChunk> chunks;
+    chunks.add (TextChunk (text, font, colour));
+    appendText (chunks);
+}
+
+void TextEditor::appendText (const Array<TextChunk>& chunks)
+{
+    const int oldTotalNumChars = getTotalNumChars();
+    const bool caretWasAtEnd = selection.isEmpty() && caretPosition >= oldTotalNumChars;
+
+    int firstSection;
+    paragraphs->beginEdit (Range<int> (oldTotalNumChars, oldTotalNumChars), firstSection);
+
+    Array <UniformTextSection*> newSections;
+
+    for (int i = 0; i < chunks.size(); ++i)
+    {
+        const TextChunk& chunk = chunks.getReference (i);
+
+        if (chunk.text.isNotEmpty())
+        {
+            UniformTextSection* const section = new UniformTextSection (chunk.text, chunk.font,
+                                                                        chunk.colour, passwordCharacter);
+            newSections.add (section);
+            section->splitIntoLines (newSections);
+        }
+    }
+
+    if (newSections.size() > 0)
+    {
+        sections.addArray (newSections);
+        endEditingSections();
+
+        // (lines only get discarded here if the updates are falling a long way behind)
+        discardExcessLines (TextEditorDefs::maxExcessLinesWhileAppending);
+
+        if (caretWasAtEnd)
+        {
+            caretPosition = getTotalNumChars();
+            selection = Range<int>::emptyRange (caretPosition);
+        }
+
+        if (appendTimer == nullptr)
+            appendTimer = new AppendTimer (*this);
+
+        appendTimer->triggerUpdate();
+    }
+}
+
+void TextEditor::setMaximumNumberOfLines (const int maxLines)
+{
+    maxNumLines = jmax (0, maxLines);
+
+    if (discardExcessLines (0))
+        updateAfterAppending();
+}
+
+bool TextEditor::discardExcessLines (const int numSpareLines)
+{
+    const int numToDiscard = maxNumLines > 0 ? paragraphs->getNumLines() - maxNumLines : 0;
+
+    if (numToDiscard > numSpareLines)
+    {
+        int numSections;
+        float height;
+        const int numChars = paragraphs->discardFirstParagraphs (numToDiscard, numSections, height);
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            UniformTextSection* const section = sections.getUnchecked (i);
+            section->clear();
+            delete section;
+        }
+
+        sections.removeRange (0, numSections);
+
+        caretPosition = jmax (0, caretPosition - numChars);
+        selection = Range<int> (jmax (0, selection.getStart() - numChars),
+                                jmax (0, selection.getEnd() - numChars));
+        underlinedSections.clear();
+        undoManager.clearUndoHistory();
+
+        discardedHeight += height;
+        valueTextNeedsUpdating = true;
+        return true;
+    }
+
+    return false;
+}
+
+void TextEditor::updateAfterAppending()
+{
+    discardExcessLines (0);
+    updateTextHolderSize();
+
+    if (caretPosition >= getTotalNumChars())
+    {
+        scrollToMakeSureCursorIsVisible();
+    }
+    else
+    {
+        // keep the same text in view after lines have been discarded from above it
+        if (discardedHeight > 0)
+            viewport->setViewPosition (viewport->getViewPositionX(),
+                                       jmax (0, viewport->getViewPositionY() - roundToInt (discardedHeight)));
+
+        updateCaretPosition();
+    }
+
+    discardedHeight = 0;
+    textHolder->repaint();
+    textChanged();
+}
+
 void TextEditor::setHighlightedRegion (const Range<int>& newSelection)
 {
     moveCaretTo (newSelection.getStart(), false);
@@ -1665,10 +2354,11 @@ void TextEditor::drawContent (Graphics& g)
         const Rectangle<int> clip (g.getClipBounds());
         Colour selectedTextColour;
 
-        Iterator i (sections, wordWrapWidth, passwordCharacter);
+        // only the paragraphs that overlap the clip region need to be visited
+        paragraphs->updateLayout (wordWrapWidth, passwordCharacter);
+        const int firstParagraph = paragraphs->findParagraphAt ((float) clip.getY());
 
-        while (i.lineY + 200.0 < clip.getY() && i.next())
-        {}
+        Iterator i (paragraphs->createIterator (firstParagraph));
 
         if (! selection.isEmpty())
         {
@@ -1710,7 +2400,7 @@ void TextEditor::drawContent (Graphics& g)
         {
             const Range<int>& underlinedSection = underlinedSections.getReference (j);
 
-            Iterator i2 (sections, wordWrapWidth, passwordCharacter);
+            Iterator i2 (paragraphs->createIterator (firstParagraph));
 
             while (i2.next() && i2.lineY < clip.getBottom())
             {
@@ -2269,40 +2959,28 @@ void TextEditor::insert (const String& text,
             repaintText (Range<int> (insertIndex, getTotalNumChars())); // must do this before and after changing the data, in case
                                                                         // a line gets moved due to word wrap
 
-            int index = 0;
-            int nextIndex = 0;
+            int i;
+            int index = paragraphs->beginEdit (Range<int> (insertIndex, insertIndex), i);
 
-            for (int i = 0; i < sections.size(); ++i)
+            for (; i < sections.size(); ++i)
             {
-                nextIndex = index + sections.getUnchecked (i)->getTotalLength();
+                const int nextIndex = index + sections.getUnchecked (i)->getTotalLength();
 
                 if (insertIndex == index)
-                {
-                    sections.insert (i, new UniformTextSection (text,
-                                                                font, colour,
-                                                                passwordCharacter));
                     break;
-                }
-                else if (insertIndex > index && insertIndex < nextIndex)
+
+                if (insertIndex > index && insertIndex < nextIndex)
                 {
                     splitSection (i, insertIndex - index);
-                    sections.insert (i + 1, new UniformTextSection (text,
-                                                                    font, colour,
-                                                                    passwordCharacter));
+                    ++i;
                     break;
                 }
 
                 index = nextIndex;
             }
 
-            if (nextIndex == insertIndex)
-                sections.add (new UniformTextSection (text,
-                                                      font, colour,
-                                                      passwordCharacter));
-
-            coalesceSimilarSections();
-            totalNumChars = -1;
-            valueTextNeedsUpdating = true;
+            insertSection (i, new UniformTextSection (text, font, colour, passwordCharacter));
+            endEditingSections();
 
             updateTextHolderSize();
             moveCaretTo (caretPositionToMoveTo, false);
@@ -2315,42 +2993,30 @@ void TextEditor::insert (const String& text,
 void TextEditor::reinsert (const int insertIndex,
                            const Array <UniformTextSection*>& sectionsToInsert)
 {
-    int index = 0;
-    int nextIndex = 0;
+    int i;
+    int index = paragraphs->beginEdit (Range<int> (insertIndex, insertIndex), i);
 
-    for (int i = 0; i < sections.size(); ++i)
+    for (; i < sections.size(); ++i)
     {
-        nextIndex = index + sections.getUnchecked (i)->getTotalLength();
+        const int nextIndex = index + sections.getUnchecked (i)->getTotalLength();
 
         if (insertIndex == index)
-        {
-            for (int j = sectionsToInsert.size(); --j >= 0;)
-                sections.insert (i, new UniformTextSection (*sectionsToInsert.getUnchecked(j)));
-
             break;
-        }
-        else if (insertIndex > index && insertIndex < nextIndex)
+
+        if (insertIndex > index && insertIndex < nextIndex)
         {
             splitSection (i, insertIndex - index);
-
-            for (int j = sectionsToInsert.size(); --j >= 0;)
-                sections.insert (i + 1, new UniformTextSection (*sectionsToInsert.getUnchecked(j)));
-
+            ++i;
             break;
         }
 
         index = nextIndex;
     }
 
-    if (nextIndex == insertIndex)
-    {
-        for (int j = 0; j < sectionsToInsert.size(); ++j)
-            sections.add (new UniformTextSection (*sectionsToInsert.getUnchecked(j)));
-    }
+    for (int j = sectionsToInsert.size(); --j >= 0;)
+        sections.insert (i, new UniformTextSection (*sectionsToInsert.getUnchecked(j)));
 
-    coalesceSimilarSections();
-    totalNumChars = -1;
-    valueTextNeedsUpdating = true;
+    endEditingSections();
 }
 
 void TextEditor::remove (const Range<int>& range,
@@ -2359,9 +3025,11 @@ void TextEditor::remove (const Range<int>& range,
 {
     if (! range.isEmpty())
     {
-        int index = 0;
+        int firstSection;
+        const int firstSectionStart = paragraphs->beginEdit (range, firstSection);
+        int index = firstSectionStart;
 
-        for (int i = 0; i < sections.size(); ++i)
+        for (int i = firstSection; i < sections.size(); ++i)
         {
             const int nextIndex = index + sections.getUnchecked(i)->getTotalLength();
 
@@ -2384,13 +3052,13 @@ void TextEditor::remove (const Range<int>& range,
             }
         }
 
-        index = 0;
+        index = firstSectionStart;
 
         if (um != nullptr)
         {
             Array <UniformTextSection*> removedSections;
 
-            for (int i = 0; i < sections.size(); ++i)
+            for (int i = firstSection; i < sections.size(); ++i)
             {
                 if (range.getEnd() <= range.getStart())
                     break;
@@ -2405,6 +3073,8 @@ void TextEditor::remove (const Range<int>& range,
                 index = nextIndex;
             }
 
+            endEditingSections();
+
             if (um->getNumActionsInCurrentTransaction() > TextEditorDefs::maxActionsPerTransaction)
                 newTransaction();
 
@@ -2415,7 +3085,7 @@ void TextEditor::remove (const Range<int>& range,
         {
             Range<int> remainingRange (range);
 
-            for (int i = 0; i < sections.size(); ++i)
+            for (int i = firstSection; i < sections.size(); ++i)
             {
                 UniformTextSection* const section = sections.getUnchecked (i);
 
@@ -2439,9 +3109,7 @@ void TextEditor::remove (const Range<int>& range,
                 }
             }
 
-            coalesceSimilarSections();
-            totalNumChars = -1;
-            valueTextNeedsUpdating = true;
+            endEditingSections();
 
             moveCaretTo (caretPositionToMoveTo, false);
 
@@ -2470,9 +3138,11 @@ String TextEditor::getTextInRange (const Range<int>& range) const
     MemoryOutputStream mo;
     mo.preallocate ((size_t) jmin (getTotalNumChars(), range.getLength()));
 
-    int index = 0;
+    const int paragraph = paragraphs->findParagraphContaining (range.getStart());
+    int firstSection;
+    int index = paragraphs->getParagraphStart (paragraph, firstSection);
 
-    for (int i = 0; i < sections.size(); ++i)
+    for (int i = firstSection; i < sections.size(); ++i)
     {
         const UniformTextSection* const s = sections.getUnchecked (i);
         const int nextIndex = index + s->getTotalLength();
@@ -2498,15 +3168,7 @@ String TextEditor::getHighlightedText() const
 
 int TextEditor::getTotalNumChars() const
 {
-    if (totalNumChars < 0)
-    {
-        totalNumChars = 0;
-
-        for (int i = sections.size(); --i >= 0;)
-            totalNumChars += sections.getUnchecked (i)->getTotalLength();
-    }
-
-    return totalNumChars;
+    return paragraphs->getTotalNumChars();
 }
 
 bool TextEditor::isEmpty() const
@@ -2520,7 +3182,8 @@ void TextEditor::getCharPosition (const int index, float& cx, float& cy, float&
 
     if (wordWrapWidth > 0 && sections.size() > 0)
     {
-        Iterator i (sections, wordWrapWidth, passwordCharacter);
+        paragraphs->updateLayout (wordWrapWidth, passwordCharacter);
+        Iterator i (paragraphs->createIterator (paragraphs->findParagraphContaining (index)));
 
         i.getCharPosition (index, cx, cy, lineHeight);
     }
@@ -2537,7 +3200,8 @@ int TextEditor::indexAtPosition (const float x, const float y)
 
     if (wordWrapWidth > 0)
     {
-        Iterator i (sections, wordWrapWidth, passwordCharacter);
+        paragraphs->updateLayout (wordWrapWidth, passwordCharacter);
+        Iterator i (paragraphs->createIterator (paragraphs->findParagraphAt (y)));
 
         while (i.next())
         {
@@ -2615,22 +3279,43 @@ void TextEditor::splitSection (const int sectionIndex,
                      sections.getUnchecked (sectionIndex)->split (charToSplitAt, passwordCharacter));
 }
 
-void TextEditor::coalesceSimilarSections()
+void TextEditor::insertSection (const int sectionIndex, UniformTextSection* const newSection)
 {
-    for (int i = 0; i < sections.size() - 1; ++i)
+    Array <UniformTextSection*> lines;
+    lines.add (newSection);
+    newSection->splitIntoLines (lines);
+
+    sections.insertArray (sectionIndex, lines.getRawDataPointer(), lines.size());
+}
+
+int TextEditor::coalesceSimilarSections (const int startSection, int endSection)
+{
+    for (int i = startSection; i < endSection - 1; ++i)
     {
         UniformTextSection* const s1 = sections.getUnchecked (i);
         UniformTextSection* const s2 = sections.getUnchecked (i + 1);
 
         if (s1->font == s2->font
-             && s1->colour == s2->colour)
+             && s1->colour == s2->colour
+             && ! s1->endsWithNewLine()) // (sections mustn't span a line-break)
         {
             s1->append (*s2, passwordCharacter);
             sections.remove (i + 1);
             delete s2;
+            --endSection;
             --i;
         }
     }
+
+    return endSection;
+}
+
+void TextEditor::endEditingSections()
+{
+    const Range<int> edited (paragraphs->getEditedSections());
+    paragraphs->endEdit (coalesceSimilarSections (edited.getStart(), edited.getEnd()) - edited.getStart());
+
+    valueTextNeedsUpdating = true;
 }
 
 void TextEditor::Listener::textEditorTextChanged (TextEditor&) {}
@@ -2638,4 +3323,97 @@ void TextEditor::Listener::textEditorReturnKeyPressed (TextEditor&) {}
 void TextEditor::Listener::textEditorEscapeKeyPressed (TextEditor&) {}
 void TextEditor::Listener::textEditorFocusLost (TextEditor&) {}
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TextEditorTests  : public UnitTest
+{
+public:
+    TextEditorTests() : UnitTest ("TextEditor") {}
+
+    static String createRandomText (Random& r)
+    {
+        String s;
+
+        for (int i = r.nextInt (12); --i >= 0;)
+            s << (r.nextInt (4) == 0 ? "\n" : String::repeatedString ("x", 1 + r.nextInt (6)));
+
+        return s;
+    }
+
+    // Removes lines from the start of the text in the same way as setMaximumNumberOfLines()
+    static String trimLines (const String& text, const int maxLines)
+    {
+        int numLines = 1;
+
+        for (int i = 0; i < text.length(); ++i)
+            if (text[i] == '\n')
+                ++numLines;
+
+        if (text.endsWithChar ('\n'))
+            --numLines;
+
+        int start = 0;
+
+        for (int i = numLines - maxLines; --i >= 0;)
+            start = text.indexOfChar (start, '\n') + 1;
+
+        return text.substring (start);
+    }
+
+    void runTest()
+    {
+        beginTest ("Appending and trimming lines");
+
+        Random r (1234);
+        const juce::Font font (15.0f);
+        const int lineHeight = roundToInt (font.getHeight());
+
+        TextEditor editor;
+        editor.setMultiLine (true, false);
+        editor.setSize (300, 200);
+
+        String expected;
+        int maxLines = 0;
+
+        for (int i = 0; i < 300; ++i)
+        {
+            Array<TextEditor::TextChunk> chunks;
+
+            for (int j = 1 + r.nextInt (4); --j >= 0;)
+            {
+                const String text (createRandomText (r));
+                chunks.add (TextEditor::TextChunk (text, font, Colours::black));
+                expected << text;
+            }
+
+            editor.appendText (chunks);
+
+            if (r.nextInt (5) == 0)
+                maxLines = 1 + r.nextInt (40);
+
+            editor.setMaximumNumberOfLines (maxLines);
+
+            if (maxLines > 0)
+                expected = trimLines (expected, maxLines);
+
+            expectEquals (editor.getTotalNumChars(), expected.length());
+            expectEquals (editor.getText(), expected);
+
+            if (expected.isNotEmpty())
+            {
+                const int index = r.nextInt (expected.length());
+                const int line = expected.substring (0, index).retainCharacters ("\n").length();
+
+                editor.setCaretPosition (index);
+                expectEquals (editor.getCaretRectangle().getY(), line * lineHeight);
+            }
+        }
+    }
+};
+
+static TextEditorTests textEditorUnitTests;
+
+#endif
+
 END_JUCE_NAMESPACE
@@ -381,6 +381,51 @@ public:
     /** Deletes all the text from the editor. */
     void clear();
 
+    //==============================================================================
+    /** A run of text with a font and colour, as used by appendText(). */
+    struct JUCE_API  TextChunk
+    {
+        TextChunk (const String& text, const Font& font, const Colour& colour);
+
+        String text;
+        Font font;
+        Colour colour;
+    };
+
+    /** Adds a list of chunks of text to the end of the editor.
+
+        This is intended for editors that are used as a log or console, where text arrives
+        at a high rate. Adding many chunks in a single call is much cheaper than calling
+        insertTextAtCaret() for each of them, and the change isn't added to the undo history.
+
+        Rather than being resized and repainted straight away, the editor gets updated at
+        most once per frame, after which the listeners receive a single change callback.
+
+        If the caret was at the end of the text, it'll be moved to the new end, so that the
+        view follows the text as it arrives.
+
+        @see setMaximumNumberOfLines
+    */
+    void appendText (const Array<TextChunk>& chunks);
+
+    /** Adds some text to the end of the editor, using the given font and colour.
+        @see appendText (const Array<TextChunk>&)
+    */
+    void appendText (const String& text, const Font& font, const Colour& colour);
+
+    /** Limits the number of lines that the editor will hold.
+
+        Once there are more lines than this, the oldest ones are discarded from the start of
+        the text. This is done in batches, so the cost per discarded line stays constant no
+        matter how much text the editor holds. Discarding any lines clears the undo history.
+
+        @param maxLines     the number of lines to keep, or 0 to keep any number of lines
+    */
+    void setMaximumNumberOfLines (int maxLines);
+
+    /** Returns the limit set by setMaximumNumberOfLines(), or 0 if there isn't one. */
+    int getMaximumNumberOfLines() const noexcept            { return maxNumLines; }
+
     /** Deletes the currently selected region.
         This doesn't copy the deleted section to the clipboard - if you need to do that, call copy() first.
         @see copy, paste, SystemClipboard
@@ -623,11 +668,14 @@ private:
     //==============================================================================
     class Iterator;
     class UniformTextSection;
+    class ParagraphCache;
     class TextHolderComponent;
     class InsertAction;
     class RemoveAction;
+    class AppendTimer;
     friend class InsertAction;
     friend class RemoveAction;
+    friend class AppendTimer;
 
     ScopedPointer <Viewport> viewport;
     TextHolderComponent* textHolder;
@@ -653,9 +701,12 @@ private:
     int leftIndent, topIndent;
     unsigned int lastTransactionTime;
     Font currentFont;
-    mutable int totalNumChars;
     int caretPosition;
     Array <UniformTextSection*> sections;
+    ScopedPointer <ParagraphCache> paragraphs;
+    ScopedPointer <AppendTimer> appendTimer;
+    int maxNumLines;
+    float discardedHeight;
     String textToShowWhenEmpty;
     Colour colourForTextWhenEmpty;
     juce_wchar passwordCharacter;
@@ -672,8 +723,12 @@ private:
     ListenerList <Listener> listeners;
     Array <Range<int> > underlinedSections;
 
-    void coalesceSimilarSections();
+    int coalesceSimilarSections (int startSection, int endSection);
     void splitSection (int sectionIndex, int charToSplitAt);
+    void insertSection (int sectionIndex, UniformTextSection* newSection);
+    void endEditingSections();
+    bool discardExcessLines (int numSpareLines);
+    void updateAfterAppending();
     void clearInternal (UndoManager* um);
     void insert (const String& text, int insertIndex, const Font& font,
                  const Colour& colour, UndoManager* um, int caretPositionToMoveTo);
@@ -30,6 +30,7 @@ BEGIN_JUCE_NAMESPACE
 //==============================================================================
 static Array <ComponentPeer*> heavyweightPeers;
 static uint32 lastUniqueID = 1;
+static double targetFrameRate = 60.0;
 
 //==============================================================================
 ComponentPeer::ComponentPeer (Component* const component_, const int styleFlags_)
@@ -42,6 +43,7 @@ ComponentPeer::ComponentPeer (Component* const component_, const int styleFlags_
       fakeMouseMessageSent (false),
       isWindowMinimised (false)
 {
+    zerostruct (frameStats);
     heavyweightPeers.add (this);
 }
 
@@ -107,6 +109,23 @@ void ComponentPeer::handlePaint (LowLevelGraphicsContext& contextToPaintTo)
 {
     Graphics g (&contextToPaintTo);
 
+    const int64 startTicks = Time::getHighResolutionTicks();
+    int64 numPixels = 0;
+
+    if (Component::ComponentHelpers::collectPaintStats)
+    {
+        numPixels = Component::ComponentHelpers::getArea (contextToPaintTo.getClipRegion());
+        Component::ComponentHelpers::paintStats.numPixelsInFrames += numPixels;
+    }
+
+    const bool showOverdraw = Component::ComponentHelpers::showOverdraw;
+
+    if (showOverdraw)
+    {
+        Component::ComponentHelpers::overdrawAreas.clearQuick();
+        Component::ComponentHelpers::overdrawTarget = component;
+    }
+
    #if JUCE_ENABLE_REPAINT_DEBUGGING
     g.saveState();
    #endif
@@ -117,6 +136,18 @@ void ComponentPeer::handlePaint (LowLevelGraphicsContext& contextToPaintTo)
     }
     JUCE_CATCH_EXCEPTION
 
+    if (showOverdraw)
+    {
+        // each painted region gets its own tint, so the colour builds up where they overlap
+        Component::ComponentHelpers::overdrawTarget = nullptr;
+        g.setColour (Colours::red.withAlpha (0.15f));
+
+        const Array<Rectangle<int> >& areas = Component::ComponentHelpers::overdrawAreas;
+
+        for (int i = 0; i < areas.size(); ++i)
+            g.fillRect (areas.getReference (i));
+    }
+
    #if JUCE_ENABLE_REPAINT_DEBUGGING
     // enabling this code will fill all areas that get repainted with a colour overlay, to show
     // clearly when things are being repainted.
@@ -135,6 +166,102 @@ void ComponentPeer::handlePaint (LowLevelGraphicsContext& contextToPaintTo)
         mess up a lot of the calculations that the library needs to do.
     */
     jassert (roundToInt (10.1f) == 10);
+
+    const double frameSeconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+    ++frameStats.numFrames;
+    frameStats.lastFrameSeconds = frameSeconds;
+    frameStats.totalFrameSeconds += frameSeconds;
+    frameStats.longestFrameSeconds = jmax (frameStats.longestFrameSeconds, frameSeconds);
+    frameStats.numPixelsPainted += numPixels;
+}
+
+void ComponentPeer::resetFrameStatistics() noexcept
+{
+    zerostruct (frameStats);
+}
+
+void ComponentPeer::setTargetFrameRate (const double framesPerSecond) noexcept
+{
+    jassert (framesPerSecond > 0);
+    targetFrameRate = jmax (1.0, framesPerSecond);
+}
+
+double ComponentPeer::getTargetFrameRate() noexcept
+{
+    return targetFrameRate;
+}
+
+namespace ComponentPeerHelpers
+{
+    int64 getArea (const Rectangle<int>& r) noexcept
+    {
+        return r.getWidth() * (int64) r.getHeight();
+    }
+
+    int64 getArea (const RectangleList& region) noexcept
+    {
+        int64 total = 0;
+
+        for (RectangleList::Iterator i (region); i.next();)
+            total += getArea (*i.getRectangle());
+
+        return total;
+    }
+
+    struct AreaComparator
+    {
+        static int compareElements (const Rectangle<int>& first, const Rectangle<int>& second) noexcept
+        {
+            const int64 a1 = getArea (first), a2 = getArea (second);
+            return a1 < a2 ? -1 : (a1 > a2 ? 1 : 0);
+        }
+    };
+}
+
+int ComponentPeer::chooseAreasToPaint (const Array<Rectangle<int> >& requestedAreas,
+                                       RectangleList& areasToPaint, RectangleList& deferredAreas,
+                                       const double secondsPerPixel, const double frameSeconds)
+{
+    using namespace ComponentPeerHelpers;
+
+    int64 numPixels = getArea (areasToPaint);
+    int64 numPixelsRequested = 0;
+
+    for (int i = 0; i < requestedAreas.size(); ++i)
+        numPixelsRequested += getArea (requestedAreas.getReference (i));
+
+    if (secondsPerPixel * (numPixels + numPixelsRequested) <= frameSeconds)
+    {
+        for (int i = 0; i < requestedAreas.size(); ++i)
+            areasToPaint.add (requestedAreas.getReference (i));
+
+        return 0;
+    }
+
+    Array<Rectangle<int> > sortedAreas (requestedAreas);
+    AreaComparator comparator;
+    sortedAreas.sort (comparator, true);
+
+    int numDeferred = 0;
+
+    for (int i = 0; i < sortedAreas.size(); ++i)
+    {
+        const Rectangle<int>& r = sortedAreas.getReference (i);
+
+        if (areasToPaint.isEmpty() || areasToPaint.containsRectangle (r)
+             || secondsPerPixel * (numPixels + getArea (r)) <= frameSeconds)
+        {
+            areasToPaint.add (r);
+            numPixels += getArea (r);
+        }
+        else
+        {
+            deferredAreas.add (r);
+            ++numDeferred;
+        }
+    }
+
+    return numDeferred;
 }
 
 bool ComponentPeer::handleKeyPress (const int keyCode,
@@ -569,4 +696,79 @@ void ComponentPeer::setCurrentRenderingEngine (int /*index*/)
 {
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class FramePacingTests  : public UnitTest
+{
+public:
+    FramePacingTests() : UnitTest ("Frame pacing") {}
+
+    void runTest()
+    {
+        beginTest ("Everything is painted when it fits");
+
+        {
+            Array<Rectangle<int> > requested;
+            requested.add (Rectangle<int> (0, 0, 10, 10));
+            requested.add (Rectangle<int> (50, 50, 20, 20));
+
+            RectangleList toPaint, deferred;
+            expectEquals (ComponentPeer::chooseAreasToPaint (requested, toPaint, deferred, 0.001, 1.0), 0);
+            expect (deferred.isEmpty());
+            expect (toPaint.containsRectangle (requested[0]));
+            expect (toPaint.containsRectangle (requested[1]));
+        }
+
+        beginTest ("Larger areas are deferred whole");
+
+        {
+            // the second area overlaps the first, so a RectangleList would have split it up
+            Array<Rectangle<int> > requested;
+            requested.add (Rectangle<int> (0, 0, 10, 10));
+            requested.add (Rectangle<int> (5, 5, 30, 30));
+            requested.add (Rectangle<int> (100, 0, 10, 10));
+
+            RectangleList toPaint, deferred;
+            expectEquals (ComponentPeer::chooseAreasToPaint (requested, toPaint, deferred, 0.001, 0.25), 1);
+            expect (toPaint.containsRectangle (requested[0]));
+            expect (toPaint.containsRectangle (requested[2]));
+            expect (deferred.getNumRectangles() == 1);
+            expect (deferred.getRectangle (0) == requested[1]);
+        }
+
+        beginTest ("Areas that were already chosen are always painted");
+
+        {
+            Array<Rectangle<int> > requested;
+            requested.add (Rectangle<int> (0, 0, 10, 10));
+            requested.add (Rectangle<int> (200, 200, 10, 10));
+
+            RectangleList toPaint (Rectangle<int> (0, 0, 100, 100)), deferred;
+            expectEquals (ComponentPeer::chooseAreasToPaint (requested, toPaint, deferred, 0.001, 1.0), 1);
+            expect (toPaint.containsRectangle (Rectangle<int> (0, 0, 100, 100)));
+            expect (deferred.getNumRectangles() == 1);
+            expect (deferred.getRectangle (0) == requested[1]);
+        }
+
+        beginTest ("Something is painted even when nothing fits");
+
+        {
+            Array<Rectangle<int> > requested;
+            requested.add (Rectangle<int> (0, 0, 100, 100));
+            requested.add (Rectangle<int> (0, 200, 50, 50));
+
+            RectangleList toPaint, deferred;
+            expectEquals (ComponentPeer::chooseAreasToPaint (requested, toPaint, deferred, 1.0, 0.001), 1);
+            expect (toPaint.getNumRectangles() == 1);
+            expect (toPaint.getRectangle (0) == requested[1]);
+            expect (deferred.getRectangle (0) == requested[0]);
+        }
+    }
+};
+
+static FramePacingTests framePacingUnitTests;
+
+#endif
+
 END_JUCE_NAMESPACE
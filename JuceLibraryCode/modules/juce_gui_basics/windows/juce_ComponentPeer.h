@@ -230,6 +230,60 @@ public:
     /** This is called to repaint the component into the given context. */
     void handlePaint (LowLevelGraphicsContext& contextToPaintTo);
 
+    /** Some numbers describing the frames that this window has painted.
+        @see getFrameStatistics
+    */
+    struct FrameStatistics
+    {
+        int64 numFrames;                /**< The number of times the window has been painted. */
+        double lastFrameSeconds;        /**< How long the most recent paint took. */
+        double totalFrameSeconds;       /**< The total time spent painting. */
+        double longestFrameSeconds;     /**< The longest time that any paint has taken. */
+        int64 numPixelsPainted;         /**< The total area of the regions that have been painted, while
+                                             Component::setPaintStatisticsEnabled() was turned on. */
+        int64 numRegionsDeferred;       /**< The number of times a repaint region was put off until a later frame
+                                             because painting was taking longer than the frame period. */
+
+        /** Returns the average time that a paint has taken. */
+        double getAverageFrameSeconds() const noexcept      { return numFrames > 0 ? totalFrameSeconds / numFrames : 0.0; }
+    };
+
+    /** Returns the frame statistics that have accumulated since the window was created,
+        or since resetFrameStatistics() was called.
+    */
+    const FrameStatistics& getFrameStatistics() const noexcept      { return frameStats; }
+
+    /** Sets all the frame statistics back to zero. */
+    void resetFrameStatistics() noexcept;
+
+    /** Sets the number of frames per second at which windows should paint.
+
+        Repaints that are requested between frames are combined and painted together
+        in the next frame. If painting takes longer than the frame period, the larger
+        newly-requested regions may be put off until the following frame, so that small
+        changes can carry on being drawn at the target rate.
+
+        On some platforms, the OS decides when windows are painted, and this is ignored.
+        The default is 60 frames per second.
+    */
+    static void setTargetFrameRate (double framesPerSecond) noexcept;
+
+    /** Returns the frame rate that was set with setTargetFrameRate(). */
+    static double getTargetFrameRate() noexcept;
+
+    /** Decides which of the areas that were asked to be repainted should go into the next frame.
+
+        This is used by peers that pace their own painting. Whatever is already in areasToPaint
+        will always be painted. The requested areas are added to it, smallest first, for as long
+        as the estimated time stays within frameSeconds. An area that doesn't fit is added whole
+        to deferredAreas, so that a component's repaint is never split across two frames.
+
+        @returns the number of areas that were deferred
+    */
+    static int chooseAreasToPaint (const Array<Rectangle<int> >& requestedAreas,
+                                   RectangleList& areasToPaint, RectangleList& deferredAreas,
+                                   double secondsPerPixel, double frameSeconds);
+
     //==============================================================================
     /** Sets this window to either be always-on-top or normal.
 
@@ -369,6 +423,7 @@ protected:
     Rectangle<int> lastNonFullscreenBounds;
     uint32 lastPaintTime;
     ComponentBoundsConstrainer* constrainer;
+    FrameStatistics frameStats;
 
     static void updateCurrentModifiers() noexcept;
 
@@ -561,6 +561,11 @@ int CPlusPlusCodeTokeniser::readNextToken (CodeDocument::Iterator& source)
     return result;
 }
 
+CodeTokeniser* CPlusPlusCodeTokeniser::createCopy() const
+{
+    return new CPlusPlusCodeTokeniser();
+}
+
 StringArray CPlusPlusCodeTokeniser::getTokenTypes()
 {
     const char* const types[] =
@@ -62,6 +62,7 @@ public:
     int readNextToken (CodeDocument::Iterator& source);
     StringArray getTokenTypes();
     Colour getDefaultColour (int tokenType);
+    CodeTokeniser* createCopy() const;
 
     /** This is a handy method for checking whether a string is a c++ reserved keyword. */
     static bool isReservedKeyword (const String& token) noexcept;
@@ -134,6 +134,20 @@ CodeDocument::Iterator::Iterator (CodeDocument* const document_)
 {
 }
 
+CodeDocument::Iterator::Iterator (const CodeDocument::Position& startPosition)
+    : document (startPosition.getOwner()),
+      charPointer (nullptr),
+      line (startPosition.getLineNumber()),
+      position (startPosition.getPosition())
+{
+    jassert (document != nullptr);
+
+    const CodeDocumentLine* const l = document->lines [line];
+
+    if (l != nullptr)
+        charPointer = l->line.getCharPointer() + startPosition.getIndexInLine();
+}
+
 CodeDocument::Iterator::Iterator (const CodeDocument::Iterator& other)
     : document (other.document),
       charPointer (other.charPointer),
@@ -141,6 +141,9 @@ public:
         */
         int getIndexInLine() const noexcept         { return indexInLine; }
 
+        /** Returns the document that this position refers to. */
+        CodeDocument* getOwner() const noexcept     { return owner; }
+
         /** Allows the position to be automatically updated when the document changes.
 
             If this is set to true, the positon will register with its document so that
@@ -335,6 +338,12 @@ public:
     {
     public:
         Iterator (CodeDocument* document);
+
+        /** Creates an iterator whose next character will be the one at the given position.
+            This is a quick way to resume tokenising from a known point in the document.
+        */
+        explicit Iterator (const Position& startPosition);
+
         Iterator (const Iterator& other);
         Iterator& operator= (const Iterator& other) noexcept;
         ~Iterator() noexcept;
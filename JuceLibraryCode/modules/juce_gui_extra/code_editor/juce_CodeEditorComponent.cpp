@@ -229,6 +229,379 @@ private:
     }
 };
 
+//==============================================================================
+/*  Keeps a tokeniser checkpoint for the start of every line in the document, and
+    computes them on a background thread so that scrolling never has to wait for
+    the tokeniser. The thread uses its own copy of the tokeniser, so if the tokeniser
+    can't be copied, the checkpoints are brought up to date on the message thread instead.
+
+    The thread works on its own private copy of the document, which is kept in sync
+    by posting it the lines that each edit has changed. For each line it stores the
+    distance back from the line's start to the nearest token boundary, so after an
+    edit it only needs to re-tokenise from the first damaged line until the new
+    boundaries line up with the ones that were cached before the edit.
+*/
+class CodeEditorComponent::BackgroundTokeniser  : public TimeSliceClient
+{
+public:
+    BackgroundTokeniser (CodeEditorComponent& owner_, CodeTokeniser& tokeniser_)
+        : owner (owner_),
+          tokeniserCopy (tokeniser_.createCopy()),
+          tokeniser (tokeniserCopy != nullptr ? *tokeniserCopy : tokeniser_),
+          thread ("Code tokeniser"),
+          firstInvalidLine (0),
+          lastDamagedLine (-1),
+          repairFrontier (0),
+          appliedGeneration (0),
+          lastPostedGeneration (0),
+          lineToWaitFor (-1)
+    {
+        const CodeDocument& document = owner.getDocument();
+
+        Array <String> initialLines;
+        for (int i = 0; i < document.getNumLines(); ++i)
+            initialLines.add (document.getLine (i));
+
+        shadowLines = initialLines;
+        postChange (0, 0, initialLines);
+
+        if (isRunningInBackground())
+        {
+            thread.addTimeSliceClient (this);
+            thread.startThread (3);
+        }
+    }
+
+    ~BackgroundTokeniser()
+    {
+        thread.removeTimeSliceClient (this);
+        thread.stopThread (2000);
+    }
+
+    //==============================================================================
+    // Called on the message thread when the document has been edited.
+    void documentChanged (int firstLine)
+    {
+        const CodeDocument& document = owner.getDocument();
+        const int oldNumLines = shadowLines.size();
+        const int newNumLines = document.getNumLines();
+        const int delta = newNumLines - oldNumLines;
+
+        firstLine = jlimit (0, jmin (oldNumLines, newNumLines), firstLine);
+
+        // The document gives lines that an edit didn't touch their original string objects, so
+        // the changed region ends where the old and new lines start sharing their text again.
+        int numOldLines = jmax (0, -delta);
+
+        while (firstLine + numOldLines < oldNumLines
+                && ! isSameString (shadowLines.getReference (firstLine + numOldLines),
+                                   document.getLine (firstLine + numOldLines + delta)))
+            ++numOldLines;
+
+        Array <String> newLines;
+        newLines.ensureStorageAllocated (numOldLines + delta);
+
+        for (int i = 0; i < numOldLines + delta; ++i)
+            newLines.add (document.getLine (firstLine + i));
+
+        shadowLines.removeRange (firstLine, numOldLines);
+        shadowLines.insertArray (firstLine, newLines.getRawDataPointer(), newLines.size());
+
+        postChange (firstLine, numOldLines, newLines);
+    }
+
+    /* Finds the nearest line at or before the given one whose checkpoint is known, and
+       returns its index. The position of the token boundary to start tokenising from is
+       returned in checkpointPosition. The start of the document always counts as a
+       checkpoint, so while line 0 is being re-tokenised this returns 0 and position 0.
+    */
+    int findCheckpoint (int line, int& checkpointPosition)
+    {
+        const ScopedLock sl (stateLock);
+
+        int numApplied = 0;
+        while (numApplied < damagedLines.size() && damagedLines.getReference (numApplied).generation <= appliedGeneration)
+            ++numApplied;
+
+        damagedLines.removeRange (0, numApplied);
+
+        int numValidLines = firstInvalidLine;
+
+        for (int i = damagedLines.size(); --i >= 0;)
+            numValidLines = jmin (numValidLines, damagedLines.getReference (i).line);
+
+        line = jmin (line, numValidLines - 1);
+
+        if (line <= 0)
+        {
+            checkpointPosition = 0;
+            return 0;
+        }
+
+        checkpointPosition = jmax (0, getLineStart (owner.getDocument(), line) - lineStates.getUnchecked (line));
+        return line;
+    }
+
+    // False if the tokeniser couldn't be copied, in which case there's no thread, and
+    // catchUpWithLine() has to be called on the message thread instead.
+    bool isRunningInBackground() const noexcept     { return tokeniserCopy != nullptr; }
+
+    void catchUpWithLine (const int line)
+    {
+        jassert (! isRunningInBackground());
+
+        applyPendingChanges();
+
+        while (firstInvalidLine <= line && ! tokeniseSomeLines())
+        {}
+    }
+
+    // Asks for the owner to be refreshed when the thread has caught up with this line.
+    void waitForLine (const int line)
+    {
+        lineToWaitFor = line;
+        thread.moveToFrontOfQueue (this);
+    }
+
+    //==============================================================================
+    int useTimeSlice()
+    {
+        applyPendingChanges();
+
+        const bool finished = tokeniseSomeLines();
+
+        const int lineNeeded = lineToWaitFor.get();
+
+        if (lineNeeded >= 0 && (finished || lineNeeded < firstInvalidLine)
+             && lineToWaitFor.compareAndSetBool (-1, lineNeeded))
+            owner.triggerAsyncUpdate();
+
+        return finished ? 500 : 0;
+    }
+
+private:
+    //==============================================================================
+    struct PendingChange
+    {
+        PendingChange (int startLine_, int numOldLines_, const Array <String>& newLines_, int generation_)
+            : startLine (startLine_), numOldLines (numOldLines_),
+              newLines (newLines_), generation (generation_)
+        {
+        }
+
+        int startLine, numOldLines;
+        Array <String> newLines;
+        int generation;
+    };
+
+    struct DamagedLine
+    {
+        DamagedLine (int generation_, int line_) noexcept  : generation (generation_), line (line_) {}
+
+        int generation, line;
+    };
+
+    CodeEditorComponent& owner;
+    ScopedPointer <CodeTokeniser> tokeniserCopy;
+    CodeTokeniser& tokeniser;
+    TimeSliceThread thread;
+
+    // only used by the message thread..
+    Array <String> shadowLines;
+    Array <DamagedLine> damagedLines;
+
+    // only used by the background thread..
+    CodeDocument mirror;
+
+    CriticalSection changeLock, stateLock;
+    OwnedArray <PendingChange> pendingChanges;
+    Array <int> lineStates;
+    int firstInvalidLine, lastDamagedLine, repairFrontier, appliedGeneration, lastPostedGeneration;
+    Atomic <int> lineToWaitFor;
+
+    static bool isSameString (const String& s1, const String& s2) noexcept
+    {
+        return s1.getCharPointer().getAddress() == s2.getCharPointer().getAddress();
+    }
+
+    static int getLineStart (const CodeDocument& document, const int line)
+    {
+        if (line >= document.getNumLines())
+            return document.getNumCharacters();
+
+        return CodeDocument::Position (&document, line, 0).getPosition();
+    }
+
+    void postChange (const int startLine, const int numOldLines, const Array <String>& newLines)
+    {
+        ++lastPostedGeneration;
+
+        damagedLines.add (DamagedLine (lastPostedGeneration, startLine));
+
+        {
+            const ScopedLock sl (changeLock);
+            pendingChanges.add (new PendingChange (startLine, numOldLines, newLines, lastPostedGeneration));
+        }
+
+        thread.moveToFrontOfQueue (this);
+    }
+
+    void applyPendingChanges()
+    {
+        OwnedArray <PendingChange> changes;
+
+        {
+            const ScopedLock sl (changeLock);
+            changes.swapWithArray (pendingChanges);
+        }
+
+        if (changes.size() == 0)
+            return;
+
+        for (int i = 0; i < changes.size(); ++i)
+        {
+            const PendingChange& change = *changes.getUnchecked (i);
+
+            const int start = getLineStart (mirror, change.startLine);
+            const int end = getLineStart (mirror, change.startLine + change.numOldLines);
+
+            MemoryOutputStream newText;
+            for (int j = 0; j < change.newLines.size(); ++j)
+                newText << change.newLines.getReference (j);
+
+            mirror.deleteSection (CodeDocument::Position (&mirror, start), CodeDocument::Position (&mirror, end));
+            mirror.insertText (CodeDocument::Position (&mirror, start), newText.toString());
+        }
+
+        mirror.clearUndoHistory();
+
+        const ScopedLock sl (stateLock);
+
+        for (int i = 0; i < changes.size(); ++i)
+        {
+            const PendingChange& change = *changes.getUnchecked (i);
+            const int numNewLines = change.newLines.size();
+
+            // If an earlier repair was still in progress, the states beyond the point it had got
+            // to are older than the ones before it, so a new repair mustn't stop short of there.
+            if (change.startLine < firstInvalidLine && firstInvalidLine < lineStates.size())
+                repairFrontier = jmax (repairFrontier, firstInvalidLine);
+
+            lineStates.removeRange (change.startLine, change.numOldLines);
+            lineStates.insertMultiple (change.startLine, -1, numNewLines);
+
+            lastDamagedLine = adjustLineForChange (lastDamagedLine, change);
+            repairFrontier  = adjustLineForChange (repairFrontier, change);
+
+            // (the line after an edit is included in case the tokeniser looked ahead into it)
+            lastDamagedLine = jmax (lastDamagedLine, change.startLine + numNewLines);
+            firstInvalidLine = jmin (firstInvalidLine, change.startLine);
+        }
+
+        appliedGeneration = changes.getLast()->generation;
+
+        jassert (lineStates.size() == mirror.getNumLines());
+    }
+
+    static int adjustLineForChange (const int line, const PendingChange& change) noexcept
+    {
+        if (line >= change.startLine + change.numOldLines)
+            return line + change.newLines.size() - change.numOldLines;
+
+        if (line > change.startLine)
+            return change.startLine + change.newLines.size();
+
+        return line;
+    }
+
+    void setLineState (const int line, const int state)
+    {
+        const ScopedLock sl (stateLock);
+        lineStates.set (line, state);
+        firstInvalidLine = line + 1;
+    }
+
+    void markAllLinesValidFrom (int line)
+    {
+        const ScopedLock sl (stateLock);
+
+        while (line < lineStates.size() && lineStates.getUnchecked (line) >= 0)
+            ++line;
+
+        firstInvalidLine = line;
+        lastDamagedLine = -1;
+        repairFrontier = 0;
+    }
+
+    // Returns true when every line has an up-to-date checkpoint.
+    bool tokeniseSomeLines()
+    {
+        const int numLines = mirror.getNumLines();
+        int line = firstInvalidLine;
+
+        if (line >= numLines)
+        {
+            markAllLinesValidFrom (numLines);
+            return true;
+        }
+
+        if (line == 0)
+        {
+            setLineState (0, 0);
+
+            if (++line >= numLines)
+            {
+                markAllLinesValidFrom (numLines);
+                return true;
+            }
+        }
+
+        CodeDocument::Iterator source (CodeDocument::Position (&mirror, getLineStart (mirror, line - 1)
+                                                                          - lineStates.getUnchecked (line - 1)));
+        int tokenStart = source.getPosition();
+        int lineStart = getLineStart (mirror, line);
+        const int endOfDamage = getLineStart (mirror, lastDamagedLine + 1);
+        const uint32 endTime = Time::getMillisecondCounter() + 10;
+
+        for (;;)
+        {
+            tokeniser.readNextToken (source);
+
+            const int tokenEnd = source.getPosition() > tokenStart ? source.getPosition()
+                                                                   : std::numeric_limits<int>::max();
+
+            while (lineStart < tokenEnd)
+            {
+                const int state = lineStart - tokenStart;
+
+                if (line > lastDamagedLine && line >= repairFrontier && tokenStart >= endOfDamage
+                     && lineStates.getUnchecked (line) == state)
+                {
+                    markAllLinesValidFrom (line);
+                    return firstInvalidLine >= numLines;
+                }
+
+                setLineState (line, state);
+
+                if (++line >= numLines)
+                {
+                    markAllLinesValidFrom (numLines);
+                    return true;
+                }
+
+                lineStart = getLineStart (mirror, line);
+            }
+
+            tokenStart = tokenEnd;
+
+            if (Time::getMillisecondCounter() > endTime || thread.threadShouldExit())
+                return false;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BackgroundTokeniser);
+};
+
 //==============================================================================
 CodeEditorComponent::CodeEditorComponent (CodeDocument& document_,
                                           CodeTokeniser* const codeTokeniser_)
@@ -256,6 +629,9 @@ CodeEditorComponent::CodeEditorComponent (CodeDocument& document_,
     selectionEnd = CodeDocument::Position (&document_, 0, 0);
     selectionEnd.setPositionMaintained (true);
 
+    if (codeTokeniser != nullptr)
+        backgroundTokeniser = new BackgroundTokeniser (*this, *codeTokeniser);
+
     setOpaque (true);
     setMouseCursor (MouseCursor (MouseCursor::IBeamCursor));
     setWantsKeyboardFocus (true);
@@ -281,12 +657,12 @@ CodeEditorComponent::CodeEditorComponent (CodeDocument& document_,
 
 CodeEditorComponent::~CodeEditorComponent()
 {
+    backgroundTokeniser = nullptr;
     document.removeListener (this);
 }
 
 void CodeEditorComponent::loadContent (const String& newContent)
 {
-    clearCachedIterators (0);
     document.replaceAllContent (newContent);
     document.clearUndoHistory();
     document.setSavePoint();
@@ -315,7 +691,8 @@ Rectangle<int> CodeEditorComponent::getCaretRectangle()
 void CodeEditorComponent::codeDocumentChanged (const CodeDocument::Position& affectedTextStart,
                                                const CodeDocument::Position& affectedTextEnd)
 {
-    clearCachedIterators (affectedTextStart.getLineNumber());
+    if (backgroundTokeniser != nullptr)
+        backgroundTokeniser->documentChanged (affectedTextStart.getLineNumber());
 
     triggerAsyncUpdate();
 
@@ -409,13 +786,13 @@ void CodeEditorComponent::rebuildLineTokens()
     jassert (numNeeded == lines.size());
 
     CodeDocument::Iterator source (&document);
-    getIteratorForPosition (CodeDocument::Position (&document, firstLineOnScreen, 0).getPosition(), source);
+    CodeTokeniser* const tokeniser = getIteratorForLine (firstLineOnScreen, source) ? codeTokeniser : nullptr;
 
     for (int i = 0; i < numNeeded; ++i)
     {
         CodeEditorLine* const line = lines.getUnchecked(i);
 
-        if (line->update (document, firstLineOnScreen + i, source, codeTokeniser, spacesPerTab,
+        if (line->update (document, firstLineOnScreen + i, source, tokeniser, spacesPerTab,
                           selectionStart, selectionEnd))
         {
             minLineToRepaint = jmin (minLineToRepaint, i);
@@ -519,8 +896,6 @@ void CodeEditorComponent::scrollToLineInternal (int newFirstLineOnScreen)
     {
         firstLineOnScreen = newFirstLineOnScreen;
         updateCaretPosition();
-
-        updateCachedIterators (firstLineOnScreen);
         triggerAsyncUpdate();
     }
 }
@@ -1117,65 +1492,29 @@ const Colour CodeEditorComponent::getColourForTokenType (const int tokenType) co
     return coloursForTokenCategories.getReference (tokenType);
 }
 
-void CodeEditorComponent::clearCachedIterators (const int firstLineToBeInvalid)
+bool CodeEditorComponent::getIteratorForLine (const int line, CodeDocument::Iterator& source)
 {
-    int i;
-    for (i = cachedIterators.size(); --i >= 0;)
-        if (cachedIterators.getUnchecked (i)->getLine() < firstLineToBeInvalid)
-            break;
+    if (backgroundTokeniser == nullptr)
+        return false;
 
-    cachedIterators.removeRange (jmax (0, i - 1), cachedIterators.size());
-}
+    // If the background thread hasn't reached this line yet, only catch up here when it's
+    // close by - otherwise the lines are shown uncoloured until the thread has got there.
+    const int maxLinesToTokeniseSynchronously = 200;
 
-void CodeEditorComponent::updateCachedIterators (int maxLineNum)
-{
-    const int maxNumCachedPositions = 5000;
-    const int linesBetweenCachedSources = jmax (10, document.getNumLines() / maxNumCachedPositions);
-
-    if (cachedIterators.size() == 0)
-        cachedIterators.add (new CodeDocument::Iterator (&document));
+    if (! backgroundTokeniser->isRunningInBackground())
+        backgroundTokeniser->catchUpWithLine (line);
 
-    if (codeTokeniser == nullptr)
-        return;
+    int checkpointPosition = 0;
+    const int checkpointLine = backgroundTokeniser->findCheckpoint (line, checkpointPosition);
 
-    for (;;)
+    if (line - checkpointLine > maxLinesToTokeniseSynchronously)
     {
-        CodeDocument::Iterator* last = cachedIterators.getLast();
-
-        if (last->getLine() >= maxLineNum)
-            break;
-
-        CodeDocument::Iterator* t = new CodeDocument::Iterator (*last);
-        cachedIterators.add (t);
-        const int targetLine = last->getLine() + linesBetweenCachedSources;
-
-        for (;;)
-        {
-            codeTokeniser->readNextToken (*t);
-
-            if (t->getLine() >= targetLine)
-                break;
-
-            if (t->isEOF())
-                return;
-        }
+        backgroundTokeniser->waitForLine (line);
+        return false;
     }
-}
 
-void CodeEditorComponent::getIteratorForPosition (int position, CodeDocument::Iterator& source)
-{
-    if (codeTokeniser == nullptr)
-        return;
-
-    for (int i = cachedIterators.size(); --i >= 0;)
-    {
-        CodeDocument::Iterator* t = cachedIterators.getUnchecked (i);
-        if (t->getPosition() <= position)
-        {
-            source = *t;
-            break;
-        }
-    }
+    source = CodeDocument::Iterator (CodeDocument::Position (&document, checkpointPosition));
+    const int position = CodeDocument::Position (&document, line, 0).getPosition();
 
     while (source.getPosition() < position)
     {
@@ -1188,6 +1527,8 @@ void CodeEditorComponent::getIteratorForPosition (int position, CodeDocument::It
             break;
         }
     }
+
+    return true;
 }
 
 END_JUCE_NAMESPACE
@@ -52,6 +52,10 @@ public:
         The object that you pass in is not owned or deleted by the editor - you must
         make sure that it doesn't get deleted while this component is still using it.
 
+        If the tokeniser's createCopy() method returns a new tokeniser, the editor uses that
+        copy to keep the tokeniser's state for the whole document up-to-date on a background
+        thread. Otherwise, this is done on the message thread while the editor is being painted.
+
         @see CodeDocument
     */
     CodeEditorComponent (CodeDocument& document,
@@ -287,10 +291,10 @@ private:
     OwnedArray <CodeEditorLine> lines;
     void rebuildLineTokens();
 
-    OwnedArray <CodeDocument::Iterator> cachedIterators;
-    void clearCachedIterators (int firstLineToBeInvalid);
-    void updateCachedIterators (int maxLineNum);
-    void getIteratorForPosition (int position, CodeDocument::Iterator& result);
+    class BackgroundTokeniser;
+    friend class BackgroundTokeniser;
+    ScopedPointer <BackgroundTokeniser> backgroundTokeniser;
+    bool getIteratorForLine (int line, CodeDocument::Iterator& result);
     void moveLineDelta (int delta, bool selecting);
 
     //==============================================================================
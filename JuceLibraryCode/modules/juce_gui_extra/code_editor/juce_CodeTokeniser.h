@@ -62,6 +62,14 @@ public:
     */
     virtual Colour getDefaultColour (int tokenType) = 0;
 
+    /** Creates a new tokeniser that works in the same way as this one.
+
+        The CodeEditorComponent uses the copy to tokenise the document on a background
+        thread, while the original carries on being used by the message thread. If a
+        tokeniser can't be copied, it should return nullptr, and the editor will then
+        only call it from the message thread.
+    */
+    virtual CodeTokeniser* createCopy() const       { return nullptr; }
 
 private:
     //==============================================================================
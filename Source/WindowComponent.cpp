@@ -342,39 +342,42 @@ void WindowComponent::readXMLLayout(String xmlFile, Label* labelOne, LayoutLabel
 {
     String xmlPath = File::getSpecialLocation(File::userHomeDirectory).getFullPathName();
     xmlPath += "/Projects/JuceText/SampleText/";
-    XmlDocument myDocument (File (xmlPath + xmlFile));
-    ScopedPointer<XmlElement> xml (myDocument.getDocumentElement());
-    if (xml != nullptr && xml->hasTagName ("textarray"))
+    // Stream through the file rather than building the whole tree, skipping
+    // every child before the one we want and stopping as soon as it's been read.
+    XmlPullParser parser (File (xmlPath + xmlFile));
+    if (parser.next() && parser.hasTagName ("textarray"))
     {
         int subCounter = 0;
-        forEachXmlChildElement (*xml, e)
+        while (parser.next() && parser.getEventType() != XmlPullParser::endElement)
         {
-            if (subCounter != counter)
-            {
-                subCounter++;
+            if (parser.getEventType() != XmlPullParser::startElement)
                 continue;
-            }
-            if (e->hasTagName ("text"))
+            if (subCounter != counter || ! parser.hasTagName ("text"))
             {
-                ScopedPointer<AttributedString> as1;
-                as1 = new AttributedString(e->getAllSubText());
-                // Test Colored Text
-                //as1->setForegroundColour(3, 5, Colours::blue);
-                // Test Single Font
-                Font lucidiaGrande("Lucidia Grande", 13.0f, 0);
-                as1->setFont(0, e->getAllSubText().length(), lucidiaGrande);
-                // Test Multiple Fonts
-                /*Font lucidiaGrande("Lucidia Grande", 13.0f, 0);
-                as1->setFont(0, 5, lucidiaGrande);
-                Font times("Times", 13.0f, 0);
-                as1->setFont(6, e->getAllSubText().length(), times);*/
-                // Test Paragraph Alignment
-                //as1->setTextAlignment(AttributedString::center);
-                labelOne->setText (e->getAllSubText(), false);
-                labelTwo->setAttributedText (as1, false);
-                counter++;
-                break;
+                if (subCounter != counter)
+                    subCounter++;
+                parser.skipElement();
+                continue;
             }
+            const String text (parser.readElementText());
+            ScopedPointer<AttributedString> as1;
+            as1 = new AttributedString(text);
+            // Test Colored Text
+            //as1->setForegroundColour(3, 5, Colours::blue);
+            // Test Single Font
+            Font lucidiaGrande("Lucidia Grande", 13.0f, 0);
+            as1->setFont(0, text.length(), lucidiaGrande);
+            // Test Multiple Fonts
+            /*Font lucidiaGrande("Lucidia Grande", 13.0f, 0);
+            as1->setFont(0, 5, lucidiaGrande);
+            Font times("Times", 13.0f, 0);
+            as1->setFont(6, text.length(), times);*/
+            // Test Paragraph Alignment
+            //as1->setTextAlignment(AttributedString::center);
+            labelOne->setText (text, false);
+            labelTwo->setAttributedText (as1, false);
+            counter++;
+            break;
         }
         if (subCounter == counter) counter = 0;
     }